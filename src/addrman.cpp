@@ -6,6 +6,7 @@
 #include <addrman.h>
 #include <addrman_impl.h>
 
+#include <crypto/common.h>
 #include <hash.h>
 #include <logging.h>
 #include <logging/timer.h>
@@ -20,6 +21,7 @@
 #include <util/time.h>
 
 #include <cmath>
+#include <memory>
 #include <optional>
 
 /** Over how many buckets entries with tried addresses from a single group (/16 for IPv4) are spread */
@@ -104,22 +106,28 @@ double AddrInfo::GetChance(NodeSeconds now) const
     return fChance;
 }
 
+AddrTables::AddrTables()
+{
+    // All pages start out as the same page of empty positions, which is unshared on the first write.
+    const auto empty_page{std::make_shared<SlotPage>()};
+    empty_page->fill(-1);
+    m_slot_pages.assign((NEW_SLOTS + TRIED_SLOTS) / SLOTS_PER_PAGE, empty_page);
+}
+
+void AddrTables::Reserve(size_t capacity)
+{
+    while (Capacity() < capacity) {
+        m_info_pages.push_back(std::make_shared<InfoPage>());
+    }
+}
+
 AddrManImpl::AddrManImpl(const NetGroupManager& netgroupman, bool deterministic, int32_t consistency_check_ratio)
     : insecure_rand{deterministic}
     , nKey{deterministic ? uint256{1} : insecure_rand.rand256()}
     , m_consistency_check_ratio{consistency_check_ratio}
     , m_netgroupman{netgroupman}
+    , m_select_seed{deterministic ? uint256{2} : insecure_rand.rand256()}
 {
-    for (auto& bucket : vvNew) {
-        for (auto& entry : bucket) {
-            entry = -1;
-        }
-    }
-    for (auto& bucket : vvTried) {
-        for (auto& entry : bucket) {
-            entry = -1;
-        }
-    }
 }
 
 AddrManImpl::~AddrManImpl()
@@ -130,7 +138,9 @@ AddrManImpl::~AddrManImpl()
 template <typename Stream>
 void AddrManImpl::Serialize(Stream& s_) const
 {
-    LOCK(cs);
+    // Write a snapshot, so that cs is not held while writing to disk.
+    const auto snapshot{GetSnapshot(/*wait=*/true)};
+    const AddrTables& tables{snapshot->tables};
 
     /**
      * Serialized format.
@@ -160,7 +170,7 @@ void AddrManImpl::Serialize(Stream& s_) const
      * as incompatible. This is necessary because it did not check the version number on
      * deserialization.
      *
-     * vvNew, vvTried, mapInfo, mapAddr and vRandom are never encoded explicitly;
+     * The bucket positions of the entries, mapAddr and vRandom are never encoded explicitly;
      * they are instead reconstructed from the other information.
      *
      * This format is more complex, but significantly smaller (at most 1.5 MiB), and supports
@@ -181,41 +191,47 @@ void AddrManImpl::Serialize(Stream& s_) const
     s << static_cast<uint8_t>(INCOMPATIBILITY_BASE + lowest_compatible);
 
     s << nKey;
-    s << nNew;
-    s << nTried;
+    s << snapshot->n_new;
+    s << snapshot->n_tried;
 
     int nUBuckets = ADDRMAN_NEW_BUCKET_COUNT ^ (1 << 30);
     s << nUBuckets;
-    std::unordered_map<int, int> mapUnkIds;
+    // New entries are written in the order of their first position in the new buckets.
+    // Their index in that order is what the buckets refer to them by.
+    std::vector<int> ser_ids(tables.Capacity(), -1);
     int nIds = 0;
-    for (const auto& entry : mapInfo) {
-        mapUnkIds[entry.first] = nIds;
-        const AddrInfo& info = entry.second;
-        if (info.nRefCount) {
-            assert(nIds != nNew); // this means nNew was wrong, oh ow
-            s << info;
-            nIds++;
+    for (int bucket = 0; bucket < ADDRMAN_NEW_BUCKET_COUNT; bucket++) {
+        for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
+            const nid_type nid{tables.GetEntry(/*use_tried=*/false, bucket, i)};
+            if (nid != -1 && ser_ids[nid] == -1) {
+                assert(nIds != snapshot->n_new); // this means nNew was wrong, oh ow
+                ser_ids[nid] = nIds++;
+                s << tables.GetInfo(nid);
+            }
         }
     }
     nIds = 0;
-    for (const auto& entry : mapInfo) {
-        const AddrInfo& info = entry.second;
-        if (info.fInTried) {
-            assert(nIds != nTried); // this means nTried was wrong, oh ow
-            s << info;
-            nIds++;
+    for (int bucket = 0; bucket < ADDRMAN_TRIED_BUCKET_COUNT; bucket++) {
+        for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
+            const nid_type nid{tables.GetEntry(/*use_tried=*/true, bucket, i)};
+            if (nid != -1) {
+                assert(nIds != snapshot->n_tried); // this means nTried was wrong, oh ow
+                s << tables.GetInfo(nid);
+                nIds++;
+            }
         }
     }
     for (int bucket = 0; bucket < ADDRMAN_NEW_BUCKET_COUNT; bucket++) {
         int nSize = 0;
         for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
-            if (vvNew[bucket][i] != -1)
+            if (tables.GetEntry(/*use_tried=*/false, bucket, i) != -1)
                 nSize++;
         }
         s << nSize;
         for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
-            if (vvNew[bucket][i] != -1) {
-                int nIndex = mapUnkIds[vvNew[bucket][i]];
+            const nid_type nid{tables.GetEntry(/*use_tried=*/false, bucket, i)};
+            if (nid != -1) {
+                int nIndex = ser_ids[nid];
                 s << nIndex;
             }
         }
@@ -277,16 +293,14 @@ void AddrManImpl::Unserialize(Stream& s_)
                     ADDRMAN_TRIED_BUCKET_COUNT * ADDRMAN_BUCKET_SIZE));
     }
 
-    // Deserialize entries from the new table.
+    // Deserialize entries from the new table. They get the nIds 0 to nNew - 1.
     for (int n = 0; n < nNew; n++) {
-        AddrInfo& info = mapInfo[n];
+        const nid_type nid{AllocateId()};
+        AddrInfo& info = m_tables.GetMutableInfo(nid);
         s >> info;
-        mapAddr[info] = n;
-        info.nRandomPos = vRandom.size();
-        vRandom.push_back(n);
+        mapAddr[info] = nid;
         m_network_counts[info.GetNetwork()].n_new++;
     }
-    nIdCount = nNew;
 
     // Deserialize entries from the tried table.
     int nLost = 0;
@@ -296,14 +310,12 @@ void AddrManImpl::Unserialize(Stream& s_)
         int nKBucket = info.GetTriedBucket(nKey, m_netgroupman);
         int nKBucketPos = info.GetBucketPosition(nKey, false, nKBucket);
         if (info.IsValid()
-                && vvTried[nKBucket][nKBucketPos] == -1) {
-            info.nRandomPos = vRandom.size();
+                && m_tables.GetEntry(/*use_tried=*/true, nKBucket, nKBucketPos) == -1) {
+            const nid_type nid{AllocateId()};
             info.fInTried = true;
-            vRandom.push_back(nIdCount);
-            mapInfo[nIdCount] = info;
-            mapAddr[info] = nIdCount;
-            vvTried[nKBucket][nKBucketPos] = nIdCount;
-            nIdCount++;
+            m_tables.GetMutableInfo(nid) = info;
+            mapAddr[info] = nid;
+            m_tables.SetEntry(/*use_tried=*/true, nKBucket, nKBucketPos, nid);
             m_network_counts[info.GetNetwork()].n_tried++;
         } else {
             nLost++;
@@ -346,7 +358,7 @@ void AddrManImpl::Unserialize(Stream& s_)
     for (auto bucket_entry : bucket_entries) {
         int bucket{bucket_entry.first};
         const int entry_index{bucket_entry.second};
-        AddrInfo& info = mapInfo[entry_index];
+        AddrInfo& info = m_tables.GetMutableInfo(entry_index);
 
         // Don't store the entry in the new bucket if it's not a valid address for our addrman
         if (!info.IsValid()) continue;
@@ -357,17 +369,17 @@ void AddrManImpl::Unserialize(Stream& s_)
         if (info.nRefCount >= ADDRMAN_NEW_BUCKETS_PER_ADDRESS) continue;
 
         int bucket_position = info.GetBucketPosition(nKey, true, bucket);
-        if (restore_bucketing && vvNew[bucket][bucket_position] == -1) {
+        if (restore_bucketing && m_tables.GetEntry(/*use_tried=*/false, bucket, bucket_position) == -1) {
             // Bucketing has not changed, using existing bucket positions for the new table
-            vvNew[bucket][bucket_position] = entry_index;
+            m_tables.SetEntry(/*use_tried=*/false, bucket, bucket_position, entry_index);
             ++info.nRefCount;
         } else {
             // In case the new table data cannot be used (bucket count wrong or new asmap),
             // try to give them a reference based on their primary source address.
             bucket = info.GetNewBucket(nKey, m_netgroupman);
             bucket_position = info.GetBucketPosition(nKey, true, bucket);
-            if (vvNew[bucket][bucket_position] == -1) {
-                vvNew[bucket][bucket_position] = entry_index;
+            if (m_tables.GetEntry(/*use_tried=*/false, bucket, bucket_position) == -1) {
+                m_tables.SetEntry(/*use_tried=*/false, bucket, bucket_position, entry_index);
                 ++info.nRefCount;
             }
         }
@@ -375,18 +387,17 @@ void AddrManImpl::Unserialize(Stream& s_)
 
     // Prune new entries with refcount 0 (as a result of collisions or invalid address).
     int nLostUnk = 0;
-    for (auto it = mapInfo.cbegin(); it != mapInfo.cend(); ) {
-        if (it->second.fInTried == false && it->second.nRefCount == 0) {
-            const auto itCopy = it++;
-            Delete(itCopy->first);
+    for (nid_type nid = 0; nid < nid_type(m_random_pos.size()); nid++) {
+        const AddrInfo& info = m_tables.GetInfo(nid);
+        if (m_random_pos[nid] != -1 && info.fInTried == false && info.nRefCount == 0) {
+            Delete(nid);
             ++nLostUnk;
-        } else {
-            ++it;
         }
     }
     if (nLost + nLostUnk > 0) {
         LogPrint(BCLog::ADDRMAN, "addrman lost %i new and %i tried addresses due to collisions or invalid addresses\n", nLostUnk, nLost);
     }
+    ++m_version;
 
     const int check_code{CheckAddrman()};
     if (check_code != 0) {
@@ -396,7 +407,7 @@ void AddrManImpl::Unserialize(Stream& s_)
     }
 }
 
-AddrInfo* AddrManImpl::Find(const CService& addr, int* pnId)
+AddrInfo* AddrManImpl::Find(const CService& addr, nid_type* pnId)
 {
     AssertLockHeld(cs);
 
@@ -405,26 +416,40 @@ AddrInfo* AddrManImpl::Find(const CService& addr, int* pnId)
         return nullptr;
     if (pnId)
         *pnId = (*it).second;
-    const auto it2 = mapInfo.find((*it).second);
-    if (it2 != mapInfo.end())
-        return &(*it2).second;
-    return nullptr;
+    return &m_tables.GetMutableInfo((*it).second);
 }
 
-AddrInfo* AddrManImpl::Create(const CAddress& addr, const CNetAddr& addrSource, int* pnId)
+AddrInfo* AddrManImpl::Create(const CAddress& addr, const CNetAddr& addrSource, nid_type* pnId)
 {
     AssertLockHeld(cs);
 
-    int nId = nIdCount++;
-    mapInfo[nId] = AddrInfo(addr, addrSource);
+    const nid_type nId{AllocateId()};
+    AddrInfo& info = m_tables.GetMutableInfo(nId);
+    info = AddrInfo(addr, addrSource);
     mapAddr[addr] = nId;
-    mapInfo[nId].nRandomPos = vRandom.size();
-    vRandom.push_back(nId);
     nNew++;
     m_network_counts[addr.GetNetwork()].n_new++;
     if (pnId)
         *pnId = nId;
-    return &mapInfo[nId];
+    return &info;
+}
+
+nid_type AddrManImpl::AllocateId()
+{
+    AssertLockHeld(cs);
+
+    nid_type nId;
+    if (!m_free_ids.empty()) {
+        nId = m_free_ids.back();
+        m_free_ids.pop_back();
+    } else {
+        nId = m_random_pos.size();
+        m_random_pos.push_back(-1);
+        m_tables.Reserve(m_random_pos.size());
+    }
+    m_random_pos[nId] = vRandom.size();
+    vRandom.push_back(nId);
+    return nId;
 }
 
 void AddrManImpl::SwapRandom(unsigned int nRndPos1, unsigned int nRndPos2) const
@@ -436,35 +461,34 @@ void AddrManImpl::SwapRandom(unsigned int nRndPos1, unsigned int nRndPos2) const
 
     assert(nRndPos1 < vRandom.size() && nRndPos2 < vRandom.size());
 
-    int nId1 = vRandom[nRndPos1];
-    int nId2 = vRandom[nRndPos2];
+    nid_type nId1 = vRandom[nRndPos1];
+    nid_type nId2 = vRandom[nRndPos2];
 
-    const auto it_1{mapInfo.find(nId1)};
-    const auto it_2{mapInfo.find(nId2)};
-    assert(it_1 != mapInfo.end());
-    assert(it_2 != mapInfo.end());
-
-    it_1->second.nRandomPos = nRndPos2;
-    it_2->second.nRandomPos = nRndPos1;
+    m_random_pos[nId1] = nRndPos2;
+    m_random_pos[nId2] = nRndPos1;
 
     vRandom[nRndPos1] = nId2;
     vRandom[nRndPos2] = nId1;
 }
 
-void AddrManImpl::Delete(int nId)
+void AddrManImpl::Delete(nid_type nId)
 {
     AssertLockHeld(cs);
 
-    assert(mapInfo.count(nId) != 0);
-    AddrInfo& info = mapInfo[nId];
+    assert(m_random_pos[nId] != -1);
+    AddrInfo& info = m_tables.GetMutableInfo(nId);
     assert(!info.fInTried);
     assert(info.nRefCount == 0);
 
-    SwapRandom(info.nRandomPos, vRandom.size() - 1);
+    SwapRandom(m_random_pos[nId], vRandom.size() - 1);
     m_network_counts[info.GetNetwork()].n_new--;
     vRandom.pop_back();
     mapAddr.erase(info);
-    mapInfo.erase(nId);
+    info = AddrInfo{};
+    m_random_pos[nId] = -1;
+    m_free_ids.push_back(nId);
+    // The nId will be handed out again, so it must not be taken for a colliding entry anymore.
+    m_tried_collisions.erase(nId);
     nNew--;
 }
 
@@ -473,12 +497,12 @@ void AddrManImpl::ClearNew(int nUBucket, int nUBucketPos)
     AssertLockHeld(cs);
 
     // if there is an entry in the specified bucket, delete it.
-    if (vvNew[nUBucket][nUBucketPos] != -1) {
-        int nIdDelete = vvNew[nUBucket][nUBucketPos];
-        AddrInfo& infoDelete = mapInfo[nIdDelete];
+    const nid_type nIdDelete{m_tables.GetEntry(/*use_tried=*/false, nUBucket, nUBucketPos)};
+    if (nIdDelete != -1) {
+        AddrInfo& infoDelete = m_tables.GetMutableInfo(nIdDelete);
         assert(infoDelete.nRefCount > 0);
         infoDelete.nRefCount--;
-        vvNew[nUBucket][nUBucketPos] = -1;
+        m_tables.SetEntry(/*use_tried=*/false, nUBucket, nUBucketPos, -1);
         LogPrint(BCLog::ADDRMAN, "Removed %s from new[%i][%i]\n", infoDelete.ToStringAddrPort(), nUBucket, nUBucketPos);
         if (infoDelete.nRefCount == 0) {
             Delete(nIdDelete);
@@ -486,7 +510,7 @@ void AddrManImpl::ClearNew(int nUBucket, int nUBucketPos)
     }
 }
 
-void AddrManImpl::MakeTried(AddrInfo& info, int nId)
+void AddrManImpl::MakeTried(AddrInfo& info, nid_type nId)
 {
     AssertLockHeld(cs);
 
@@ -495,8 +519,8 @@ void AddrManImpl::MakeTried(AddrInfo& info, int nId)
     for (int n = 0; n < ADDRMAN_NEW_BUCKET_COUNT; ++n) {
         const int bucket{(start_bucket + n) % ADDRMAN_NEW_BUCKET_COUNT};
         const int pos{info.GetBucketPosition(nKey, true, bucket)};
-        if (vvNew[bucket][pos] == nId) {
-            vvNew[bucket][pos] = -1;
+        if (m_tables.GetEntry(/*use_tried=*/false, bucket, pos) == nId) {
+            m_tables.SetEntry(/*use_tried=*/false, bucket, pos, -1);
             info.nRefCount--;
             if (info.nRefCount == 0) break;
         }
@@ -511,15 +535,15 @@ void AddrManImpl::MakeTried(AddrInfo& info, int nId)
     int nKBucketPos = info.GetBucketPosition(nKey, false, nKBucket);
 
     // first make space to add it (the existing tried entry there is moved to new, deleting whatever is there).
-    if (vvTried[nKBucket][nKBucketPos] != -1) {
+    if (m_tables.GetEntry(/*use_tried=*/true, nKBucket, nKBucketPos) != -1) {
         // find an item to evict
-        int nIdEvict = vvTried[nKBucket][nKBucketPos];
-        assert(mapInfo.count(nIdEvict) == 1);
-        AddrInfo& infoOld = mapInfo[nIdEvict];
+        const nid_type nIdEvict{m_tables.GetEntry(/*use_tried=*/true, nKBucket, nKBucketPos)};
+        assert(m_random_pos[nIdEvict] != -1);
+        AddrInfo& infoOld = m_tables.GetMutableInfo(nIdEvict);
 
         // Remove the to-be-evicted item from the tried set.
         infoOld.fInTried = false;
-        vvTried[nKBucket][nKBucketPos] = -1;
+        m_tables.SetEntry(/*use_tried=*/true, nKBucket, nKBucketPos, -1);
         nTried--;
         m_network_counts[infoOld.GetNetwork()].n_tried--;
 
@@ -527,19 +551,19 @@ void AddrManImpl::MakeTried(AddrInfo& info, int nId)
         int nUBucket = infoOld.GetNewBucket(nKey, m_netgroupman);
         int nUBucketPos = infoOld.GetBucketPosition(nKey, true, nUBucket);
         ClearNew(nUBucket, nUBucketPos);
-        assert(vvNew[nUBucket][nUBucketPos] == -1);
+        assert(m_tables.GetEntry(/*use_tried=*/false, nUBucket, nUBucketPos) == -1);
 
         // Enter it into the new set again.
         infoOld.nRefCount = 1;
-        vvNew[nUBucket][nUBucketPos] = nIdEvict;
+        m_tables.SetEntry(/*use_tried=*/false, nUBucket, nUBucketPos, nIdEvict);
         nNew++;
         m_network_counts[infoOld.GetNetwork()].n_new++;
         LogPrint(BCLog::ADDRMAN, "Moved %s from tried[%i][%i] to new[%i][%i] to make space\n",
                  infoOld.ToStringAddrPort(), nKBucket, nKBucketPos, nUBucket, nUBucketPos);
     }
-    assert(vvTried[nKBucket][nKBucketPos] == -1);
+    assert(m_tables.GetEntry(/*use_tried=*/true, nKBucket, nKBucketPos) == -1);
 
-    vvTried[nKBucket][nKBucketPos] = nId;
+    m_tables.SetEntry(/*use_tried=*/true, nKBucket, nKBucketPos, nId);
     nTried++;
     info.fInTried = true;
     m_network_counts[info.GetNetwork()].n_tried++;
@@ -552,7 +576,7 @@ bool AddrManImpl::AddSingle(const CAddress& addr, const CNetAddr& source, std::c
     if (!addr.IsRoutable())
         return false;
 
-    int nId;
+    nid_type nId;
     AddrInfo* pinfo = Find(addr, &nId);
 
     // Do not set a penalty for a source's self-announcement
@@ -597,10 +621,11 @@ bool AddrManImpl::AddSingle(const CAddress& addr, const CNetAddr& source, std::c
 
     int nUBucket = pinfo->GetNewBucket(nKey, source, m_netgroupman);
     int nUBucketPos = pinfo->GetBucketPosition(nKey, true, nUBucket);
-    bool fInsert = vvNew[nUBucket][nUBucketPos] == -1;
-    if (vvNew[nUBucket][nUBucketPos] != nId) {
+    const nid_type nIdExisting{m_tables.GetEntry(/*use_tried=*/false, nUBucket, nUBucketPos)};
+    bool fInsert = nIdExisting == -1;
+    if (nIdExisting != nId) {
         if (!fInsert) {
-            AddrInfo& infoExisting = mapInfo[vvNew[nUBucket][nUBucketPos]];
+            const AddrInfo& infoExisting = m_tables.GetInfo(nIdExisting);
             if (infoExisting.IsTerrible() || (infoExisting.nRefCount > 1 && pinfo->nRefCount == 0)) {
                 // Overwrite the existing new table entry.
                 fInsert = true;
@@ -609,7 +634,7 @@ bool AddrManImpl::AddSingle(const CAddress& addr, const CNetAddr& source, std::c
         if (fInsert) {
             ClearNew(nUBucket, nUBucketPos);
             pinfo->nRefCount++;
-            vvNew[nUBucket][nUBucketPos] = nId;
+            m_tables.SetEntry(/*use_tried=*/false, nUBucket, nUBucketPos, nId);
             LogPrint(BCLog::ADDRMAN, "Added %s mapped to AS%i to new[%i][%i]\n",
                      addr.ToStringAddrPort(), m_netgroupman.GetMappedAS(addr), nUBucket, nUBucketPos);
         } else {
@@ -625,7 +650,7 @@ bool AddrManImpl::Good_(const CService& addr, bool test_before_evict, NodeSecond
 {
     AssertLockHeld(cs);
 
-    int nId;
+    nid_type nId;
 
     m_last_good = time;
 
@@ -655,14 +680,14 @@ bool AddrManImpl::Good_(const CService& addr, bool test_before_evict, NodeSecond
     int tried_bucket_pos = info.GetBucketPosition(nKey, false, tried_bucket);
 
     // Will moving this address into tried evict another entry?
-    if (test_before_evict && (vvTried[tried_bucket][tried_bucket_pos] != -1)) {
+    const nid_type colliding_id{m_tables.GetEntry(/*use_tried=*/true, tried_bucket, tried_bucket_pos)};
+    if (test_before_evict && (colliding_id != -1)) {
         if (m_tried_collisions.size() < ADDRMAN_SET_TRIED_COLLISION_SIZE) {
             m_tried_collisions.insert(nId);
         }
         // Output the entry we'd be colliding with, for debugging purposes
-        auto colliding_entry = mapInfo.find(vvTried[tried_bucket][tried_bucket_pos]);
         LogPrint(BCLog::ADDRMAN, "Collision with %s while attempting to move %s to tried table. Collisions=%d\n",
-                 colliding_entry != mapInfo.end() ? colliding_entry->second.ToStringAddrPort() : "",
+                 m_tables.GetInfo(colliding_id).ToStringAddrPort(),
                  addr.ToStringAddrPort(),
                  m_tried_collisions.size());
         return false;
@@ -707,18 +732,14 @@ void AddrManImpl::Attempt_(const CService& addr, bool fCountFailure, NodeSeconds
     }
 }
 
-std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool new_only, std::optional<Network> network) const
+std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(const Snapshot& snapshot, bool new_only, std::optional<Network> network, FastRandomContext& rng) const
 {
-    AssertLockHeld(cs);
-
-    if (vRandom.empty()) return {};
-
-    size_t new_count = nNew;
-    size_t tried_count = nTried;
+    size_t new_count = snapshot.n_new;
+    size_t tried_count = snapshot.n_tried;
 
     if (network.has_value()) {
-        auto it = m_network_counts.find(*network);
-        if (it == m_network_counts.end()) return {};
+        auto it = snapshot.network_counts.find(*network);
+        if (it == snapshot.network_counts.end()) return {};
 
         auto counts = it->second;
         new_count = counts.n_new;
@@ -736,7 +757,7 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool new_only, std::option
     } else if (new_count == 0) {
         search_tried = true;
     } else {
-        search_tried = insecure_rand.randbool();
+        search_tried = rng.randbool();
     }
 
     const int bucket_count{search_tried ? ADDRMAN_TRIED_BUCKET_COUNT : ADDRMAN_NEW_BUCKET_COUNT};
@@ -745,19 +766,19 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool new_only, std::option
     double chance_factor = 1.0;
     while (1) {
         // Pick a bucket, and an initial position in that bucket.
-        int bucket = insecure_rand.randrange(bucket_count);
-        int initial_position = insecure_rand.randrange(ADDRMAN_BUCKET_SIZE);
+        int bucket = rng.randrange(bucket_count);
+        int initial_position = rng.randrange(ADDRMAN_BUCKET_SIZE);
 
         // Iterate over the positions of that bucket, starting at the initial one,
         // and looping around.
-        int i, position, node_id;
+        int i, position;
+        nid_type node_id;
         for (i = 0; i < ADDRMAN_BUCKET_SIZE; ++i) {
             position = (initial_position + i) % ADDRMAN_BUCKET_SIZE;
-            node_id = GetEntry(search_tried, bucket, position);
+            node_id = snapshot.tables.GetEntry(search_tried, bucket, position);
             if (node_id != -1) {
                 if (network.has_value()) {
-                    const auto it{mapInfo.find(node_id)};
-                    if (Assume(it != mapInfo.end()) && it->second.GetNetwork() == *network) break;
+                    if (snapshot.tables.GetInfo(node_id).GetNetwork() == *network) break;
                 } else {
                     break;
                 }
@@ -768,12 +789,10 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool new_only, std::option
         if (i == ADDRMAN_BUCKET_SIZE) continue;
 
         // Find the entry to return.
-        const auto it_found{mapInfo.find(node_id)};
-        assert(it_found != mapInfo.end());
-        const AddrInfo& info{it_found->second};
+        const AddrInfo& info{snapshot.tables.GetInfo(node_id)};
 
         // With probability GetChance() * chance_factor, return the entry.
-        if (insecure_rand.randbits(30) < chance_factor * info.GetChance() * (1 << 30)) {
+        if (rng.randbits(30) < chance_factor * info.GetChance() * (1 << 30)) {
             LogPrint(BCLog::ADDRMAN, "Selected %s from %s\n", info.ToStringAddrPort(), search_tried ? "tried" : "new");
             return {info, info.m_last_try};
         }
@@ -783,21 +802,43 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool new_only, std::option
     }
 }
 
-int AddrManImpl::GetEntry(bool use_tried, size_t bucket, size_t position) const
+std::shared_ptr<const AddrManImpl::Snapshot> AddrManImpl::GetSnapshot(bool wait) const
 {
-    AssertLockHeld(cs);
-
-    if (use_tried) {
-        if (Assume(position < ADDRMAN_BUCKET_SIZE) && Assume(bucket < ADDRMAN_TRIED_BUCKET_COUNT)) {
-            return vvTried[bucket][position];
-        }
-    } else {
-        if (Assume(position < ADDRMAN_BUCKET_SIZE) && Assume(bucket < ADDRMAN_NEW_BUCKET_COUNT)) {
-            return vvNew[bucket][position];
-        }
+    auto snapshot{std::atomic_load(&m_snapshot)};
+    if (snapshot && snapshot->version == m_version.load()) return snapshot;
+
+    if (!wait && snapshot) {
+        // Another thread is changing addrman. Rather than waiting for it, use the tables as
+        // they were before.
+        TRY_LOCK(cs, locked);
+        if (!locked) return snapshot;
+        Check();
+        return GetSnapshot_();
     }
 
-    return -1;
+    LOCK(cs);
+    Check();
+    return GetSnapshot_();
+}
+
+std::shared_ptr<const AddrManImpl::Snapshot> AddrManImpl::GetSnapshot_() const
+{
+    AssertLockHeld(cs);
+
+    // m_version only changes while cs is held, so another thread may have published an
+    // up-to-date snapshot since we looked.
+    auto snapshot{std::atomic_load(&m_snapshot)};
+    if (snapshot && snapshot->version == m_version.load()) return snapshot;
+
+    snapshot = std::make_shared<const Snapshot>(Snapshot{
+        .tables = m_tables,
+        .n_new = nNew,
+        .n_tried = nTried,
+        .network_counts = m_network_counts,
+        .version = m_version.load(),
+    });
+    std::atomic_store(&m_snapshot, snapshot);
+    return snapshot;
 }
 
 std::vector<CAddress> AddrManImpl::GetAddr_(size_t max_addresses, size_t max_pct, std::optional<Network> network) const
@@ -821,10 +862,7 @@ std::vector<CAddress> AddrManImpl::GetAddr_(size_t max_addresses, size_t max_pct
 
         int nRndPos = insecure_rand.randrange(vRandom.size() - n) + n;
         SwapRandom(n, nRndPos);
-        const auto it{mapInfo.find(vRandom[n])};
-        assert(it != mapInfo.end());
-
-        const AddrInfo& ai{it->second};
+        const AddrInfo& ai{m_tables.GetInfo(vRandom[n])};
 
         // Filter by network (optional)
         if (network != std::nullopt && ai.GetNetClass() != network) continue;
@@ -846,9 +884,9 @@ std::vector<std::pair<AddrInfo, AddressPosition>> AddrManImpl::GetEntries_(bool
     std::vector<std::pair<AddrInfo, AddressPosition>> infos;
     for (int bucket = 0; bucket < bucket_count; ++bucket) {
         for (int position = 0; position < ADDRMAN_BUCKET_SIZE; ++position) {
-            int id = GetEntry(from_tried, bucket, position);
+            nid_type id = m_tables.GetEntry(from_tried, bucket, position);
             if (id >= 0) {
-                AddrInfo info = mapInfo.at(id);
+                AddrInfo info = m_tables.GetInfo(id);
                 AddressPosition location = AddressPosition(
                     from_tried,
                     /*multiplicity_in=*/from_tried ? 1 : info.nRefCount,
@@ -901,27 +939,27 @@ void AddrManImpl::ResolveCollisions_()
 {
     AssertLockHeld(cs);
 
-    for (std::set<int>::iterator it = m_tried_collisions.begin(); it != m_tried_collisions.end();) {
-        int id_new = *it;
+    for (std::set<nid_type>::iterator it = m_tried_collisions.begin(); it != m_tried_collisions.end();) {
+        nid_type id_new = *it;
 
         bool erase_collision = false;
 
-        // If id_new not found in mapInfo remove it from m_tried_collisions
-        if (mapInfo.count(id_new) != 1) {
+        // If id_new no longer refers to an entry remove it from m_tried_collisions
+        if (m_random_pos[id_new] == -1) {
             erase_collision = true;
         } else {
-            AddrInfo& info_new = mapInfo[id_new];
+            AddrInfo& info_new = m_tables.GetMutableInfo(id_new);
 
             // Which tried bucket to move the entry to.
             int tried_bucket = info_new.GetTriedBucket(nKey, m_netgroupman);
             int tried_bucket_pos = info_new.GetBucketPosition(nKey, false, tried_bucket);
             if (!info_new.IsValid()) { // id_new may no longer map to a valid address
                 erase_collision = true;
-            } else if (vvTried[tried_bucket][tried_bucket_pos] != -1) { // The position in the tried bucket is not empty
+            } else if (m_tables.GetEntry(/*use_tried=*/true, tried_bucket, tried_bucket_pos) != -1) { // The position in the tried bucket is not empty
 
                 // Get the to-be-evicted address that is being tested
-                int id_old = vvTried[tried_bucket][tried_bucket_pos];
-                AddrInfo& info_old = mapInfo[id_old];
+                nid_type id_old = m_tables.GetEntry(/*use_tried=*/true, tried_bucket, tried_bucket_pos);
+                AddrInfo& info_old = m_tables.GetMutableInfo(id_old);
 
                 const auto current_time{Now<NodeSeconds>()};
 
@@ -966,25 +1004,27 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::SelectTriedCollision_()
 
     if (m_tried_collisions.size() == 0) return {};
 
-    std::set<int>::iterator it = m_tried_collisions.begin();
+    std::set<nid_type>::iterator it = m_tried_collisions.begin();
 
     // Selects a random element from m_tried_collisions
     std::advance(it, insecure_rand.randrange(m_tried_collisions.size()));
-    int id_new = *it;
+    nid_type id_new = *it;
 
-    // If id_new not found in mapInfo remove it from m_tried_collisions
-    if (mapInfo.count(id_new) != 1) {
+    // If id_new no longer refers to an entry remove it from m_tried_collisions
+    if (m_random_pos[id_new] == -1) {
         m_tried_collisions.erase(it);
         return {};
     }
 
-    const AddrInfo& newInfo = mapInfo[id_new];
+    const AddrInfo& newInfo = m_tables.GetInfo(id_new);
 
     // which tried bucket to move the entry to
     int tried_bucket = newInfo.GetTriedBucket(nKey, m_netgroupman);
     int tried_bucket_pos = newInfo.GetBucketPosition(nKey, false, tried_bucket);
 
-    const AddrInfo& info_old = mapInfo[vvTried[tried_bucket][tried_bucket_pos]];
+    const nid_type id_old{m_tables.GetEntry(/*use_tried=*/true, tried_bucket, tried_bucket_pos)};
+    if (id_old == -1) return {};
+    const AddrInfo& info_old = m_tables.GetInfo(id_old);
     return {info_old, info_old.m_last_try};
 }
 
@@ -1055,16 +1095,24 @@ int AddrManImpl::CheckAddrman() const
     LOG_TIME_MILLIS_WITH_CATEGORY_MSG_ONCE(
         strprintf("new %i, tried %i, total %u", nNew, nTried, vRandom.size()), BCLog::ADDRMAN);
 
-    std::unordered_set<int> setTried;
-    std::unordered_map<int, int> mapNew;
+    std::unordered_set<nid_type> setTried;
+    std::unordered_map<nid_type, int> mapNew;
     std::unordered_map<Network, NewTriedCount> local_counts;
 
     if (vRandom.size() != (size_t)(nTried + nNew))
         return -7;
 
-    for (const auto& entry : mapInfo) {
-        int n = entry.first;
-        const AddrInfo& info = entry.second;
+    if (m_tables.Capacity() < m_random_pos.size() || vRandom.size() + m_free_ids.size() != m_random_pos.size())
+        return -22;
+    for (const nid_type n : m_free_ids) {
+        if (n < 0 || (size_t)n >= m_random_pos.size() || m_random_pos[n] != -1) {
+            return -22;
+        }
+    }
+
+    for (nid_type n = 0; n < (nid_type)m_random_pos.size(); n++) {
+        if (m_random_pos[n] == -1) continue;
+        const AddrInfo& info = m_tables.GetInfo(n);
         if (info.fInTried) {
             if (!TicksSinceEpoch<std::chrono::seconds>(info.m_last_success)) {
                 return -1;
@@ -1085,7 +1133,7 @@ int AddrManImpl::CheckAddrman() const
         if (it == mapAddr.end() || it->second != n) {
             return -5;
         }
-        if (info.nRandomPos < 0 || (size_t)info.nRandomPos >= vRandom.size() || vRandom[info.nRandomPos] != n)
+        if ((size_t)m_random_pos[n] >= vRandom.size() || vRandom[m_random_pos[n]] != n)
             return -14;
         if (info.m_last_try < NodeSeconds{0s}) {
             return -6;
@@ -1102,32 +1150,33 @@ int AddrManImpl::CheckAddrman() const
 
     for (int n = 0; n < ADDRMAN_TRIED_BUCKET_COUNT; n++) {
         for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
-            if (vvTried[n][i] != -1) {
-                if (!setTried.count(vvTried[n][i]))
+            const nid_type nid{m_tables.GetEntry(/*use_tried=*/true, n, i)};
+            if (nid != -1) {
+                if (!setTried.count(nid))
                     return -11;
-                const auto it{mapInfo.find(vvTried[n][i])};
-                if (it == mapInfo.end() || it->second.GetTriedBucket(nKey, m_netgroupman) != n) {
+                const AddrInfo& info = m_tables.GetInfo(nid);
+                if (info.GetTriedBucket(nKey, m_netgroupman) != n) {
                     return -17;
                 }
-                if (it->second.GetBucketPosition(nKey, false, n) != i) {
+                if (info.GetBucketPosition(nKey, false, n) != i) {
                     return -18;
                 }
-                setTried.erase(vvTried[n][i]);
+                setTried.erase(nid);
             }
         }
     }
 
     for (int n = 0; n < ADDRMAN_NEW_BUCKET_COUNT; n++) {
         for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
-            if (vvNew[n][i] != -1) {
-                if (!mapNew.count(vvNew[n][i]))
+            const nid_type nid{m_tables.GetEntry(/*use_tried=*/false, n, i)};
+            if (nid != -1) {
+                if (!mapNew.count(nid))
                     return -12;
-                const auto it{mapInfo.find(vvNew[n][i])};
-                if (it == mapInfo.end() || it->second.GetBucketPosition(nKey, true, n) != i) {
+                if (m_tables.GetInfo(nid).GetBucketPosition(nKey, true, n) != i) {
                     return -19;
                 }
-                if (--mapNew[vvNew[n][i]] == 0)
-                    mapNew.erase(vvNew[n][i]);
+                if (--mapNew[nid] == 0)
+                    mapNew.erase(nid);
             }
         }
     }
@@ -1167,6 +1216,7 @@ bool AddrManImpl::Add(const std::vector<CAddress>& vAddr, const CNetAddr& source
     LOCK(cs);
     Check();
     auto ret = Add_(vAddr, source, time_penalty);
+    ++m_version;
     Check();
     return ret;
 }
@@ -1176,6 +1226,7 @@ bool AddrManImpl::Good(const CService& addr, NodeSeconds time)
     LOCK(cs);
     Check();
     auto ret = Good_(addr, /*test_before_evict=*/true, time);
+    ++m_version;
     Check();
     return ret;
 }
@@ -1185,6 +1236,7 @@ void AddrManImpl::Attempt(const CService& addr, bool fCountFailure, NodeSeconds
     LOCK(cs);
     Check();
     Attempt_(addr, fCountFailure, time);
+    ++m_version;
     Check();
 }
 
@@ -1193,6 +1245,7 @@ void AddrManImpl::ResolveCollisions()
     LOCK(cs);
     Check();
     ResolveCollisions_();
+    ++m_version;
     Check();
 }
 
@@ -1207,11 +1260,12 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::SelectTriedCollision()
 
 std::pair<CAddress, NodeSeconds> AddrManImpl::Select(bool new_only, std::optional<Network> network) const
 {
-    LOCK(cs);
-    Check();
-    auto addrRet = Select_(new_only, network);
-    Check();
-    return addrRet;
+    const auto snapshot{GetSnapshot(/*wait=*/false)};
+
+    uint256 seed{m_select_seed};
+    WriteLE64(seed.begin(), ReadLE64(seed.begin()) ^ m_select_count.fetch_add(1, std::memory_order_relaxed));
+    FastRandomContext rng{seed};
+    return Select_(*snapshot, new_only, network, rng);
 }
 
 std::vector<CAddress> AddrManImpl::GetAddr(size_t max_addresses, size_t max_pct, std::optional<Network> network) const
@@ -1237,6 +1291,7 @@ void AddrManImpl::Connected(const CService& addr, NodeSeconds time)
     LOCK(cs);
     Check();
     Connected_(addr, time);
+    ++m_version;
     Check();
 }
 
@@ -1245,6 +1300,7 @@ void AddrManImpl::SetServices(const CService& addr, ServiceFlags nServices)
     LOCK(cs);
     Check();
     SetServices_(addr, nServices);
+    ++m_version;
     Check();
 }
 
@@ -153,6 +153,10 @@ public:
      *                     guarantee a tried entry).
      * @param[in] network  Select only addresses of this network (nullopt = all). Passing a network may
      *                     slow down the search.
+     *
+     * Select does not wait for other threads changing addrman; while one does, the address is chosen
+     * from addrman as it was before that change.
+     *
      * @return    CAddress The record for the selected peer.
      *            seconds  The last time we attempted to connect to that peer.
      */
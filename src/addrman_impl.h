@@ -9,13 +9,18 @@
 #include <logging/timer.h>
 #include <netaddress.h>
 #include <protocol.h>
+#include <random.h>
 #include <serialize.h>
 #include <sync.h>
 #include <timedata.h>
 #include <uint256.h>
+#include <util/check.h>
 #include <util/time.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <set>
 #include <unordered_map>
@@ -33,6 +38,9 @@ static constexpr int ADDRMAN_NEW_BUCKET_COUNT{1 << ADDRMAN_NEW_BUCKET_COUNT_LOG2
 static constexpr int32_t ADDRMAN_BUCKET_SIZE_LOG2{6};
 static constexpr int ADDRMAN_BUCKET_SIZE{1 << ADDRMAN_BUCKET_SIZE_LOG2};
 
+/** Identifier of an addrman entry, used to address it in the tables. -1 marks an empty bucket position. */
+using nid_type = int32_t;
+
 /**
  * Extended statistics about a CAddress
  */
@@ -60,9 +68,6 @@ public:
     //! in tried set? (memory only)
     bool fInTried{false};
 
-    //! position in vRandom
-    mutable int nRandomPos{-1};
-
     SERIALIZE_METHODS(AddrInfo, obj)
     {
         READWRITE(AsBase<CAddress>(obj), obj.source, Using<ChronoFormatter<int64_t>>(obj.m_last_success), obj.nAttempts);
@@ -98,6 +103,88 @@ public:
     double GetChance(NodeSeconds now = Now<NodeSeconds>()) const;
 };
 
+/**
+ * Flat, index-addressed storage of the addrman tables. Entries are addressed by their nid, and
+ * the positions of the "new" and "tried" buckets hold the nids of their entries.
+ *
+ * Entries and bucket positions are kept in fixed-size pages that are shared copy-on-write:
+ * copying an AddrTables only copies page pointers, and a page is duplicated the first time it is
+ * modified while another copy still refers to it. This makes publishing a snapshot of the tables
+ * cheap, and keeps a published snapshot immutable while the tables are updated.
+ */
+class AddrTables
+{
+public:
+    AddrTables();
+
+    //! Return the nid at a bucket position, or -1 if the position is empty.
+    nid_type GetEntry(bool use_tried, int bucket, int position) const
+    {
+        if (Assume(position >= 0 && position < ADDRMAN_BUCKET_SIZE) &&
+            Assume(bucket >= 0 && bucket < (use_tried ? ADDRMAN_TRIED_BUCKET_COUNT : ADDRMAN_NEW_BUCKET_COUNT))) {
+            const size_t slot{Slot(use_tried, bucket, position)};
+            return (*m_slot_pages[slot / SLOTS_PER_PAGE])[slot % SLOTS_PER_PAGE];
+        }
+        return -1;
+    }
+
+    void SetEntry(bool use_tried, int bucket, int position, nid_type nid)
+    {
+        const size_t slot{Slot(use_tried, bucket, position)};
+        Unshare(m_slot_pages[slot / SLOTS_PER_PAGE])[slot % SLOTS_PER_PAGE] = nid;
+    }
+
+    const AddrInfo& GetInfo(nid_type nid) const
+    {
+        return (*m_info_pages[nid / INFOS_PER_PAGE])[nid % INFOS_PER_PAGE];
+    }
+
+    //! Access an entry for modification. The reference stays valid until the tables are copied.
+    AddrInfo& GetMutableInfo(nid_type nid)
+    {
+        return Unshare(m_info_pages[nid / INFOS_PER_PAGE])[nid % INFOS_PER_PAGE];
+    }
+
+    //! Number of nids that entries can be stored at.
+    size_t Capacity() const { return m_info_pages.size() * INFOS_PER_PAGE; }
+
+    //! Make room for entries at all nids below capacity.
+    void Reserve(size_t capacity);
+
+private:
+    static constexpr size_t NEW_SLOTS{ADDRMAN_NEW_BUCKET_COUNT * ADDRMAN_BUCKET_SIZE};
+    static constexpr size_t TRIED_SLOTS{ADDRMAN_TRIED_BUCKET_COUNT * ADDRMAN_BUCKET_SIZE};
+    static constexpr size_t SLOTS_PER_PAGE{1024};
+    static constexpr size_t INFOS_PER_PAGE{128};
+    static_assert((NEW_SLOTS + TRIED_SLOTS) % SLOTS_PER_PAGE == 0);
+
+    using SlotPage = std::array<nid_type, SLOTS_PER_PAGE>;
+    using InfoPage = std::array<AddrInfo, INFOS_PER_PAGE>;
+
+    //! Positions of the new buckets come first, followed by those of the tried buckets.
+    static size_t Slot(bool use_tried, int bucket, int position)
+    {
+        return (use_tried ? NEW_SLOTS : 0) + size_t(bucket) * ADDRMAN_BUCKET_SIZE + position;
+    }
+
+    //! Make sure no other copy of the tables refers to a page before it is modified.
+    template <typename Page>
+    static Page& Unshare(std::shared_ptr<Page>& page)
+    {
+        if (page.use_count() > 1) {
+            page = std::make_shared<Page>(std::as_const(*page));
+        } else {
+            // The previous other owner may have been a reader in another thread. Synchronize with
+            // its release of the page, so its reads happen before our writes.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *page;
+    }
+
+    std::vector<std::shared_ptr<SlotPage>> m_slot_pages;
+    std::vector<std::shared_ptr<InfoPage>> m_info_pages;
+};
+
 class AddrManImpl
 {
 public:
@@ -179,37 +266,34 @@ private:
     //! @note Don't increment this. Increment `lowest_compatible` in `Serialize()` instead.
     static constexpr uint8_t INCOMPATIBILITY_BASE = 32;
 
-    //! last used nId
-    int nIdCount GUARDED_BY(cs){0};
-
-    //! table with information about all nIds
-    std::unordered_map<int, AddrInfo> mapInfo GUARDED_BY(cs);
+    //! all entries, and the "new" and "tried" buckets referring to them
+    AddrTables m_tables GUARDED_BY(cs);
 
     //! find an nId based on its network address and port.
-    std::unordered_map<CService, int, CServiceHash> mapAddr GUARDED_BY(cs);
+    std::unordered_map<CService, nid_type, CServiceHash> mapAddr GUARDED_BY(cs);
 
     //! randomly-ordered vector of all nIds
     //! This is mutable because it is unobservable outside the class, so any
     //! changes to it (even in const methods) are also unobservable.
-    mutable std::vector<int> vRandom GUARDED_BY(cs);
+    mutable std::vector<nid_type> vRandom GUARDED_BY(cs);
+
+    //! position of each nId in vRandom, or -1 if the nId is unused
+    mutable std::vector<int> m_random_pos GUARDED_BY(cs);
+
+    //! unused nIds below m_random_pos.size(), handed out again before new ones
+    std::vector<nid_type> m_free_ids GUARDED_BY(cs);
 
     // number of "tried" entries
     int nTried GUARDED_BY(cs){0};
 
-    //! list of "tried" buckets
-    int vvTried[ADDRMAN_TRIED_BUCKET_COUNT][ADDRMAN_BUCKET_SIZE] GUARDED_BY(cs);
-
     //! number of (unique) "new" entries
     int nNew GUARDED_BY(cs){0};
 
-    //! list of "new" buckets
-    int vvNew[ADDRMAN_NEW_BUCKET_COUNT][ADDRMAN_BUCKET_SIZE] GUARDED_BY(cs);
-
     //! last time Good was called (memory only). Initially set to 1 so that "never" is strictly worse.
     NodeSeconds m_last_good GUARDED_BY(cs){1s};
 
     //! Holds addrs inserted into tried table that collide with existing entries. Test-before-evict discipline used to resolve these collisions.
-    std::set<int> m_tried_collisions;
+    std::set<nid_type> m_tried_collisions;
 
     /** Perform consistency checks every m_consistency_check_ratio operations (if non-zero). */
     const int32_t m_consistency_check_ratio;
@@ -225,23 +309,53 @@ private:
     /** Number of entries in addrman per network and new/tried table. */
     std::unordered_map<Network, NewTriedCount> m_network_counts GUARDED_BY(cs);
 
+    /** Immutable copy of the tables, published so that Select() and Serialize() can read them without taking cs. */
+    struct Snapshot {
+        AddrTables tables;
+        int n_new;
+        int n_tried;
+        std::unordered_map<Network, NewTriedCount> network_counts;
+        //! Value of m_version the snapshot was taken at.
+        uint64_t version;
+    };
+
+    /** The most recently published snapshot. Only accessed through std::atomic_load and std::atomic_store. */
+    mutable std::shared_ptr<const Snapshot> m_snapshot;
+
+    /** Incremented, while holding cs, after every change that may be visible through a snapshot. */
+    std::atomic<uint64_t> m_version{0};
+
+    /** Key for the random numbers drawn by Select(), which does not use insecure_rand as it runs without cs. */
+    const uint256 m_select_seed;
+
+    /** Number of Select() calls, mixed into m_select_seed so that every call draws different random numbers. */
+    mutable std::atomic<uint64_t> m_select_count{0};
+
     //! Find an entry.
-    AddrInfo* Find(const CService& addr, int* pnId = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    AddrInfo* Find(const CService& addr, nid_type* pnId = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //! Create a new entry and add it to the internal data structures m_tables, mapAddr and vRandom.
+    AddrInfo* Create(const CAddress& addr, const CNetAddr& addrSource, nid_type* pnId = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
-    //! Create a new entry and add it to the internal data structures mapInfo, mapAddr and vRandom.
-    AddrInfo* Create(const CAddress& addr, const CNetAddr& addrSource, int* pnId = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    //! Hand out an unused nId, and add it to vRandom.
+    nid_type AllocateId() EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     //! Swap two elements in vRandom.
     void SwapRandom(unsigned int nRandomPos1, unsigned int nRandomPos2) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     //! Delete an entry. It must not be in tried, and have refcount 0.
-    void Delete(int nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void Delete(nid_type nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     //! Clear a position in a "new" table. This is the only place where entries are actually deleted.
     void ClearNew(int nUBucket, int nUBucketPos) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     //! Move an entry from the "new" table(s) to the "tried" table
-    void MakeTried(AddrInfo& info, int nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    void MakeTried(AddrInfo& info, nid_type nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //! Return a snapshot of the current tables, publishing a new one if the last one is outdated.
+    //! Unless wait is set, an outdated snapshot is returned while another thread holds cs.
+    std::shared_ptr<const Snapshot> GetSnapshot(bool wait) const EXCLUSIVE_LOCKS_REQUIRED(!cs);
+    std::shared_ptr<const Snapshot> GetSnapshot_() const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     /** Attempt to add a single address to addrman's new table.
      *  @see AddrMan::Add() for parameters. */
@@ -253,13 +367,7 @@ private:
 
     void Attempt_(const CService& addr, bool fCountFailure, NodeSeconds time) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
-    std::pair<CAddress, NodeSeconds> Select_(bool new_only, std::optional<Network> network) const EXCLUSIVE_LOCKS_REQUIRED(cs);
-
-    /** Helper to generalize looking up an addrman entry from either table.
-     *
-     *  @return  int The nid of the entry. If the addrman position is empty or not found, returns -1.
-     * */
-    int GetEntry(bool use_tried, size_t bucket, size_t position) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+    std::pair<CAddress, NodeSeconds> Select_(const Snapshot& snapshot, bool new_only, std::optional<Network> network, FastRandomContext& rng) const;
 
     std::vector<CAddress> GetAddr_(size_t max_addresses, size_t max_pct, std::optional<Network> network) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
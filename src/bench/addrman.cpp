@@ -7,10 +7,13 @@
 #include <netbase.h>
 #include <netgroup.h>
 #include <random.h>
+#include <streams.h>
 #include <util/check.h>
 #include <util/time.h>
 
+#include <atomic>
 #include <optional>
+#include <thread>
 #include <vector>
 
 /* A "source" is a source address from which we have received a bunch of other addresses. */
@@ -131,6 +134,45 @@ static void AddrManSelectByNetwork(benchmark::Bench& bench)
     });
 }
 
+// Select() while another thread keeps feeding addresses to addrman, as addr gossip does while
+// ThreadOpenConnections looks for an address to connect to.
+static void AddrManSelectWhileAdding(benchmark::Bench& bench)
+{
+    AddrMan addrman{EMPTY_NETGROUPMAN, /*deterministic=*/false, ADDRMAN_CONSISTENCY_CHECK_RATIO};
+
+    FillAddrMan(addrman);
+
+    std::atomic<bool> stop{false};
+    std::thread adder{[&] {
+        while (!stop) {
+            for (size_t source_i = 0; source_i < NUM_SOURCES && !stop; ++source_i) {
+                addrman.Add(g_addresses[source_i], g_sources[(source_i + 1) % NUM_SOURCES]);
+            }
+        }
+    }};
+
+    bench.run([&] {
+        const auto& address = addrman.Select();
+        assert(address.first.GetPort() > 0);
+    });
+
+    stop = true;
+    adder.join();
+}
+
+static void AddrManSerialize(benchmark::Bench& bench)
+{
+    AddrMan addrman{EMPTY_NETGROUPMAN, /*deterministic=*/false, ADDRMAN_CONSISTENCY_CHECK_RATIO};
+
+    FillAddrMan(addrman);
+    DataStream stream{};
+
+    bench.run([&] {
+        stream.clear();
+        stream << addrman;
+    });
+}
+
 static void AddrManGetAddr(benchmark::Bench& bench)
 {
     AddrMan addrman{EMPTY_NETGROUPMAN, /*deterministic=*/false, ADDRMAN_CONSISTENCY_CHECK_RATIO};
@@ -173,5 +215,7 @@ BENCHMARK(AddrManAdd, benchmark::PriorityLevel::HIGH);
 BENCHMARK(AddrManSelect, benchmark::PriorityLevel::HIGH);
 BENCHMARK(AddrManSelectFromAlmostEmpty, benchmark::PriorityLevel::HIGH);
 BENCHMARK(AddrManSelectByNetwork, benchmark::PriorityLevel::HIGH);
+BENCHMARK(AddrManSelectWhileAdding, benchmark::PriorityLevel::HIGH);
+BENCHMARK(AddrManSerialize, benchmark::PriorityLevel::HIGH);
 BENCHMARK(AddrManGetAddr, benchmark::PriorityLevel::HIGH);
 BENCHMARK(AddrManAddThenGood, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,62 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <blockencodings.h>
+#include <consensus/amount.h>
+#include <kernel/cs_main.h>
+#include <kernel/mempool_entry.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <util/chaintype.h>
+
+#include <vector>
+
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+{
+    LockPoints lp;
+    pool.addUnchecked(CTxMemPoolEntry(tx, /*fee=*/1000, /*time=*/0, /*entry_height=*/1, /*entry_sequence=*/0, /*spends_coinbase=*/false, /*sigops_cost=*/4, lp));
+}
+
+/** Reconstruct a compact block against a large mempool. One block transaction is
+ *  missing from the mempool, so every mempool entry has its short ID computed. */
+static void BlockEncodingLargeMempool(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const ChainTestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    FastRandomContext det_rand{true};
+
+    CBlock block;
+    block.nBits = 0x207fffff;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << OP_1;
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    tx.vout[0].nValue = COIN;
+    block.vtx.push_back(MakeTransactionRef(tx));
+    {
+        LOCK2(cs_main, pool.cs);
+        for (int i = 0; i < 50000; ++i) {
+            tx.vin[0].prevout = COutPoint{det_rand.rand256(), 0};
+            const CTransactionRef tx_r{MakeTransactionRef(tx)};
+            AddTx(tx_r, pool);
+            if (i % 25 == 0) block.vtx.push_back(tx_r);
+        }
+        tx.vin[0].prevout = COutPoint{det_rand.rand256(), 0};
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+    const CBlockHeaderAndShortTxIDs cmpctblock{block};
+    const std::vector<std::pair<uint256, CTransactionRef>> extra_txn;
+
+    bench.run([&] {
+        PartiallyDownloadedBlock partial_block{&pool};
+        const auto res{partial_block.InitData(cmpctblock, extra_txn)};
+        assert(res == READ_STATUS_OK);
+    });
+}
+
+BENCHMARK(BlockEncodingLargeMempool, benchmark::PriorityLevel::HIGH);
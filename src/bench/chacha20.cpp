@@ -10,6 +10,7 @@
 /* Number of bytes to process per iteration */
 static const uint64_t BUFFER_SIZE_TINY  = 64;
 static const uint64_t BUFFER_SIZE_SMALL = 256;
+static const uint64_t BUFFER_SIZE_MEDIUM = 4096;
 static const uint64_t BUFFER_SIZE_LARGE = 1024*1024;
 
 static void CHACHA20(benchmark::Bench& bench, size_t buffersize)
@@ -24,6 +25,17 @@ static void CHACHA20(benchmark::Bench& bench, size_t buffersize)
     });
 }
 
+static void CHACHA20_KEYSTREAM(benchmark::Bench& bench, size_t buffersize)
+{
+    std::vector<std::byte> key(32, {});
+    ChaCha20 ctx(key);
+    ctx.Seek({0, 0}, 0);
+    std::vector<std::byte> out(buffersize, {});
+    bench.batch(out.size()).unit("byte").run([&] {
+        ctx.Keystream(out);
+    });
+}
+
 static void FSCHACHA20POLY1305(benchmark::Bench& bench, size_t buffersize)
 {
     std::vector<std::byte> key(32);
@@ -46,11 +58,26 @@ static void CHACHA20_256BYTES(benchmark::Bench& bench)
     CHACHA20(bench, BUFFER_SIZE_SMALL);
 }
 
+static void CHACHA20_4KB(benchmark::Bench& bench)
+{
+    CHACHA20(bench, BUFFER_SIZE_MEDIUM);
+}
+
 static void CHACHA20_1MB(benchmark::Bench& bench)
 {
     CHACHA20(bench, BUFFER_SIZE_LARGE);
 }
 
+static void CHACHA20_KEYSTREAM_256BYTES(benchmark::Bench& bench)
+{
+    CHACHA20_KEYSTREAM(bench, BUFFER_SIZE_SMALL);
+}
+
+static void CHACHA20_KEYSTREAM_1MB(benchmark::Bench& bench)
+{
+    CHACHA20_KEYSTREAM(bench, BUFFER_SIZE_LARGE);
+}
+
 static void FSCHACHA20POLY1305_64BYTES(benchmark::Bench& bench)
 {
     FSCHACHA20POLY1305(bench, BUFFER_SIZE_TINY);
@@ -61,6 +88,11 @@ static void FSCHACHA20POLY1305_256BYTES(benchmark::Bench& bench)
     FSCHACHA20POLY1305(bench, BUFFER_SIZE_SMALL);
 }
 
+static void FSCHACHA20POLY1305_4KB(benchmark::Bench& bench)
+{
+    FSCHACHA20POLY1305(bench, BUFFER_SIZE_MEDIUM);
+}
+
 static void FSCHACHA20POLY1305_1MB(benchmark::Bench& bench)
 {
     FSCHACHA20POLY1305(bench, BUFFER_SIZE_LARGE);
@@ -68,7 +100,11 @@ static void FSCHACHA20POLY1305_1MB(benchmark::Bench& bench)
 
 BENCHMARK(CHACHA20_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(CHACHA20_256BYTES, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_4KB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(CHACHA20_1MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_KEYSTREAM_256BYTES, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_KEYSTREAM_1MB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_256BYTES, benchmark::PriorityLevel::HIGH);
+BENCHMARK(FSCHACHA20POLY1305_4KB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_1MB, benchmark::PriorityLevel::HIGH);
@@ -196,6 +196,19 @@ static void SipHash_32b(benchmark::Bench& bench)
     });
 }
 
+static void SipHash_32b_Batch(benchmark::Bench& bench)
+{
+    std::vector<uint256> vals(64);
+    std::vector<const uint256*> ptrs;
+    for (const auto& val : vals) ptrs.push_back(&val);
+    std::vector<uint64_t> out(vals.size());
+    uint64_t k1 = 0;
+    bench.batch(vals.size()).unit("hash").run([&] {
+        SipHashUint256Batch(0, ++k1, ptrs, out);
+        *((uint64_t*)vals[0].begin()) = out.back();
+    });
+}
+
 static void FastRandom_32bit(benchmark::Bench& bench)
 {
     FastRandomContext rng(true);
@@ -245,6 +258,19 @@ static void MuHashDiv(benchmark::Bench& bench)
     });
 }
 
+static void MuHashFinalize(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    MuHash3072 acc{rng.randbytes(32)};
+    acc /= MuHash3072(rng.rand256());
+
+    bench.run([&] {
+        uint256 out;
+        acc.Finalize(out);
+        acc /= MuHash3072(out);
+    });
+}
+
 static void MuHashPrecompute(benchmark::Bench& bench)
 {
     MuHash3072 acc;
@@ -270,6 +296,7 @@ BENCHMARK(SHA256_32b_SSE4, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256_32b_AVX2, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256_32b_SHANI, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SipHash_32b, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SipHash_32b_Batch, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_STANDARD, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_SSE4, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_AVX2, benchmark::PriorityLevel::HIGH);
@@ -281,3 +308,4 @@ BENCHMARK(MuHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MuHashMul, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MuHashDiv, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MuHashPrecompute, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MuHashFinalize, benchmark::PriorityLevel::HIGH);
@@ -4,6 +4,7 @@
 
 #include <bench/bench.h>
 #include <blockfilter.h>
+#include <crypto/siphash.h>
 
 static GCSFilter::ElementSet GenerateGCSTestElements()
 {
@@ -81,8 +82,58 @@ static void GCSFilterMatch(benchmark::Bench& bench)
         filter.Match(GCSFilter::Element());
     });
 }
+static void GCSFilterMatchAny(benchmark::Bench& bench)
+{
+    auto elements = GenerateGCSTestElements();
+
+    GCSFilter filter({0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+
+    // A wallet's worth of scripts, none of which are in the filter
+    GCSFilter::ElementSet queries;
+    for (int i = 0; i < 1000; ++i) {
+        GCSFilter::Element query(25, 0xff);
+        query[0] = static_cast<unsigned char>(i);
+        query[1] = static_cast<unsigned char>(i >> 8);
+        queries.insert(std::move(query));
+    }
+
+    bench.run([&] {
+        filter.MatchAny(queries);
+    });
+}
+
+static void GCSFilterSipHash(benchmark::Bench& bench)
+{
+    auto elements = GenerateGCSTestElements();
+
+    uint64_t siphash_k0 = 0;
+    bench.batch(elements.size()).unit("element").run([&] {
+        uint64_t sum = 0;
+        for (const GCSFilter::Element& element : elements) {
+            sum += SipHash(siphash_k0, 0, element);
+        }
+        siphash_k0 += sum;
+    });
+}
+
+static void GCSFilterSipHashBatch(benchmark::Bench& bench)
+{
+    auto elements = GenerateGCSTestElements();
+    std::vector<Span<const unsigned char>> element_spans(elements.begin(), elements.end());
+    std::vector<uint64_t> hashes(element_spans.size());
+
+    uint64_t siphash_k0 = 0;
+    bench.batch(elements.size()).unit("element").run([&] {
+        SipHashBatch(siphash_k0, 0, element_spans, hashes);
+        siphash_k0 += hashes.back();
+    });
+}
+
 BENCHMARK(GCSBlockFilterGetHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterConstruct, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecode, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecodeSkipCheck, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterMatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterMatchAny, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterSipHash, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterSipHashBatch, benchmark::PriorityLevel::HIGH);
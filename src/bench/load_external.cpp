@@ -6,7 +6,9 @@
 #include <bench/data.h>
 #include <chainparams.h>
 #include <clientversion.h>
+#include <node/blockstorage.h>
 #include <test/util/setup_common.h>
+#include <util/check.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
@@ -22,7 +24,7 @@
  * This benchmark measures the performance of deserializing the block (or just
  * its header, beginning with PR 16981).
  */
-static void LoadExternalBlockFile(benchmark::Bench& bench)
+static void LoadBlockFile(benchmark::Bench& bench, bool compressed)
 {
     const auto testing_setup{MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN)};
 
@@ -32,10 +34,16 @@ static void LoadExternalBlockFile(benchmark::Bench& bench)
     DataStream ss{};
     auto params{testing_setup->m_node.chainman->GetParams()};
     ss << params.MessageStart();
-    ss << static_cast<uint32_t>(benchmark::data::block413567.size());
-    // We can't use the streaming serialization (ss << benchmark::data::block413567)
-    // because that first writes a compact size.
-    ss << Span{benchmark::data::block413567};
+    if (compressed) {
+        const auto data{*Assert(node::CompressBlockData(MakeByteSpan(benchmark::data::block413567)))};
+        ss << static_cast<uint32_t>(data.size() | node::BLOCK_COMPRESSED_FLAG);
+        ss << Span{data};
+    } else {
+        ss << static_cast<uint32_t>(benchmark::data::block413567.size());
+        // We can't use the streaming serialization (ss << benchmark::data::block413567)
+        // because that first writes a compact size.
+        ss << Span{benchmark::data::block413567};
+    }
 
     // Create the test file.
     {
@@ -61,4 +69,8 @@ static void LoadExternalBlockFile(benchmark::Bench& bench)
     fs::remove(blkfile);
 }
 
+static void LoadExternalBlockFile(benchmark::Bench& bench) { LoadBlockFile(bench, /*compressed=*/false); }
+static void LoadExternalBlockFileCompressed(benchmark::Bench& bench) { LoadBlockFile(bench, /*compressed=*/true); }
+
 BENCHMARK(LoadExternalBlockFile, benchmark::PriorityLevel::HIGH);
+BENCHMARK(LoadExternalBlockFileCompressed, benchmark::PriorityLevel::HIGH);
@@ -118,5 +118,38 @@ static void MempoolCheck(benchmark::Bench& bench)
     });
 }
 
+static void MempoolRemoveForBlockLongChain(benchmark::Bench& bench)
+{
+    // A single chain of transactions, each spending the previous one. Confirming the chain one
+    // transaction per block updates the ancestor state of every remaining descendant each time.
+    const int chain_length{500};
+    std::vector<CTransactionRef> chain;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << OP_1;
+    tx.vout.resize(1);
+    tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+    tx.vout[0].nValue = 10 * COIN;
+    for (int i = 0; i < chain_length; ++i) {
+        chain.push_back(MakeTransactionRef(tx));
+        tx.vin[0].prevout = COutPoint(chain.back()->GetHash(), 0);
+    }
+
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& chain_tx : chain) {
+            AddTx(chain_tx, pool);
+        }
+        unsigned int height{1};
+        for (const auto& chain_tx : chain) {
+            pool.removeForBlock({chain_tx}, height++);
+        }
+        assert(pool.size() == 0);
+    });
+}
+
 BENCHMARK(ComplexMemPool, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolRemoveForBlockLongChain, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MempoolCheck, benchmark::PriorityLevel::HIGH);
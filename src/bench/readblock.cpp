@@ -0,0 +1,64 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include <chainparams.h>
+#include <clientversion.h>
+#include <flatfile.h>
+#include <node/blockstorage.h>
+#include <node/kernel_notifications.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <util/chaintype.h>
+
+#include <cassert>
+#include <vector>
+
+/**
+ * Read a block written by a BlockManager, stored as is or compressed. Reading
+ * a compressed block decompresses it, trading some time for the disk space
+ * saved.
+ */
+static void ReadBlock(benchmark::Bench& bench, bool compress, bool raw)
+{
+    const auto testing_setup{MakeNoLogFileContext<BasicTestingSetup>(ChainType::MAIN)};
+    node::KernelNotifications notifications{testing_setup->m_node.exit_status};
+    const node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .compress_blocks = compress,
+        .blocks_dir = testing_setup->m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+    };
+    node::BlockManager blockman{testing_setup->m_node.kernel->interrupt, blockman_opts};
+
+    CBlock block;
+    SpanReader{PROTOCOL_VERSION, benchmark::data::block413567} >> block;
+    const FlatFilePos pos{blockman.SaveBlockToDisk(block, /*nHeight=*/0, /*dbp=*/nullptr)};
+    assert(!pos.IsNull());
+
+    bench.unit("block").run([&] {
+        if (raw) {
+            std::vector<uint8_t> block_data;
+            const bool success{blockman.ReadRawBlockFromDisk(block_data, pos)};
+            assert(success);
+        } else {
+            CBlock read_block;
+            const bool success{blockman.ReadBlockFromDisk(read_block, pos)};
+            assert(success);
+        }
+    });
+}
+
+static void ReadBlockFromDisk(benchmark::Bench& bench) { ReadBlock(bench, /*compress=*/false, /*raw=*/false); }
+static void ReadBlockFromDiskCompressed(benchmark::Bench& bench) { ReadBlock(bench, /*compress=*/true, /*raw=*/false); }
+static void ReadRawBlockFromDisk(benchmark::Bench& bench) { ReadBlock(bench, /*compress=*/false, /*raw=*/true); }
+static void ReadRawBlockFromDiskCompressed(benchmark::Bench& bench) { ReadBlock(bench, /*compress=*/true, /*raw=*/true); }
+
+BENCHMARK(ReadBlockFromDisk, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ReadBlockFromDiskCompressed, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ReadRawBlockFromDisk, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ReadRawBlockFromDiskCompressed, benchmark::PriorityLevel::HIGH);
@@ -12,6 +12,9 @@
 
 #include <univalue.h>
 
+#include <atomic>
+#include <thread>
+
 
 static void AddTx(const CTransactionRef& tx, const CAmount& fee, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
 {
@@ -42,4 +45,47 @@ static void RpcMempool(benchmark::Bench& bench)
     });
 }
 
+/**
+ * Measure transaction acceptance while another thread keeps polling the
+ * verbose mempool, the way block explorers poll `getrawmempool true`.
+ */
+static void RpcMempoolAcceptWhilePolling(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const ChainTestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+
+    std::vector<CTransactionRef> txs;
+    for (int i = 0; i < 1001; ++i) {
+        CMutableTransaction tx = CMutableTransaction();
+        tx.vin.resize(1);
+        tx.vin[0].scriptSig = CScript() << OP_1;
+        tx.vin[0].scriptWitness.stack.push_back({1});
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[0].nValue = i;
+        txs.push_back(MakeTransactionRef(tx));
+    }
+    const CTransactionRef accepted{txs.back()};
+    txs.pop_back();
+    {
+        LOCK2(cs_main, pool.cs);
+        for (const auto& tx : txs) AddTx(tx, /*fee=*/tx->vout[0].nValue, pool);
+    }
+
+    std::atomic<bool> stop{false};
+    std::thread poller{[&] {
+        while (!stop) (void)MempoolToJSON(pool, /*verbose=*/true).write();
+    }};
+
+    bench.run([&] {
+        LOCK2(cs_main, pool.cs);
+        AddTx(accepted, /*fee=*/1000, pool);
+        pool.removeForBlock({accepted}, /*nBlockHeight=*/1);
+    });
+
+    stop = true;
+    poller.join();
+}
+
 BENCHMARK(RpcMempool, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RpcMempoolAcceptWhilePolling, benchmark::PriorityLevel::HIGH);
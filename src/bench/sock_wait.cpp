@@ -0,0 +1,64 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat/compat.h>
+#include <util/fs_helpers.h>
+#include <util/sock.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#ifndef WIN32 // Windows does not have socketpair(2).
+
+/** Number of connected sockets to wait on, all idle but one. */
+static constexpr int NUM_IDLE_PEERS{1000};
+
+/** Wait (without blocking) for readiness of many idle sockets and one with data to read. */
+static void WaitManyIdlePeers(benchmark::Bench& bench, SockEventsMode mode)
+{
+    // Each peer needs two descriptors: our end and the remote end.
+    if (RaiseFileDescriptorLimit(2 * NUM_IDLE_PEERS + 64) < 2 * NUM_IDLE_PEERS + 64) return;
+
+    std::vector<std::shared_ptr<const Sock>> remote;
+    Sock::EventsPerSock events_per_sock;
+    for (int i = 0; i < NUM_IDLE_PEERS; ++i) {
+        int s[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, s) == 0);
+        events_per_sock.emplace(std::make_shared<const Sock>(s[0]), Sock::Events{Sock::RECV});
+        remote.push_back(std::make_shared<const Sock>(s[1]));
+    }
+    assert(remote.back()->Send("a", 1, 0) == 1);
+
+#ifdef USE_EPOLL
+    SockEpoll epoll;
+#endif
+    bench.run([&] {
+        bool ok{false};
+#ifdef USE_EPOLL
+        if (mode == SockEventsMode::EPOLL) ok = epoll.WaitMany(std::chrono::milliseconds{0}, events_per_sock);
+#endif
+        if (mode == SockEventsMode::POLL) ok = events_per_sock.begin()->first->WaitMany(std::chrono::milliseconds{0}, events_per_sock);
+        assert(ok);
+    });
+}
+
+static void SockWaitManyIdlePeersPoll(benchmark::Bench& bench)
+{
+    WaitManyIdlePeers(bench, SockEventsMode::POLL);
+}
+
+BENCHMARK(SockWaitManyIdlePeersPoll, benchmark::PriorityLevel::HIGH);
+
+#ifdef USE_EPOLL
+static void SockWaitManyIdlePeersEpoll(benchmark::Bench& bench)
+{
+    WaitManyIdlePeers(bench, SockEventsMode::EPOLL);
+}
+
+BENCHMARK(SockWaitManyIdlePeersEpoll, benchmark::PriorityLevel::HIGH);
+#endif // USE_EPOLL
+
+#endif // WIN32
@@ -0,0 +1,116 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <random.h>
+#include <txrequest.h>
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+static constexpr NodeId NUM_PEERS{1000};
+static constexpr size_t NUM_ANNOUNCEMENTS{50000};
+//! How many peers announce each transaction.
+static constexpr size_t ANNOUNCERS_PER_TX{8};
+//! Peers below this id are preferred (outbound) and announce without delay.
+static constexpr NodeId NUM_PREFERRED{8};
+
+namespace {
+struct Announcement {
+    NodeId peer;
+    GenTxid gtxid;
+};
+
+/** NUM_ANNOUNCEMENTS announcements of NUM_ANNOUNCEMENTS / ANNOUNCERS_PER_TX transactions, in announcement order. */
+std::vector<Announcement> MakeAnnouncements()
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<Announcement> announcements;
+    announcements.reserve(NUM_ANNOUNCEMENTS);
+    while (announcements.size() < NUM_ANNOUNCEMENTS) {
+        const GenTxid gtxid{GenTxid::Wtxid(rng.rand256())};
+        for (size_t i = 0; i < ANNOUNCERS_PER_TX; ++i) {
+            announcements.push_back({static_cast<NodeId>(rng.randrange(NUM_PEERS)), gtxid});
+        }
+    }
+    return announcements;
+}
+
+void Announce(TxRequestTracker& tracker, const std::vector<Announcement>& announcements, std::chrono::microseconds now)
+{
+    for (const auto& ann : announcements) {
+        const bool preferred{ann.peer < NUM_PREFERRED};
+        tracker.ReceivedInv(ann.peer, ann.gtxid, preferred, preferred ? now : now + 2s);
+    }
+}
+} // namespace
+
+/** Announcements arrive and all peers disconnect again. */
+static void TxRequestAnnounceDisconnect(benchmark::Bench& bench)
+{
+    const auto announcements{MakeAnnouncements()};
+    bench.batch(NUM_ANNOUNCEMENTS).unit("announcement").run([&] {
+        TxRequestTracker tracker;
+        Announce(tracker, announcements, 1s);
+        for (NodeId peer = 0; peer < NUM_PEERS; ++peer) tracker.DisconnectedPeer(peer);
+        assert(tracker.Size() == 0);
+    });
+}
+
+/** The SendMessages loop polls every peer while no announcement is due, as between inv bursts. */
+static void TxRequestGetRequestableIdle(benchmark::Bench& bench)
+{
+    const auto announcements{MakeAnnouncements()};
+    TxRequestTracker tracker;
+    Announce(tracker, announcements, 1h);
+    std::vector<std::pair<NodeId, GenTxid>> expired;
+    bench.batch(NUM_PEERS).unit("call").run([&] {
+        for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+            const auto requestable{tracker.GetRequestable(peer, 1s, &expired)};
+            assert(requestable.empty());
+        }
+    });
+}
+
+/**
+ * Every announced transaction is fetched: each SendMessages round polls all peers, requests what
+ * they are selected for, and half the requests are answered with the transaction while the other
+ * half get a NOTFOUND, so the next best announcement is selected.
+ */
+static void TxRequestDownload(benchmark::Bench& bench)
+{
+    const auto announcements{MakeAnnouncements()};
+    bench.batch(NUM_ANNOUNCEMENTS).unit("announcement").run([&] {
+        TxRequestTracker tracker;
+        std::chrono::microseconds now{1s};
+        Announce(tracker, announcements, now);
+        std::vector<std::pair<NodeId, GenTxid>> expired;
+        std::vector<std::pair<NodeId, GenTxid>> requested;
+        bool notfound{false};
+        while (tracker.Size() > 0) {
+            now += 100ms;
+            for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+                for (const GenTxid& gtxid : tracker.GetRequestable(peer, now, &expired)) {
+                    tracker.RequestedTx(peer, gtxid.GetHash(), now + 60s);
+                    requested.emplace_back(peer, gtxid);
+                }
+            }
+            for (const auto& [peer, gtxid] : requested) {
+                if ((notfound = !notfound)) {
+                    tracker.ReceivedResponse(peer, gtxid.GetHash());
+                } else {
+                    tracker.ForgetTxHash(gtxid.GetHash());
+                }
+            }
+            requested.clear();
+        }
+    });
+}
+
+BENCHMARK(TxRequestAnnounceDisconnect, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxRequestGetRequestableIdle, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxRequestDownload, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,76 @@
+// Copyright (c) 2023 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <net.h>
+#include <protocol.h>
+#include <span.h>
+#include <test/util/setup_common.h>
+#include <version.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/** Move all bytes the sender has queued into the receiver, returning the number of messages received. */
+static size_t Transfer(Transport& sender, Transport& receiver)
+{
+    size_t received{0};
+    while (true) {
+        const auto& [bytes, more, msg_type] = sender.GetBytesToSend(/*have_next_message=*/false);
+        if (bytes.empty()) return received;
+        Span<const uint8_t> to_recv{bytes};
+        while (!to_recv.empty()) {
+            const bool ok{receiver.ReceivedBytes(to_recv)};
+            assert(ok);
+            if (receiver.ReceivedMessageComplete()) {
+                bool reject{false};
+                (void)receiver.GetReceivedMessage({}, reject);
+                assert(!reject);
+                ++received;
+            }
+        }
+        sender.MarkBytesSent(bytes.size());
+    }
+}
+
+/** Encrypt, frame, decrypt and authenticate messages of the given payload size between two v2 transports. */
+static void V2_TRANSPORT(benchmark::Bench& bench, size_t payload_size)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>(ChainType::MAIN);
+    V2Transport initiator{0, true, SER_NETWORK, INIT_PROTO_VERSION};
+    V2Transport responder{1, false, SER_NETWORK, INIT_PROTO_VERSION};
+
+    // Key exchange, garbage terminators and version packets.
+    for (int i = 0; i < 3; ++i) {
+        Transfer(initiator, responder);
+        Transfer(responder, initiator);
+    }
+    assert(initiator.GetInfo().transport_type == TransportProtocolType::V2);
+    assert(responder.GetInfo().transport_type == TransportProtocolType::V2);
+
+    const std::vector<unsigned char> payload(payload_size, 0x5a);
+    bench.batch(payload_size).unit("byte").run([&] {
+        CSerializedNetMsg msg;
+        msg.m_type = NetMsgType::TX;
+        msg.data = payload;
+        const bool queued{initiator.SetMessageToSend(msg)};
+        assert(queued);
+        const size_t received{Transfer(initiator, responder)};
+        assert(received == 1);
+    });
+}
+
+static void V2_TRANSPORT_256BYTES(benchmark::Bench& bench)
+{
+    V2_TRANSPORT(bench, 256);
+}
+
+static void V2_TRANSPORT_1MB(benchmark::Bench& bench)
+{
+    V2_TRANSPORT(bench, 1024 * 1024);
+}
+
+BENCHMARK(V2_TRANSPORT_256BYTES, benchmark::PriorityLevel::HIGH);
+BENCHMARK(V2_TRANSPORT_1MB, benchmark::PriorityLevel::HIGH);
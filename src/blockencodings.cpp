@@ -15,8 +15,15 @@
 #include <txmempool.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <array>
 #include <unordered_map>
 
+/** Number of mempool transactions whose short IDs are computed together in InitData. */
+static constexpr size_t SHORTID_BATCH_SIZE{64};
+/** Bits in the short ID prefilter used by InitData (must be a power of two). */
+static constexpr size_t SHORTID_FILTER_BITS{1 << 16};
+
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block) :
         nonce(GetRand<uint64_t>()),
         shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
@@ -45,6 +52,14 @@ uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const uint256& txhash) const {
     return SipHashUint256(shorttxidk0, shorttxidk1, txhash) & 0xffffffffffffL;
 }
 
+void CBlockHeaderAndShortTxIDs::GetShortIDs(Span<const uint256* const> txhashes, Span<uint64_t> out) const {
+    static_assert(SHORTTXIDS_LENGTH == 6, "shorttxids calculation assumes 6-byte shorttxids");
+    SipHashUint256Batch(shorttxidk0, shorttxidk1, txhashes, out);
+    for (size_t i = 0; i < txhashes.size(); i++) {
+        out[i] &= 0xffffffffffffL;
+    }
+}
+
 
 
 ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn) {
@@ -104,32 +119,51 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     if (shorttxids.size() != cmpctblock.shorttxids.size())
         return READ_STATUS_FAILED; // Short ID collision
 
+    // Most mempool transactions are not in the block. A small bitmap of the
+    // block's short IDs rejects nearly all of them without probing the map.
+    std::vector<bool> shortid_filter(SHORTID_FILTER_BITS);
+    for (const uint64_t shortid : cmpctblock.shorttxids) {
+        shortid_filter[shortid & (SHORTID_FILTER_BITS - 1)] = true;
+    }
+
     std::vector<bool> have_txn(txn_available.size());
     {
     LOCK(pool->cs);
-    for (size_t i = 0; i < pool->vTxHashes.size(); i++) {
-        uint64_t shortid = cmpctblock.GetShortID(pool->vTxHashes[i].first);
-        std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
-        if (idit != shorttxids.end()) {
-            if (!have_txn[idit->second]) {
-                txn_available[idit->second] = pool->vTxHashes[i].second->GetSharedTx();
-                have_txn[idit->second]  = true;
-                mempool_count++;
-            } else {
-                // If we find two mempool txn that match the short id, just request it.
-                // This should be rare enough that the extra bandwidth doesn't matter,
-                // but eating a round-trip due to FillBlock failure would be annoying
-                if (txn_available[idit->second]) {
-                    txn_available[idit->second].reset();
-                    mempool_count--;
+    // Short IDs are computed a batch at a time, so the SipHash of several
+    // mempool transactions can be interleaved.
+    std::array<const uint256*, SHORTID_BATCH_SIZE> batch_hashes;
+    std::array<uint64_t, SHORTID_BATCH_SIZE> batch_ids;
+    for (size_t batch_start = 0; batch_start < pool->vTxHashes.size() && mempool_count < shorttxids.size(); batch_start += SHORTID_BATCH_SIZE) {
+        const size_t batch_size = std::min(SHORTID_BATCH_SIZE, pool->vTxHashes.size() - batch_start);
+        for (size_t j = 0; j < batch_size; j++) {
+            batch_hashes[j] = &pool->vTxHashes[batch_start + j].first;
+        }
+        cmpctblock.GetShortIDs(Span{batch_hashes}.first(batch_size), batch_ids);
+        for (size_t j = 0; j < batch_size; j++) {
+            if (!shortid_filter[batch_ids[j] & (SHORTID_FILTER_BITS - 1)]) continue;
+            const size_t i = batch_start + j;
+            std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(batch_ids[j]);
+            if (idit != shorttxids.end()) {
+                if (!have_txn[idit->second]) {
+                    txn_available[idit->second] = pool->vTxHashes[i].second->GetSharedTx();
+                    have_txn[idit->second]  = true;
+                    mempool_count++;
+                } else {
+                    // If we find two mempool txn that match the short id, just request it.
+                    // This should be rare enough that the extra bandwidth doesn't matter,
+                    // but eating a round-trip due to FillBlock failure would be annoying
+                    if (txn_available[idit->second]) {
+                        txn_available[idit->second].reset();
+                        mempool_count--;
+                    }
                 }
             }
+            // Though ideally we'd continue scanning for the two-txn-match-shortid case,
+            // the performance win of an early exit here is too good to pass up and worth
+            // the extra risk.
+            if (mempool_count == shorttxids.size())
+                break;
         }
-        // Though ideally we'd continue scanning for the two-txn-match-shortid case,
-        // the performance win of an early exit here is too good to pass up and worth
-        // the extra risk.
-        if (mempool_count == shorttxids.size())
-            break;
     }
     }
 
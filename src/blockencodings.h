@@ -112,6 +112,8 @@ public:
     CBlockHeaderAndShortTxIDs(const CBlock& block);
 
     uint64_t GetShortID(const uint256& txhash) const;
+    /** Compute GetShortID() for a batch of hashes at once. out must be at least as large as txhashes. */
+    void GetShortIDs(Span<const uint256* const> txhashes, Span<uint64_t> out) const;
 
     size_t BlockTxCount() const { return shorttxids.size() + prefilledtxn.size(); }
 
@@ -25,18 +25,21 @@ static const std::map<BlockFilterType, std::string> g_filter_types = {
 
 uint64_t GCSFilter::HashToRange(const Element& element) const
 {
-    uint64_t hash = CSipHasher(m_params.m_siphash_k0, m_params.m_siphash_k1)
-        .Write(element)
-        .Finalize();
+    uint64_t hash = SipHash(m_params.m_siphash_k0, m_params.m_siphash_k1, element);
     return FastRange64(hash, m_F);
 }
 
 std::vector<uint64_t> GCSFilter::BuildHashedSet(const ElementSet& elements) const
 {
-    std::vector<uint64_t> hashed_elements;
-    hashed_elements.reserve(elements.size());
+    std::vector<Span<const unsigned char>> element_spans;
+    element_spans.reserve(elements.size());
     for (const Element& element : elements) {
-        hashed_elements.push_back(HashToRange(element));
+        element_spans.emplace_back(element);
+    }
+    std::vector<uint64_t> hashed_elements(elements.size());
+    SipHashBatch(m_params.m_siphash_k0, m_params.m_siphash_k1, element_spans, hashed_elements);
+    for (uint64_t& hash : hashed_elements) {
+        hash = FastRange64(hash, m_F);
     }
     std::sort(hashed_elements.begin(), hashed_elements.end());
     return hashed_elements;
@@ -62,11 +65,11 @@ GCSFilter::GCSFilter(const Params& params, std::vector<unsigned char> encoded_fi
 
     // Verify that the encoded filter contains exactly N elements. If it has too much or too little
     // data, a std::ios_base::failure exception will be raised.
-    BitStreamReader<SpanReader> bitreader{stream};
+    GolombRiceDecoder decoder{Span{m_encoded}.last(stream.size())};
     for (uint64_t i = 0; i < m_N; ++i) {
-        GolombRiceDecode(bitreader, m_params.m_P);
+        decoder.Decode(m_params.m_P);
     }
-    if (!stream.empty()) {
+    if (decoder.RemainingBytes() != 0) {
         throw std::ios_base::failure("encoded_filter contains excess data");
     }
 }
@@ -109,12 +112,12 @@ bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
     uint64_t N = ReadCompactSize(stream);
     assert(N == m_N);
 
-    BitStreamReader<SpanReader> bitreader{stream};
+    GolombRiceDecoder decoder{Span{m_encoded}.last(stream.size())};
 
     uint64_t value = 0;
     size_t hashes_index = 0;
     for (uint32_t i = 0; i < m_N; ++i) {
-        uint64_t delta = GolombRiceDecode(bitreader, m_params.m_P);
+        uint64_t delta = decoder.Decode(m_params.m_P);
         value += delta;
 
         while (true) {
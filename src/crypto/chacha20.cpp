@@ -7,6 +7,7 @@
 
 #include <crypto/common.h>
 #include <crypto/chacha20.h>
+#include <compat/cpuid.h>
 #include <support/cleanse.h>
 #include <span.h>
 
@@ -23,6 +24,75 @@ constexpr static inline uint32_t rotl32(uint32_t v, int c) { return (v << c) | (
 
 #define REPEAT10(a) do { {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; {a}; } while(0)
 
+#if defined(__SSE2__)
+namespace chacha20_sse2 {
+/** Process blocks (rounded down to a multiple of 4) starting at block counter input[8], which must
+ *  not wrap around. Without input (in == nullptr) the keystream itself is written. */
+void Crypt(const uint32_t input[12], const unsigned char* in, unsigned char* out, size_t blocks);
+}
+#endif
+
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID) && !defined(BUILD_SUPERAXECOIN_INTERNAL)
+#define CHACHA20_HAVE_AVX2
+namespace chacha20_avx2 {
+/** Same as chacha20_sse2::Crypt, for multiples of 8 blocks. */
+void Crypt(const uint32_t input[12], const unsigned char* in, unsigned char* out, size_t blocks);
+}
+#endif
+
+namespace {
+
+#ifdef CHACHA20_HAVE_AVX2
+bool DetectAVX2()
+{
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    if (!((ecx >> 27) & 1) || !((ecx >> 28) & 1)) return false; // XSAVE and AVX
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    if ((a & 6) != 6) return false; // OS saves the AVX registers
+    GetCPUID(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 5) & 1;
+}
+#endif
+
+/** Process as many leading blocks as possible with a multi-block implementation.
+ *
+ * Batches never cross a wraparound of the 32-bit block counter, leaving that to the
+ * scalar code. The block counter in input is advanced past the processed blocks, and
+ * the number of processed blocks is returned.
+ */
+size_t CryptMultiBlock(uint32_t input[12], const unsigned char* in, unsigned char* out, size_t blocks) noexcept
+{
+    const size_t todo = std::min<uint64_t>(blocks, (uint64_t{1} << 32) - input[8]);
+    size_t done{0};
+    const auto advance = [&](size_t n) {
+        input[8] += n;
+        if (input[8] == 0) ++input[9];
+        if (in) in += n * ChaCha20Aligned::BLOCKLEN;
+        out += n * ChaCha20Aligned::BLOCKLEN;
+        done += n;
+    };
+#ifdef CHACHA20_HAVE_AVX2
+    static const bool use_avx2{DetectAVX2()};
+    if (use_avx2 && todo - done >= 8) {
+        const size_t n = (todo - done) & ~size_t{7};
+        chacha20_avx2::Crypt(input, in, out, n);
+        advance(n);
+    }
+#endif
+#if defined(__SSE2__)
+    if (todo - done >= 4) {
+        const size_t n = (todo - done) & ~size_t{3};
+        chacha20_sse2::Crypt(input, in, out, n);
+        advance(n);
+    }
+#endif
+    return done;
+}
+
+} // namespace
+
 void ChaCha20Aligned::SetKey(Span<const std::byte> key) noexcept
 {
     assert(key.size() == KEYLEN);
@@ -67,6 +137,9 @@ inline void ChaCha20Aligned::Keystream(Span<std::byte> output) noexcept
     uint32_t x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
     uint32_t j4, j5, j6, j7, j8, j9, j10, j11, j12, j13, j14, j15;
 
+    const size_t multi = CryptMultiBlock(input, nullptr, c, blocks);
+    blocks -= multi;
+    c += multi * BLOCKLEN;
     if (!blocks) return;
 
     j4 = input[0];
@@ -170,6 +243,10 @@ inline void ChaCha20Aligned::Crypt(Span<const std::byte> in_bytes, Span<std::byt
     uint32_t x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
     uint32_t j4, j5, j6, j7, j8, j9, j10, j11, j12, j13, j14, j15;
 
+    const size_t multi = CryptMultiBlock(input, m, c, blocks);
+    blocks -= multi;
+    m += multi * BLOCKLEN;
+    c += multi * BLOCKLEN;
     if (!blocks) return;
 
     j4 = input[0];
@@ -0,0 +1,120 @@
+// Copyright (c) 2023 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// 8-way word-sliced ChaCha20: each 256-bit register holds the same state word
+// of 8 consecutive blocks.
+
+#ifdef ENABLE_AVX2
+
+#include <attributes.h>
+
+#include <cstddef>
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace chacha20_avx2 {
+namespace {
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+
+template<int N>
+__m256i inline RotL(__m256i x) { return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N)); }
+template<>
+__m256i inline RotL<16>(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13)); }
+template<>
+__m256i inline RotL<8>(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14, 3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14)); }
+
+void ALWAYS_INLINE QuarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+{
+    a = Add(a, b); d = RotL<16>(Xor(d, a));
+    c = Add(c, d); b = RotL<12>(Xor(b, c));
+    a = Add(a, b); d = RotL<8>(Xor(d, a));
+    c = Add(c, d); b = RotL<7>(Xor(b, c));
+}
+
+/** Transpose an 8x8 matrix of 32-bit words: afterwards r<k> holds word k of every input register. */
+void ALWAYS_INLINE Transpose(__m256i& r0, __m256i& r1, __m256i& r2, __m256i& r3, __m256i& r4, __m256i& r5, __m256i& r6, __m256i& r7)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(r0, r1), t1 = _mm256_unpackhi_epi32(r0, r1);
+    __m256i t2 = _mm256_unpacklo_epi32(r2, r3), t3 = _mm256_unpackhi_epi32(r2, r3);
+    __m256i t4 = _mm256_unpacklo_epi32(r4, r5), t5 = _mm256_unpackhi_epi32(r4, r5);
+    __m256i t6 = _mm256_unpacklo_epi32(r6, r7), t7 = _mm256_unpackhi_epi32(r6, r7);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+    r0 = _mm256_permute2x128_si256(u0, u4, 0x20);
+    r1 = _mm256_permute2x128_si256(u1, u5, 0x20);
+    r2 = _mm256_permute2x128_si256(u2, u6, 0x20);
+    r3 = _mm256_permute2x128_si256(u3, u7, 0x20);
+    r4 = _mm256_permute2x128_si256(u0, u4, 0x31);
+    r5 = _mm256_permute2x128_si256(u1, u5, 0x31);
+    r6 = _mm256_permute2x128_si256(u2, u6, 0x31);
+    r7 = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/** Write 32 bytes of output, XORed with the corresponding input bytes if there are any. */
+void ALWAYS_INLINE Output(const unsigned char* in, unsigned char* out, size_t pos, __m256i x)
+{
+    if (in) x = Xor(x, _mm256_loadu_si256((const __m256i*)(in + pos)));
+    _mm256_storeu_si256((__m256i*)(out + pos), x);
+}
+
+} // namespace
+
+void Crypt(const uint32_t input[12], const unsigned char* in, unsigned char* out, size_t blocks)
+{
+    const __m256i j0 = _mm256_set1_epi32(0x61707865), j1 = _mm256_set1_epi32(0x3320646e);
+    const __m256i j2 = _mm256_set1_epi32(0x79622d32), j3 = _mm256_set1_epi32(0x6b206574);
+    const __m256i j4 = _mm256_set1_epi32(input[0]), j5 = _mm256_set1_epi32(input[1]);
+    const __m256i j6 = _mm256_set1_epi32(input[2]), j7 = _mm256_set1_epi32(input[3]);
+    const __m256i j8 = _mm256_set1_epi32(input[4]), j9 = _mm256_set1_epi32(input[5]);
+    const __m256i j10 = _mm256_set1_epi32(input[6]), j11 = _mm256_set1_epi32(input[7]);
+    const __m256i j13 = _mm256_set1_epi32(input[9]), j14 = _mm256_set1_epi32(input[10]);
+    const __m256i j15 = _mm256_set1_epi32(input[11]);
+    __m256i j12 = Add(_mm256_set1_epi32(input[8]), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+    for (; blocks >= 8; blocks -= 8) {
+        __m256i x0 = j0, x1 = j1, x2 = j2, x3 = j3, x4 = j4, x5 = j5, x6 = j6, x7 = j7;
+        __m256i x8 = j8, x9 = j9, x10 = j10, x11 = j11, x12 = j12, x13 = j13, x14 = j14, x15 = j15;
+
+        for (int i = 0; i < 10; ++i) {
+            QuarterRound(x0, x4, x8, x12);
+            QuarterRound(x1, x5, x9, x13);
+            QuarterRound(x2, x6, x10, x14);
+            QuarterRound(x3, x7, x11, x15);
+            QuarterRound(x0, x5, x10, x15);
+            QuarterRound(x1, x6, x11, x12);
+            QuarterRound(x2, x7, x8, x13);
+            QuarterRound(x3, x4, x9, x14);
+        }
+
+        x0 = Add(x0, j0); x1 = Add(x1, j1); x2 = Add(x2, j2); x3 = Add(x3, j3);
+        x4 = Add(x4, j4); x5 = Add(x5, j5); x6 = Add(x6, j6); x7 = Add(x7, j7);
+        x8 = Add(x8, j8); x9 = Add(x9, j9); x10 = Add(x10, j10); x11 = Add(x11, j11);
+        x12 = Add(x12, j12); x13 = Add(x13, j13); x14 = Add(x14, j14); x15 = Add(x15, j15);
+
+        // Turn words 0..7 and 8..15 of the 8 blocks into the two 32-byte halves of each block.
+        Transpose(x0, x1, x2, x3, x4, x5, x6, x7);
+        Transpose(x8, x9, x10, x11, x12, x13, x14, x15);
+
+        Output(in, out, 0, x0); Output(in, out, 32, x8);
+        Output(in, out, 64, x1); Output(in, out, 96, x9);
+        Output(in, out, 128, x2); Output(in, out, 160, x10);
+        Output(in, out, 192, x3); Output(in, out, 224, x11);
+        Output(in, out, 256, x4); Output(in, out, 288, x12);
+        Output(in, out, 320, x5); Output(in, out, 352, x13);
+        Output(in, out, 384, x6); Output(in, out, 416, x14);
+        Output(in, out, 448, x7); Output(in, out, 480, x15);
+
+        j12 = Add(j12, _mm256_set1_epi32(8));
+        if (in) in += 512;
+        out += 512;
+    }
+}
+
+} // namespace chacha20_avx2
+
+#endif
@@ -0,0 +1,105 @@
+// Copyright (c) 2023 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// 4-way word-sliced ChaCha20: each 128-bit register holds the same state word
+// of 4 consecutive blocks. SSE2 is part of the x86-64 baseline, so this needs
+// no runtime detection.
+
+#if defined(__SSE2__)
+
+#include <attributes.h>
+
+#include <cstddef>
+#include <stdint.h>
+#include <emmintrin.h>
+
+namespace chacha20_sse2 {
+namespace {
+
+__m128i inline Add(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+__m128i inline Xor(__m128i x, __m128i y) { return _mm_xor_si128(x, y); }
+
+template<int N>
+__m128i inline RotL(__m128i x) { return _mm_or_si128(_mm_slli_epi32(x, N), _mm_srli_epi32(x, 32 - N)); }
+
+void ALWAYS_INLINE QuarterRound(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+{
+    a = Add(a, b); d = RotL<16>(Xor(d, a));
+    c = Add(c, d); b = RotL<12>(Xor(b, c));
+    a = Add(a, b); d = RotL<8>(Xor(d, a));
+    c = Add(c, d); b = RotL<7>(Xor(b, c));
+}
+
+/** Transpose a 4x4 matrix of 32-bit words: afterwards r<k> holds word k of every input register. */
+void ALWAYS_INLINE Transpose(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3)
+{
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1), t3 = _mm_unpackhi_epi32(r2, r3);
+    r0 = _mm_unpacklo_epi64(t0, t1);
+    r1 = _mm_unpackhi_epi64(t0, t1);
+    r2 = _mm_unpacklo_epi64(t2, t3);
+    r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/** Write 16 bytes of output, XORed with the corresponding input bytes if there are any. */
+void ALWAYS_INLINE Output(const unsigned char* in, unsigned char* out, size_t pos, __m128i x)
+{
+    if (in) x = Xor(x, _mm_loadu_si128((const __m128i*)(in + pos)));
+    _mm_storeu_si128((__m128i*)(out + pos), x);
+}
+
+} // namespace
+
+void Crypt(const uint32_t input[12], const unsigned char* in, unsigned char* out, size_t blocks)
+{
+    const __m128i j0 = _mm_set1_epi32(0x61707865), j1 = _mm_set1_epi32(0x3320646e);
+    const __m128i j2 = _mm_set1_epi32(0x79622d32), j3 = _mm_set1_epi32(0x6b206574);
+    const __m128i j4 = _mm_set1_epi32(input[0]), j5 = _mm_set1_epi32(input[1]);
+    const __m128i j6 = _mm_set1_epi32(input[2]), j7 = _mm_set1_epi32(input[3]);
+    const __m128i j8 = _mm_set1_epi32(input[4]), j9 = _mm_set1_epi32(input[5]);
+    const __m128i j10 = _mm_set1_epi32(input[6]), j11 = _mm_set1_epi32(input[7]);
+    const __m128i j13 = _mm_set1_epi32(input[9]), j14 = _mm_set1_epi32(input[10]);
+    const __m128i j15 = _mm_set1_epi32(input[11]);
+    __m128i j12 = Add(_mm_set1_epi32(input[8]), _mm_setr_epi32(0, 1, 2, 3));
+
+    for (; blocks >= 4; blocks -= 4) {
+        __m128i x0 = j0, x1 = j1, x2 = j2, x3 = j3, x4 = j4, x5 = j5, x6 = j6, x7 = j7;
+        __m128i x8 = j8, x9 = j9, x10 = j10, x11 = j11, x12 = j12, x13 = j13, x14 = j14, x15 = j15;
+
+        for (int i = 0; i < 10; ++i) {
+            QuarterRound(x0, x4, x8, x12);
+            QuarterRound(x1, x5, x9, x13);
+            QuarterRound(x2, x6, x10, x14);
+            QuarterRound(x3, x7, x11, x15);
+            QuarterRound(x0, x5, x10, x15);
+            QuarterRound(x1, x6, x11, x12);
+            QuarterRound(x2, x7, x8, x13);
+            QuarterRound(x3, x4, x9, x14);
+        }
+
+        x0 = Add(x0, j0); x1 = Add(x1, j1); x2 = Add(x2, j2); x3 = Add(x3, j3);
+        x4 = Add(x4, j4); x5 = Add(x5, j5); x6 = Add(x6, j6); x7 = Add(x7, j7);
+        x8 = Add(x8, j8); x9 = Add(x9, j9); x10 = Add(x10, j10); x11 = Add(x11, j11);
+        x12 = Add(x12, j12); x13 = Add(x13, j13); x14 = Add(x14, j14); x15 = Add(x15, j15);
+
+        // Turn each group of 4 words of the 4 blocks into the corresponding 16-byte quarter of each block.
+        Transpose(x0, x1, x2, x3);
+        Transpose(x4, x5, x6, x7);
+        Transpose(x8, x9, x10, x11);
+        Transpose(x12, x13, x14, x15);
+
+        Output(in, out, 0, x0); Output(in, out, 16, x4); Output(in, out, 32, x8); Output(in, out, 48, x12);
+        Output(in, out, 64, x1); Output(in, out, 80, x5); Output(in, out, 96, x9); Output(in, out, 112, x13);
+        Output(in, out, 128, x2); Output(in, out, 144, x6); Output(in, out, 160, x10); Output(in, out, 176, x14);
+        Output(in, out, 192, x3); Output(in, out, 208, x7); Output(in, out, 224, x11); Output(in, out, 240, x15);
+
+        j12 = Add(j12, _mm_set1_epi32(4));
+        if (in) in += 256;
+        out += 256;
+    }
+}
+
+} // namespace chacha20_sse2
+
+#endif
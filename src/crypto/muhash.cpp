@@ -9,6 +9,7 @@
 #include <hash.h>
 
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 #include <limits>
 
@@ -113,12 +114,214 @@ inline void addnextract2(limb_t& c0, limb_t& c1, const limb_t& a, limb_t& n)
     c1 = c2;
 }
 
+#ifdef __SIZEOF_INT128__
+/*
+ * Modular inversion with the safegcd algorithm of Bernstein and Yang ("Fast
+ * constant-time gcd computation and modular inversion", 2019), in the
+ * variable-time form of libsecp256k1's modinv64. MuHash only inverts public
+ * data, so the running time may depend on the input. Numbers are represented
+ * in signed limbs of 62 bits, the top limb holding the sign.
+ */
+
+typedef __int128 signed_double_limb_t;
+
+constexpr int SIGNED_LIMBS = 50;
+static_assert(62 * (SIGNED_LIMBS - 1) < 3072 && 3072 - 62 * (SIGNED_LIMBS - 1) < 62, "bad number of signed limbs");
+constexpr uint64_t M62 = std::numeric_limits<uint64_t>::max() >> 2;
+
+struct Signed62 {
+    int64_t v[SIGNED_LIMBS];
+};
+
+/** The modulus, as -MAX_PRIME_DIFF + 2^3072. */
+constexpr Signed62 MakeModulus()
+{
+    Signed62 m{};
+    m.v[0] = -static_cast<int64_t>(MAX_PRIME_DIFF);
+    m.v[SIGNED_LIMBS - 1] = int64_t{1} << (3072 - 62 * (SIGNED_LIMBS - 1));
+    return m;
+}
+constexpr Signed62 MODULUS_SIGNED62 = MakeModulus();
+
+/** Inverse of the modulus mod 2^62, by Newton iteration. */
+constexpr uint64_t MakeModulusInv62()
+{
+    const uint64_t a = -static_cast<uint64_t>(MAX_PRIME_DIFF); // The modulus mod 2^64
+    uint64_t x = a; // Correct to 3 bits, as a is odd
+    for (int i = 0; i < 5; ++i) x *= 2 - a * x;
+    return x & M62;
+}
+constexpr uint64_t MODULUS_INV62 = MakeModulusInv62();
+static_assert(((MODULUS_INV62 * -static_cast<uint64_t>(MAX_PRIME_DIFF)) & M62) == 1, "bad modulus inverse");
+
+/** The transition matrix of 62 divsteps, scaled by 2^62. */
+struct Trans2x2 {
+    int64_t u, v, q, r;
+};
+
+/** Compute the transition matrix and the new eta of 62 divsteps on the bottom limbs of f and g. */
+int64_t divsteps_62_var(int64_t eta, uint64_t f0, uint64_t g0, Trans2x2& t)
+{
+    uint64_t u = 1, v = 0, q = 0, r = 1;
+    uint64_t f = f0, g = g0, m;
+    uint32_t w;
+    int i = 62, limit, zeros;
+
+    for (;;) {
+        // Drop the zero bits at the bottom of g, a divstep each.
+        zeros = __builtin_ctzll(g | (std::numeric_limits<uint64_t>::max() << i));
+        g >>= zeros;
+        u <<= zeros;
+        v <<= zeros;
+        eta -= zeros;
+        i -= zeros;
+        if (i == 0) break;
+        // g is odd: if eta is negative, swap f and g, negating g.
+        if (eta < 0) {
+            uint64_t tmp;
+            eta = -eta;
+            tmp = f; f = g; g = -tmp;
+            tmp = u; u = q; q = -tmp;
+            tmp = v; v = r; r = -tmp;
+            // Cancel out up to 6 bottom bits of g, within the divsteps left and eta + 1.
+            limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+            m = (std::numeric_limits<uint64_t>::max() >> (64 - limit)) & 63U;
+            w = (f * g * (f * f - 2)) & m;
+        } else {
+            // Cancel out up to 4 bottom bits of g.
+            limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+            m = (std::numeric_limits<uint64_t>::max() >> (64 - limit)) & 15U;
+            w = f + (((f + 1) & 4) << 1);
+            w = (-w * g) & m;
+        }
+        g += f * w;
+        q += u * w;
+        r += v * w;
+    }
+    t.u = (int64_t)u;
+    t.v = (int64_t)v;
+    t.q = (int64_t)q;
+    t.r = (int64_t)r;
+    return eta;
+}
+
+/** [d,e] = t * [d,e] / 2^62 mod the modulus, keeping d and e in (-2*modulus, modulus). */
+void update_de_62(Signed62& d, Signed62& e, const Trans2x2& t)
+{
+    const int64_t u = t.u, v = t.v, q = t.q, r = t.r;
+    // Add multiples of the modulus to make the bottom 62 bits of t * [d,e] zero, and
+    // the result non-negative if d or e is.
+    const int64_t sd = d.v[SIGNED_LIMBS - 1] >> 63;
+    const int64_t se = e.v[SIGNED_LIMBS - 1] >> 63;
+    int64_t md = (u & sd) + (v & se);
+    int64_t me = (q & sd) + (r & se);
+    signed_double_limb_t cd = (signed_double_limb_t)u * d.v[0] + (signed_double_limb_t)v * e.v[0];
+    signed_double_limb_t ce = (signed_double_limb_t)q * d.v[0] + (signed_double_limb_t)r * e.v[0];
+    md -= (int64_t)((MODULUS_INV62 * (uint64_t)cd + (uint64_t)md) & M62);
+    me -= (int64_t)((MODULUS_INV62 * (uint64_t)ce + (uint64_t)me) & M62);
+    cd += (signed_double_limb_t)MODULUS_SIGNED62.v[0] * md;
+    ce += (signed_double_limb_t)MODULUS_SIGNED62.v[0] * me;
+    assert(((uint64_t)cd & M62) == 0 && ((uint64_t)ce & M62) == 0);
+    cd >>= 62;
+    ce >>= 62;
+    for (int i = 1; i < SIGNED_LIMBS; ++i) {
+        cd += (signed_double_limb_t)u * d.v[i] + (signed_double_limb_t)v * e.v[i];
+        ce += (signed_double_limb_t)q * d.v[i] + (signed_double_limb_t)r * e.v[i];
+        // Most limbs of the modulus are zero.
+        if (MODULUS_SIGNED62.v[i]) {
+            cd += (signed_double_limb_t)MODULUS_SIGNED62.v[i] * md;
+            ce += (signed_double_limb_t)MODULUS_SIGNED62.v[i] * me;
+        }
+        d.v[i - 1] = (int64_t)((uint64_t)cd & M62);
+        e.v[i - 1] = (int64_t)((uint64_t)ce & M62);
+        cd >>= 62;
+        ce >>= 62;
+    }
+    d.v[SIGNED_LIMBS - 1] = (int64_t)cd;
+    e.v[SIGNED_LIMBS - 1] = (int64_t)ce;
+}
+
+/** [f,g] = t * [f,g] / 2^62, on the bottom len limbs of f and g. */
+void update_fg_62_var(int len, Signed62& f, Signed62& g, const Trans2x2& t)
+{
+    const int64_t u = t.u, v = t.v, q = t.q, r = t.r;
+    signed_double_limb_t cf = (signed_double_limb_t)u * f.v[0] + (signed_double_limb_t)v * g.v[0];
+    signed_double_limb_t cg = (signed_double_limb_t)q * f.v[0] + (signed_double_limb_t)r * g.v[0];
+    assert(((uint64_t)cf & M62) == 0 && ((uint64_t)cg & M62) == 0);
+    cf >>= 62;
+    cg >>= 62;
+    for (int i = 1; i < len; ++i) {
+        cf += (signed_double_limb_t)u * f.v[i] + (signed_double_limb_t)v * g.v[i];
+        cg += (signed_double_limb_t)q * f.v[i] + (signed_double_limb_t)r * g.v[i];
+        f.v[i - 1] = (int64_t)((uint64_t)cf & M62);
+        g.v[i - 1] = (int64_t)((uint64_t)cg & M62);
+        cf >>= 62;
+        cg >>= 62;
+    }
+    f.v[len - 1] = (int64_t)cf;
+    g.v[len - 1] = (int64_t)cg;
+}
+
+/** Bring r from (-2*modulus, modulus) to [0, modulus), negating it first if sign is negative. */
+void normalize_62(Signed62& r, int64_t sign)
+{
+    int64_t cond_add = r.v[SIGNED_LIMBS - 1] >> 63;
+    for (int i = 0; i < SIGNED_LIMBS; ++i) r.v[i] += MODULUS_SIGNED62.v[i] & cond_add;
+    const int64_t cond_negate = sign >> 63;
+    for (int i = 0; i < SIGNED_LIMBS; ++i) r.v[i] = (r.v[i] ^ cond_negate) - cond_negate;
+    for (int i = 0; i < SIGNED_LIMBS - 1; ++i) {
+        r.v[i + 1] += r.v[i] >> 62;
+        r.v[i] &= M62;
+    }
+    cond_add = r.v[SIGNED_LIMBS - 1] >> 63;
+    for (int i = 0; i < SIGNED_LIMBS; ++i) r.v[i] += MODULUS_SIGNED62.v[i] & cond_add;
+    for (int i = 0; i < SIGNED_LIMBS - 1; ++i) {
+        r.v[i + 1] += r.v[i] >> 62;
+        r.v[i] &= M62;
+    }
+}
+
+Signed62 ToSigned62(const Num3072& in)
+{
+    Signed62 out;
+    unsigned __int128 acc = 0;
+    int bits = 0, j = 0;
+    for (int i = 0; i < SIGNED_LIMBS; ++i) {
+        if (bits < 62 && j < Num3072::LIMBS) {
+            acc |= (unsigned __int128)in.limbs[j++] << bits;
+            bits += LIMB_SIZE;
+        }
+        out.v[i] = (int64_t)((uint64_t)acc & M62);
+        acc >>= 62;
+        bits -= 62;
+    }
+    return out;
+}
+
+Num3072 FromSigned62(const Signed62& in)
+{
+    Num3072 out;
+    unsigned __int128 acc = 0;
+    int bits = 0, i = 0;
+    for (int j = 0; j < Num3072::LIMBS; ++j) {
+        while (bits < LIMB_SIZE && i < SIGNED_LIMBS) {
+            acc |= (unsigned __int128)(uint64_t)in.v[i++] << bits;
+            bits += 62;
+        }
+        out.limbs[j] = (limb_t)acc;
+        acc >>= LIMB_SIZE;
+        bits -= LIMB_SIZE;
+    }
+    return out;
+}
+#else
 /** in_out = in_out^(2^sq) * mul */
 inline void square_n_mul(Num3072& in_out, const int sq, const Num3072& mul)
 {
     for (int j = 0; j < sq; ++j) in_out.Square();
     in_out.Multiply(mul);
 }
+#endif
 
 } // namespace
 
@@ -143,6 +346,40 @@ void Num3072::FullReduce()
 
 Num3072 Num3072::GetInverse() const
 {
+#ifdef __SIZEOF_INT128__
+    // Run divsteps on f = modulus and g = this until g is zero, applying the
+    // same transitions to d = 0 and e = 1. f is then +/-1 and d +/- the inverse.
+    Signed62 d{}, e{};
+    e.v[0] = 1;
+    Signed62 f = MODULUS_SIGNED62;
+    Signed62 g = ToSigned62(*this);
+    int len = SIGNED_LIMBS;
+    int64_t eta = -1; // eta = -delta; delta is initially 1
+
+    while (true) {
+        Trans2x2 t;
+        eta = divsteps_62_var(eta, f.v[0], g.v[0], t);
+        update_de_62(d, e, t);
+        update_fg_62_var(len, f, g, t);
+        if (g.v[0] == 0) {
+            int64_t cond = 0;
+            for (int j = 1; j < len; ++j) cond |= g.v[j];
+            if (cond == 0) break;
+        }
+        // Shorten f and g once their top limbs are only sign bits.
+        const int64_t fn = f.v[len - 1], gn = g.v[len - 1];
+        int64_t cond = ((int64_t)len - 2) >> 63;
+        cond |= fn ^ (fn >> 63);
+        cond |= gn ^ (gn >> 63);
+        if (cond == 0) {
+            f.v[len - 2] |= (int64_t)((uint64_t)fn << 62);
+            g.v[len - 2] |= (int64_t)((uint64_t)gn << 62);
+            --len;
+        }
+    }
+    normalize_62(d, f.v[len - 1]);
+    return FromSigned62(d);
+#else
     // For fast exponentiation a sliding window exponentiation with repunit
     // precomputation is utilized. See "Fast Point Decompression for Standard
     // Elliptic Curves" (Brumley, Järvinen, 2008).
@@ -176,6 +413,7 @@ Num3072 Num3072::GetInverse() const
     square_n_mul(out, 3, p[0]);
 
     return out;
+#endif
 }
 
 void Num3072::Multiply(const Num3072& a)
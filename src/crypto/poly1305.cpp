@@ -10,7 +10,158 @@
 namespace poly1305_donna {
 
 // Based on the public domain implementation by Andrew Moon
-// poly1305-donna-32.h from https://github.com/floodyberry/poly1305-donna
+// poly1305-donna-32.h and poly1305-donna-64.h from https://github.com/floodyberry/poly1305-donna
+
+#ifdef __SIZEOF_INT128__
+
+typedef unsigned __int128 uint128_t;
+
+void poly1305_init(poly1305_context *st, const unsigned char key[32]) noexcept {
+    uint64_t t0, t1;
+
+    /* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
+    t0 = ReadLE64(&key[0]);
+    t1 = ReadLE64(&key[8]);
+
+    st->r[0] = ( t0                    ) & 0xffc0fffffff;
+    st->r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+    st->r[2] = ((t1 >> 24)             ) & 0x00ffffffc0f;
+
+    /* h = 0 */
+    st->h[0] = 0;
+    st->h[1] = 0;
+    st->h[2] = 0;
+
+    /* save pad for later */
+    st->pad[0] = ReadLE64(&key[16]);
+    st->pad[1] = ReadLE64(&key[24]);
+
+    st->leftover = 0;
+    st->final = 0;
+}
+
+static void poly1305_blocks(poly1305_context *st, const unsigned char *m, size_t bytes) noexcept {
+    const uint64_t hibit = (st->final) ? 0 : ((uint64_t)1 << 40); /* 1 << 128 */
+    uint64_t r0,r1,r2;
+    uint64_t s1,s2;
+    uint64_t h0,h1,h2;
+    uint64_t c;
+    uint128_t d0,d1,d2;
+
+    r0 = st->r[0];
+    r1 = st->r[1];
+    r2 = st->r[2];
+
+    s1 = r1 * (5 << 2);
+    s2 = r2 * (5 << 2);
+
+    h0 = st->h[0];
+    h1 = st->h[1];
+    h2 = st->h[2];
+
+    while (bytes >= POLY1305_BLOCK_SIZE) {
+        uint64_t t0, t1;
+
+        /* h += m[i] */
+        t0 = ReadLE64(m + 0);
+        t1 = ReadLE64(m + 8);
+
+        h0 += (( t0                    ) & 0xfffffffffff);
+        h1 += (((t0 >> 44) | (t1 << 20)) & 0xfffffffffff);
+        h2 += (((t1 >> 24)             ) & 0x3ffffffffff) | hibit;
+
+        /* h *= r */
+        d0 = ((uint128_t)h0 * r0) + ((uint128_t)h1 * s2) + ((uint128_t)h2 * s1);
+        d1 = ((uint128_t)h0 * r1) + ((uint128_t)h1 * r0) + ((uint128_t)h2 * s2);
+        d2 = ((uint128_t)h0 * r2) + ((uint128_t)h1 * r1) + ((uint128_t)h2 * r0);
+
+        /* (partial) h %= p */
+                      c = (uint64_t)(d0 >> 44); h0 = (uint64_t)d0 & 0xfffffffffff;
+        d1 += c;      c = (uint64_t)(d1 >> 44); h1 = (uint64_t)d1 & 0xfffffffffff;
+        d2 += c;      c = (uint64_t)(d2 >> 42); h2 = (uint64_t)d2 & 0x3ffffffffff;
+        h0 += c * 5;  c =           (h0 >> 44); h0 =           h0 & 0xfffffffffff;
+        h1 += c;
+
+        m += POLY1305_BLOCK_SIZE;
+        bytes -= POLY1305_BLOCK_SIZE;
+    }
+
+    st->h[0] = h0;
+    st->h[1] = h1;
+    st->h[2] = h2;
+}
+
+void poly1305_finish(poly1305_context *st, unsigned char mac[16]) noexcept {
+    uint64_t h0,h1,h2,c;
+    uint64_t g0,g1,g2;
+    uint64_t t0,t1;
+
+    /* process the remaining block */
+    if (st->leftover) {
+        size_t i = st->leftover;
+        st->buffer[i++] = 1;
+        for (; i < POLY1305_BLOCK_SIZE; i++) {
+            st->buffer[i] = 0;
+        }
+        st->final = 1;
+        poly1305_blocks(st, st->buffer, POLY1305_BLOCK_SIZE);
+    }
+
+    /* fully carry h */
+    h0 = st->h[0];
+    h1 = st->h[1];
+    h2 = st->h[2];
+
+                 c = (h1 >> 44); h1 &= 0xfffffffffff;
+    h2 += c;     c = (h2 >> 42); h2 &= 0x3ffffffffff;
+    h0 += c * 5; c = (h0 >> 44); h0 &= 0xfffffffffff;
+    h1 += c;     c = (h1 >> 44); h1 &= 0xfffffffffff;
+    h2 += c;     c = (h2 >> 42); h2 &= 0x3ffffffffff;
+    h0 += c * 5; c = (h0 >> 44); h0 &= 0xfffffffffff;
+    h1 += c;
+
+    /* compute h + -p */
+    g0 = h0 + 5; c = (g0 >> 44); g0 &= 0xfffffffffff;
+    g1 = h1 + c; c = (g1 >> 44); g1 &= 0xfffffffffff;
+    g2 = h2 + c - ((uint64_t)1 << 42);
+
+    /* select h if h < p, or h + -p if h >= p */
+    c = (g2 >> ((sizeof(uint64_t) * 8) - 1)) - 1;
+    g0 &= c;
+    g1 &= c;
+    g2 &= c;
+    c = ~c;
+    h0 = (h0 & c) | g0;
+    h1 = (h1 & c) | g1;
+    h2 = (h2 & c) | g2;
+
+    /* h = (h + pad) */
+    t0 = st->pad[0];
+    t1 = st->pad[1];
+
+    h0 += (( t0                    ) & 0xfffffffffff)    ; c = (h0 >> 44); h0 &= 0xfffffffffff;
+    h1 += (((t0 >> 44) | (t1 << 20)) & 0xfffffffffff) + c; c = (h1 >> 44); h1 &= 0xfffffffffff;
+    h2 += (((t1 >> 24)             ) & 0x3ffffffffff) + c;                 h2 &= 0x3ffffffffff;
+
+    /* mac = h % (2^128) */
+    h0 = ((h0      ) | (h1 << 44));
+    h1 = ((h1 >> 20) | (h2 << 24));
+
+    WriteLE64(mac + 0, h0);
+    WriteLE64(mac + 8, h1);
+
+    /* zero out the state */
+    st->h[0] = 0;
+    st->h[1] = 0;
+    st->h[2] = 0;
+    st->r[0] = 0;
+    st->r[1] = 0;
+    st->r[2] = 0;
+    st->pad[0] = 0;
+    st->pad[1] = 0;
+}
+
+#else
 
 void poly1305_init(poly1305_context *st, const unsigned char key[32]) noexcept {
     /* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
@@ -183,6 +334,8 @@ void poly1305_finish(poly1305_context *st, unsigned char mac[16]) noexcept {
     st->pad[3] = 0;
 }
 
+#endif
+
 void poly1305_update(poly1305_context *st, const unsigned char *m, size_t bytes) noexcept {
     size_t i;
 
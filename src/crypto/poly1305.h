@@ -16,8 +16,20 @@
 namespace poly1305_donna {
 
 // Based on the public domain implementation by Andrew Moon
-// poly1305-donna-32.h from https://github.com/floodyberry/poly1305-donna
+// poly1305-donna-32.h and poly1305-donna-64.h from https://github.com/floodyberry/poly1305-donna
 
+#ifdef __SIZEOF_INT128__
+/** State with three 44/44/42-bit limbs, multiplied using 64x64->128 bit products. */
+typedef struct {
+    uint64_t r[3];
+    uint64_t h[3];
+    uint64_t pad[2];
+    size_t leftover;
+    unsigned char buffer[POLY1305_BLOCK_SIZE];
+    unsigned char final;
+} poly1305_context;
+#else
+/** State with five 26-bit limbs, multiplied using 32x32->64 bit products. */
 typedef struct {
     uint32_t r[5];
     uint32_t h[5];
@@ -26,6 +38,7 @@ typedef struct {
     unsigned char buffer[POLY1305_BLOCK_SIZE];
     unsigned char final;
 } poly1305_context;
+#endif
 
 void poly1305_init(poly1305_context *st, const unsigned char key[32]) noexcept;
 void poly1305_update(poly1305_context *st, const unsigned char *m, size_t bytes) noexcept;
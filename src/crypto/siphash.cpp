@@ -4,6 +4,11 @@
 
 #include <crypto/siphash.h>
 
+#include <crypto/common.h>
+
+#include <algorithm>
+#include <cassert>
+
 #define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
 
 #define SIPROUND do { \
@@ -172,3 +177,169 @@ uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint3
     SIPROUND;
     return v0 ^ v1 ^ v2 ^ v3;
 }
+
+namespace {
+
+/** The last word of a byte string: its trailing bytes and its length, in the top byte. */
+uint64_t SipHashFinalWord(Span<const unsigned char> data)
+{
+    const size_t tail{data.size() & 7};
+    uint64_t t{uint64_t{data.size()} << 56};
+    for (size_t i = 0; i < tail; ++i) {
+        t |= uint64_t{data[data.size() - tail + i]} << (8 * i);
+    }
+    return t;
+}
+
+/** Absorb the words of data from `pos` on, then finalize. */
+uint64_t SipHashFinish(uint64_t v0, uint64_t v1, uint64_t v2, uint64_t v3, Span<const unsigned char> data, size_t pos)
+{
+    for (; pos + 8 <= data.size(); pos += 8) {
+        const uint64_t d{ReadLE64(data.data() + pos)};
+        v3 ^= d;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= d;
+    }
+    const uint64_t t{SipHashFinalWord(data)};
+    v3 ^= t;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= t;
+    v2 ^= 0xFF;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+} // namespace
+
+uint64_t SipHash(uint64_t k0, uint64_t k1, Span<const unsigned char> data)
+{
+    return SipHashFinish(0x736f6d6570736575ULL ^ k0, 0x646f72616e646f6dULL ^ k1,
+                         0x6c7967656e657261ULL ^ k0, 0x7465646279746573ULL ^ k1, data, 0);
+}
+
+namespace {
+
+/** Two interleaved SipRounds, on states (v0..v3) and (w0..w3). */
+#define SIPROUND_X2 do { \
+    v0 += v1; w0 += w1; v1 = ROTL(v1, 13); w1 = ROTL(w1, 13); v1 ^= v0; w1 ^= w0; \
+    v0 = ROTL(v0, 32); w0 = ROTL(w0, 32); \
+    v2 += v3; w2 += w3; v3 = ROTL(v3, 16); w3 = ROTL(w3, 16); v3 ^= v2; w3 ^= w2; \
+    v0 += v3; w0 += w3; v3 = ROTL(v3, 21); w3 = ROTL(w3, 21); v3 ^= v0; w3 ^= w0; \
+    v2 += v1; w2 += w1; v1 = ROTL(v1, 17); w1 = ROTL(w1, 17); v1 ^= v2; w1 ^= w2; \
+    v2 = ROTL(v2, 32); w2 = ROTL(w2, 32); \
+} while (0)
+
+/** Compute SipHashUint256 of two values at once. The two states are
+ *  independent, so their rounds can execute in parallel. */
+void SipHashUint256X2(uint64_t k0, uint64_t k1, const uint256& a, const uint256& b, uint64_t& out_a, uint64_t& out_b)
+{
+    uint64_t d = a.GetUint64(0);
+    uint64_t e = b.GetUint64(0);
+
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0, w0 = v0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1, w1 = v1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0, w2 = v2;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1, w3 = v3;
+    v3 ^= d;
+    w3 ^= e;
+
+    SIPROUND_X2;
+    SIPROUND_X2;
+    v0 ^= d;
+    w0 ^= e;
+    d = a.GetUint64(1);
+    e = b.GetUint64(1);
+    v3 ^= d;
+    w3 ^= e;
+    SIPROUND_X2;
+    SIPROUND_X2;
+    v0 ^= d;
+    w0 ^= e;
+    d = a.GetUint64(2);
+    e = b.GetUint64(2);
+    v3 ^= d;
+    w3 ^= e;
+    SIPROUND_X2;
+    SIPROUND_X2;
+    v0 ^= d;
+    w0 ^= e;
+    d = a.GetUint64(3);
+    e = b.GetUint64(3);
+    v3 ^= d;
+    w3 ^= e;
+    SIPROUND_X2;
+    SIPROUND_X2;
+    v0 ^= d;
+    w0 ^= e;
+    v3 ^= (uint64_t{4}) << 59;
+    w3 ^= (uint64_t{4}) << 59;
+    SIPROUND_X2;
+    SIPROUND_X2;
+    v0 ^= (uint64_t{4}) << 59;
+    w0 ^= (uint64_t{4}) << 59;
+    v2 ^= 0xFF;
+    w2 ^= 0xFF;
+    SIPROUND_X2;
+    SIPROUND_X2;
+    SIPROUND_X2;
+    SIPROUND_X2;
+    out_a = v0 ^ v1 ^ v2 ^ v3;
+    out_b = w0 ^ w1 ^ w2 ^ w3;
+}
+
+/** Compute SipHash of two byte strings at once. The words both strings have
+ *  are absorbed in interleaved rounds, the rest of the longer one on its own. */
+void SipHashX2(uint64_t k0, uint64_t k1, Span<const unsigned char> a, Span<const unsigned char> b, uint64_t& out_a, uint64_t& out_b)
+{
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0, w0 = v0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1, w1 = v1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0, w2 = v2;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1, w3 = v3;
+
+    const size_t common{std::min(a.size(), b.size()) & ~size_t{7}};
+    for (size_t pos = 0; pos < common; pos += 8) {
+        const uint64_t d{ReadLE64(a.data() + pos)};
+        const uint64_t e{ReadLE64(b.data() + pos)};
+        v3 ^= d;
+        w3 ^= e;
+        SIPROUND_X2;
+        SIPROUND_X2;
+        v0 ^= d;
+        w0 ^= e;
+    }
+    out_a = SipHashFinish(v0, v1, v2, v3, a, common);
+    out_b = SipHashFinish(w0, w1, w2, w3, b, common);
+}
+
+#undef SIPROUND_X2
+
+} // namespace
+
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, Span<const uint256* const> vals, Span<uint64_t> out)
+{
+    assert(out.size() >= vals.size());
+    size_t pos = 0;
+    for (; pos + 2 <= vals.size(); pos += 2) {
+        SipHashUint256X2(k0, k1, *vals[pos], *vals[pos + 1], out[pos], out[pos + 1]);
+    }
+    if (pos < vals.size()) {
+        out[pos] = SipHashUint256(k0, k1, *vals[pos]);
+    }
+}
+
+void SipHashBatch(uint64_t k0, uint64_t k1, Span<const Span<const unsigned char>> vals, Span<uint64_t> out)
+{
+    assert(out.size() >= vals.size());
+    size_t pos = 0;
+    for (; pos + 2 <= vals.size(); pos += 2) {
+        SipHashX2(k0, k1, vals[pos], vals[pos + 1], out[pos], out[pos + 1]);
+    }
+    if (pos < vals.size()) {
+        out[pos] = SipHash(k0, k1, vals[pos]);
+    }
+}
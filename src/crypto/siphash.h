@@ -45,4 +45,26 @@ public:
 uint64_t SipHashUint256(uint64_t k0, uint64_t k1, const uint256& val);
 uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint32_t extra);
 
+/** SipHash-2-4 of a byte string, read a word at a time.
+ *
+ *  It is identical to CSipHasher(k0, k1).Write(data).Finalize().
+ */
+uint64_t SipHash(uint64_t k0, uint64_t k1, Span<const unsigned char> data);
+
+/** Batched SipHashUint256: out[i] = SipHashUint256(k0, k1, *vals[i]).
+ *
+ *  Several hashes are computed in interleaved lanes, so that the independent
+ *  rounds can be pipelined (or vectorized) by the CPU. out must be at least as
+ *  large as vals.
+ */
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, Span<const uint256* const> vals, Span<uint64_t> out);
+
+/** Batched SipHash: out[i] = SipHash(k0, k1, vals[i]).
+ *
+ *  As SipHashUint256Batch, for byte strings of any length. Two strings are
+ *  hashed in interleaved lanes while both have words left. out must be at
+ *  least as large as vals.
+ */
+void SipHashBatch(uint64_t k0, uint64_t k1, Span<const Span<const unsigned char>> vals, Span<uint64_t> out);
+
 #endif // SUPERAXECOIN_CRYPTO_SIPHASH_H
@@ -0,0 +1,304 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <common/args.h>
+#include <compressor.h>
+#include <crypto/sha256.h>
+#include <logging.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <undo.h>
+#include <validation.h>
+
+static constexpr uint8_t DB_ADDRESS{'a'};
+static constexpr uint8_t DB_BLOCK_HEIGHT{'b'};
+
+namespace {
+
+enum class RowKind : uint8_t {
+    FUNDING = 0,
+    SPEND = 1,
+};
+
+/**
+ * Key of an output paying to a script, or of the input spending it. Rows of
+ * the same script sort by funding height, then by outpoint, and the spend row
+ * of an output directly follows its funding row.
+ */
+struct DBAddressKey {
+    uint256 script_hash;
+    int height{0};
+    uint256 txid;
+    uint32_t vout{0};
+    RowKind kind{RowKind::FUNDING};
+
+    DBAddressKey() = default;
+    DBAddressKey(const uint256& script_hash_in, int height_in, const uint256& txid_in, uint32_t vout_in, RowKind kind_in)
+        : script_hash(script_hash_in), height(height_in), txid(txid_in), vout(vout_in), kind(kind_in) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS);
+        s << script_hash;
+        ser_writedata32be(s, height);
+        s << txid;
+        ser_writedata32be(s, vout);
+        ser_writedata8(s, static_cast<uint8_t>(kind));
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_ADDRESS) {
+            throw std::ios_base::failure("Invalid format for addressindex DB address key");
+        }
+        s >> script_hash;
+        height = ser_readdata32be(s);
+        s >> txid;
+        vout = ser_readdata32be(s);
+        kind = static_cast<RowKind>(ser_readdata8(s));
+    }
+};
+
+/** Smallest key of a script, for seeking to the start of its history. */
+struct DBAddressPrefix {
+    uint256 script_hash;
+
+    explicit DBAddressPrefix(const uint256& script_hash_in) : script_hash(script_hash_in) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS);
+        s << script_hash;
+    }
+};
+
+struct DBFundingValue {
+    CAmount amount;
+
+    SERIALIZE_METHODS(DBFundingValue, obj) { READWRITE(Using<AmountCompression>(obj.amount)); }
+};
+
+struct DBSpendValue {
+    uint256 txid;
+    uint32_t vin;
+    int height;
+
+    SERIALIZE_METHODS(DBSpendValue, obj) { READWRITE(obj.txid, VARINT(obj.vin), VARINT_MODE(obj.height, VarIntMode::NONNEGATIVE_SIGNED)); }
+};
+
+struct DBHeightKey {
+    int height;
+
+    explicit DBHeightKey(int height_in) : height(height_in) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_BLOCK_HEIGHT);
+        ser_writedata32be(s, height);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_BLOCK_HEIGHT) {
+            throw std::ios_base::failure("Invalid format for addressindex DB height key");
+        }
+        height = ser_readdata32be(s);
+    }
+};
+
+/**
+ * Call `funding` for every spendable output created by the block and `spend`
+ * for every input, with the key of its row. Only the block and its undo data
+ * are used, so the rows of different blocks can be derived independently.
+ */
+template <typename FundingFn, typename SpendFn>
+void ForEachRow(const CBlock& block, const CBlockUndo& block_undo, int height, FundingFn&& funding, SpendFn&& spend)
+{
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx{*block.vtx[i]};
+        const uint256& txid{tx.GetHash()};
+
+        for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+            const CTxOut& out{tx.vout[j]};
+            if (out.scriptPubKey.IsUnspendable()) continue;
+            funding(DBAddressKey{AddressIndex::ScriptHash(out.scriptPubKey), height, txid, j, RowKind::FUNDING},
+                    DBFundingValue{out.nValue});
+        }
+
+        // The coinbase tx has no undo data since no former output is spent
+        if (tx.IsCoinBase()) continue;
+        const CTxUndo& tx_undo{block_undo.vtxundo.at(i - 1)};
+        for (uint32_t j = 0; j < tx.vin.size(); ++j) {
+            const COutPoint& prevout{tx.vin[j].prevout};
+            const Coin& coin{tx_undo.vprevout.at(j)};
+            spend(DBAddressKey{AddressIndex::ScriptHash(coin.out.scriptPubKey), static_cast<int>(coin.nHeight), prevout.hash, prevout.n, RowKind::SPEND},
+                  DBSpendValue{txid, j, height});
+        }
+    }
+}
+
+/** Rows of a block, derived ahead of writing them. */
+struct PreparedRows : BaseIndex::PreparedBlock {
+    std::vector<std::pair<DBAddressKey, DBFundingValue>> funding;
+    std::vector<std::pair<DBAddressKey, DBSpendValue>> spends;
+};
+
+} // namespace
+
+std::unique_ptr<AddressIndex> g_address_index;
+
+AddressIndex::AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "addressindex")
+{
+    fs::path path{gArgs.GetDataDirNet() / "indexes" / "address"};
+    fs::create_directories(path);
+
+    m_db = std::make_unique<BaseIndex::DB>(path / "db", n_cache_size, f_memory, f_wipe);
+}
+
+uint256 AddressIndex::ScriptHash(const CScript& script)
+{
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+
+bool AddressIndex::CustomInit(const std::optional<interfaces::BlockKey>& block)
+{
+    // Blocks connected after the best block was last committed may have been
+    // written, and may no longer be part of the chain. Remove their rows, the
+    // sync thread writes them again if they are.
+    const int start_height{block ? block->height + 1 : 0};
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    CDBBatch batch(*m_db);
+    DBHeightKey key{start_height};
+    for (db_it->Seek(key); db_it->Valid() && db_it->GetKey(key); db_it->Next()) {
+        uint256 block_hash;
+        if (!db_it->GetValue(block_hash)) {
+            return error("%s: unable to read value in %s at key (%c, %d)",
+                         __func__, GetName(), DB_BLOCK_HEIGHT, key.height);
+        }
+        if (!EraseBlock(batch, block_hash, key.height)) return false;
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    std::unique_ptr<PreparedBlock> prepared;
+    if (!CustomPrepare(block, prepared)) return false;
+    CDBBatch batch(*m_db);
+    return CustomAppendPrepared(batch, block, *prepared) && m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const
+{
+    auto rows{std::make_unique<PreparedRows>()};
+
+    // Ignore genesis block, its coinbase output cannot be spent
+    if (block.height > 0) {
+        // pindex variable gives indexing code access to node internals. It
+        // will be removed in upcoming commit
+        const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+        CBlockUndo block_undo;
+        if (!m_chainstate->m_blockman.UndoReadFromDisk(block_undo, *pindex)) {
+            return false;
+        }
+
+        ForEachRow(*Assert(block.data), block_undo, block.height,
+            [&](const DBAddressKey& key, const DBFundingValue& value) { rows->funding.emplace_back(key, value); },
+            [&](const DBAddressKey& key, const DBSpendValue& value) { rows->spends.emplace_back(key, value); });
+    }
+    prepared = std::move(rows);
+    return true;
+}
+
+bool AddressIndex::CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared)
+{
+    if (block.height == 0) return true;
+
+    const PreparedRows& rows{static_cast<PreparedRows&>(prepared)};
+    for (const auto& [key, value] : rows.funding) batch.Write(key, value);
+    for (const auto& [key, value] : rows.spends) batch.Write(key, value);
+    batch.Write(DBHeightKey(block.height), block.hash);
+    return true;
+}
+
+bool AddressIndex::EraseBlock(CDBBatch& batch, const uint256& block_hash, int height)
+{
+    LOCK(cs_main);
+    const CBlockIndex* pindex{m_chainstate->m_blockman.LookupBlockIndex(block_hash)};
+    if (!pindex) {
+        return error("%s: block %s not found", __func__, block_hash.ToString());
+    }
+
+    CBlock block;
+    CBlockUndo block_undo;
+    if (!m_chainstate->m_blockman.ReadBlockFromDisk(block, *pindex) ||
+        !m_chainstate->m_blockman.UndoReadFromDisk(block_undo, *pindex)) {
+        return error("%s: Failed to read block %s from disk", __func__, block_hash.ToString());
+    }
+
+    ForEachRow(block, block_undo, height,
+        [&](const DBAddressKey& key, const DBFundingValue&) { batch.Erase(key); },
+        [&](const DBAddressKey& key, const DBSpendValue&) { batch.Erase(key); });
+    batch.Erase(DBHeightKey(height));
+    return true;
+}
+
+bool AddressIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
+{
+    CDBBatch batch(*m_db);
+    {
+        LOCK(cs_main);
+        const CBlockIndex* iter_tip{m_chainstate->m_blockman.LookupBlockIndex(current_tip.hash)};
+        const CBlockIndex* new_tip_index{m_chainstate->m_blockman.LookupBlockIndex(new_tip.hash)};
+
+        for (; iter_tip != new_tip_index; iter_tip = iter_tip->pprev) {
+            if (!EraseBlock(batch, iter_tip->GetBlockHash(), iter_tip->nHeight)) {
+                return false; // failure cause logged internally
+            }
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::FindHistory(const uint256& script_hash, size_t skip, size_t count, std::vector<AddressHistoryEntry>& entries) const
+{
+    entries.clear();
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    DBAddressKey key;
+    size_t seen{0};
+    for (db_it->Seek(DBAddressPrefix{script_hash}); db_it->Valid(); db_it->Next()) {
+        if (!db_it->GetKey(key) || key.script_hash != script_hash) break;
+
+        if (key.kind == RowKind::FUNDING) {
+            if (seen++ < skip) continue;
+            if (entries.size() == count) break;
+            DBFundingValue value;
+            if (!db_it->GetValue(value)) {
+                return error("%s: unable to read funding row of %s:%u", __func__, key.txid.ToString(), key.vout);
+            }
+            entries.push_back({key.height, key.txid, key.vout, value.amount, std::nullopt});
+        } else if (!entries.empty() && entries.back().txid == key.txid && entries.back().vout == key.vout) {
+            DBSpendValue value;
+            if (!db_it->GetValue(value)) {
+                return error("%s: unable to read spend row of %s:%u", __func__, key.txid.ToString(), key.vout);
+            }
+            entries.back().spent = AddressHistoryEntry::Spend{value.txid, value.vin, value.height};
+        }
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SUPERAXECOIN_INDEX_ADDRESSINDEX_H
+#define SUPERAXECOIN_INDEX_ADDRESSINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class CScript;
+
+static constexpr bool DEFAULT_ADDRESSINDEX{false};
+
+/** An output paying to a script, as recorded in the address index. */
+struct AddressHistoryEntry {
+    int height;
+    uint256 txid;
+    uint32_t vout;
+    CAmount amount;
+
+    /** The input that spent the output, if it was spent. */
+    struct Spend {
+        uint256 txid;
+        uint32_t vin;
+        int height;
+    };
+    std::optional<Spend> spent;
+};
+
+/**
+ * AddressIndex lists, for each scriptPubKey, the outputs paying to it and the
+ * inputs spending them. Scripts are identified by their SHA256 hash, as in
+ * the Electrum protocol.
+ *
+ * Connecting a block only writes rows, it never reads the database: the
+ * spending input of an output is recorded in a row of its own, next to the
+ * output's, and both keys can be derived from the block and its undo data.
+ */
+class AddressIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+    /** Remove the rows of the block at `height`, given its hash. */
+    [[nodiscard]] bool EraseBlock(CDBBatch& batch, const uint256& block_hash, int height);
+
+protected:
+    bool CustomInit(const std::optional<interfaces::BlockKey>& block) override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const override;
+
+    bool CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared) override;
+
+    bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Hash identifying a script in the index.
+    static uint256 ScriptHash(const CScript& script);
+
+    /// Look up the outputs paying to a script, oldest first.
+    ///
+    /// @param[in]   script_hash  ScriptHash() of the script.
+    /// @param[in]   skip  The number of outputs to skip.
+    /// @param[in]   count  The maximum number of outputs to return.
+    /// @param[out]  entries  The outputs found.
+    /// @return  false on a database error, true otherwise
+    bool FindHistory(const uint256& script_hash, size_t skip, size_t count, std::vector<AddressHistoryEntry>& entries) const;
+};
+
+/// The global address index, used by the getaddresshistory RPC and REST interface. May be null.
+extern std::unique_ptr<AddressIndex> g_address_index;
+
+#endif // SUPERAXECOIN_INDEX_ADDRESSINDEX_H
@@ -4,6 +4,7 @@
 
 #include <chainparams.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <index/base.h>
 #include <interfaces/chain.h>
 #include <kernel/chain.h>
@@ -14,19 +15,29 @@
 #include <node/database_args.h>
 #include <node/interface_ui.h>
 #include <shutdown.h>
+#include <sync.h>
 #include <tinyformat.h>
+#include <txdb.h>
 #include <util/thread.h>
+#include <util/time.h>
 #include <util/translation.h>
 #include <validation.h> // For g_chainman
 #include <warnings.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
+//! Number of blocks each sync worker thread reads ahead of the block being appended
+constexpr size_t SYNC_READ_AHEAD_PER_THREAD{4};
 
 template <typename... Args>
 void BaseIndex::FatalErrorf(const char* fmt, const Args&... args)
@@ -126,6 +137,103 @@ bool BaseIndex::Init()
     return true;
 }
 
+/**
+ * Blocks of the active chain are read from disk and passed to CustomPrepare by
+ * a pool of worker threads, ahead of the sync thread which appends them in
+ * chain order. Get() returns the block the sync thread asks for, and schedules
+ * the blocks following it. If the sync thread asks for a block other than the
+ * next one read ahead, the chain was reorganized and the blocks read ahead are
+ * dropped.
+ */
+class BaseIndex::SyncPipeline
+{
+public:
+    struct Entry {
+        const CBlockIndex* index;
+        CBlock block;
+        std::unique_ptr<PreparedBlock> prepared;
+        bool ok{false};
+        bool done{false}; //!< Set by the worker once it is done with the entry, guarded by m_mutex
+    };
+
+private:
+    BaseIndex& m_index;
+    const size_t m_read_ahead;
+    Mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::deque<std::shared_ptr<Entry>> m_queue GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    //! Entries scheduled by the sync thread, in chain order
+    std::deque<std::shared_ptr<Entry>> m_ahead;
+    std::vector<std::thread> m_workers;
+
+    void Schedule(const CBlockIndex* index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        auto entry{std::make_shared<Entry>()};
+        entry->index = index;
+        m_ahead.push_back(entry);
+        WITH_LOCK(m_mutex, m_queue.push_back(std::move(entry)));
+        m_work_cv.notify_one();
+    }
+
+    void Work() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            std::shared_ptr<Entry> entry;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queue.empty(); });
+                if (m_stop) return;
+                entry = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            entry->ok = m_index.m_chainstate->m_blockman.ReadBlockFromDisk(entry->block, *entry->index) &&
+                        m_index.CustomPrepare(kernel::MakeBlockInfo(entry->index, &entry->block), entry->prepared);
+            WITH_LOCK(m_mutex, entry->done = true);
+            m_done_cv.notify_all();
+        }
+    }
+
+public:
+    SyncPipeline(BaseIndex& index, int threads) : m_index{index}, m_read_ahead{threads * SYNC_READ_AHEAD_PER_THREAD}
+    {
+        for (int i = 0; i < threads; ++i) {
+            m_workers.emplace_back(&util::TraceThread, strprintf("%s.%d", m_index.GetName(), i), [this] { Work(); });
+        }
+    }
+
+    ~SyncPipeline()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_work_cv.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+    }
+
+    std::shared_ptr<Entry> Get(const CBlockIndex* index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        if (!m_ahead.empty() && m_ahead.front()->index != index) {
+            m_ahead.clear();
+            WITH_LOCK(m_mutex, m_queue.clear());
+        }
+        if (m_ahead.empty()) Schedule(index);
+        {
+            LOCK(cs_main);
+            while (m_ahead.size() <= m_read_ahead) {
+                const CBlockIndex* next{m_index.m_chainstate->m_chain.Next(m_ahead.back()->index)};
+                if (!next) break;
+                Schedule(next);
+            }
+        }
+
+        std::shared_ptr<Entry> entry{std::move(m_ahead.front())};
+        m_ahead.pop_front();
+        WAIT_LOCK(m_mutex, lock);
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return entry->done; });
+        return entry;
+    }
+};
+
 static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev, CChain& chain) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     AssertLockHeld(cs_main);
@@ -148,10 +256,32 @@ void BaseIndex::ThreadSync()
     if (!m_synced) {
         std::chrono::steady_clock::time_point last_log_time{0s};
         std::chrono::steady_clock::time_point last_locator_write_time{0s};
+        const auto sync_start_time{std::chrono::steady_clock::now()};
+        const int sync_start_height{pindex ? pindex->nHeight : -1};
+
+        int threads{static_cast<int>(gArgs.GetIntArg("-indexsyncthreads", DEFAULT_INDEX_SYNC_THREADS))};
+        if (threads <= 0) threads += GetNumCores();
+        SyncPipeline pipeline{*this, std::clamp(threads, 1, MAX_INDEX_SYNC_THREADS)};
+
+        // Entries of prepared blocks are written in large batches. The batch is
+        // written before anything else reads or writes the database.
+        const size_t batch_size{static_cast<size_t>(gArgs.GetIntArg("-dbbatchsize", nDefaultDbBatchSize))};
+        CDBBatch batch(GetDB());
+        auto write_batch = [&] {
+            if (batch.SizeEstimate() == 0) return true;
+            const bool ok{GetDB().WriteBatch(batch)};
+            batch.Clear();
+            return ok;
+        };
+
         while (true) {
             if (m_interrupt) {
                 LogPrintf("%s: m_interrupt set; exiting ThreadSync\n", GetName());
 
+                if (!write_batch()) {
+                    FatalErrorf("%s: Failed to write to index database", __func__);
+                    return;
+                }
                 SetBestBlockIndex(pindex);
                 // No need to handle errors in Commit. If it fails, the error will be already be
                 // logged. The best way to recover is to continue, as index cannot be corrupted by
@@ -163,11 +293,21 @@ void BaseIndex::ThreadSync()
             {
                 LOCK(cs_main);
                 const CBlockIndex* pindex_next = NextSyncBlock(pindex, m_chainstate->m_chain);
+                if (!pindex_next || pindex_next->pprev != pindex) {
+                    if (!write_batch()) {
+                        FatalErrorf("%s: Failed to write to index database", __func__);
+                        return;
+                    }
+                }
                 if (!pindex_next) {
                     SetBestBlockIndex(pindex);
                     m_synced = true;
                     // No need to handle errors in Commit. See rationale above.
                     Commit();
+                    const auto sync_time{std::chrono::steady_clock::now() - sync_start_time};
+                    const int blocks{(pindex ? pindex->nHeight : -1) - sync_start_height};
+                    LogPrintf("%s: synced %d blocks in %.3fs (%.1f blocks/s)\n", GetName(), blocks,
+                              Ticks<SecondsDouble>(sync_time), blocks / std::max(Ticks<SecondsDouble>(sync_time), 1e-3));
                     break;
                 }
                 if (pindex_next->pprev != pindex && !Rewind(pindex, pindex_next->pprev)) {
@@ -186,26 +326,32 @@ void BaseIndex::ThreadSync()
             }
 
             if (last_locator_write_time + SYNC_LOCATOR_WRITE_INTERVAL < current_time) {
+                if (!write_batch()) {
+                    FatalErrorf("%s: Failed to write to index database", __func__);
+                    return;
+                }
                 SetBestBlockIndex(pindex->pprev);
                 last_locator_write_time = current_time;
                 // No need to handle errors in Commit. See rationale above.
                 Commit();
             }
 
-            CBlock block;
-            interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex);
-            if (!m_chainstate->m_blockman.ReadBlockFromDisk(block, *pindex)) {
-                FatalErrorf("%s: Failed to read block %s from disk",
+            const auto entry{pipeline.Get(pindex)};
+            if (!entry->ok) {
+                FatalErrorf("%s: Failed to read block %s from disk or to prepare it for the index",
                            __func__, pindex->GetBlockHash().ToString());
                 return;
-            } else {
-                block_info.data = &block;
             }
-            if (!CustomAppend(block_info)) {
+            const interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, &entry->block);
+            if (entry->prepared ? !CustomAppendPrepared(batch, block_info, *entry->prepared) : !CustomAppend(block_info)) {
                 FatalErrorf("%s: Failed to write block %s to index database",
                            __func__, pindex->GetBlockHash().ToString());
                 return;
             }
+            if (batch.SizeEstimate() > batch_size && !write_batch()) {
+                FatalErrorf("%s: Failed to write to index database", __func__);
+                return;
+            }
         }
     }
 
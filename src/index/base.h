@@ -10,6 +10,7 @@
 #include <util/threadinterrupt.h>
 #include <validationinterface.h>
 
+#include <memory>
 #include <string>
 
 class CBlock;
@@ -20,6 +21,11 @@ namespace interfaces {
 class Chain;
 } // namespace interfaces
 
+/** Number of threads reading and preparing blocks during the initial sync of an index (0 = auto) */
+static constexpr int DEFAULT_INDEX_SYNC_THREADS{0};
+/** Maximum number of threads reading and preparing blocks during the initial sync of an index */
+static constexpr int MAX_INDEX_SYNC_THREADS{16};
+
 struct IndexSummary {
     std::string name;
     bool synced{false};
@@ -39,6 +45,12 @@ struct IndexSummary {
  */
 class BaseIndex : public CValidationInterface
 {
+public:
+    /// Index data of a block, computed by CustomPrepare.
+    struct PreparedBlock {
+        virtual ~PreparedBlock() = default;
+    };
+
 protected:
     /**
      * The database stores a block locator of the chain the database is synced to
@@ -61,6 +73,9 @@ protected:
     };
 
 private:
+    /// Reads blocks ahead of the initial sync and prepares them on worker threads.
+    class SyncPipeline;
+
     /// Whether the index has been initialized or not.
     std::atomic<bool> m_init{false};
     /// Whether the index is in sync with the main chain. The flag is flipped
@@ -118,6 +133,16 @@ protected:
     /// Write update index entries for a newly connected block.
     [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
 
+    /// Compute the index entries of a block during the initial sync. This is
+    /// called from several threads and ahead of the blocks before it, so it may
+    /// only depend on the block itself. Leaving `prepared` null makes the sync
+    /// call CustomAppend for the block instead of CustomAppendPrepared.
+    [[nodiscard]] virtual bool CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const { return true; }
+
+    /// Write the entries computed by CustomPrepare for a block, in chain order.
+    /// The batch is written once it is large, or before the index is committed.
+    [[nodiscard]] virtual bool CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared) { return false; }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CustomCommit(CDBBatch& batch) { return true; }
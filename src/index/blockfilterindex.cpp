@@ -54,6 +54,14 @@ struct DBVal {
     SERIALIZE_METHODS(DBVal, obj) { READWRITE(obj.hash, obj.header, obj.pos); }
 };
 
+/** A block filter and its hash, computed ahead of the header chain. */
+struct PreparedFilter : BaseIndex::PreparedBlock {
+    BlockFilter filter;
+    uint256 hash;
+
+    explicit PreparedFilter(BlockFilter&& filter_in) : filter(std::move(filter_in)) {}
+};
+
 struct DBHeightKey {
     int height;
 
@@ -216,9 +224,16 @@ size_t BlockFilterIndex::WriteFilterToDisk(FlatFilePos& pos, const BlockFilter&
 }
 
 bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    std::unique_ptr<PreparedBlock> prepared;
+    if (!CustomPrepare(block, prepared)) return false;
+    CDBBatch batch(*m_db);
+    return CustomAppendPrepared(batch, block, *prepared) && m_db->WriteBatch(batch);
+}
+
+bool BlockFilterIndex::CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const
 {
     CBlockUndo block_undo;
-    uint256 prev_header;
 
     if (block.height > 0) {
         // pindex variable gives indexing code access to node internals. It
@@ -227,37 +242,51 @@ bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
         if (!m_chainstate->m_blockman.UndoReadFromDisk(block_undo, *pindex)) {
             return false;
         }
+    }
 
-        std::pair<uint256, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
-            return false;
-        }
+    auto filter{std::make_unique<PreparedFilter>(BlockFilter(m_filter_type, *Assert(block.data), block_undo))};
+    filter->hash = filter->filter.GetHash();
+    prepared = std::move(filter);
+    return true;
+}
+
+bool BlockFilterIndex::CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared)
+{
+    const PreparedFilter& filter{static_cast<PreparedFilter&>(prepared)};
+    uint256 prev_header;
 
+    if (block.height > 0) {
         uint256 expected_block_hash = *Assert(block.prev_hash);
-        if (read_out.first != expected_block_hash) {
-            return error("%s: previous block header belongs to unexpected block %s; expected %s",
-                         __func__, read_out.first.ToString(), expected_block_hash.ToString());
+        if (m_last_header && m_last_header->first == expected_block_hash) {
+            prev_header = m_last_header->second;
+        } else {
+            std::pair<uint256, DBVal> read_out;
+            if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
+                return false;
+            }
+
+            if (read_out.first != expected_block_hash) {
+                return error("%s: previous block header belongs to unexpected block %s; expected %s",
+                             __func__, read_out.first.ToString(), expected_block_hash.ToString());
+            }
+
+            prev_header = read_out.second.header;
         }
-
-        prev_header = read_out.second.header;
     }
 
-    BlockFilter filter(m_filter_type, *Assert(block.data), block_undo);
-
-    size_t bytes_written = WriteFilterToDisk(m_next_filter_pos, filter);
+    size_t bytes_written = WriteFilterToDisk(m_next_filter_pos, filter.filter);
     if (bytes_written == 0) return false;
 
     std::pair<uint256, DBVal> value;
     value.first = block.hash;
-    value.second.hash = filter.GetHash();
-    value.second.header = filter.ComputeHeader(prev_header);
+    value.second.hash = filter.hash;
+    value.second.header = Hash(filter.hash, prev_header);
     value.second.pos = m_next_filter_pos;
 
-    if (!m_db->Write(DBHeightKey(block.height), value)) {
-        return false;
-    }
+    batch.Write(DBHeightKey(block.height), value);
 
     m_next_filter_pos.nPos += bytes_written;
+    m_last_header.emplace(block.hash, value.second.header);
     return true;
 }
 
@@ -289,6 +318,7 @@ bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
 
 bool BlockFilterIndex::CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip)
 {
+    m_last_header.reset();
     CDBBatch batch(*m_db);
     std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
 
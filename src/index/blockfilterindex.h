@@ -35,6 +35,9 @@ private:
     FlatFilePos m_next_filter_pos;
     std::unique_ptr<FlatFileSeq> m_filter_fileseq;
 
+    /** Hash and filter header of the last appended block, whose entry may not be written to the DB yet. */
+    std::optional<std::pair<uint256, uint256>> m_last_header;
+
     bool ReadFilterFromDisk(const FlatFilePos& pos, const uint256& hash, BlockFilter& filter) const;
     size_t WriteFilterToDisk(FlatFilePos& pos, const BlockFilter& filter);
 
@@ -51,6 +54,10 @@ protected:
 
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
+    bool CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const override;
+
+    bool CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared) override;
+
     bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
 
     BaseIndex::DB& GetDB() const LIFETIMEBOUND override { return *m_db; }
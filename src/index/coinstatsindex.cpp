@@ -114,35 +114,27 @@ CoinStatsIndex::CoinStatsIndex(std::unique_ptr<interfaces::Chain> chain, size_t
 
 bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
 {
-    CBlockUndo block_undo;
+    std::unique_ptr<PreparedBlock> prepared;
+    if (!CustomPrepare(block, prepared)) return false;
+    return AppendBlockStats(block, static_cast<BlockStats&>(*prepared));
+}
+
+bool CoinStatsIndex::CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const
+{
+    auto stats{std::make_unique<BlockStats>()};
     const CAmount block_subsidy{GetBlockSubsidy(block.height, Params().GetConsensus())};
-    m_total_subsidy += block_subsidy;
+    stats->subsidy = block_subsidy;
 
     // Ignore genesis block
     if (block.height > 0) {
         // pindex variable gives indexing code access to node internals. It
         // will be removed in upcoming commit
         const CBlockIndex* pindex = WITH_LOCK(cs_main, return m_chainstate->m_blockman.LookupBlockIndex(block.hash));
+        CBlockUndo block_undo;
         if (!m_chainstate->m_blockman.UndoReadFromDisk(block_undo, *pindex)) {
             return false;
         }
 
-        std::pair<uint256, DBVal> read_out;
-        if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
-            return false;
-        }
-
-        uint256 expected_block_hash{*Assert(block.prev_hash)};
-        if (read_out.first != expected_block_hash) {
-            LogPrintf("WARNING: previous block header belongs to unexpected block %s; expected %s\n",
-                      read_out.first.ToString(), expected_block_hash.ToString());
-
-            if (!m_db->Read(DBHashKey(expected_block_hash), read_out)) {
-                return error("%s: previous block header not found; expected %s",
-                             __func__, expected_block_hash.ToString());
-            }
-        }
-
         // Add the new utxos created from the block
         assert(block.data);
         for (size_t i = 0; i < block.data->vtx.size(); ++i) {
@@ -150,8 +142,8 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
 
             // Skip duplicate txid coinbase transactions (BIP30).
             if (IsBIP30Unspendable(*pindex) && tx->IsCoinBase()) {
-                m_total_unspendable_amount += block_subsidy;
-                m_total_unspendables_bip30 += block_subsidy;
+                stats->unspendable_amount += block_subsidy;
+                stats->unspendables_bip30 += block_subsidy;
                 continue;
             }
 
@@ -162,22 +154,21 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
 
                 // Skip unspendable coins
                 if (coin.out.scriptPubKey.IsUnspendable()) {
-                    m_total_unspendable_amount += coin.out.nValue;
-                    m_total_unspendables_scripts += coin.out.nValue;
+                    stats->unspendable_amount += coin.out.nValue;
+                    stats->unspendables_scripts += coin.out.nValue;
                     continue;
                 }
 
-                ApplyCoinHash(m_muhash, outpoint, coin);
+                ApplyCoinHash(stats->muhash, outpoint, coin);
 
                 if (tx->IsCoinBase()) {
-                    m_total_coinbase_amount += coin.out.nValue;
+                    stats->coinbase_amount += coin.out.nValue;
                 } else {
-                    m_total_new_outputs_ex_coinbase_amount += coin.out.nValue;
+                    stats->new_outputs_ex_coinbase_amount += coin.out.nValue;
                 }
 
-                ++m_transaction_output_count;
-                m_total_amount += coin.out.nValue;
-                m_bogo_size += GetBogoSize(coin.out.scriptPubKey);
+                ++stats->outputs_created;
+                stats->bogo_size_created += GetBogoSize(coin.out.scriptPubKey);
             }
 
             // The coinbase tx has no undo data since no former output is spent
@@ -188,22 +179,66 @@ bool CoinStatsIndex::CustomAppend(const interfaces::BlockInfo& block)
                     Coin coin{tx_undo.vprevout[j]};
                     COutPoint outpoint{tx->vin[j].prevout.hash, tx->vin[j].prevout.n};
 
-                    RemoveCoinHash(m_muhash, outpoint, coin);
+                    RemoveCoinHash(stats->muhash, outpoint, coin);
 
-                    m_total_prevout_spent_amount += coin.out.nValue;
+                    stats->prevout_spent_amount += coin.out.nValue;
 
-                    --m_transaction_output_count;
-                    m_total_amount -= coin.out.nValue;
-                    m_bogo_size -= GetBogoSize(coin.out.scriptPubKey);
+                    ++stats->outputs_spent;
+                    stats->bogo_size_spent += GetBogoSize(coin.out.scriptPubKey);
                 }
             }
         }
     } else {
         // genesis block
-        m_total_unspendable_amount += block_subsidy;
-        m_total_unspendables_genesis_block += block_subsidy;
+        stats->unspendable_amount += block_subsidy;
+        stats->unspendables_genesis_block += block_subsidy;
+    }
+    prepared = std::move(stats);
+    return true;
+}
+
+bool CoinStatsIndex::CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared)
+{
+    // The entry of a block is read back when appending the next one, so it is
+    // written right away rather than to the batch.
+    return AppendBlockStats(block, static_cast<BlockStats&>(prepared));
+}
+
+bool CoinStatsIndex::AppendBlockStats(const interfaces::BlockInfo& block, const BlockStats& stats)
+{
+    if (block.height > 0) {
+        std::pair<uint256, DBVal> read_out;
+        if (!m_db->Read(DBHeightKey(block.height - 1), read_out)) {
+            return false;
+        }
+
+        uint256 expected_block_hash{*Assert(block.prev_hash)};
+        if (read_out.first != expected_block_hash) {
+            LogPrintf("WARNING: previous block header belongs to unexpected block %s; expected %s\n",
+                      read_out.first.ToString(), expected_block_hash.ToString());
+
+            if (!m_db->Read(DBHashKey(expected_block_hash), read_out)) {
+                return error("%s: previous block header not found; expected %s",
+                             __func__, expected_block_hash.ToString());
+            }
+        }
     }
 
+    m_muhash *= stats.muhash;
+    m_transaction_output_count += stats.outputs_created;
+    m_transaction_output_count -= stats.outputs_spent;
+    m_bogo_size += stats.bogo_size_created;
+    m_bogo_size -= stats.bogo_size_spent;
+    m_total_amount += stats.coinbase_amount + stats.new_outputs_ex_coinbase_amount - stats.prevout_spent_amount;
+    m_total_subsidy += stats.subsidy;
+    m_total_unspendable_amount += stats.unspendable_amount;
+    m_total_prevout_spent_amount += stats.prevout_spent_amount;
+    m_total_new_outputs_ex_coinbase_amount += stats.new_outputs_ex_coinbase_amount;
+    m_total_coinbase_amount += stats.coinbase_amount;
+    m_total_unspendables_genesis_block += stats.unspendables_genesis_block;
+    m_total_unspendables_bip30 += stats.unspendables_bip30;
+    m_total_unspendables_scripts += stats.unspendables_scripts;
+
     // If spent prevouts + block subsidy are still a higher amount than
     // new outputs + coinbase + current unspendable amount this means
     // the miner did not claim the full block reward. Unclaimed block
@@ -38,6 +38,26 @@ private:
     CAmount m_total_unspendables_scripts{0};
     CAmount m_total_unspendables_unclaimed_rewards{0};
 
+    /** Changes to the statistics by a block, computed by CustomPrepare. */
+    struct BlockStats : PreparedBlock {
+        MuHash3072 muhash;
+        uint64_t outputs_created{0};
+        uint64_t outputs_spent{0};
+        uint64_t bogo_size_created{0};
+        uint64_t bogo_size_spent{0};
+        CAmount subsidy{0};
+        CAmount unspendable_amount{0};
+        CAmount prevout_spent_amount{0};
+        CAmount new_outputs_ex_coinbase_amount{0};
+        CAmount coinbase_amount{0};
+        CAmount unspendables_genesis_block{0};
+        CAmount unspendables_bip30{0};
+        CAmount unspendables_scripts{0};
+    };
+
+    /** Add the changes by a block to the statistics and write them. */
+    [[nodiscard]] bool AppendBlockStats(const interfaces::BlockInfo& block, const BlockStats& stats);
+
     [[nodiscard]] bool ReverseBlock(const CBlock& block, const CBlockIndex* pindex);
 
     bool AllowPrune() const override { return true; }
@@ -49,6 +69,10 @@ protected:
 
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
+    bool CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const override;
+
+    bool CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared) override;
+
     bool CustomRewind(const interfaces::BlockKey& current_tip, const interfaces::BlockKey& new_tip) override;
 
     BaseIndex::DB& GetDB() const override { return *m_db; }
@@ -26,10 +26,17 @@ public:
     /// transaction hash is not indexed.
     bool ReadTxPos(const uint256& txid, CDiskTxPos& pos) const;
 
-    /// Write a batch of transaction positions to the DB.
-    [[nodiscard]] bool WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
+    /// Add transaction positions to a batch.
+    void WriteTxs(CDBBatch& batch, const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos);
 };
 
+namespace {
+/** Positions of the transactions of a block. */
+struct PreparedTxs : BaseIndex::PreparedBlock {
+    std::vector<std::pair<uint256, CDiskTxPos>> v_pos;
+};
+} // namespace
+
 TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
     BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe)
 {}
@@ -39,13 +46,11 @@ bool TxIndex::DB::ReadTxPos(const uint256 &txid, CDiskTxPos& pos) const
     return Read(std::make_pair(DB_TXINDEX, txid), pos);
 }
 
-bool TxIndex::DB::WriteTxs(const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
+void TxIndex::DB::WriteTxs(CDBBatch& batch, const std::vector<std::pair<uint256, CDiskTxPos>>& v_pos)
 {
-    CDBBatch batch(*this);
     for (const auto& tuple : v_pos) {
         batch.Write(std::make_pair(DB_TXINDEX, tuple.first), tuple.second);
     }
-    return WriteBatch(batch);
 }
 
 TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
@@ -56,18 +61,34 @@ TxIndex::~TxIndex() = default;
 
 bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
 {
+    std::unique_ptr<PreparedBlock> prepared;
+    if (!CustomPrepare(block, prepared)) return false;
+    CDBBatch batch(*m_db);
+    return CustomAppendPrepared(batch, block, *prepared) && m_db->WriteBatch(batch);
+}
+
+bool TxIndex::CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const
+{
+    auto txs{std::make_unique<PreparedTxs>()};
+
     // Exclude genesis block transaction because outputs are not spendable.
-    if (block.height == 0) return true;
-
-    assert(block.data);
-    CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
-    std::vector<std::pair<uint256, CDiskTxPos>> vPos;
-    vPos.reserve(block.data->vtx.size());
-    for (const auto& tx : block.data->vtx) {
-        vPos.emplace_back(tx->GetHash(), pos);
-        pos.nTxOffset += ::GetSerializeSize(*tx, CLIENT_VERSION);
+    if (block.height > 0) {
+        assert(block.data);
+        CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
+        txs->v_pos.reserve(block.data->vtx.size());
+        for (const auto& tx : block.data->vtx) {
+            txs->v_pos.emplace_back(tx->GetHash(), pos);
+            pos.nTxOffset += ::GetSerializeSize(*tx, CLIENT_VERSION);
+        }
     }
-    return m_db->WriteTxs(vPos);
+    prepared = std::move(txs);
+    return true;
+}
+
+bool TxIndex::CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared)
+{
+    m_db->WriteTxs(batch, static_cast<PreparedTxs&>(prepared).v_pos);
+    return true;
 }
 
 BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
@@ -79,19 +100,43 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
         return false;
     }
 
-    CAutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
-    if (file.IsNull()) {
-        return error("%s: OpenBlockFile failed", __func__);
+    uint32_t block_size;
+    bool compressed;
+    if (!m_chainstate->m_blockman.ReadBlockDataSize(postx, block_size, compressed)) {
+        return false;
     }
+
     CBlockHeader header;
-    try {
-        file >> header;
-        if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
-            return error("%s: fseek(...) failed", __func__);
+    if (compressed) {
+        // The block is decompressed as a whole to get to the transaction
+        std::vector<uint8_t> block_data;
+        if (!m_chainstate->m_blockman.ReadRawBlockFromDisk(block_data, postx)) {
+            return error("%s: ReadRawBlockFromDisk failed", __func__);
+        }
+        try {
+            SpanReader reader{CLIENT_VERSION, block_data};
+            reader >> header;
+            if (postx.nTxOffset > reader.size()) {
+                return error("%s: transaction offset out of block", __func__);
+            }
+            SpanReader{CLIENT_VERSION, Span{block_data}.last(reader.size() - postx.nTxOffset)} >> tx;
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize error - %s", __func__, e.what());
+        }
+    } else {
+        CAutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
+        if (file.IsNull()) {
+            return error("%s: OpenBlockFile failed", __func__);
+        }
+        try {
+            file >> header;
+            if (fseek(file.Get(), postx.nTxOffset, SEEK_CUR)) {
+                return error("%s: fseek(...) failed", __func__);
+            }
+            file >> tx;
+        } catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s", __func__, e.what());
         }
-        file >> tx;
-    } catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
     }
     if (tx->GetHash() != tx_hash) {
         return error("%s: txid mismatch", __func__);
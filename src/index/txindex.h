@@ -27,6 +27,10 @@ private:
 protected:
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
+    bool CustomPrepare(const interfaces::BlockInfo& block, std::unique_ptr<PreparedBlock>& prepared) const override;
+
+    bool CustomAppendPrepared(CDBBatch& batch, const interfaces::BlockInfo& block, PreparedBlock& prepared) override;
+
     BaseIndex::DB& GetDB() const override;
 
 public:
@@ -12,6 +12,8 @@
 
 class CChainParams;
 
+static constexpr bool DEFAULT_BLOCK_COMPRESSION{false};
+
 namespace kernel {
 
 /**
@@ -22,6 +24,8 @@ struct BlockManagerOpts {
     const CChainParams& chainparams;
     uint64_t prune_target{0};
     bool fast_prune{false};
+    //! Store newly written blocks compressed
+    bool compress_blocks{DEFAULT_BLOCK_COMPRESSION};
     const fs::path blocks_dir;
     Notifications& notifications;
 };
@@ -21,6 +21,10 @@ class CChainParams;
 
 static constexpr bool DEFAULT_CHECKPOINTS_ENABLED{true};
 static constexpr auto DEFAULT_MAX_TIP_AGE{24h};
+static constexpr int DEFAULT_SNAPSHOT_THREADS{0};
+static constexpr int MAX_SNAPSHOT_THREADS{16};
+static constexpr int DEFAULT_REINDEX_THREADS{0};
+static constexpr int MAX_REINDEX_THREADS{16};
 
 namespace kernel {
 
@@ -44,6 +48,10 @@ struct ChainstateManagerOpts {
     DBOptions block_tree_db{};
     DBOptions coins_db{};
     CoinsViewOptions coins_view{};
+    //! Number of threads encoding or decoding the coins of a UTXO snapshot being dumped or loaded.
+    int snapshot_threads{1};
+    //! Number of threads scanning the block files ahead of their blocks being accepted during -reindex.
+    int reindex_threads{1};
     Notifications& notifications;
 };
 
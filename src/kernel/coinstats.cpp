@@ -17,19 +17,25 @@
 #include <streams.h>
 #include <sync.h>
 #include <tinyformat.h>
+#include <txdb.h>
 #include <uint256.h>
 #include <util/check.h>
 #include <util/overflow.h>
 #include <validation.h>
 #include <version.h>
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <iosfwd>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace kernel {
 
@@ -56,6 +62,11 @@ static void TxOutSer(T& ss, const COutPoint& outpoint, const Coin& coin)
     ss << coin.out;
 }
 
+void SerializeCoinForHash(DataStream& ss, const COutPoint& outpoint, const Coin& coin)
+{
+    TxOutSer(ss, outpoint, coin);
+}
+
 static void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin)
 {
     TxOutSer(ss, outpoint, coin);
@@ -112,20 +123,22 @@ static void ApplyStats(CCoinsStats& stats, const uint256& hash, const std::map<u
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
+//! Calculate statistics about the coins of a cursor, up to the first txid
+//! starting with a byte of `end` or more
 template <typename T>
-static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+static bool ApplyCoins(CCoinsViewCursor& cursor, unsigned int end, CCoinsStats& stats, T& hash_obj, const std::function<void()>& interruption_point)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
     uint256 prevkey;
     std::map<uint32_t, Coin> outputs;
-    while (pcursor->Valid()) {
+    while (cursor.Valid()) {
         if (interruption_point) interruption_point();
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+        if (!cursor.GetKey(key)) {
+            return error("%s: unable to read value", __func__);
+        }
+        if (*key.hash.begin() >= end) break;
+        if (cursor.GetValue(coin)) {
             if (!outputs.empty() && key.hash != prevkey) {
                 ApplyStats(stats, prevkey, outputs);
                 ApplyHash(hash_obj, prevkey, outputs);
@@ -137,12 +150,23 @@ static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, c
         } else {
             return error("%s: unable to read value", __func__);
         }
-        pcursor->Next();
+        cursor.Next();
     }
     if (!outputs.empty()) {
         ApplyStats(stats, prevkey, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+{
+    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+    assert(pcursor);
+
+    if (!ApplyCoins(*pcursor, 0x100, stats, hash_obj, interruption_point)) return false;
 
     FinalizeHash(hash_obj, stats);
 
@@ -151,11 +175,104 @@ static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, c
     return true;
 }
 
-std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point)
+static void CombineHash(MuHash3072& muhash, const MuHash3072& slice_muhash) { muhash *= slice_muhash; }
+static void CombineHash(std::nullptr_t, std::nullptr_t) {}
+
+namespace {
+struct StopComputing {
+};
+} // namespace
+
+//! Calculate statistics about the unspent transaction output set, split in
+//! slices of the txid keyspace computed by threads of their own. Only for
+//! hashes that do not depend on the order of the coins.
+template <typename T>
+static bool ComputeUTXOStats(const CCoinsViewDB& view, node::BlockManager& blockman, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point, int threads)
+{
+    struct Slice {
+        unsigned int end;
+        std::unique_ptr<CCoinsViewCursor> cursor;
+        CCoinsStats stats;
+        T hash_obj{};
+        bool success{false};
+    };
+    std::vector<Slice> slices(threads);
+    {
+        // All cursors are opened at once, so that they see the same UTXO set.
+        LOCK(::cs_main);
+        for (int i = 0; i < threads; ++i) {
+            uint256 start;
+            *start.begin() = 0x100 * i / threads;
+            slices[i].end = 0x100 * (i + 1) / threads;
+            slices[i].cursor = view.Cursor(start);
+        }
+        const CBlockIndex* pindex{Assert(blockman.LookupBlockIndex(slices[0].cursor->GetBestBlock()))};
+        stats = CCoinsStats{pindex->nHeight, pindex->GetBlockHash()};
+    }
+
+    std::atomic<bool> should_stop{false};
+    const std::function<void()> slice_interruption_point{[&] {
+        if (should_stop) throw StopComputing{};
+    }};
+    Mutex done_mutex;
+    std::condition_variable done_cv;
+    int running{threads};
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i] {
+            Slice& slice{slices[i]};
+            try {
+                slice.success = ApplyCoins(*slice.cursor, slice.end, slice.stats, slice.hash_obj, slice_interruption_point);
+            } catch (const StopComputing&) {
+            }
+            WITH_LOCK(done_mutex, --running);
+            done_cv.notify_all();
+        });
+    }
+    while (WITH_LOCK(done_mutex, return running) > 0) {
+        {
+            WAIT_LOCK(done_mutex, lock);
+            done_cv.wait_for(lock, std::chrono::milliseconds{100}, [&]() EXCLUSIVE_LOCKS_REQUIRED(done_mutex) { return running == 0; });
+        }
+        try {
+            if (interruption_point) interruption_point();
+        } catch (...) {
+            should_stop = true;
+            for (std::thread& worker : workers) worker.join();
+            throw;
+        }
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    for (const Slice& slice : slices) {
+        if (!slice.success) return false;
+        stats.nTransactions += slice.stats.nTransactions;
+        stats.nTransactionOutputs += slice.stats.nTransactionOutputs;
+        stats.nBogoSize += slice.stats.nBogoSize;
+        stats.coins_count += slice.stats.coins_count;
+        if (stats.total_amount.has_value() && slice.stats.total_amount.has_value()) {
+            stats.total_amount = CheckedAdd(*stats.total_amount, *slice.stats.total_amount);
+        } else {
+            stats.total_amount = std::nullopt;
+        }
+        CombineHash(hash_obj, slice.hash_obj);
+    }
+
+    FinalizeHash(hash_obj, stats);
+
+    stats.nDiskSize = view.EstimateSize();
+
+    return true;
+}
+
+std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point, int threads)
 {
     CBlockIndex* pindex = WITH_LOCK(::cs_main, return blockman.LookupBlockIndex(view->GetBestBlock()));
     CCoinsStats stats{Assert(pindex)->nHeight, pindex->GetBlockHash()};
 
+    // Only the coins database can be iterated from a given txid on.
+    const auto* db{threads > 1 ? dynamic_cast<const CCoinsViewDB*>(view) : nullptr};
+
     bool success = [&]() -> bool {
         switch (hash_type) {
         case(CoinStatsHashType::HASH_SERIALIZED): {
@@ -164,9 +281,11 @@ std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsV
         }
         case(CoinStatsHashType::MUHASH): {
             MuHash3072 muhash;
+            if (db) return ComputeUTXOStats(*db, blockman, stats, muhash, interruption_point, threads);
             return ComputeUTXOStats(view, stats, muhash, interruption_point);
         }
         case(CoinStatsHashType::NONE): {
+            if (db) return ComputeUTXOStats(*db, blockman, stats, nullptr, interruption_point, threads);
             return ComputeUTXOStats(view, stats, nullptr, interruption_point);
         }
         } // no default case, so the compiler can warn about missing cases
@@ -73,10 +73,15 @@ struct CCoinsStats {
 
 uint64_t GetBogoSize(const CScript& script_pub_key);
 
+//! Serialize a coin as the UTXO set hashes commit to it.
+void SerializeCoinForHash(DataStream& ss, const COutPoint& outpoint, const Coin& coin);
+
 void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 
-std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point = {});
+//! Calculate statistics about the unspent transaction output set. Set hashes
+//! (and no hash) of the coins database are computed on `threads` threads.
+std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point = {}, int threads = 1);
 } // namespace kernel
 
 #endif // SUPERAXECOIN_KERNEL_COINSTATS_H
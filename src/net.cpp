@@ -122,7 +122,24 @@ size_t CSerializedNetMsg::GetMemoryUsage() const noexcept
     // Don't count the dynamic memory used for the m_type string, by assuming it fits in the
     // "small string" optimization area (which stores data inside the object itself, up to some
     // size; 15 bytes in modern libstdc++).
-    return sizeof(*this) + memusage::DynamicUsage(data);
+    size_t usage{sizeof(*this) + memusage::DynamicUsage(data)};
+    // A shared payload is charged in full to every message referencing it, so that send buffer
+    // limits apply per peer exactly as they would for an owned copy.
+    if (m_shared_data) usage += memusage::DynamicUsage(m_shared_data) + memusage::DynamicUsage(*m_shared_data);
+    return usage;
+}
+
+void CSerializedNetMsg::MakeShared()
+{
+    if (m_shared_data || data.empty()) return;
+    m_shared_data = std::make_shared<const std::vector<unsigned char>>(std::move(data));
+    ClearShrink(data);
+}
+
+void CSerializedNetMsg::ClearPayload() noexcept
+{
+    ClearShrink(data);
+    m_shared_data.reset();
 }
 
 void CConnman::AddAddrFetch(const std::string& strDest)
@@ -613,6 +630,7 @@ void CNode::CopyStats(CNodeStats& stats)
         LOCK(cs_vSend);
         X(mapSendBytesPerMsgType);
         X(nSendBytes);
+        stats.m_send_queue_bytes = m_send_memusage + m_transport->GetSendMemoryUsage();
     }
     {
         LOCK(cs_vRecv);
@@ -622,6 +640,13 @@ void CNode::CopyStats(CNodeStats& stats)
         stats.m_transport_type = info.transport_type;
         if (info.session_id) stats.m_session_id = HexStr(*info.session_id);
     }
+    stats.m_recv_queue_bytes = WITH_LOCK(m_msg_process_queue_mutex, return m_msg_process_queue_size);
+    {
+        LOCK(m_process_time_mutex);
+        X(mapProcessTimePerMsgType);
+    }
+    X(m_process_time);
+    X(m_sig_checks);
     X(m_permission_flags);
 
     X(m_last_ping_time);
@@ -635,6 +660,30 @@ void CNode::CopyStats(CNodeStats& stats)
 }
 #undef X
 
+void CNode::AccountMessageProcessing(const std::string& msg_type, std::chrono::microseconds time, uint64_t sig_checks)
+{
+    m_sig_checks += sig_checks;
+
+    LOCK(m_process_time_mutex);
+    // Writers are serialized by m_process_time_mutex, readers need not take it.
+    m_process_time = m_process_time.load() + time;
+    // Only known message types get their own entry, as in mapRecvBytesPerMsgType.
+    auto i = mapProcessTimePerMsgType.find(msg_type);
+    if (i == mapProcessTimePerMsgType.end()) {
+        i = mapProcessTimePerMsgType.find(NET_MESSAGE_TYPE_OTHER);
+    }
+    assert(i != mapProcessTimePerMsgType.end());
+    i->second += time;
+}
+
+size_t CNode::GetMemoryUsage()
+{
+    size_t usage{m_relay_memusage.load()};
+    usage += WITH_LOCK(m_msg_process_queue_mutex, return m_msg_process_queue_size);
+    LOCK(cs_vSend);
+    return usage + m_send_memusage + m_transport->GetSendMemoryUsage();
+}
+
 bool CNode::ReceiveMsgBytes(Span<const uint8_t> msg_bytes, bool& complete)
 {
     complete = false;
@@ -805,13 +854,13 @@ bool V1Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
     AssertLockNotHeld(m_send_mutex);
     // Determine whether a new message can be set.
     LOCK(m_send_mutex);
-    if (m_sending_header || m_bytes_sent < m_message_to_send.data.size()) return false;
+    if (m_sending_header || m_bytes_sent < m_message_to_send.Payload().size()) return false;
 
     // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
+    uint256 hash = Hash(msg.Payload());
 
     // create header
-    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), msg.data.size());
+    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), msg.Payload().size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     // serialize header
@@ -833,11 +882,11 @@ Transport::BytesToSend V1Transport::GetBytesToSend(bool have_next_message) const
         return {Span{m_header_to_send}.subspan(m_bytes_sent),
                 // We have more to send after the header if the message has payload, or if there
                 // is a next message after that.
-                have_next_message || !m_message_to_send.data.empty(),
+                have_next_message || !m_message_to_send.Payload().empty(),
                 m_message_to_send.m_type
                };
     } else {
-        return {Span{m_message_to_send.data}.subspan(m_bytes_sent),
+        return {m_message_to_send.Payload().subspan(m_bytes_sent),
                 // We only have more to send after this message's payload if there is another
                 // message.
                 have_next_message,
@@ -846,18 +895,45 @@ Transport::BytesToSend V1Transport::GetBytesToSend(bool have_next_message) const
     }
 }
 
+Transport::BytesToSendV Transport::GetBytesToSendV(bool have_next_message) const noexcept
+{
+    const auto& [to_send, more, msg_type] = GetBytesToSend(have_next_message);
+    return {{to_send, {}}, more, msg_type};
+}
+
+Transport::BytesToSendV V1Transport::GetBytesToSendV(bool have_next_message) const noexcept
+{
+    AssertLockNotHeld(m_send_mutex);
+    LOCK(m_send_mutex);
+    const Span<const uint8_t> payload{m_message_to_send.Payload()};
+    if (m_sending_header) {
+        // The header and the payload can go out together.
+        return {{Span{m_header_to_send}.subspan(m_bytes_sent), payload},
+                have_next_message,
+                m_message_to_send.m_type
+               };
+    } else {
+        return {{payload.subspan(m_bytes_sent), {}},
+                have_next_message,
+                m_message_to_send.m_type
+               };
+    }
+}
+
 void V1Transport::MarkBytesSent(size_t bytes_sent) noexcept
 {
     AssertLockNotHeld(m_send_mutex);
     LOCK(m_send_mutex);
     m_bytes_sent += bytes_sent;
-    if (m_sending_header && m_bytes_sent == m_header_to_send.size()) {
-        // We're done sending a message's header. Switch to sending its data bytes.
+    if (m_sending_header && m_bytes_sent >= m_header_to_send.size()) {
+        // We're done sending a message's header. Switch to sending its data bytes, some of which
+        // may already have been sent along with it (see GetBytesToSendV).
         m_sending_header = false;
-        m_bytes_sent = 0;
-    } else if (!m_sending_header && m_bytes_sent == m_message_to_send.data.size()) {
-        // We're done sending a message's data. Wipe the data vector to reduce memory consumption.
-        ClearShrink(m_message_to_send.data);
+        m_bytes_sent -= m_header_to_send.size();
+    }
+    if (!m_sending_header && m_bytes_sent == m_message_to_send.Payload().size()) {
+        // We're done sending a message's data. Release the payload to reduce memory consumption.
+        m_message_to_send.ClearPayload();
         m_bytes_sent = 0;
     }
 }
@@ -1459,24 +1535,25 @@ bool V2Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
     if (!(m_send_state == SendState::READY && m_send_buffer.empty())) return false;
     // Construct contents (encoding message type + payload).
     std::vector<uint8_t> contents;
+    const Span<const uint8_t> payload{msg.Payload()};
     auto short_message_id = V2_MESSAGE_MAP(msg.m_type);
     if (short_message_id) {
-        contents.resize(1 + msg.data.size());
+        contents.resize(1 + payload.size());
         contents[0] = *short_message_id;
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1);
+        std::copy(payload.begin(), payload.end(), contents.begin() + 1);
     } else {
         // Initialize with zeroes, and then write the message type string starting at offset 1.
         // This means contents[0] and the unused positions in contents[1..13] remain 0x00.
-        contents.resize(1 + CMessageHeader::COMMAND_SIZE + msg.data.size(), 0);
+        contents.resize(1 + CMessageHeader::COMMAND_SIZE + payload.size(), 0);
         std::copy(msg.m_type.begin(), msg.m_type.end(), contents.data() + 1);
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1 + CMessageHeader::COMMAND_SIZE);
+        std::copy(payload.begin(), payload.end(), contents.begin() + 1 + CMessageHeader::COMMAND_SIZE);
     }
     // Construct ciphertext in send buffer.
     m_send_buffer.resize(contents.size() + BIP324Cipher::EXPANSION);
     m_cipher.Encrypt(MakeByteSpan(contents), {}, false, MakeWritableByteSpan(m_send_buffer));
     m_send_type = msg.m_type;
     // Release memory
-    ClearShrink(msg.data);
+    msg.ClearPayload();
     return true;
 }
 
@@ -1497,6 +1574,17 @@ Transport::BytesToSend V2Transport::GetBytesToSend(bool have_next_message) const
     };
 }
 
+Transport::BytesToSendV V2Transport::GetBytesToSendV(bool have_next_message) const noexcept
+{
+    AssertLockNotHeld(m_send_mutex);
+    {
+        LOCK(m_send_mutex);
+        if (m_send_state == SendState::V1) return m_v1_fallback.GetBytesToSendV(have_next_message);
+    }
+    // Otherwise, messages are encrypted into a single contiguous send buffer.
+    return Transport::GetBytesToSendV(have_next_message);
+}
+
 void V2Transport::MarkBytesSent(size_t bytes_sent) noexcept
 {
     AssertLockNotHeld(m_send_mutex);
@@ -1585,15 +1673,19 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
                 ++it;
             }
         }
-        const auto& [data, more, msg_type] = node.m_transport->GetBytesToSend(it != node.vSendMsg.end());
-        // We rely on the 'more' value returned by GetBytesToSend to correctly predict whether more
+        // Gather everything the transport can hand out now (e.g. a V1 header and its payload) so
+        // it is written with a single system call.
+        const auto& [spans, more, msg_type] = node.m_transport->GetBytesToSendV(it != node.vSendMsg.end());
+        size_t data_size{0};
+        for (const auto& span : spans) data_size += span.size();
+        // We rely on the 'more' value returned by GetBytesToSendV to correctly predict whether more
         // bytes are still to be sent, to correctly set the MSG_MORE flag. As a sanity check,
         // verify that the previously returned 'more' was correct.
-        if (expected_more.has_value()) Assume(!data.empty() == *expected_more);
+        if (expected_more.has_value()) Assume((data_size > 0) == *expected_more);
         expected_more = more;
-        data_left = !data.empty(); // will be overwritten on next loop if all of data gets sent
-        int nBytes = 0;
-        if (!data.empty()) {
+        data_left = data_size > 0; // will be overwritten on next loop if all of data gets sent
+        ssize_t nBytes = 0;
+        if (data_size > 0) {
             LOCK(node.m_sock_mutex);
             // There is no socket in case we've already disconnected, or in test cases without
             // real connections. In these cases, we bail out immediately and just leave things
@@ -1607,7 +1699,7 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
                 flags |= MSG_MORE;
             }
 #endif
-            nBytes = node.m_sock->Send(reinterpret_cast<const char*>(data.data()), data.size(), flags);
+            nBytes = node.m_sock->SendMany(spans, flags);
         }
         if (nBytes > 0) {
             node.m_last_send = GetTime<std::chrono::seconds>();
@@ -1619,7 +1711,7 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode& node) const
                 node.AccountForSentBytes(msg_type, nBytes);
             }
             nSentSize += nBytes;
-            if ((size_t)nBytes != data.size()) {
+            if ((size_t)nBytes != data_size) {
                 // could not send full message; stop sending more
                 break;
             }
@@ -1659,7 +1751,7 @@ bool CConnman::AttemptToEvictConnection()
     {
 
         LOCK(m_nodes_mutex);
-        for (const CNode* node : m_nodes) {
+        for (CNode* node : m_nodes) {
             if (node->fDisconnect)
                 continue;
             NodeEvictionCandidate candidate{
@@ -1677,6 +1769,8 @@ bool CConnman::AttemptToEvictConnection()
                 .m_network = node->ConnectedThroughNetwork(),
                 .m_noban = node->HasPermission(NetPermissionFlags::NoBan),
                 .m_conn_type = node->m_conn_type,
+                .m_process_time = node->m_process_time.load(),
+                .m_memory_usage = node->GetMemoryUsage(),
             };
             vEvictionCandidates.push_back(candidate);
         }
@@ -2032,6 +2126,16 @@ Sock::EventsPerSock CConnman::GenerateWaitSockets(Span<CNode* const> nodes)
     return events_per_sock;
 }
 
+bool CConnman::WaitForSockets(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock)
+{
+#ifdef USE_EPOLL
+    if (m_sock_epoll) {
+        return m_sock_epoll->WaitMany(timeout, events_per_sock);
+    }
+#endif
+    return events_per_sock.begin()->first->WaitMany(timeout, events_per_sock);
+}
+
 void CConnman::SocketHandler()
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
@@ -2048,7 +2152,7 @@ void CConnman::SocketHandler()
         // select(2)). If none are ready, wait for a short while and return
         // empty sets.
         events_per_sock = GenerateWaitSockets(snap.Nodes());
-        if (events_per_sock.empty() || !events_per_sock.begin()->first->WaitMany(timeout, events_per_sock)) {
+        if (events_per_sock.empty() || !WaitForSockets(timeout, events_per_sock)) {
             interruptNet.sleep_for(timeout);
         }
 
@@ -2184,9 +2288,9 @@ void CConnman::WakeMessageHandler()
 {
     {
         LOCK(mutexMsgProc);
-        fMsgProcWake = true;
+        m_msgproc_wake.assign(m_msgproc_wake.size(), true);
     }
-    condMsgProc.notify_one();
+    condMsgProc.notify_all();
 }
 
 void CConnman::ThreadDNSAddressSeed()
@@ -2891,10 +2995,8 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
 
 Mutex NetEventsInterface::g_msgproc_mutex;
 
-void CConnman::ThreadMessageHandler()
+void CConnman::ThreadMessageHandler(int shard)
 {
-    LOCK(NetEventsInterface::g_msgproc_mutex);
-
     while (!flagInterruptMsgProc)
     {
         bool fMoreWork = false;
@@ -2908,9 +3010,17 @@ void CConnman::ThreadMessageHandler()
             for (CNode* pnode : snap.Nodes()) {
                 if (pnode->fDisconnect)
                     continue;
+                if (pnode->GetId() % m_msghandler_threads != shard)
+                    continue;
+
+                // Receive messages that can be handled without g_msgproc_mutex
+                bool fMoreNodeWork = m_msgproc->ProcessConcurrentMessages(pnode);
+                if (flagInterruptMsgProc)
+                    return;
 
+                LOCK(NetEventsInterface::g_msgproc_mutex);
                 // Receive messages
-                bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
+                fMoreNodeWork |= m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
                 fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
                 if (flagInterruptMsgProc)
                     return;
@@ -2924,9 +3034,9 @@ void CConnman::ThreadMessageHandler()
 
         WAIT_LOCK(mutexMsgProc, lock);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) { return fMsgProcWake; });
+            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this, shard]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) { return bool{m_msgproc_wake[shard]}; });
         }
-        fMsgProcWake = false;
+        m_msgproc_wake[shard] = false;
     }
 }
 
@@ -3236,9 +3346,20 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
 
     {
         LOCK(mutexMsgProc);
-        fMsgProcWake = false;
+        m_msgproc_wake.assign(m_msghandler_threads, false);
     }
 
+#ifdef USE_EPOLL
+    m_sock_epoll.reset();
+    if (m_sock_events_mode == SockEventsMode::EPOLL) {
+        m_sock_epoll = std::make_unique<SockEpoll>();
+        if (!m_sock_epoll->IsValid()) {
+            LogPrintf("Falling back to -socketevents=poll\n");
+            m_sock_epoll.reset();
+        }
+    }
+#endif
+
     // Send and receive from sockets, accept connections
     threadSocketHandler = std::thread(&util::TraceThread, "net", [this] { ThreadSocketHandler(); });
 
@@ -3265,7 +3386,10 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     }
 
     // Process messages
-    threadMessageHandler = std::thread(&util::TraceThread, "msghand", [this] { ThreadMessageHandler(); });
+    for (int shard = 0; shard < m_msghandler_threads; ++shard) {
+        const std::string thread_name{shard == 0 ? "msghand" : strprintf("msghand.%d", shard)};
+        m_message_handler_threads.emplace_back(&util::TraceThread, thread_name, [this, shard] { ThreadMessageHandler(shard); });
+    }
 
     if (m_i2p_sam_session) {
         threadI2PAcceptIncoming =
@@ -3322,8 +3446,10 @@ void CConnman::StopThreads()
     if (threadI2PAcceptIncoming.joinable()) {
         threadI2PAcceptIncoming.join();
     }
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (std::thread& thread : m_message_handler_threads) {
+        if (thread.joinable()) thread.join();
+    }
+    m_message_handler_threads.clear();
     if (threadOpenConnections.joinable())
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
@@ -3688,9 +3814,12 @@ CNode::CNode(NodeId idIn,
 {
     if (inbound_onion) assert(conn_type_in == ConnectionType::INBOUND);
 
-    for (const std::string &msg : getAllNetMessageTypes())
+    for (const std::string &msg : getAllNetMessageTypes()) {
         mapRecvBytesPerMsgType[msg] = 0;
+        mapProcessTimePerMsgType[msg] = 0us;
+    }
     mapRecvBytesPerMsgType[NET_MESSAGE_TYPE_OTHER] = 0;
+    mapProcessTimePerMsgType[NET_MESSAGE_TYPE_OTHER] = 0us;
 
     if (fLogIPs) {
         LogPrint(BCLog::NET, "Added connection to %s peer=%d\n", m_addr_name, id);
@@ -3717,9 +3846,15 @@ void CNode::MarkReceivedMsgsForProcessing()
 }
 
 std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage()
+{
+    return PollMessage([](const std::string&) { return true; });
+}
+
+std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage(const std::function<bool(const std::string& msg_type)>& accept)
 {
     LOCK(m_msg_process_queue_mutex);
     if (m_msg_process_queue.empty()) return std::nullopt;
+    if (!accept(m_msg_process_queue.front().m_type)) return std::nullopt;
 
     std::list<CNetMessage> msgs;
     // Just take one message
@@ -3738,10 +3873,11 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
 void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
-    size_t nMessageSize = msg.data.size();
+    const Span<const unsigned char> payload{msg.Payload()};
+    size_t nMessageSize = payload.size();
     LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n", msg.m_type, nMessageSize, pnode->GetId());
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pnode->addr, msg.m_type, msg.data, /*is_incoming=*/false);
+        CaptureMessage(pnode->addr, msg.m_type, payload, /*is_incoming=*/false);
     }
 
     TRACE6(net, outbound_message,
@@ -3749,8 +3885,8 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         pnode->m_addr_name.c_str(),
         pnode->ConnectionTypeAsString().c_str(),
         msg.m_type.c_str(),
-        msg.data.size(),
-        msg.data.data()
+        payload.size(),
+        payload.data()
     );
 
     size_t nBytesSent = 0;
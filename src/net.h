@@ -31,7 +31,9 @@
 #include <util/sock.h>
 #include <util/threadinterrupt.h>
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
@@ -96,6 +98,11 @@ static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
 
 static constexpr bool DEFAULT_V2_TRANSPORT{false};
 
+/** -msghandlerthreads default */
+static constexpr int DEFAULT_MSGHANDLER_THREADS{1};
+/** Maximum number of message handler threads */
+static constexpr int MAX_MSGHANDLER_THREADS{16};
+
 typedef int64_t NodeId;
 
 struct AddedNodeParams {
@@ -121,15 +128,34 @@ struct CSerializedNetMsg {
     CSerializedNetMsg(const CSerializedNetMsg& msg) = delete;
     CSerializedNetMsg& operator=(const CSerializedNetMsg&) = delete;
 
+    /** Copy this message. A shared payload (see MakeShared()) is not duplicated. */
     CSerializedNetMsg Copy() const
     {
         CSerializedNetMsg copy;
         copy.data = data;
+        copy.m_shared_data = m_shared_data;
         copy.m_type = m_type;
         return copy;
     }
 
+    /**
+     * Move the payload into immutable reference-counted storage, so that the message can be
+     * queued to many peers through Copy() without copying the serialized bytes.
+     */
+    void MakeShared();
+
+    /** The payload bytes, whether owned (data) or shared (m_shared_data). */
+    Span<const unsigned char> Payload() const noexcept
+    {
+        return m_shared_data ? Span<const unsigned char>{*m_shared_data} : Span<const unsigned char>{data};
+    }
+
+    /** Release the payload, dropping the reference to any shared payload. */
+    void ClearPayload() noexcept;
+
     std::vector<unsigned char> data;
+    /** Payload shared with other messages. If set, data is empty. */
+    std::shared_ptr<const std::vector<unsigned char>> m_shared_data;
     std::string m_type;
 
     /** Compute total memory usage of this object (own memory + any dynamic memory). */
@@ -183,6 +209,7 @@ extern std::map<CNetAddr, LocalServiceInfo> mapLocalHost GUARDED_BY(g_maplocalho
 
 extern const std::string NET_MESSAGE_TYPE_OTHER;
 using mapMsgTypeSize = std::map</* message type */ std::string, /* total bytes */ uint64_t>;
+using mapMsgTypeTime = std::map</* message type */ std::string, /* total time */ std::chrono::microseconds>;
 
 class CNodeStats
 {
@@ -224,6 +251,15 @@ public:
     TransportProtocolType m_transport_type;
     /** BIP324 session id string in hex, if any. */
     std::string m_session_id;
+    /** Time spent processing messages from this peer, in total and by message type. */
+    std::chrono::microseconds m_process_time;
+    mapMsgTypeTime mapProcessTimePerMsgType;
+    /** Signatures verified while processing messages from this peer. */
+    uint64_t m_sig_checks;
+    /** Bytes of received messages waiting to be processed. */
+    uint64_t m_recv_queue_bytes;
+    /** Bytes of messages waiting to be sent, including those handed to the transport. */
+    uint64_t m_send_queue_bytes;
 };
 
 
@@ -352,9 +388,30 @@ public:
      */
     virtual BytesToSend GetBytesToSend(bool have_next_message) const noexcept = 0;
 
+    /** Maximum number of spans returned by GetBytesToSendV. */
+    static constexpr size_t MAX_SEND_SPANS{2};
+
+    /** Return type for GetBytesToSendV. Like BytesToSend, but the bytes to send are split over up
+     *  to MAX_SEND_SPANS spans, to be sent in order. Unused trailing spans are empty. */
+    using BytesToSendV = std::tuple<
+        std::array<Span<const uint8_t>, MAX_SEND_SPANS> /*to_send*/,
+        bool /*more*/,
+        const std::string& /*m_type*/
+    >;
+
+    /** Scatter-gather variant of GetBytesToSend.
+     *
+     * Returns what successive GetBytesToSend calls would return if each result were marked as
+     * fully sent in between, as far as this is possible without another SetMessageToSend call.
+     * This allows e.g. a message header and its payload to be written with a single system
+     * call. 'more' applies to the point where all returned spans have been sent.
+     */
+    virtual BytesToSendV GetBytesToSendV(bool have_next_message) const noexcept;
+
     /** Report how many bytes returned by the last GetBytesToSend() have been sent.
      *
-     * bytes_sent cannot exceed to_send.size() of the last GetBytesToSend() result.
+     * bytes_sent cannot exceed to_send.size() of the last GetBytesToSend() result, or the total
+     * size of to_send of the last GetBytesToSendV() result.
      *
      * If bytes_sent=0, this call has no effect.
      */
@@ -446,6 +503,7 @@ public:
 
     bool SetMessageToSend(CSerializedNetMsg& msg) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     BytesToSend GetBytesToSend(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
+    BytesToSendV GetBytesToSendV(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     void MarkBytesSent(size_t bytes_sent) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     size_t GetSendMemoryUsage() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     bool ShouldReconnectV1() const noexcept override { return false; }
@@ -662,6 +720,7 @@ public:
     // Send side functions.
     bool SetMessageToSend(CSerializedNetMsg& msg) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     BytesToSend GetBytesToSend(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
+    BytesToSendV GetBytesToSendV(bool have_next_message) const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     void MarkBytesSent(size_t bytes_sent) noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
     size_t GetSendMemoryUsage() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_send_mutex);
 
@@ -762,6 +821,11 @@ public:
     std::optional<std::pair<CNetMessage, bool>> PollMessage()
         EXCLUSIVE_LOCKS_REQUIRED(!m_msg_process_queue_mutex);
 
+    /** Same as PollMessage(), but only if `accept` returns true for the type
+     *  of the next message. Otherwise the message stays queued. */
+    std::optional<std::pair<CNetMessage, bool>> PollMessage(const std::function<bool(const std::string& msg_type)>& accept)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_msg_process_queue_mutex);
+
     /** Account for the total size of a sent message in the per msg type connection stats. */
     void AccountForSentBytes(const std::string& msg_type, size_t sent_bytes)
         EXCLUSIVE_LOCKS_REQUIRED(cs_vSend)
@@ -890,6 +954,21 @@ public:
      * criterium in CConnman::AttemptToEvictConnection. */
     std::atomic<std::chrono::microseconds> m_min_ping_time{std::chrono::microseconds::max()};
 
+    /** Total time spent processing messages from this peer, only updated
+     * under m_process_time_mutex. Used as an inbound peer eviction criterium
+     * in CConnman::AttemptToEvictConnection. */
+    std::atomic<std::chrono::microseconds> m_process_time{0us};
+
+    /** Number of signatures verified while processing messages from this
+     * peer. Used only for RPC stats/debugging. */
+    std::atomic<uint64_t> m_sig_checks{0};
+
+    /** Memory held by net processing on behalf of this peer (its orphan
+     * transactions and transaction announcements), as of the last time it was
+     * sent messages. Used as an inbound peer eviction criterium in
+     * CConnman::AttemptToEvictConnection. */
+    std::atomic<size_t> m_relay_memusage{0};
+
     CNode(NodeId id,
           std::shared_ptr<Sock> sock,
           const CAddress& addrIn,
@@ -955,7 +1034,15 @@ public:
 
     void CloseSocketDisconnect() EXCLUSIVE_LOCKS_REQUIRED(!m_sock_mutex);
 
-    void CopyStats(CNodeStats& stats) EXCLUSIVE_LOCKS_REQUIRED(!m_subver_mutex, !m_addr_local_mutex, !cs_vSend, !cs_vRecv);
+    void CopyStats(CNodeStats& stats) EXCLUSIVE_LOCKS_REQUIRED(!m_subver_mutex, !m_addr_local_mutex, !cs_vSend, !cs_vRecv, !m_msg_process_queue_mutex, !m_process_time_mutex);
+
+    /** Account for having processed a message of type msg_type from this peer, which took
+     * `time` and verified `sig_checks` signatures. */
+    void AccountMessageProcessing(const std::string& msg_type, std::chrono::microseconds time, uint64_t sig_checks)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_process_time_mutex);
+
+    /** Memory held on behalf of this peer: its queued messages plus m_relay_memusage. */
+    size_t GetMemoryUsage() EXCLUSIVE_LOCKS_REQUIRED(!cs_vSend, !m_msg_process_queue_mutex);
 
     std::string ConnectionTypeAsString() const { return ::ConnectionTypeAsString(m_conn_type); }
 
@@ -984,6 +1071,9 @@ private:
     mapMsgTypeSize mapSendBytesPerMsgType GUARDED_BY(cs_vSend);
     mapMsgTypeSize mapRecvBytesPerMsgType GUARDED_BY(cs_vRecv);
 
+    Mutex m_process_time_mutex;
+    mapMsgTypeTime mapProcessTimePerMsgType GUARDED_BY(m_process_time_mutex);
+
     /**
      * If an I2P session is created per connection (for outbound transient I2P
      * connections) then it is stored here so that it can be destroyed when the
@@ -1021,6 +1111,17 @@ public:
     */
     virtual bool ProcessMessages(CNode* pnode, std::atomic<bool>& interrupt) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex) = 0;
 
+    /**
+    * Process protocol messages from a given node that need neither
+    * g_msgproc_mutex nor cs_main. May run concurrently with
+    * ProcessMessages() and SendMessages() for other nodes, but never
+    * concurrently with any call for the same node.
+    *
+    * @param[in]   pnode           The node which we have received messages from.
+    * @return                      True if there is more work to be done
+    */
+    virtual bool ProcessConcurrentMessages(CNode* pnode) = 0;
+
     /**
     * Send queued protocol messages to a given node.
     *
@@ -1069,6 +1170,8 @@ public:
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
         bool m_i2p_accept_incoming;
+        SockEventsMode m_sock_events_mode{DEFAULT_SOCK_EVENTS_MODE};
+        int m_msghandler_threads{DEFAULT_MSGHANDLER_THREADS};
     };
 
     void Init(const Options& connOptions) EXCLUSIVE_LOCKS_REQUIRED(!m_added_nodes_mutex, !m_total_bytes_sent_mutex)
@@ -1103,6 +1206,8 @@ public:
             }
         }
         m_onion_binds = connOptions.onion_binds;
+        m_sock_events_mode = connOptions.m_sock_events_mode;
+        m_msghandler_threads = std::clamp(connOptions.m_msghandler_threads, 1, MAX_MSGHANDLER_THREADS);
     }
 
     CConnman(uint64_t seed0, uint64_t seed1, AddrMan& addrman, const NetGroupManager& netgroupman,
@@ -1275,7 +1380,13 @@ private:
     void AddAddrFetch(const std::string& strDest) EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex);
     void ProcessAddrFetch() EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_unused_i2p_sessions_mutex);
     void ThreadOpenConnections(std::vector<std::string> connect) EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_added_nodes_mutex, !m_nodes_mutex, !m_unused_i2p_sessions_mutex, !m_reconnections_mutex);
-    void ThreadMessageHandler() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
+    /**
+     * Process messages from and to the peers of one shard (those with
+     * NodeId % m_msghandler_threads == shard). Messages that need neither
+     * g_msgproc_mutex nor cs_main are handled concurrently with the other
+     * shards; all other processing is serialized by g_msgproc_mutex.
+     */
+    void ThreadMessageHandler(int shard) EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
     void ThreadI2PAcceptIncoming();
     void AcceptConnection(const ListenSocket& hListenSocket);
 
@@ -1304,6 +1415,13 @@ private:
      */
     Sock::EventsPerSock GenerateWaitSockets(Span<CNode* const> nodes);
 
+    /**
+     * Wait for readiness of the sockets from GenerateWaitSockets(), using the
+     * mechanism selected by m_sock_events_mode.
+     * @return false on error
+     */
+    bool WaitForSockets(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock);
+
     /**
      * Check connected and listening sockets for IO readiness and process them accordingly.
      */
@@ -1494,8 +1612,8 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake GUARDED_BY(mutexMsgProc);
+    /** flags for waking the message processor threads, one per thread. */
+    std::vector<bool> m_msgproc_wake GUARDED_BY(mutexMsgProc);
 
     std::condition_variable condMsgProc;
     Mutex mutexMsgProc;
@@ -1518,9 +1636,22 @@ private:
 
     std::thread threadDNSAddressSeed;
     std::thread threadSocketHandler;
+
+    /** How the socket handler thread waits for socket readiness. */
+    SockEventsMode m_sock_events_mode{DEFAULT_SOCK_EVENTS_MODE};
+
+#ifdef USE_EPOLL
+    /**
+     * Persistent epoll registrations of the connected and listening sockets,
+     * used if m_sock_events_mode is EPOLL. Only accessed by the socket handler thread.
+     */
+    std::unique_ptr<SockEpoll> m_sock_epoll;
+#endif
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
+    /** Message handler threads. Peers are sharded across them by NodeId. */
+    std::vector<std::thread> m_message_handler_threads;
+    int m_msghandler_threads{DEFAULT_MSGHANDLER_THREADS};
     std::thread threadI2PAcceptIncoming;
 
     /** flag for deciding to connect to an extra outbound peer,
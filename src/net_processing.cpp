@@ -25,6 +25,7 @@
 #include <node/blockstorage.h>
 #include <node/txreconciliation.h>
 #include <policy/fees.h>
+#include <policy/packages.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <primitives/block.h>
@@ -32,6 +33,7 @@
 #include <random.h>
 #include <reverse_iterator.h>
 #include <scheduler.h>
+#include <script/sigcache.h>
 #include <streams.h>
 #include <sync.h>
 #include <timedata.h>
@@ -41,13 +43,14 @@
 #include <txrequest.h>
 #include <util/check.h> // For NDEBUG compile time check
 #include <util/strencodings.h>
+#include <util/time.h>
 #include <util/trace.h>
 #include <validation.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
-#include <future>
 #include <memory>
 #include <optional>
 #include <typeinfo>
@@ -102,8 +105,11 @@ static constexpr auto OVERLOADED_PEER_TX_DELAY{2s};
 static constexpr auto GETDATA_TX_INTERVAL{60s};
 /** Limit to avoid sending big packets. Not used in processing incoming GETDATA for compatibility */
 static const unsigned int MAX_GETDATA_SZ = 1000;
-/** Number of blocks that can be requested at any given time from a single peer. */
+/** Number of blocks that can be requested at any given time from a single peer, until its
+ *  download rate is known (and always, when adaptive block download is disabled). */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Upper bound for the adaptive per-peer in-flight limit, see GetBlocksInFlightLimit(). */
+static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE = 128;
 /** Default time during which a peer must stall block download progress before being disconnected.
  * the actual timeout is increased temporarily if peers are disconnected for hitting the timeout */
 static constexpr auto BLOCK_STALLING_TIMEOUT_DEFAULT{2s};
@@ -122,6 +128,13 @@ static const int MAX_BLOCKTXN_DEPTH = 10;
  *  degree of disordering of blocks on disk (which make reindexing and pruning harder). We'll probably
  *  want to make this a per-peer adaptive value at some point. */
 static const unsigned int BLOCK_DOWNLOAD_WINDOW = 1024;
+/** With adaptive block download, the window is sized to span about as many bytes as
+ *  BLOCK_DOWNLOAD_WINDOW blocks of this size, so it widens when blocks are small. */
+static constexpr double BLOCK_DOWNLOAD_WINDOW_REFERENCE_SIZE{1'000'000};
+/** Upper bound for the adaptive block download window. */
+static const unsigned int MAX_BLOCK_DOWNLOAD_WINDOW = 5 * BLOCK_DOWNLOAD_WINDOW;
+/** Weight of a new sample in the smoothed block size and per-peer download rate. */
+static constexpr double BLOCK_DOWNLOAD_SMOOTHING{0.125};
 /** Block download timeout base, expressed in multiples of the block interval (i.e. 10 min) */
 static constexpr double BLOCK_DOWNLOAD_TIMEOUT_BASE = 1;
 /** Additional block download timeout per parallel downloading peer (i.e. 5 min) */
@@ -423,6 +436,8 @@ struct CNodeState {
     std::list<QueuedBlock> vBlocksInFlight;
     //! When the first entry in vBlocksInFlight started downloading. Don't care when vBlocksInFlight is empty.
     std::chrono::microseconds m_downloading_since{0us};
+    //! Smoothed rate (in bytes per second) at which this peer delivered requested blocks, or 0 if unknown.
+    double m_block_download_rate{0};
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload{false};
     /** Whether this peer wants invs or cmpctblocks (when possible) for block announcements. */
@@ -502,6 +517,8 @@ public:
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_recent_confirmed_transactions_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
     bool SendMessages(CNode* pto) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_recent_confirmed_transactions_mutex, !m_most_recent_block_mutex, g_msgproc_mutex);
+    bool ProcessConcurrentMessages(CNode* pfrom) override
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
 
     /** Implement PeerManager */
     void StartScheduledTasks(CScheduler& scheduler) override;
@@ -520,6 +537,21 @@ public:
     void UpdateLastBlockAnnounceTime(NodeId node, int64_t time_in_seconds) override;
 
 private:
+    /** Whether messages of this type need neither g_msgproc_mutex nor cs_main, and can be
+     *  handled by ProcessConcurrentMessages(). */
+    static bool IsConcurrentMessage(const std::string& msg_type);
+
+    /** Handle a message for which IsConcurrentMessage() is true. */
+    void ProcessConcurrentMessage(CNode& pfrom, Peer& peer, const std::string& msg_type, CDataStream& vRecv,
+                                  std::chrono::microseconds time_received);
+
+    /** Trace and (if enabled) capture a message polled from a peer's processing queue. */
+    void RecordInboundMessage(const CNode& pfrom, const CNetMessage& msg) const;
+
+    /** Account and trace the time and signature checks spent on a message from a peer, given the
+     *  SteadyClock time and GetThreadSignatureChecks() reading from before it was processed. */
+    void RecordMessageProcessing(CNode& pfrom, const std::string& msg_type, SteadyClock::time_point start, uint64_t sig_checks_start) const;
+
     /** Consider evicting an outbound peer based on the amount of time they've been behind our tip */
     void ConsiderEviction(CNode& pto, Peer& peer, std::chrono::seconds time_in_seconds) EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_msgproc_mutex);
 
@@ -587,6 +619,36 @@ private:
     bool ProcessOrphanTx(Peer& peer)
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, g_msgproc_mutex);
 
+    /** A 1-parent-1-child package formed from a transaction we just received and an orphan
+     *  announced by the same peer. */
+    struct PackageToValidate {
+        const Package m_txns;
+        const NodeId m_peer;
+
+        std::string ToString() const
+        {
+            return strprintf("parent %s (wtxid=%s) + child %s (wtxid=%s) from peer=%d",
+                             m_txns.front()->GetHash().ToString(), m_txns.front()->GetWitnessHash().ToString(),
+                             m_txns.back()->GetHash().ToString(), m_txns.back()->GetWitnessHash().ToString(),
+                             m_peer);
+        }
+    };
+
+    /**
+     * Look for an orphan announced by nodeid that spends ptx, such that ptx, which was rejected
+     * for its feerate alone, may be accepted together with the child paying for it.
+     *
+     * @return  The package to validate, or std::nullopt if there is no such child or every
+     *          candidate package was already rejected.
+     */
+    std::optional<PackageToValidate> Find1P1CPackage(const CTransactionRef& ptx, NodeId nodeid)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Submit a package to the mempool. Relay and forget the transactions that were accepted,
+     *  remember the package if it was rejected, and punish the peer for invalid transactions. */
+    void ProcessPackage(const PackageToValidate& package)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, g_msgproc_mutex, cs_main);
+
     /** Process a single headers message from a peer.
      *
      * @param[in]   pfrom     CNode of the peer
@@ -696,6 +758,13 @@ private:
     /** Send `feefilter` message. */
     void MaybeSendFeefilter(CNode& node, Peer& peer, std::chrono::microseconds current_time) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
 
+    /** Send `reqrecon` message if a reconciliation round we initiate with this peer is due. */
+    void MaybeRequestReconciliation(CNode& node, std::chrono::microseconds current_time);
+
+    /** Announce transactions by wtxid at the end of a reconciliation round, skipping those no
+     *  longer in the mempool. */
+    void AnnounceReconciledTransactions(CNode& node, Peer& peer, const std::vector<uint256>& wtxids);
+
     FastRandomContext m_rng GUARDED_BY(NetEventsInterface::g_msgproc_mutex);
 
     FeeFilterRounder m_fee_filter_rounder GUARDED_BY(NetEventsInterface::g_msgproc_mutex);
@@ -773,7 +842,14 @@ private:
     /** Stalling timeout for blocks in IBD */
     std::atomic<std::chrono::seconds> m_block_stalling_timeout{BLOCK_STALLING_TIMEOUT_DEFAULT};
 
-    bool AlreadyHaveTx(const GenTxid& gtxid)
+    /** Whether we already have, or recently rejected, a transaction.
+     *
+     * @param[in] include_reconsiderable  Whether to count transactions rejected only for their
+     *                                    feerate. These are requested again when an orphan is
+     *                                    missing them, so they can be validated as a package
+     *                                    with it.
+     */
+    bool AlreadyHaveTx(const GenTxid& gtxid, bool include_reconsiderable)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main, !m_recent_confirmed_transactions_mutex);
 
     /**
@@ -813,6 +889,21 @@ private:
     CRollingBloomFilter m_recent_rejects GUARDED_BY(::cs_main){120'000, 0.000'001};
     uint256 hashRecentRejectsChainTip GUARDED_BY(cs_main);
 
+    /**
+     * Filter for transactions that were recently rejected by the mempool only
+     * because their feerate is below the mempool minimum (see
+     * IsReconsiderable()), and for 1-parent-1-child packages (by package hash)
+     * that were rejected as a whole.
+     *
+     * Such a transaction may still be accepted together with a child paying
+     * for it, so it is kept out of m_recent_rejects: it is not re-requested
+     * for a plain announcement, but it is when an orphan names it as a missing
+     * parent. It is reset together with m_recent_rejects.
+     *
+     * Memory used: 1.3 MB
+     */
+    CRollingBloomFilter m_recent_rejects_reconsiderable GUARDED_BY(::cs_main){120'000, 0.000'001};
+
     /*
      * Filter for transactions that have been recently confirmed.
      * We use this to avoid requesting transactions that have already been
@@ -848,6 +939,25 @@ private:
     uint256 m_most_recent_block_hash GUARDED_BY(m_most_recent_block_mutex);
     std::unique_ptr<const std::map<uint256, CTransactionRef>> m_most_recent_block_txs GUARDED_BY(m_most_recent_block_mutex);
 
+    /** Messages carrying the most recent block that can be cached (see GetRecentBlockMessage). */
+    enum class RecentBlockMsg {
+        BLOCK,            //!< block with witness data
+        BLOCK_NO_WITNESS, //!< block without witness data
+        CMPCTBLOCK,       //!< compact block
+        HEADERS,          //!< headers message announcing just this block
+    };
+    static constexpr size_t NUM_RECENT_BLOCK_MSGS{4};
+    /** Serialized messages for m_most_recent_block, indexed by RecentBlockMsg. */
+    std::array<std::optional<CSerializedNetMsg>, NUM_RECENT_BLOCK_MSGS> m_most_recent_block_msgs GUARDED_BY(m_most_recent_block_mutex);
+
+    /**
+     * Get a message carrying the most recent block, if its hash is hash. Each message is
+     * serialized on first use only, and the returned copies share its payload, so sending a new
+     * block to many peers does not serialize or copy it for each of them.
+     */
+    std::optional<CSerializedNetMsg> GetRecentBlockMessage(const uint256& hash, RecentBlockMsg type)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+
     // Data about the low-work headers synchronization, aggregated from all peers' HeadersSyncStates.
     /** Mutex guarding the other m_headers_presync_* variables. */
     Mutex m_headers_presync_mutex;
@@ -890,6 +1000,17 @@ private:
      */
     bool BlockRequested(NodeId nodeid, const CBlockIndex& block, std::list<QueuedBlock>::iterator** pit = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /** Update the block size and download rate estimates for a requested block of the given
+     *  serialized size arriving from a peer. Must be called before RemoveBlockRequest(). */
+    void RecordBlockDownload(NodeId nodeid, const uint256& hash, size_t block_size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Number of blocks that may be in flight from this peer at once. With adaptive block
+     *  download, this covers the bandwidth-delay product of the connection in blocks. */
+    int GetBlocksInFlightLimit(const CNode& node, const CNodeState& state) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** How far beyond the last block we have in common with a peer we download. */
+    unsigned int GetBlockDownloadWindow() const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     bool TipMayBeStale() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Update pindexLastCommonBlock and add not-in-flight missing successors to vBlocks, until it has
@@ -965,6 +1086,9 @@ private:
     /** Number of peers from which we're downloading blocks. */
     int m_peers_downloading_from GUARDED_BY(cs_main) = 0;
 
+    /** Smoothed serialized size of requested blocks we received, or 0 if none yet. */
+    double m_avg_block_size GUARDED_BY(cs_main){0};
+
     /** Storage for orphan information */
     TxOrphanage m_orphanage;
 
@@ -1234,6 +1358,44 @@ bool PeerManagerImpl::BlockRequested(NodeId nodeid, const CBlockIndex& block, st
     return true;
 }
 
+void PeerManagerImpl::RecordBlockDownload(NodeId nodeid, const uint256& hash, size_t block_size)
+{
+    for (auto range = mapBlocksInFlight.equal_range(hash); range.first != range.second; range.first++) {
+        auto [node_id, list_it] = range.first->second;
+        if (node_id != nodeid) continue;
+
+        m_avg_block_size = m_avg_block_size == 0 ? block_size : m_avg_block_size + BLOCK_DOWNLOAD_SMOOTHING * (block_size - m_avg_block_size);
+
+        // Only the first block in the queue has a meaningful start time: the moment it was
+        // requested, or the moment the block before it arrived.
+        CNodeState& state = *Assert(State(node_id));
+        if (state.vBlocksInFlight.begin() != list_it) return;
+        const auto elapsed{GetTime<std::chrono::microseconds>() - state.m_downloading_since};
+        if (elapsed <= 0us) return;
+        const double rate{block_size / std::chrono::duration<double>(elapsed).count()};
+        state.m_block_download_rate = state.m_block_download_rate == 0 ? rate : state.m_block_download_rate + BLOCK_DOWNLOAD_SMOOTHING * (rate - state.m_block_download_rate);
+        return;
+    }
+}
+
+int PeerManagerImpl::GetBlocksInFlightLimit(const CNode& node, const CNodeState& state) const
+{
+    const auto rtt{node.m_min_ping_time.load()};
+    if (!m_opts.adaptive_block_download || state.m_block_download_rate == 0 || m_avg_block_size == 0 || rtt == std::chrono::microseconds::max()) {
+        return MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+    }
+    // Blocks the peer can deliver during one round trip, plus the one being received. Twice
+    // that leaves room for the measured rate to grow until the link itself is the limit.
+    const double bdp_blocks{state.m_block_download_rate * std::chrono::duration<double>(rtt).count() / m_avg_block_size};
+    return std::clamp<double>(2 * (bdp_blocks + 1), MAX_BLOCKS_IN_TRANSIT_PER_PEER, MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE);
+}
+
+unsigned int PeerManagerImpl::GetBlockDownloadWindow() const
+{
+    if (!m_opts.adaptive_block_download || m_avg_block_size == 0) return BLOCK_DOWNLOAD_WINDOW;
+    return std::clamp<double>(BLOCK_DOWNLOAD_WINDOW * BLOCK_DOWNLOAD_WINDOW_REFERENCE_SIZE / m_avg_block_size, BLOCK_DOWNLOAD_WINDOW, MAX_BLOCK_DOWNLOAD_WINDOW);
+}
+
 void PeerManagerImpl::MaybeSetPeerAsAnnouncingHeaderAndIDs(NodeId nodeid)
 {
     AssertLockHeld(cs_main);
@@ -1380,10 +1542,10 @@ void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int co
         return;
 
     const CBlockIndex *pindexWalk = state->pindexLastCommonBlock;
-    // Never fetch further than the best block we know the peer has, or more than BLOCK_DOWNLOAD_WINDOW + 1 beyond the last
+    // Never fetch further than the best block we know the peer has, or more than the download window + 1 beyond the last
     // linked block we have in common with this peer. The +1 is so we can detect stalling, namely if we would be able to
     // download that next block if the window were 1 larger.
-    int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
+    int nWindowEnd = state->pindexLastCommonBlock->nHeight + GetBlockDownloadWindow();
 
     FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd, &m_chainman.ActiveChain(), &nodeStaller);
 }
@@ -1414,7 +1576,7 @@ void PeerManagerImpl::TryDownloadingHistoricalBlocks(const Peer& peer, unsigned
         return;
     }
 
-    FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + BLOCK_DOWNLOAD_WINDOW, target_block->nHeight));
+    FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + GetBlockDownloadWindow(), target_block->nHeight));
 }
 
 void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain, NodeId* nodeStaller)
@@ -1674,6 +1836,7 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) c
             if (queue.pindex)
                 stats.vHeightInFlight.push_back(queue.pindex->nHeight);
         }
+        stats.m_txrequest_usage = m_txrequest.UsageByPeer(nodeid);
     }
 
     PeerRef peer = GetPeerRef(nodeid);
@@ -1703,6 +1866,7 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) c
     stats.m_addr_processed = peer->m_addr_processed.load();
     stats.m_addr_rate_limited = peer->m_addr_rate_limited.load();
     stats.m_addr_relay_enabled = peer->m_addr_relay_enabled.load();
+    stats.m_orphan_usage = m_orphanage.UsageByPeer(nodeid);
     {
         LOCK(peer->m_headers_sync_mutex);
         if (peer->m_headers_sync) {
@@ -1980,6 +2144,34 @@ void PeerManagerImpl::BlockDisconnected(const std::shared_ptr<const CBlock> &blo
  * Maintain state about the best-seen block and fast-announce a compact block
  * to compatible peers.
  */
+std::optional<CSerializedNetMsg> PeerManagerImpl::GetRecentBlockMessage(const uint256& hash, RecentBlockMsg type)
+{
+    LOCK(m_most_recent_block_mutex);
+    if (!m_most_recent_block || m_most_recent_block_hash != hash) return std::nullopt;
+
+    auto& msg{m_most_recent_block_msgs[static_cast<size_t>(type)]};
+    if (!msg) {
+        // None of these serializations depend on the peer's protocol version.
+        const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+        switch (type) {
+        case RecentBlockMsg::BLOCK:
+            msg = msgMaker.Make(NetMsgType::BLOCK, *m_most_recent_block);
+            break;
+        case RecentBlockMsg::BLOCK_NO_WITNESS:
+            msg = msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, *m_most_recent_block);
+            break;
+        case RecentBlockMsg::CMPCTBLOCK:
+            msg = msgMaker.Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block);
+            break;
+        case RecentBlockMsg::HEADERS:
+            msg = msgMaker.Make(NetMsgType::HEADERS, std::vector<CBlock>{m_most_recent_block->GetBlockHeader()});
+            break;
+        } // no default case, so the compiler can warn about missing cases
+        msg->MakeShared();
+    }
+    return msg->Copy();
+}
+
 void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock)
 {
     auto pcmpctblock = std::make_shared<const CBlockHeaderAndShortTxIDs>(*pblock);
@@ -1994,8 +2186,6 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
     if (!DeploymentActiveAt(*pindex, m_chainman, Consensus::DEPLOYMENT_SEGWIT)) return;
 
     uint256 hashBlock(pblock->GetHash());
-    const std::shared_future<CSerializedNetMsg> lazy_ser{
-        std::async(std::launch::deferred, [&] { return msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock); })};
 
     {
         auto most_recent_block_txs = std::make_unique<std::map<uint256, CTransactionRef>>();
@@ -2009,9 +2199,10 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
         m_most_recent_block = pblock;
         m_most_recent_compact_block = pcmpctblock;
         m_most_recent_block_txs = std::move(most_recent_block_txs);
+        m_most_recent_block_msgs = {};
     }
 
-    m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    m_connman.ForEachNode([this, pindex, &pcmpctblock, &msgMaker, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
@@ -2025,8 +2216,8 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
 
-            const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
-            m_connman.PushMessage(pnode, ser_cmpctblock.Copy());
+            auto cmpctblock_msg{GetRecentBlockMessage(hashBlock, RecentBlockMsg::CMPCTBLOCK)};
+            m_connman.PushMessage(pnode, cmpctblock_msg ? std::move(*cmpctblock_msg) : msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
             state.pindexBestHeaderSent = pindex;
         }
     });
@@ -2112,7 +2303,7 @@ void PeerManagerImpl::BlockChecked(const CBlock& block, const BlockValidationSta
 //
 
 
-bool PeerManagerImpl::AlreadyHaveTx(const GenTxid& gtxid)
+bool PeerManagerImpl::AlreadyHaveTx(const GenTxid& gtxid, bool include_reconsiderable)
 {
     if (m_chainman.ActiveChain().Tip()->GetBlockHash() != hashRecentRejectsChainTip) {
         // If the chain tip has changed previously rejected transactions
@@ -2121,6 +2312,7 @@ bool PeerManagerImpl::AlreadyHaveTx(const GenTxid& gtxid)
         // txs a second chance.
         hashRecentRejectsChainTip = m_chainman.ActiveChain().Tip()->GetBlockHash();
         m_recent_rejects.reset();
+        m_recent_rejects_reconsiderable.reset();
     }
 
     const uint256& hash = gtxid.GetHash();
@@ -2132,6 +2324,8 @@ bool PeerManagerImpl::AlreadyHaveTx(const GenTxid& gtxid)
         if (m_recent_confirmed_transactions.contains(hash)) return true;
     }
 
+    if (include_reconsiderable && m_recent_rejects_reconsiderable.contains(hash)) return true;
+
     return m_recent_rejects.contains(hash) || m_mempool.exists(gtxid);
 }
 
@@ -2306,9 +2500,11 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
     }
     if (pblock) {
         if (inv.IsMsgBlk()) {
-            m_connman.PushMessage(&pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, *pblock));
+            auto block_msg{GetRecentBlockMessage(pindex->GetBlockHash(), RecentBlockMsg::BLOCK_NO_WITNESS)};
+            m_connman.PushMessage(&pfrom, block_msg ? std::move(*block_msg) : msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, *pblock));
         } else if (inv.IsMsgWitnessBlk()) {
-            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
+            auto block_msg{GetRecentBlockMessage(pindex->GetBlockHash(), RecentBlockMsg::BLOCK)};
+            m_connman.PushMessage(&pfrom, block_msg ? std::move(*block_msg) : msgMaker.Make(NetMsgType::BLOCK, *pblock));
         } else if (inv.IsMsgFilteredBlk()) {
             bool sendMerkleBlock = false;
             CMerkleBlock merkleBlock;
@@ -2339,14 +2535,17 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
             // and we don't feel like constructing the object for them, so
             // instead we respond with the full, non-compact block.
             if (CanDirectFetch() && pindex->nHeight >= m_chainman.ActiveChain().Height() - MAX_CMPCTBLOCK_DEPTH) {
-                if (a_recent_compact_block && a_recent_compact_block->header.GetHash() == pindex->GetBlockHash()) {
+                if (auto cmpctblock_msg{GetRecentBlockMessage(pindex->GetBlockHash(), RecentBlockMsg::CMPCTBLOCK)}) {
+                    m_connman.PushMessage(&pfrom, std::move(*cmpctblock_msg));
+                } else if (a_recent_compact_block && a_recent_compact_block->header.GetHash() == pindex->GetBlockHash()) {
                     m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::CMPCTBLOCK, *a_recent_compact_block));
                 } else {
                     CBlockHeaderAndShortTxIDs cmpctblock{*pblock};
                     m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::CMPCTBLOCK, cmpctblock));
                 }
             } else {
-                m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
+                auto block_msg{GetRecentBlockMessage(pindex->GetBlockHash(), RecentBlockMsg::BLOCK)};
+                m_connman.PushMessage(&pfrom, block_msg ? std::move(*block_msg) : msgMaker.Make(NetMsgType::BLOCK, *pblock));
             }
         }
     }
@@ -2993,6 +3192,109 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     return;
 }
 
+/**
+ * Whether a transaction was rejected only because its feerate is below the
+ * mempool minimum feerate, so that it may still be accepted as part of a
+ * package with a child paying for it. Individual transactions must always meet
+ * the minimum relay feerate, so that rejection is final.
+ */
+static bool IsReconsiderable(const TxValidationState& state)
+{
+    return state.GetResult() == TxValidationResult::TX_MEMPOOL_POLICY &&
+           state.GetRejectReason() == "mempool min fee not met";
+}
+
+/** Hash of the sorted wtxids of a package, used to remember rejected packages */
+static uint256 GetPackageHash(const Package& package)
+{
+    std::vector<uint256> wtxids;
+    wtxids.reserve(package.size());
+    for (const auto& tx : package) {
+        wtxids.push_back(tx->GetWitnessHash());
+    }
+    std::sort(wtxids.begin(), wtxids.end());
+    HashWriter hashwriter{};
+    for (const auto& wtxid : wtxids) {
+        hashwriter << wtxid;
+    }
+    return hashwriter.GetSHA256();
+}
+
+std::optional<PeerManagerImpl::PackageToValidate> PeerManagerImpl::Find1P1CPackage(const CTransactionRef& ptx, NodeId nodeid)
+{
+    AssertLockHeld(cs_main);
+
+    // Only the peer that announced the child is asked to provide the parent, so
+    // only pair the parent with that peer's orphans. This keeps a peer from
+    // making us validate packages built from other peers' transactions.
+    for (const CTransactionRef& child : m_orphanage.GetChildrenFromSamePeer(ptx, nodeid)) {
+        Package package{ptx, child};
+        if (m_recent_rejects_reconsiderable.contains(GetPackageHash(package))) continue;
+        return PackageToValidate{std::move(package), nodeid};
+    }
+    return std::nullopt;
+}
+
+void PeerManagerImpl::ProcessPackage(const PackageToValidate& package)
+{
+    AssertLockHeld(g_msgproc_mutex);
+    AssertLockHeld(cs_main);
+
+    LogPrint(BCLog::TXPACKAGES, "evaluating package %s\n", package.ToString());
+    const PackageMempoolAcceptResult result{ProcessNewPackage(m_chainman.ActiveChainstate(), m_mempool, package.m_txns, /*test_accept=*/false)};
+
+    for (const CTransactionRef& tx : package.m_txns) {
+        const auto it_result{result.m_tx_results.find(tx->GetWitnessHash())};
+        if (it_result == result.m_tx_results.end()) continue;
+        const MempoolAcceptResult& tx_result{it_result->second};
+        switch (tx_result.m_result_type) {
+        case MempoolAcceptResult::ResultType::VALID:
+            LogPrint(BCLog::MEMPOOL, "AcceptToMemoryPool: peer=%d: accepted %s (wtxid=%s) in package (poolsz %u txn, %u kB)\n",
+                package.m_peer,
+                tx->GetHash().ToString(),
+                tx->GetWitnessHash().ToString(),
+                m_mempool.size(), m_mempool.DynamicMemoryUsage() / 1000);
+            m_txrequest.ForgetTxHash(tx->GetHash());
+            m_txrequest.ForgetTxHash(tx->GetWitnessHash());
+            RelayTransaction(tx->GetHash(), tx->GetWitnessHash());
+            m_orphanage.AddChildrenToWorkSet(*tx);
+            m_orphanage.EraseTx(tx->GetHash());
+            for (const CTransactionRef& removedTx : tx_result.m_replaced_transactions.value()) {
+                AddToCompactExtraTransactions(removedTx);
+            }
+            break;
+        case MempoolAcceptResult::ResultType::INVALID: {
+            const TxValidationState& state{tx_result.m_state};
+            // Fee-related failures and the child's missing parent are expected when the
+            // package as a whole is rejected; only other failures are final.
+            if (IsReconsiderable(state) || state.GetResult() == TxValidationResult::TX_MISSING_INPUTS) break;
+            LogPrint(BCLog::MEMPOOLREJ, "%s (wtxid=%s) from peer=%d was not accepted in package: %s\n",
+                tx->GetHash().ToString(),
+                tx->GetWitnessHash().ToString(),
+                package.m_peer,
+                state.ToString());
+            if (state.GetResult() != TxValidationResult::TX_WITNESS_STRIPPED) {
+                m_recent_rejects.insert(tx->GetWitnessHash());
+            }
+            m_orphanage.EraseTx(tx->GetHash());
+            MaybePunishNodeForTx(package.m_peer, state);
+            break;
+        }
+        case MempoolAcceptResult::ResultType::MEMPOOL_ENTRY:
+        case MempoolAcceptResult::ResultType::DIFFERENT_WITNESS:
+            // Already in the mempool, e.g. the parent was accepted while the child was missing.
+            m_orphanage.EraseTx(tx->GetHash());
+            break;
+        }
+    }
+
+    if (result.m_state.IsInvalid()) {
+        LogPrint(BCLog::TXPACKAGES, "package rejected: %s (%s)\n", package.ToString(), result.m_state.ToString());
+        // Don't try this exact package again, but allow the parent to be paired with other children.
+        m_recent_rejects_reconsiderable.insert(GetPackageHash(package.m_txns));
+    }
+}
+
 bool PeerManagerImpl::ProcessOrphanTx(Peer& peer)
 {
     AssertLockHeld(g_msgproc_mutex);
@@ -3038,6 +3340,15 @@ bool PeerManagerImpl::ProcessOrphanTx(Peer& peer)
             // Has inputs but not accepted to mempool
             // Probably non-standard or insufficient fee
             LogPrint(BCLog::TXPACKAGES, "   removed orphan tx %s (wtxid=%s)\n", orphanHash.ToString(), orphan_wtxid.ToString());
+            if (IsReconsiderable(state)) {
+                // The orphan's own feerate is too low, but one of its own orphaned
+                // children may pay for it.
+                m_recent_rejects_reconsiderable.insert(orphan_wtxid);
+                auto package_to_validate{Find1P1CPackage(porphanTx, peer.m_id)};
+                m_orphanage.EraseTx(orphanHash);
+                if (package_to_validate) ProcessPackage(*package_to_validate);
+                return true;
+            }
             if (state.GetResult() != TxValidationResult::TX_WITNESS_STRIPPED) {
                 // We can add the wtxid of this transaction to our reject filter.
                 // Do not add txids of witness transactions or witness-stripped
@@ -3347,6 +3658,104 @@ void PeerManagerImpl::ProcessCompactBlockTxns(CNode& pfrom, Peer& peer, const Bl
     return;
 }
 
+bool PeerManagerImpl::IsConcurrentMessage(const std::string& msg_type)
+{
+    return msg_type == NetMsgType::PING || msg_type == NetMsgType::PONG || msg_type == NetMsgType::FEEFILTER;
+}
+
+void PeerManagerImpl::ProcessConcurrentMessage(CNode& pfrom, Peer& peer, const std::string& msg_type, CDataStream& vRecv,
+                                               std::chrono::microseconds time_received)
+{
+    const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
+
+    if (msg_type == NetMsgType::PING) {
+        if (pfrom.GetCommonVersion() > BIP0031_VERSION) {
+            uint64_t nonce = 0;
+            vRecv >> nonce;
+            // Echo the message back with the nonce. This allows for two useful features:
+            //
+            // 1) A remote node can quickly check if the connection is operational
+            // 2) Remote nodes can measure the latency of the network thread. If this node
+            //    is overloaded it won't respond to pings quickly and the remote node can
+            //    avoid sending us more work, like chain download requests.
+            //
+            // The nonce stops the remote getting confused between different pings: without
+            // it, if the remote node sends a ping once per second and this node takes 5
+            // seconds to respond to each, the 5th ping the remote sends would appear to
+            // return very quickly.
+            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::PONG, nonce));
+        }
+        return;
+    }
+
+    if (msg_type == NetMsgType::PONG) {
+        const auto ping_end = time_received;
+        uint64_t nonce = 0;
+        size_t nAvail = vRecv.in_avail();
+        bool bPingFinished = false;
+        std::string sProblem;
+
+        if (nAvail >= sizeof(nonce)) {
+            vRecv >> nonce;
+
+            // Only process pong message if there is an outstanding ping (old ping without nonce should never pong)
+            if (peer.m_ping_nonce_sent != 0) {
+                if (nonce == peer.m_ping_nonce_sent) {
+                    // Matching pong received, this ping is no longer outstanding
+                    bPingFinished = true;
+                    const auto ping_time = ping_end - peer.m_ping_start.load();
+                    if (ping_time.count() >= 0) {
+                        // Let connman know about this successful ping-pong
+                        pfrom.PongReceived(ping_time);
+                    } else {
+                        // This should never happen
+                        sProblem = "Timing mishap";
+                    }
+                } else {
+                    // Nonce mismatches are normal when pings are overlapping
+                    sProblem = "Nonce mismatch";
+                    if (nonce == 0) {
+                        // This is most likely a bug in another implementation somewhere; cancel this ping
+                        bPingFinished = true;
+                        sProblem = "Nonce zero";
+                    }
+                }
+            } else {
+                sProblem = "Unsolicited pong without ping";
+            }
+        } else {
+            // This is most likely a bug in another implementation somewhere; cancel this ping
+            bPingFinished = true;
+            sProblem = "Short payload";
+        }
+
+        if (!(sProblem.empty())) {
+            LogPrint(BCLog::NET, "pong peer=%d: %s, %x expected, %x received, %u bytes\n",
+                pfrom.GetId(),
+                sProblem,
+                peer.m_ping_nonce_sent,
+                nonce,
+                nAvail);
+        }
+        if (bPingFinished) {
+            peer.m_ping_nonce_sent = 0;
+        }
+        return;
+    }
+
+    if (msg_type == NetMsgType::FEEFILTER) {
+        CAmount newFeeFilter = 0;
+        vRecv >> newFeeFilter;
+        if (MoneyRange(newFeeFilter)) {
+            if (auto tx_relay = peer.GetTxRelay(); tx_relay != nullptr) {
+                tx_relay->m_fee_filter_received = newFeeFilter;
+            }
+            LogPrint(BCLog::NET, "received: feefilter of %s from peer=%d\n", CFeeRate(newFeeFilter).ToString(), pfrom.GetId());
+        }
+        return;
+    }
+}
+
 void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type, CDataStream& vRecv,
                                      const std::chrono::microseconds time_received,
                                      const std::atomic<bool>& interruptMsgProc)
@@ -3905,10 +4314,11 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                     return;
                 }
                 const GenTxid gtxid = ToGenTxid(inv);
-                const bool fAlreadyHave = AlreadyHaveTx(gtxid);
+                const bool fAlreadyHave = AlreadyHaveTx(gtxid, /*include_reconsiderable=*/true);
                 LogPrint(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
 
                 AddKnownTx(*peer, inv.hash);
+                if (m_txreconciliation && peer->m_wtxid_relay) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), inv.hash);
                 if (!fAlreadyHave && !m_chainman.IsInitialBlockDownload()) {
                     AddTxAnnouncement(pfrom, gtxid, current_time);
                 }
@@ -4192,6 +4602,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         const uint256& hash = peer->m_wtxid_relay ? wtxid : txid;
         AddKnownTx(*peer, hash);
+        if (m_txreconciliation && peer->m_wtxid_relay) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), wtxid);
 
         LOCK(cs_main);
 
@@ -4210,7 +4621,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         // already; and an adversary can already relay us old transactions
         // (older than our recency filter) if trying to DoS us, without any need
         // for witness malleation.
-        if (AlreadyHaveTx(GenTxid::Wtxid(wtxid))) {
+        if (AlreadyHaveTx(GenTxid::Wtxid(wtxid), /*include_reconsiderable=*/true)) {
             if (pfrom.HasPermission(NetPermissionFlags::ForceRelay)) {
                 // Always relay transactions received from peers with forcerelay
                 // permission, even if they were already in the mempool, allowing
@@ -4239,6 +4650,15 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // due to node policy (vs. consensus). So we can't blanket penalize a
             // peer simply for relaying a tx that our m_recent_rejects has caught,
             // regardless of false positives.
+
+            if (m_recent_rejects_reconsiderable.contains(wtxid)) {
+                // This tx was rejected for its feerate alone, so don't validate it by
+                // itself again. It was likely re-requested as the missing parent of an
+                // orphan, so try it together with a child from this peer.
+                if (auto package_to_validate{Find1P1CPackage(ptx, pfrom.GetId())}) {
+                    ProcessPackage(*package_to_validate);
+                }
+            }
             return;
         }
 
@@ -4265,6 +4685,19 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 AddToCompactExtraTransactions(removedTx);
             }
         }
+        else if (IsReconsiderable(state))
+        {
+            // The tx may still be accepted with a child paying for it. Keep it out of
+            // m_recent_rejects so that an orphan naming it as a parent can fetch it again.
+            m_recent_rejects_reconsiderable.insert(tx.GetWitnessHash());
+            m_txrequest.ForgetTxHash(tx.GetWitnessHash());
+            if (RecursiveDynamicUsage(*ptx) < 100000) {
+                AddToCompactExtraTransactions(ptx);
+            }
+            if (auto package_to_validate{Find1P1CPackage(ptx, pfrom.GetId())}) {
+                ProcessPackage(*package_to_validate);
+            }
+        }
         else if (state.GetResult() == TxValidationResult::TX_MISSING_INPUTS)
         {
             bool fRejectedParents = false; // It may be the case that the orphans parents have all been rejected
@@ -4296,7 +4729,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                     // protocol for getting all unconfirmed parents.
                     const auto gtxid{GenTxid::Txid(parent_txid)};
                     AddKnownTx(*peer, parent_txid);
-                    if (!AlreadyHaveTx(gtxid)) AddTxAnnouncement(pfrom, gtxid, current_time);
+                    if (!AlreadyHaveTx(gtxid, /*include_reconsiderable=*/false)) AddTxAnnouncement(pfrom, gtxid, current_time);
                 }
 
                 if (m_orphanage.AddTx(ptx, pfrom.GetId())) {
@@ -4308,7 +4741,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 m_txrequest.ForgetTxHash(tx.GetWitnessHash());
 
                 // DoS prevention: do not allow m_orphanage to grow unbounded (see CVE-2012-3789)
-                m_orphanage.LimitOrphans(m_opts.max_orphan_txs);
+                m_orphanage.LimitOrphans(m_opts.max_orphan_txs, m_opts.max_orphan_usage);
             } else {
                 LogPrint(BCLog::MEMPOOL, "not keeping orphan with rejected parents %s (wtxid=%s)\n",
                          tx.GetHash().ToString(),
@@ -4684,6 +5117,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
+        const size_t block_size{vRecv.size()};
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
         vRecv >> *pblock;
 
@@ -4697,6 +5131,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            RecordBlockDownload(pfrom.GetId(), hash, block_size);
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -4779,78 +5214,8 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
-    if (msg_type == NetMsgType::PING) {
-        if (pfrom.GetCommonVersion() > BIP0031_VERSION) {
-            uint64_t nonce = 0;
-            vRecv >> nonce;
-            // Echo the message back with the nonce. This allows for two useful features:
-            //
-            // 1) A remote node can quickly check if the connection is operational
-            // 2) Remote nodes can measure the latency of the network thread. If this node
-            //    is overloaded it won't respond to pings quickly and the remote node can
-            //    avoid sending us more work, like chain download requests.
-            //
-            // The nonce stops the remote getting confused between different pings: without
-            // it, if the remote node sends a ping once per second and this node takes 5
-            // seconds to respond to each, the 5th ping the remote sends would appear to
-            // return very quickly.
-            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::PONG, nonce));
-        }
-        return;
-    }
-
-    if (msg_type == NetMsgType::PONG) {
-        const auto ping_end = time_received;
-        uint64_t nonce = 0;
-        size_t nAvail = vRecv.in_avail();
-        bool bPingFinished = false;
-        std::string sProblem;
-
-        if (nAvail >= sizeof(nonce)) {
-            vRecv >> nonce;
-
-            // Only process pong message if there is an outstanding ping (old ping without nonce should never pong)
-            if (peer->m_ping_nonce_sent != 0) {
-                if (nonce == peer->m_ping_nonce_sent) {
-                    // Matching pong received, this ping is no longer outstanding
-                    bPingFinished = true;
-                    const auto ping_time = ping_end - peer->m_ping_start.load();
-                    if (ping_time.count() >= 0) {
-                        // Let connman know about this successful ping-pong
-                        pfrom.PongReceived(ping_time);
-                    } else {
-                        // This should never happen
-                        sProblem = "Timing mishap";
-                    }
-                } else {
-                    // Nonce mismatches are normal when pings are overlapping
-                    sProblem = "Nonce mismatch";
-                    if (nonce == 0) {
-                        // This is most likely a bug in another implementation somewhere; cancel this ping
-                        bPingFinished = true;
-                        sProblem = "Nonce zero";
-                    }
-                }
-            } else {
-                sProblem = "Unsolicited pong without ping";
-            }
-        } else {
-            // This is most likely a bug in another implementation somewhere; cancel this ping
-            bPingFinished = true;
-            sProblem = "Short payload";
-        }
-
-        if (!(sProblem.empty())) {
-            LogPrint(BCLog::NET, "pong peer=%d: %s, %x expected, %x received, %u bytes\n",
-                pfrom.GetId(),
-                sProblem,
-                peer->m_ping_nonce_sent,
-                nonce,
-                nAvail);
-        }
-        if (bPingFinished) {
-            peer->m_ping_nonce_sent = 0;
-        }
+    if (IsConcurrentMessage(msg_type)) {
+        ProcessConcurrentMessage(pfrom, *peer, msg_type, vRecv, time_received);
         return;
     }
 
@@ -4926,18 +5291,6 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
-    if (msg_type == NetMsgType::FEEFILTER) {
-        CAmount newFeeFilter = 0;
-        vRecv >> newFeeFilter;
-        if (MoneyRange(newFeeFilter)) {
-            if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
-                tx_relay->m_fee_filter_received = newFeeFilter;
-            }
-            LogPrint(BCLog::NET, "received: feefilter of %s from peer=%d\n", CFeeRate(newFeeFilter).ToString(), pfrom.GetId());
-        }
-        return;
-    }
-
     if (msg_type == NetMsgType::GETCFILTERS) {
         ProcessGetCFilters(pfrom, *peer, vRecv);
         return;
@@ -4956,7 +5309,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
     if (msg_type == NetMsgType::NOTFOUND) {
         std::vector<CInv> vInv;
         vRecv >> vInv;
-        if (vInv.size() <= MAX_PEER_TX_ANNOUNCEMENTS + MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        if (vInv.size() <= MAX_PEER_TX_ANNOUNCEMENTS + MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE) {
             LOCK(::cs_main);
             for (CInv &inv : vInv) {
                 if (inv.IsGenTxMsg()) {
@@ -4969,6 +5322,76 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    // Reconciliation rounds (BIP-330). The initiator sends reqrecon, the responder answers with a
+    // sketch of its set, and the initiator decodes the difference against its own set. If that
+    // fails it asks for an extension once, and either way ends the round with reconcildiff.
+    if (msg_type == NetMsgType::REQRECON) {
+        if (!m_txreconciliation) return;
+        uint16_t peer_set_size, peer_q;
+        vRecv >> peer_set_size >> peer_q;
+        const auto sketch{m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), peer_set_size, peer_q)};
+        if (!sketch) {
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected reqrecon); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::SKETCH, *sketch));
+        return;
+    }
+
+    if (msg_type == NetMsgType::SKETCH) {
+        if (!m_txreconciliation) return;
+        std::vector<uint8_t> skdata;
+        vRecv >> skdata;
+        auto result{m_txreconciliation->HandleSketch(pfrom.GetId(), skdata)};
+        switch (result.status) {
+        case ReconciliationSketchResult::Status::PROTOCOL_VIOLATION:
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected sketch); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        case ReconciliationSketchResult::Status::NEED_EXTENSION:
+            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::REQSKETCHEXT));
+            return;
+        case ReconciliationSketchResult::Status::SUCCESS:
+        case ReconciliationSketchResult::Status::FAILURE: {
+            const uint8_t success = result.status == ReconciliationSketchResult::Status::SUCCESS;
+            m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::RECONCILDIFF, success, result.missing));
+            AnnounceReconciledTransactions(pfrom, *peer, result.to_announce);
+            return;
+        }
+        }
+        return;
+    }
+
+    if (msg_type == NetMsgType::REQSKETCHEXT) {
+        if (!m_txreconciliation) return;
+        const auto extension{m_txreconciliation->HandleSketchExtensionRequest(pfrom.GetId())};
+        if (!extension) {
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected reqsketchext); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::SKETCH, *extension));
+        return;
+    }
+
+    if (msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation) return;
+        uint8_t success;
+        std::vector<uint32_t> ask_shortids;
+        vRecv >> success >> ask_shortids;
+        const auto to_announce{ask_shortids.size() <= MAX_SKETCH_CAPACITY ?
+                                   m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success, ask_shortids) :
+                                   std::nullopt};
+        if (!to_announce) {
+            LogPrintLevel(BCLog::NET, BCLog::Level::Debug, "txreconciliation protocol violation from peer=%d (unexpected reconcildiff); disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        AnnounceReconciledTransactions(pfrom, *peer, *to_announce);
+        return;
+    }
+
     // Ignore unknown commands for extensibility
     LogPrint(BCLog::NET, "Unknown command \"%s\" from peer=%d\n", SanitizeString(msg_type), pfrom.GetId());
     return;
@@ -5027,7 +5450,11 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
         }
     }
 
+    const auto orphan_start{SteadyClock::now()};
+    const uint64_t orphan_sig_checks_start{GetThreadSignatureChecks()};
     const bool processed_orphan = ProcessOrphanTx(*peer);
+    // Reconsidering an orphan is deferred work for the tx message that provided it.
+    if (processed_orphan) RecordMessageProcessing(*pfrom, NetMsgType::TX, orphan_start, orphan_sig_checks_start);
 
     if (pfrom->fDisconnect)
         return false;
@@ -5053,21 +5480,12 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     CNetMessage& msg{poll_result->first};
     bool fMoreWork = poll_result->second;
 
-    TRACE6(net, inbound_message,
-        pfrom->GetId(),
-        pfrom->m_addr_name.c_str(),
-        pfrom->ConnectionTypeAsString().c_str(),
-        msg.m_type.c_str(),
-        msg.m_recv.size(),
-        msg.m_recv.data()
-    );
-
-    if (m_opts.capture_messages) {
-        CaptureMessage(pfrom->addr, msg.m_type, MakeUCharSpan(msg.m_recv), /*is_incoming=*/true);
-    }
+    RecordInboundMessage(*pfrom, msg);
 
     msg.SetVersion(pfrom->GetCommonVersion());
 
+    const auto start{SteadyClock::now()};
+    const uint64_t sig_checks_start{GetThreadSignatureChecks()};
     try {
         ProcessMessage(*pfrom, msg.m_type, msg.m_recv, msg.m_time, interruptMsgProc);
         if (interruptMsgProc) return false;
@@ -5086,10 +5504,81 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     } catch (...) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size);
     }
+    RecordMessageProcessing(*pfrom, msg.m_type, start, sig_checks_start);
 
     return fMoreWork;
 }
 
+bool PeerManagerImpl::ProcessConcurrentMessages(CNode* pfrom)
+{
+    PeerRef peer = GetPeerRef(pfrom->GetId());
+    if (peer == nullptr) return false;
+
+    // Messages are handled in the order they were received. Only take the
+    // message at the front of the queue, and only if nothing received earlier
+    // still has work pending in ProcessMessages().
+    if (!pfrom->fSuccessfullyConnected || pfrom->fDisconnect || pfrom->fPauseSend) return false;
+    {
+        LOCK(peer->m_getdata_requests_mutex);
+        if (!peer->m_getdata_requests.empty()) return false;
+    }
+    if (m_orphanage.HaveTxToReconsider(peer->m_id)) return false;
+
+    auto poll_result{pfrom->PollMessage(IsConcurrentMessage)};
+    if (!poll_result) return false;
+
+    CNetMessage& msg{poll_result->first};
+    RecordInboundMessage(*pfrom, msg);
+    msg.SetVersion(pfrom->GetCommonVersion());
+
+    const auto start{SteadyClock::now()};
+    const uint64_t sig_checks_start{GetThreadSignatureChecks()};
+    try {
+        LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(msg.m_type), msg.m_recv.size(), pfrom->GetId());
+        ProcessConcurrentMessage(*pfrom, *peer, msg.m_type, msg.m_recv, msg.m_time);
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size, e.what(), typeid(e).name());
+    } catch (...) {
+        LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size);
+    }
+
+    RecordMessageProcessing(*pfrom, msg.m_type, start, sig_checks_start);
+
+    return poll_result->second;
+}
+
+void PeerManagerImpl::RecordInboundMessage(const CNode& pfrom, const CNetMessage& msg) const
+{
+    TRACE6(net, inbound_message,
+        pfrom.GetId(),
+        pfrom.m_addr_name.c_str(),
+        pfrom.ConnectionTypeAsString().c_str(),
+        msg.m_type.c_str(),
+        msg.m_recv.size(),
+        msg.m_recv.data()
+    );
+
+    if (m_opts.capture_messages) {
+        CaptureMessage(pfrom.addr, msg.m_type, MakeUCharSpan(msg.m_recv), /*is_incoming=*/true);
+    }
+}
+
+void PeerManagerImpl::RecordMessageProcessing(CNode& pfrom, const std::string& msg_type, SteadyClock::time_point start, uint64_t sig_checks_start) const
+{
+    const auto time{std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - start)};
+    const uint64_t sig_checks{GetThreadSignatureChecks() - sig_checks_start};
+    pfrom.AccountMessageProcessing(msg_type, time, sig_checks);
+
+    TRACE6(net, processed_message,
+        pfrom.GetId(),
+        pfrom.m_addr_name.c_str(),
+        pfrom.ConnectionTypeAsString().c_str(),
+        msg_type.c_str(),
+        time.count(),
+        sig_checks
+    );
+}
+
 void PeerManagerImpl::ConsiderEviction(CNode& pto, Peer& peer, std::chrono::seconds time_in_seconds)
 {
     AssertLockHeld(cs_main);
@@ -5414,6 +5903,34 @@ void PeerManagerImpl::MaybeSendSendHeaders(CNode& node, Peer& peer)
     }
 }
 
+void PeerManagerImpl::MaybeRequestReconciliation(CNode& node, std::chrono::microseconds current_time)
+{
+    if (!m_txreconciliation) return;
+    const auto request{m_txreconciliation->InitiateReconciliationRequest(node.GetId(), current_time)};
+    if (!request) return;
+    m_connman.PushMessage(&node, CNetMsgMaker(node.GetCommonVersion()).Make(NetMsgType::REQRECON, request->set_size, request->q));
+}
+
+void PeerManagerImpl::AnnounceReconciledTransactions(CNode& node, Peer& peer, const std::vector<uint256>& wtxids)
+{
+    auto tx_relay = peer.GetTxRelay();
+    if (!tx_relay || wtxids.empty()) return;
+
+    const CNetMsgMaker msgMaker(node.GetCommonVersion());
+    std::vector<CInv> vInv;
+    LOCK(tx_relay->m_tx_inventory_mutex);
+    for (const uint256& wtxid : wtxids) {
+        if (!m_mempool.exists(GenTxid::Wtxid(wtxid))) continue;
+        tx_relay->m_tx_inventory_known_filter.insert(wtxid);
+        vInv.emplace_back(MSG_WTX, wtxid);
+        if (vInv.size() == MAX_INV_SZ) {
+            m_connman.PushMessage(&node, msgMaker.Make(NetMsgType::INV, vInv));
+            vInv.clear();
+        }
+    }
+    if (!vInv.empty()) m_connman.PushMessage(&node, msgMaker.Make(NetMsgType::INV, vInv));
+}
+
 void PeerManagerImpl::MaybeSendFeefilter(CNode& pto, Peer& peer, std::chrono::microseconds current_time)
 {
     if (m_opts.ignore_incoming_txs) return;
@@ -5673,13 +6190,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", __func__,
                             vHeaders.front().GetHash().ToString(), pto->GetId());
 
-                    std::optional<CSerializedNetMsg> cached_cmpctblock_msg;
-                    {
-                        LOCK(m_most_recent_block_mutex);
-                        if (m_most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                            cached_cmpctblock_msg = msgMaker.Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block);
-                        }
-                    }
+                    auto cached_cmpctblock_msg{GetRecentBlockMessage(pBestIndex->GetBlockHash(), RecentBlockMsg::CMPCTBLOCK)};
                     if (cached_cmpctblock_msg.has_value()) {
                         m_connman.PushMessage(pto, std::move(cached_cmpctblock_msg.value()));
                     } else {
@@ -5700,7 +6211,10 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         LogPrint(BCLog::NET, "%s: sending header %s to peer=%d\n", __func__,
                                 vHeaders.front().GetHash().ToString(), pto->GetId());
                     }
-                    m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::HEADERS, vHeaders));
+                    // A new block is usually announced on its own, to every peer.
+                    std::optional<CSerializedNetMsg> cached_headers_msg;
+                    if (vHeaders.size() == 1) cached_headers_msg = GetRecentBlockMessage(pBestIndex->GetBlockHash(), RecentBlockMsg::HEADERS);
+                    m_connman.PushMessage(pto, cached_headers_msg ? std::move(*cached_headers_msg) : msgMaker.Make(NetMsgType::HEADERS, vHeaders));
                     state.pindexBestHeaderSent = pBestIndex;
                 } else
                     fRevertToInv = true;
@@ -5815,6 +6329,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     // No reason to drain out at many times the network's capacity,
                     // especially since we have many peers and some will draw much shorter delays.
                     unsigned int nRelayedTransactions = 0;
+                    const bool reconcile{m_txreconciliation && m_txreconciliation->IsPeerRegistered(pto->GetId())};
                     LOCK(tx_relay->m_bloom_filter_mutex);
                     size_t broadcast_max{INVENTORY_BROADCAST_TARGET + (tx_relay->m_tx_inventory_to_send.size()/1000)*5};
                     broadcast_max = std::min<size_t>(INVENTORY_BROADCAST_MAX, broadcast_max);
@@ -5841,6 +6356,13 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                             continue;
                         }
                         if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        // Leave all but a fanout fraction to the next reconciliation round, unless
+                        // the peer's reconciliation set is full.
+                        if (reconcile && !m_txreconciliation->ShouldFanoutTo(pto->GetId(), hash) &&
+                            m_txreconciliation->AddToSet(pto->GetId(), hash)) {
+                            tx_relay->m_tx_inventory_known_filter.insert(hash);
+                            continue;
+                        }
                         // Send
                         vInv.push_back(inv);
                         nRelayedTransactions++;
@@ -5930,11 +6452,12 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        const int max_blocks_in_flight{GetBlocksInFlightLimit(*pto, state)};
+        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < size_t(max_blocks_in_flight)) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            auto get_inflight_budget = [&state]() {
-                return std::max(0, MAX_BLOCKS_IN_TRANSIT_PER_PEER - static_cast<int>(state.vBlocksInFlight.size()));
+            auto get_inflight_budget = [&state, max_blocks_in_flight]() {
+                return std::max(0, max_blocks_in_flight - static_cast<int>(state.vBlocksInFlight.size()));
             };
 
             // If a snapshot chainstate is in use, we want to find its next blocks
@@ -5972,7 +6495,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                 entry.second.GetHash().ToString(), entry.first);
         }
         for (const GenTxid& gtxid : requestable) {
-            if (!AlreadyHaveTx(gtxid)) {
+            if (!AlreadyHaveTx(gtxid, /*include_reconsiderable=*/false)) {
                 LogPrint(BCLog::NET, "Requesting %s %s peer=%d\n", gtxid.IsWtxid() ? "wtx" : "tx",
                     gtxid.GetHash().ToString(), pto->GetId());
                 vGetData.emplace_back(gtxid.IsWtxid() ? MSG_WTX : (MSG_TX | GetFetchFlags(*peer)), gtxid.GetHash());
@@ -5987,11 +6510,14 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                 m_txrequest.ForgetTxHash(gtxid.GetHash());
             }
         }
+        // Keep the memory held on behalf of this peer current for inbound peer eviction.
+        pto->m_relay_memusage = m_orphanage.UsageByPeer(pto->GetId()) + m_txrequest.UsageByPeer(pto->GetId());
 
 
         if (!vGetData.empty())
             m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::GETDATA, vGetData));
     } // release cs_main
     MaybeSendFeefilter(*pto, *peer, current_time);
+    MaybeRequestReconciliation(*pto, current_time);
     return true;
 }
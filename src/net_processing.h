@@ -17,12 +17,16 @@ class ChainstateManager;
 /** Whether transaction reconciliation protocol should be enabled by default. */
 static constexpr bool DEFAULT_TXRECONCILIATION_ENABLE{false};
 /** Default for -maxorphantx, maximum number of orphan transactions kept in memory */
-static const uint32_t DEFAULT_MAX_ORPHAN_TRANSACTIONS{100};
+static const uint32_t DEFAULT_MAX_ORPHAN_TRANSACTIONS{1000};
+/** Default for -maxorphanmem, maximum memory used by orphan transactions in megabytes */
+static const uint32_t DEFAULT_MAX_ORPHAN_MEMORY_MB{10};
 /** Default number of non-mempool transactions to keep around for block reconstruction. Includes
     orphan, replaced, and rejected transactions. */
 static const uint32_t DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN{100};
 static const bool DEFAULT_PEERBLOOMFILTERS = false;
 static const bool DEFAULT_PEERBLOCKFILTERS = false;
+/** Default for -adaptiveblockdownload */
+static const bool DEFAULT_ADAPTIVE_BLOCK_DOWNLOAD{true};
 /** Threshold for marking a node to be discouraged, e.g. disconnected and added to the discouragement filter. */
 static const int DISCOURAGEMENT_THRESHOLD{100};
 /** Maximum number of outstanding CMPCTBLOCK requests for the same block. */
@@ -41,6 +45,8 @@ struct CNodeStateStats {
     bool m_addr_relay_enabled{false};
     ServiceFlags their_services;
     int64_t presync_height{-1};
+    size_t m_orphan_usage{0};
+    size_t m_txrequest_usage{0};
 };
 
 class PeerManager : public CValidationInterface, public NetEventsInterface
@@ -53,11 +59,16 @@ public:
         bool reconcile_txs{DEFAULT_TXRECONCILIATION_ENABLE};
         //! Maximum number of orphan transactions kept in memory
         uint32_t max_orphan_txs{DEFAULT_MAX_ORPHAN_TRANSACTIONS};
+        //! Maximum memory used by orphan transactions, in bytes
+        size_t max_orphan_usage{DEFAULT_MAX_ORPHAN_MEMORY_MB * 1'000'000};
         //! Number of non-mempool transactions to keep around for block reconstruction. Includes
         //! orphan, replaced, and rejected transactions.
         uint32_t max_extra_txs{DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN};
         //! Whether all P2P messages are captured to disk
         bool capture_messages{false};
+        //! Whether the block download window and per-peer in-flight limits adapt to
+        //! measured block sizes, download rates and round-trip times
+        bool adaptive_block_download{DEFAULT_ADAPTIVE_BLOCK_DOWNLOAD};
         //! Whether or not the internal RNG behaves deterministically (this is
         //! a test-only option).
         bool deterministic_rng{false};
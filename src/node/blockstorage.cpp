@@ -7,6 +7,7 @@
 #include <chain.h>
 #include <clientversion.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <dbwrapper.h>
 #include <flatfile.h>
 #include <hash.h>
@@ -22,11 +23,13 @@
 #include <undo.h>
 #include <util/batchpriority.h>
 #include <util/fs.h>
+#include <util/lz4.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <array>
 #include <map>
 #include <unordered_map>
 
@@ -947,7 +950,34 @@ bool BlockManager::FindUndoPos(BlockValidationState& state, int nFile, FlatFileP
     return true;
 }
 
-bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
+std::optional<std::vector<std::byte>> CompressBlockData(Span<const std::byte> block)
+{
+    std::vector<std::byte> data(sizeof(uint32_t));
+    WriteLE32(UCharCast(data.data()), block.size());
+    util::LZ4Compress(block, data);
+    if (data.size() >= block.size()) return std::nullopt;
+    return data;
+}
+
+bool DecompressBlockData(Span<const std::byte> data, std::vector<uint8_t>& block)
+{
+    if (data.size() < sizeof(uint32_t)) return false;
+    const uint32_t size{ReadLE32(UCharCast(data.data()))};
+    if (size > MAX_SIZE) return false;
+    block.resize(size);
+    return util::LZ4Decompress(data.subspan(sizeof(uint32_t)), MakeWritableByteSpan(block));
+}
+
+bool DecompressBlockHeader(Span<const std::byte> data, CBlockHeader& header)
+{
+    if (data.size() < sizeof(uint32_t)) return false;
+    std::array<uint8_t, 80> header_data; // serialized size of a block header
+    if (!util::LZ4DecompressPrefix(data.subspan(sizeof(uint32_t)), MakeWritableByteSpan(header_data))) return false;
+    SpanReader{CLIENT_VERSION, header_data} >> header;
+    return true;
+}
+
+bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, Span<const std::byte> compressed) const
 {
     // Open history file to append
     CAutoFile fileout{OpenBlockFile(pos)};
@@ -956,7 +986,7 @@ bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
     }
 
     // Write index header
-    unsigned int nSize = GetSerializeSize(block, fileout.GetVersion());
+    unsigned int nSize = compressed.empty() ? GetSerializeSize(block, fileout.GetVersion()) : compressed.size() | BLOCK_COMPRESSED_FLAG;
     fileout << GetParams().MessageStart() << nSize;
 
     // Write block
@@ -965,7 +995,11 @@ bool BlockManager::WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const
         return error("WriteBlockToDisk: ftell failed");
     }
     pos.nPos = (unsigned int)fileOutPos;
-    fileout << block;
+    if (compressed.empty()) {
+        fileout << block;
+    } else {
+        fileout.write(compressed);
+    }
 
     return true;
 }
@@ -1015,15 +1049,38 @@ bool BlockManager::ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) cons
 {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein{OpenBlockFile(pos, true)};
+    if (pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE) {
+        return error("ReadBlockFromDisk: No block header before %s", pos.ToString());
+    }
+
+    // Open history file to read, at the header telling how the block is stored
+    FlatFilePos hpos{pos};
+    hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    CAutoFile filein{OpenBlockFile(hpos, true)};
     if (filein.IsNull()) {
         return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
     }
 
     // Read block
     try {
-        filein >> block;
+        MessageStartChars blk_start;
+        uint32_t blk_size;
+        filein >> blk_start >> blk_size;
+        if (blk_size & BLOCK_COMPRESSED_FLAG) {
+            blk_size &= ~BLOCK_COMPRESSED_FLAG;
+            if (blk_size > MAX_SIZE) {
+                return error("%s: Block data is larger than maximum deserialization size for %s", __func__, pos.ToString());
+            }
+            std::vector<std::byte> data(blk_size);
+            filein.read(data);
+            std::vector<uint8_t> block_data;
+            if (!DecompressBlockData(data, block_data)) {
+                return error("%s: Failed to decompress block at %s", __func__, pos.ToString());
+            }
+            SpanReader{filein.GetVersion(), block_data} >> block;
+        } else {
+            filein >> block;
+        }
     } catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
@@ -1076,13 +1133,24 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
                          HexStr(GetParams().MessageStart()));
         }
 
+        const bool compressed{(blk_size & BLOCK_COMPRESSED_FLAG) != 0};
+        blk_size &= ~BLOCK_COMPRESSED_FLAG;
+
         if (blk_size > MAX_SIZE) {
             return error("%s: Block data is larger than maximum deserialization size for %s: %s versus %s", __func__, pos.ToString(),
                          blk_size, MAX_SIZE);
         }
 
-        block.resize(blk_size); // Zeroing of memory is intentional here
-        filein.read(MakeWritableByteSpan(block));
+        if (compressed) {
+            std::vector<std::byte> data(blk_size);
+            filein.read(data);
+            if (!DecompressBlockData(data, block)) {
+                return error("%s: Failed to decompress block at %s", __func__, pos.ToString());
+            }
+        } else {
+            block.resize(blk_size); // Zeroing of memory is intentional here
+            filein.read(MakeWritableByteSpan(block));
+        }
     } catch (const std::exception& e) {
         return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
     }
@@ -1090,14 +1158,55 @@ bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatF
     return true;
 }
 
+bool BlockManager::ReadBlockDataSize(const FlatFilePos& pos, uint32_t& size, bool& compressed) const
+{
+    if (pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE) {
+        return error("%s: No block header before %s", __func__, pos.ToString());
+    }
+    FlatFilePos hpos = pos;
+    hpos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    CAutoFile filein{OpenBlockFile(hpos, true)};
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+    }
+
+    try {
+        MessageStartChars blk_start;
+        filein >> blk_start >> size;
+        if (blk_start != GetParams().MessageStart()) {
+            return error("%s: Block magic mismatch for %s", __func__, pos.ToString());
+        }
+    } catch (const std::exception& e) {
+        return error("%s: Read from block file failed: %s for %s", __func__, e.what(), pos.ToString());
+    }
+    compressed = (size & BLOCK_COMPRESSED_FLAG) != 0;
+    size &= ~BLOCK_COMPRESSED_FLAG;
+    return true;
+}
+
 FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, const FlatFilePos* dbp)
 {
     unsigned int nBlockSize = ::GetSerializeSize(block, CLIENT_VERSION);
+    std::optional<std::vector<std::byte>> compressed;
     FlatFilePos blockPos;
     const auto position_known {dbp != nullptr};
     if (position_known) {
         blockPos = *dbp;
+        // a block found in the blk files (-reindex) takes the space of the data stored for it, which is smaller than
+        // the serialized block if it is compressed.
+        uint32_t stored_size;
+        bool stored_compressed;
+        if (ReadBlockDataSize(blockPos, stored_size, stored_compressed) && stored_compressed) {
+            nBlockSize = stored_size;
+        }
     } else {
+        if (m_opts.compress_blocks) {
+            std::vector<unsigned char> block_data;
+            block_data.reserve(nBlockSize);
+            CVectorWriter{CLIENT_VERSION, block_data, 0} << block;
+            compressed = CompressBlockData(MakeByteSpan(block_data));
+            if (compressed) nBlockSize = compressed->size();
+        }
         // when known, blockPos.nPos points at the offset of the block data in the blk file. that already accounts for
         // the serialization header present in the file (the 4 magic message start bytes + the 4 length bytes = 8 bytes = BLOCK_SERIALIZATION_HEADER_SIZE).
         // we add BLOCK_SERIALIZATION_HEADER_SIZE only for new blocks since they will have the serialization header added when written to disk.
@@ -1108,7 +1217,7 @@ FlatFilePos BlockManager::SaveBlockToDisk(const CBlock& block, int nHeight, cons
         return FlatFilePos();
     }
     if (!position_known) {
-        if (!WriteBlockToDisk(block, blockPos)) {
+        if (!WriteBlockToDisk(block, blockPos, compressed ? Span<const std::byte>{*compressed} : Span<const std::byte>{})) {
             m_opts.notifications.fatalError("Failed to write block");
             return FlatFilePos();
         }
@@ -1142,26 +1251,34 @@ void ImportBlocks(ChainstateManager& chainman, std::vector<fs::path> vImportFile
 
         // -reindex
         if (fReindex) {
-            int nFile = 0;
             // Map of disk positions for blocks with unknown parent (only used for reindex);
             // parent hash -> child disk position, multiple children can have the same parent.
             std::multimap<uint256, FlatFilePos> blocks_with_unknown_parent;
-            while (true) {
-                FlatFilePos pos(nFile, 0);
-                if (!fs::exists(chainman.m_blockman.GetBlockPosFilename(pos))) {
-                    break; // No block files left to reindex
-                }
-                CAutoFile file{chainman.m_blockman.OpenBlockFile(pos, true)};
-                if (file.IsNull()) {
-                    break; // This error is logged in OpenBlockFile
-                }
-                LogPrintf("Reindexing block file blk%05u.dat...\n", (unsigned int)nFile);
-                chainman.LoadExternalBlockFile(file, &pos, &blocks_with_unknown_parent);
+            if (chainman.m_options.reindex_threads > 1) {
+                chainman.LoadBlockFiles(blocks_with_unknown_parent);
                 if (chainman.m_interrupt) {
                     LogPrintf("Interrupt requested. Exit %s\n", __func__);
                     return;
                 }
-                nFile++;
+            } else {
+                int nFile = 0;
+                while (true) {
+                    FlatFilePos pos(nFile, 0);
+                    if (!fs::exists(chainman.m_blockman.GetBlockPosFilename(pos))) {
+                        break; // No block files left to reindex
+                    }
+                    CAutoFile file{chainman.m_blockman.OpenBlockFile(pos, true)};
+                    if (file.IsNull()) {
+                        break; // This error is logged in OpenBlockFile
+                    }
+                    LogPrintf("Reindexing block file blk%05u.dat...\n", (unsigned int)nFile);
+                    chainman.LoadExternalBlockFile(file, &pos, &blocks_with_unknown_parent);
+                    if (chainman.m_interrupt) {
+                        LogPrintf("Interrupt requested. Exit %s\n", __func__);
+                        return;
+                    }
+                    nFile++;
+                }
             }
             WITH_LOCK(::cs_main, chainman.m_blockman.m_block_tree_db->WriteReindexing(false));
             fReindex = false;
@@ -13,6 +13,7 @@
 #include <kernel/chainparams.h>
 #include <kernel/cs_main.h>
 #include <kernel/messagestartchars.h>
+#include <span.h>
 #include <sync.h>
 #include <util/fs.h>
 #include <util/hasher.h>
@@ -23,6 +24,7 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -32,6 +34,7 @@
 class BlockValidationState;
 class CAutoFile;
 class CBlock;
+class CBlockHeader;
 class CBlockUndo;
 class CChainParams;
 class Chainstate;
@@ -76,6 +79,21 @@ static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 /** Size of header written by WriteBlockToDisk before a serialized CBlock */
 static constexpr size_t BLOCK_SERIALIZATION_HEADER_SIZE = std::tuple_size_v<MessageStartChars> + sizeof(unsigned int);
 
+/**
+ * Set in the size of the header written by WriteBlockToDisk when the block is
+ * stored compressed. The data is then the size of the serialized block, as 4
+ * bytes, followed by the block compressed in the LZ4 block format. Each block
+ * is compressed on its own, so it can be read without the ones around it.
+ */
+static constexpr uint32_t BLOCK_COMPRESSED_FLAG{1U << 31};
+
+/** Compress a serialized block. Returns the data to store, or nothing if compression does not make it smaller. */
+std::optional<std::vector<std::byte>> CompressBlockData(Span<const std::byte> block);
+/** Decompress the data of a block stored with BLOCK_COMPRESSED_FLAG. */
+[[nodiscard]] bool DecompressBlockData(Span<const std::byte> data, std::vector<uint8_t>& block);
+/** Decompress only the header of a block stored with BLOCK_COMPRESSED_FLAG. */
+[[nodiscard]] bool DecompressBlockHeader(Span<const std::byte> data, CBlockHeader& header);
+
 extern std::atomic_bool fReindex;
 
 // Because validation code takes pointers to the map's CBlockIndex objects, if
@@ -164,7 +182,8 @@ private:
 
     CAutoFile OpenUndoFile(const FlatFilePos& pos, bool fReadOnly = false) const;
 
-    bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos) const;
+    /** Write a block, or its compressed data if not empty. */
+    bool WriteBlockToDisk(const CBlock& block, FlatFilePos& pos, Span<const std::byte> compressed = {}) const;
     bool UndoWriteToDisk(const CBlockUndo& blockundo, FlatFilePos& pos, const uint256& hashBlock) const;
 
     /* Calculate the block/rev files to delete based on height specified by user with RPC command pruneblockchain */
@@ -364,6 +383,8 @@ public:
     bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos) const;
     bool ReadBlockFromDisk(CBlock& block, const CBlockIndex& index) const;
     bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos) const;
+    /** Read the size of the data stored for the block at `pos`, and whether it is compressed. */
+    bool ReadBlockDataSize(const FlatFilePos& pos, uint32_t& size, bool& compressed) const;
 
     bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex& index) const;
 
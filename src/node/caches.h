@@ -17,6 +17,7 @@ struct CacheSizes {
     int64_t coins;
     int64_t tx_index;
     int64_t filter_index;
+    int64_t address_index;
 };
 CacheSizes CalculateCacheSizes(const ArgsManager& args, size_t n_indexes = 0);
 } // namespace node
@@ -6,6 +6,7 @@
 
 #include <arith_uint256.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <kernel/chainstatemanager_opts.h>
 #include <node/coins_view_args.h>
 #include <node/database_args.h>
@@ -16,6 +17,7 @@
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <chrono>
 #include <string>
 
@@ -37,6 +39,14 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
 
     if (auto value{args.GetIntArg("-maxtipage")}) opts.max_tip_age = std::chrono::seconds{*value};
 
+    int snapshot_threads{static_cast<int>(args.GetIntArg("-snapshotthreads", DEFAULT_SNAPSHOT_THREADS))};
+    if (snapshot_threads <= 0) snapshot_threads += GetNumCores();
+    opts.snapshot_threads = std::clamp(snapshot_threads, 1, MAX_SNAPSHOT_THREADS);
+
+    int reindex_threads{static_cast<int>(args.GetIntArg("-reindexthreads", DEFAULT_REINDEX_THREADS))};
+    if (reindex_threads <= 0) reindex_threads += GetNumCores();
+    opts.reindex_threads = std::clamp(reindex_threads, 1, MAX_REINDEX_THREADS);
+
     ReadDatabaseArgs(args, opts.block_tree_db);
     ReadDatabaseArgs(args, opts.coins_db);
     ReadCoinsViewArgs(args, opts.coins_view);
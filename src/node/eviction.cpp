@@ -175,6 +175,36 @@ void ProtectEvictionCandidatesByRatio(std::vector<NodeEvictionCandidate>& evicti
     EraseLastKElements(eviction_candidates, ReverseCompareNodeTimeConnected, remaining_to_protect);
 }
 
+/**
+ * If any candidates take disproportionate resources, i.e. more than EVICTION_RESOURCE_MEDIAN_MULTIPLE
+ * times the median processing time (and at least EVICTION_MIN_PROCESS_TIME) or memory (and at least
+ * EVICTION_MIN_MEMORY_USAGE), keep only those.
+ */
+static void PreferResourceHeavyCandidates(std::vector<NodeEvictionCandidate>& eviction_candidates)
+{
+    if (eviction_candidates.empty()) return;
+    std::vector<std::chrono::microseconds> process_times;
+    std::vector<size_t> memory_usages;
+    for (const NodeEvictionCandidate& n : eviction_candidates) {
+        process_times.push_back(n.m_process_time);
+        memory_usages.push_back(n.m_memory_usage);
+    }
+    const size_t middle{eviction_candidates.size() / 2};
+    std::nth_element(process_times.begin(), process_times.begin() + middle, process_times.end());
+    std::nth_element(memory_usages.begin(), memory_usages.begin() + middle, memory_usages.end());
+    const auto max_process_time{std::max(EVICTION_MIN_PROCESS_TIME, process_times[middle] * EVICTION_RESOURCE_MEDIAN_MULTIPLE)};
+    const size_t max_memory_usage{std::max(EVICTION_MIN_MEMORY_USAGE, memory_usages[middle] * EVICTION_RESOURCE_MEDIAN_MULTIPLE)};
+
+    const auto is_heavy{[&](const NodeEvictionCandidate& n) {
+        return n.m_process_time > max_process_time || n.m_memory_usage > max_memory_usage;
+    }};
+    if (std::any_of(eviction_candidates.begin(), eviction_candidates.end(), is_heavy)) {
+        eviction_candidates.erase(std::remove_if(eviction_candidates.begin(), eviction_candidates.end(),
+                                                 [&](const NodeEvictionCandidate& n) { return !is_heavy(n); }),
+                                  eviction_candidates.end());
+    }
+}
+
 [[nodiscard]] std::optional<NodeId> SelectNodeToEvict(std::vector<NodeEvictionCandidate>&& vEvictionCandidates)
 {
     // Protect connections with certain characteristics
@@ -214,6 +244,10 @@ void ProtectEvictionCandidatesByRatio(std::vector<NodeEvictionCandidate>& evicti
                                   [](NodeEvictionCandidate const &n){return !n.prefer_evict;}),vEvictionCandidates.end());
     }
 
+    // Of those, consider only peers that cost us disproportionate processing time or memory, if any.
+    // An attacker cannot escape this without consuming fewer of our resources.
+    PreferResourceHeavyCandidates(vEvictionCandidates);
+
     // Identify the network group with the most connections and youngest member.
     // (vEvictionCandidates is already sorted by reverse connect time)
     uint64_t naMostConnections;
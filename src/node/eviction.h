@@ -9,6 +9,7 @@
 #include <net_permissions.h>
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <vector>
@@ -30,14 +31,25 @@ struct NodeEvictionCandidate {
     Network m_network;
     bool m_noban;
     ConnectionType m_conn_type;
+    std::chrono::microseconds m_process_time;
+    size_t m_memory_usage;
 };
 
+/** Unprotected inbound peers that take more than this multiple of the median message processing
+ * time or memory usage of the remaining eviction candidates are evicted first... */
+static constexpr int EVICTION_RESOURCE_MEDIAN_MULTIPLE{4};
+/** ...as long as they also take at least this much processing time... */
+static constexpr std::chrono::microseconds EVICTION_MIN_PROCESS_TIME{std::chrono::seconds{1}};
+/** ...or memory, in bytes. */
+static constexpr size_t EVICTION_MIN_MEMORY_USAGE{1'000'000};
+
 /**
  * Select an inbound peer to evict after filtering out (protecting) peers having
  * distinct, difficult-to-forge characteristics. The protection logic picks out
  * fixed numbers of desirable peers per various criteria, followed by (mostly)
  * ratios of desirable or disadvantaged peers. If any eviction candidates
- * remain, the selection logic chooses a peer to evict.
+ * remain, the selection logic chooses a peer to evict, preferring peers that
+ * consume a disproportionate share of our processing time or memory.
  */
 [[nodiscard]] std::optional<NodeId> SelectNodeToEvict(std::vector<NodeEvictionCandidate>&& vEvictionCandidates);
 
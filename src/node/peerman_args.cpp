@@ -16,12 +16,18 @@ void ApplyArgsManOptions(const ArgsManager& argsman, PeerManager::Options& optio
         options.max_orphan_txs = uint32_t((std::clamp<int64_t>(*value, 0, std::numeric_limits<uint32_t>::max())));
     }
 
+    if (auto value{argsman.GetIntArg("-maxorphanmem")}) {
+        options.max_orphan_usage = size_t(std::clamp<int64_t>(*value, 0, std::numeric_limits<uint32_t>::max())) * 1'000'000;
+    }
+
     if (auto value{argsman.GetIntArg("-blockreconstructionextratxn")}) {
         options.max_extra_txs = uint32_t((std::clamp<int64_t>(*value, 0, std::numeric_limits<uint32_t>::max())));
     }
 
     if (auto value{argsman.GetBoolArg("-capturemessages")}) options.capture_messages = *value;
 
+    if (auto value{argsman.GetBoolArg("-adaptiveblockdownload")}) options.adaptive_block_download = *value;
+
     if (auto value{argsman.GetBoolArg("-blocksonly")}) options.ignore_incoming_txs = *value;
 }
 
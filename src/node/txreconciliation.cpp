@@ -5,9 +5,14 @@
 #include <node/txreconciliation.h>
 
 #include <common/system.h>
+#include <crypto/siphash.h>
 #include <logging.h>
+#include <node/minisketchwrapper.h>
 #include <util/check.h>
 
+#include <algorithm>
+#include <limits>
+#include <set>
 #include <unordered_map>
 #include <variant>
 
@@ -29,6 +34,22 @@ uint256 ComputeSalt(uint64_t salt1, uint64_t salt2)
     return (HashWriter(RECON_SALT_HASHER) << std::min(salt1, salt2) << std::max(salt1, salt2)).GetSHA256();
 }
 
+/** Size of one serialized sketch element: short IDs are 32 bits. */
+constexpr size_t SKETCH_ELEMENT_SIZE{4};
+
+/** Where we are in a reconciliation round with a peer. */
+enum class Phase {
+    NONE,
+    //! Initiator: sent reqrecon, waiting for the sketch.
+    INIT_REQUESTED,
+    //! Initiator: sent reqsketchext, waiting for the extension.
+    EXT_REQUESTED,
+    //! Responder: sent the sketch, waiting for reqsketchext or reconcildiff.
+    INIT_RESPONDED,
+    //! Responder: sent the extension, waiting for reconcildiff.
+    EXT_RESPONDED,
+};
+
 /**
  * Keeps track of txreconciliation-related per-peer state.
  */
@@ -36,9 +57,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -47,16 +65,79 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
+    /** Transactions to announce to the peer in the next round. */
+    std::set<uint256> m_local_set;
+
+    /** The set frozen for the round in progress, by short ID. */
+    std::unordered_map<uint32_t, uint256> m_reconciling;
+
+    Phase m_phase{Phase::NONE};
+
+    /** Capacity of the initial sketch of the round in progress (0 if we asked for a fallback). */
+    size_t m_capacity{0};
+
+    /** Initiator: the peer's initial sketch, kept to be combined with its extension. */
+    std::vector<uint8_t> m_remote_sketch;
+
+    /** Initiator: when to start the next round. */
+    std::chrono::microseconds m_next_request{0};
+
     TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+
+    /** Short ID as specified by BIP-330; never 0, which a sketch cannot hold. */
+    uint32_t ComputeShortID(const uint256& wtxid) const
+    {
+        return 1 + (SipHashUint256(m_k0, m_k1, wtxid) % 0xFFFFFFFF);
+    }
+
+    /** Move the pending set into the round about to start. */
+    void Freeze()
+    {
+        for (const uint256& wtxid : m_local_set) {
+            m_reconciling.emplace(ComputeShortID(wtxid), wtxid);
+        }
+        m_local_set.clear();
+    }
+
+    Minisketch ComputeSketch(size_t capacity) const
+    {
+        Minisketch sketch = node::MakeMinisketch32(capacity);
+        for (const auto& [short_id, _] : m_reconciling) sketch.Add(short_id);
+        return sketch;
+    }
+
+    std::vector<uint256> ReconcilingTransactions() const
+    {
+        std::vector<uint256> result;
+        result.reserve(m_reconciling.size());
+        for (const auto& [_, wtxid] : m_reconciling) result.push_back(wtxid);
+        return result;
+    }
+
+    void FinishRound()
+    {
+        m_reconciling.clear();
+        m_phase = Phase::NONE;
+        m_capacity = 0;
+        m_remote_sketch.clear();
+    }
 };
 
+/**
+ * Estimate how many elements the set difference has, given the sizes of both sets and the
+ * fixed-point q coefficient (see RECON_Q). One extra element absorbs small estimation errors.
+ */
+size_t EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, uint16_t q)
+{
+    const size_t set_size_diff{local_set_size > remote_set_size ? local_set_size - remote_set_size : remote_set_size - local_set_size};
+    const size_t min_size{std::min(local_set_size, remote_set_size)};
+    return set_size_diff + uint64_t{q} * min_size / Q_PRECISION + 1;
+}
+
 } // namespace
 
 /** Actual implementation for TxReconciliationTracker's data structure. */
@@ -142,6 +223,183 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool AddToSet(NodeId peer_id, const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || state->m_local_set.size() >= MAX_RECON_SET_SIZE) return false;
+        state->m_local_set.insert(wtxid);
+        return true;
+    }
+
+    void TryRemovingFromSet(NodeId peer_id, const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        if (auto* state = GetRegisteredState(peer_id)) state->m_local_set.erase(wtxid);
+    }
+
+    bool ShouldFanoutTo(NodeId peer_id, const uint256& wtxid) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const auto* state = GetRegisteredState(peer_id);
+        if (!state) return true;
+        // Swapped keys, so that the choice is independent of the short ID.
+        static const uint64_t threshold{static_cast<uint64_t>(RECON_FANOUT_FRACTION * static_cast<double>(std::numeric_limits<uint64_t>::max()))};
+        return SipHashUint256(state->m_k1, state->m_k0, wtxid) < threshold;
+    }
+
+    std::optional<ReconciliationRequest> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || !state->m_we_initiate || state->m_phase != Phase::NONE || now < state->m_next_request) return std::nullopt;
+
+        state->m_next_request = now + RECON_REQUEST_INTERVAL;
+        state->Freeze();
+        state->m_phase = Phase::INIT_REQUESTED;
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Initiate reconciliation with peer=%d (set size %u)\n",
+                      peer_id, state->m_reconciling.size());
+        return ReconciliationRequest{
+            .set_size = static_cast<uint16_t>(std::min<size_t>(state->m_reconciling.size(), std::numeric_limits<uint16_t>::max())),
+            .q = static_cast<uint16_t>(RECON_Q * Q_PRECISION),
+        };
+    }
+
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || state->m_we_initiate || state->m_phase != Phase::NONE || peer_q > Q_PRECISION) return std::nullopt;
+
+        state->Freeze();
+        state->m_phase = Phase::INIT_RESPONDED;
+        const size_t capacity{EstimateSketchCapacity(state->m_reconciling.size(), peer_set_size, peer_q)};
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation request from peer=%d (their set %u, ours %u, capacity %u)\n",
+                      peer_id, peer_set_size, state->m_reconciling.size(), capacity);
+        // Leave room for the extension; beyond that, ask the initiator to fall back to flooding.
+        if (2 * capacity > MAX_SKETCH_CAPACITY) return std::vector<uint8_t>{};
+        state->m_capacity = capacity;
+        return state->ComputeSketch(capacity).Serialize();
+    }
+
+    ReconciliationSketchResult HandleSketch(NodeId peer_id, Span<const uint8_t> skdata) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        using Status = ReconciliationSketchResult::Status;
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || !state->m_we_initiate || skdata.size() % SKETCH_ELEMENT_SIZE != 0) return {Status::PROTOCOL_VIOLATION, {}, {}};
+
+        std::vector<uint8_t> sketch;
+        if (state->m_phase == Phase::INIT_REQUESTED) {
+            if (skdata.size() > MAX_SKETCH_CAPACITY * SKETCH_ELEMENT_SIZE) return {Status::PROTOCOL_VIOLATION, {}, {}};
+            // An empty sketch is the responder asking to fall back to flooding.
+            if (skdata.empty()) return Fail(peer_id, *state);
+            sketch.assign(skdata.begin(), skdata.end());
+        } else if (state->m_phase == Phase::EXT_REQUESTED) {
+            // The extension carries as many elements as the initial sketch.
+            if (skdata.size() != state->m_remote_sketch.size()) return {Status::PROTOCOL_VIOLATION, {}, {}};
+            sketch = std::move(state->m_remote_sketch);
+            sketch.insert(sketch.end(), skdata.begin(), skdata.end());
+        } else {
+            return {Status::PROTOCOL_VIOLATION, {}, {}};
+        }
+
+        const size_t capacity{sketch.size() / SKETCH_ELEMENT_SIZE};
+        Minisketch remote_sketch = node::MakeMinisketch32(capacity);
+        remote_sketch.Deserialize(sketch);
+        const auto difference{state->ComputeSketch(capacity).Merge(remote_sketch).Decode(capacity)};
+        if (!difference) {
+            if (state->m_phase == Phase::INIT_REQUESTED && 2 * capacity <= MAX_SKETCH_CAPACITY) {
+                state->m_remote_sketch = std::move(sketch);
+                state->m_phase = Phase::EXT_REQUESTED;
+                LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Request sketch extension from peer=%d\n", peer_id);
+                return {Status::NEED_EXTENSION, {}, {}};
+            }
+            return Fail(peer_id, *state);
+        }
+
+        ReconciliationSketchResult result{Status::SUCCESS, {}, {}};
+        for (const uint64_t short_id : *difference) {
+            const auto it{state->m_reconciling.find(static_cast<uint32_t>(short_id))};
+            if (it != state->m_reconciling.end()) {
+                result.to_announce.push_back(it->second);
+            } else {
+                result.missing.push_back(static_cast<uint32_t>(short_id));
+            }
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d succeeded (we miss %u, they miss %u)\n",
+                      peer_id, result.missing.size(), result.to_announce.size());
+        state->FinishRound();
+        return result;
+    }
+
+    std::optional<std::vector<uint8_t>> HandleSketchExtensionRequest(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || state->m_we_initiate || state->m_phase != Phase::INIT_RESPONDED || state->m_capacity == 0) return std::nullopt;
+
+        state->m_phase = Phase::EXT_RESPONDED;
+        // A sketch of twice the capacity starts with the initial sketch; only send the rest.
+        std::vector<uint8_t> extended{state->ComputeSketch(2 * state->m_capacity).Serialize()};
+        extended.erase(extended.begin(), extended.begin() + state->m_capacity * SKETCH_ELEMENT_SIZE);
+        return extended;
+    }
+
+    std::optional<std::vector<uint256>> HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredState(peer_id);
+        if (!state || state->m_we_initiate || (state->m_phase != Phase::INIT_RESPONDED && state->m_phase != Phase::EXT_RESPONDED)) return std::nullopt;
+
+        std::vector<uint256> to_announce;
+        if (success) {
+            for (const uint32_t short_id : ask_shortids) {
+                const auto it{state->m_reconciling.find(short_id)};
+                if (it != state->m_reconciling.end()) to_announce.push_back(it->second);
+            }
+        } else {
+            to_announce = state->ReconcilingTransactions();
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d finished (success=%i, they miss %u)\n",
+                      peer_id, success, to_announce.size());
+        state->FinishRound();
+        return to_announce;
+    }
+
+private:
+    TxReconciliationState* GetRegisteredState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
+    const TxReconciliationState* GetRegisteredState(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
+    /** Give up on the round: the initiator announces its whole set and tells the peer to do the same. */
+    ReconciliationSketchResult Fail(NodeId peer_id, TxReconciliationState& state) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d failed, falling back to flooding %u transactions\n",
+                      peer_id, state.m_reconciling.size());
+        ReconciliationSketchResult result{ReconciliationSketchResult::Status::FAILURE, {}, state.ReconcilingTransactions()};
+        state.FinishRound();
+        return result;
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -168,3 +426,43 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const uint256& wtxid)
+{
+    return m_impl->AddToSet(peer_id, wtxid);
+}
+
+void TxReconciliationTracker::TryRemovingFromSet(NodeId peer_id, const uint256& wtxid)
+{
+    m_impl->TryRemovingFromSet(peer_id, wtxid);
+}
+
+bool TxReconciliationTracker::ShouldFanoutTo(NodeId peer_id, const uint256& wtxid) const
+{
+    return m_impl->ShouldFanoutTo(peer_id, wtxid);
+}
+
+std::optional<ReconciliationRequest> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->InitiateReconciliationRequest(peer_id, now);
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, peer_set_size, peer_q);
+}
+
+ReconciliationSketchResult TxReconciliationTracker::HandleSketch(NodeId peer_id, Span<const uint8_t> skdata)
+{
+    return m_impl->HandleSketch(peer_id, skdata);
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::HandleSketchExtensionRequest(NodeId peer_id)
+{
+    return m_impl->HandleSketchExtensionRequest(peer_id);
+}
+
+std::optional<std::vector<uint256>> TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, success, ask_shortids);
+}
@@ -6,13 +6,33 @@
 #define SUPERAXECOIN_NODE_TXRECONCILIATION_H
 
 #include <net.h>
+#include <span.h>
 #include <sync.h>
+#include <uint256.h>
 
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <tuple>
+#include <vector>
 
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
+/** Precision of the fixed-point q coefficient sent in reqrecon (BIP-330). */
+static constexpr uint16_t Q_PRECISION{(2 << 14) - 1};
+/**
+ * Coefficient q used to estimate the set difference as |sizeA - sizeB| + q * min(sizeA, sizeB),
+ * i.e. the expected fraction of the smaller set the other side does not have.
+ */
+static constexpr double RECON_Q{0.25};
+/** How often we initiate a reconciliation round with each peer we reconcile with. */
+static constexpr std::chrono::microseconds RECON_REQUEST_INTERVAL{std::chrono::seconds{8}};
+/** Transactions waiting to be reconciled with a peer beyond this many are flooded instead. */
+static constexpr size_t MAX_RECON_SET_SIZE{3000};
+/** Largest sketch capacity (including an extension) we build or decode, bounding decoding cost. */
+static constexpr size_t MAX_SKETCH_CAPACITY{1024};
+/** Fraction of reconciling peers to which a transaction is still flooded, to keep relay latency low. */
+static constexpr double RECON_FANOUT_FRACTION{0.1};
 
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
@@ -21,6 +41,29 @@ enum class ReconciliationRegisterResult {
     PROTOCOL_VIOLATION,
 };
 
+/** Contents of a reqrecon message. */
+struct ReconciliationRequest {
+    uint16_t set_size;
+    uint16_t q;
+};
+
+/** Outcome of processing a sketch as the reconciliation initiator. */
+struct ReconciliationSketchResult {
+    enum class Status {
+        PROTOCOL_VIOLATION,
+        //! The sketch could not be decoded; request an extension.
+        NEED_EXTENSION,
+        //! The set difference was found; send reconcildiff(success) asking for missing.
+        SUCCESS,
+        //! The set difference could not be found; send reconcildiff(failure).
+        FAILURE,
+    } status;
+    //! Short IDs of the transactions the peer has and we do not.
+    std::vector<uint32_t> missing;
+    //! Transactions to announce to the peer: those it does not have, or our whole set on failure.
+    std::vector<uint256> to_announce;
+};
+
 /**
  * Transaction reconciliation is a way for nodes to efficiently announce transactions.
  * This object keeps track of all txreconciliation-related communications with the peers.
@@ -84,6 +127,55 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Step 1. Add a transaction to be announced to the peer in the next reconciliation round.
+     * Returns false if the peer is not registered or its set is full, in which case the
+     * transaction should be flooded instead.
+     */
+    bool AddToSet(NodeId peer_id, const uint256& wtxid);
+
+    /**
+     * Step 1. Drop a transaction the peer turned out to know from its pending set.
+     */
+    void TryRemovingFromSet(NodeId peer_id, const uint256& wtxid);
+
+    /**
+     * Step 1. Whether a transaction should still be flooded to this reconciling peer. Holds for
+     * a deterministic RECON_FANOUT_FRACTION of (transaction, peer) pairs.
+     */
+    bool ShouldFanoutTo(NodeId peer_id, const uint256& wtxid) const;
+
+    /**
+     * Step 2 (initiator). If a round with this peer is due, freeze the set and return the
+     * contents of the reqrecon message to send.
+     */
+    std::optional<ReconciliationRequest> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now);
+
+    /**
+     * Step 2 (responder). Freeze the set and return the sketch to send in response to reqrecon.
+     * An empty sketch asks the initiator to fall back to flooding, when the estimated difference
+     * is too large. Returns std::nullopt if the request violates the protocol.
+     */
+    std::optional<std::vector<uint8_t>> HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q);
+
+    /**
+     * Steps 3 and 4 (initiator). Process the peer's sketch, or its extension.
+     */
+    ReconciliationSketchResult HandleSketch(NodeId peer_id, Span<const uint8_t> skdata);
+
+    /**
+     * Step 4b (responder). Return the extension of the sketch sent in this round. Returns
+     * std::nullopt if the request violates the protocol.
+     */
+    std::optional<std::vector<uint8_t>> HandleSketchExtensionRequest(NodeId peer_id);
+
+    /**
+     * Final step (responder). Process reconcildiff and return the transactions to announce to the
+     * peer: the ones it asked for, or the whole set on failure. Returns std::nullopt if the
+     * message violates the protocol.
+     */
+    std::optional<std::vector<uint256>> HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids);
 };
 
 #endif // SUPERAXECOIN_NODE_TXRECONCILIATION_H
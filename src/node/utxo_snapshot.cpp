@@ -4,21 +4,300 @@
 
 #include <node/utxo_snapshot.h>
 
+#include <coins.h>
+#include <consensus/amount.h>
+#include <crypto/muhash.h>
+#include <hash.h>
+#include <kernel/coinstats.h>
 #include <logging.h>
+#include <primitives/transaction.h>
 #include <streams.h>
 #include <sync.h>
 #include <tinyformat.h>
 #include <txdb.h>
 #include <uint256.h>
 #include <util/fs.h>
+#include <util/thread.h>
+#include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace node {
+namespace {
+
+//! Chunks scheduled ahead of the one being written or emplaced, per thread
+constexpr size_t SNAPSHOT_CHUNKS_AHEAD_PER_THREAD{2};
+
+struct SnapshotChunk {
+    std::vector<std::pair<COutPoint, Coin>> coins;
+    SnapshotChunkHeader header;
+    DataStream payload;
+    //! The coins serialized as the UTXO set hash commits to them
+    DataStream hashed;
+    MuHash3072 muhash;
+    std::string error;
+    bool done{false}; //!< Set by the worker once it is done with the chunk, guarded by m_mutex
+};
+
+/**
+ * Chunks of a snapshot are serialized or decoded, and hashed, by a pool of
+ * worker threads, while the calling thread reads or writes the file. Chunks
+ * are handed back by Pop() in the order they were pushed in.
+ */
+class SnapshotChunkPipeline
+{
+private:
+    const std::function<void(SnapshotChunk&)> m_work;
+    const size_t m_depth;
+    Mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::deque<std::shared_ptr<SnapshotChunk>> m_queue GUARDED_BY(m_mutex);
+    bool m_stop GUARDED_BY(m_mutex){false};
+    //! Chunks pushed and not popped yet, in file order
+    std::deque<std::shared_ptr<SnapshotChunk>> m_ahead;
+    std::vector<std::thread> m_workers;
+
+    void Work() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            std::shared_ptr<SnapshotChunk> chunk;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queue.empty(); });
+                if (m_stop) return;
+                chunk = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            m_work(*chunk);
+            WITH_LOCK(m_mutex, chunk->done = true);
+            m_done_cv.notify_all();
+        }
+    }
+
+public:
+    SnapshotChunkPipeline(int threads, std::function<void(SnapshotChunk&)> work)
+        : m_work{std::move(work)}, m_depth{threads * SNAPSHOT_CHUNKS_AHEAD_PER_THREAD}
+    {
+        for (int i = 0; i < threads; ++i) {
+            m_workers.emplace_back(&util::TraceThread, strprintf("snapshot.%d", i), [this] { Work(); });
+        }
+    }
+
+    ~SnapshotChunkPipeline()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_work_cv.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+    }
+
+    bool Empty() const { return m_ahead.empty(); }
+    bool Full() const { return m_ahead.size() >= m_depth; }
+
+    void Push(std::shared_ptr<SnapshotChunk> chunk) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        m_ahead.push_back(chunk);
+        WITH_LOCK(m_mutex, m_queue.push_back(std::move(chunk)));
+        m_work_cv.notify_one();
+    }
+
+    std::shared_ptr<SnapshotChunk> Pop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        std::shared_ptr<SnapshotChunk> chunk{std::move(m_ahead.front())};
+        m_ahead.pop_front();
+        WAIT_LOCK(m_mutex, lock);
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return chunk->done; });
+        return chunk;
+    }
+};
+
+void HashChunkCoins(SnapshotChunk& chunk)
+{
+    for (const auto& [outpoint, coin] : chunk.coins) {
+        const size_t begin{chunk.hashed.size()};
+        kernel::SerializeCoinForHash(chunk.hashed, outpoint, coin);
+        chunk.muhash.Insert(MakeUCharSpan(chunk.hashed).subspan(begin));
+    }
+}
+
+void EncodeChunk(SnapshotChunk& chunk)
+{
+    for (const auto& [outpoint, coin] : chunk.coins) {
+        chunk.payload << outpoint << coin;
+    }
+    chunk.header.m_coins_count = chunk.coins.size();
+    chunk.header.m_size = chunk.payload.size();
+    chunk.header.m_hash = Hash(chunk.payload);
+    HashChunkCoins(chunk);
+    chunk.coins.clear();
+}
+
+void DecodeChunk(SnapshotChunk& chunk, int max_height)
+{
+    if (Hash(chunk.payload) != chunk.header.m_hash) {
+        chunk.error = "bad chunk hash";
+        return;
+    }
+    chunk.coins.reserve(chunk.header.m_coins_count);
+    try {
+        for (uint32_t i = 0; i < chunk.header.m_coins_count; ++i) {
+            auto& [outpoint, coin] = chunk.coins.emplace_back();
+            chunk.payload >> outpoint >> coin;
+            if (coin.nHeight > static_cast<uint32_t>(max_height) ||
+                outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
+            ) {
+                chunk.error = "bad snapshot data";
+                return;
+            }
+            if (!MoneyRange(coin.out.nValue)) {
+                chunk.error = "bad snapshot data - bad tx out value";
+                return;
+            }
+        }
+    } catch (const std::ios_base::failure&) {
+        chunk.error = "bad snapshot format";
+        return;
+    }
+    if (!chunk.payload.empty()) {
+        chunk.error = "unexpected data after the coins of the chunk";
+        return;
+    }
+    HashChunkCoins(chunk);
+}
+
+} // namespace
+
+SnapshotCoinsStats WriteSnapshotCoins(AutoFile& afile, CCoinsViewCursor& cursor, int threads,
+                                      const std::function<void()>& interruption_point)
+{
+    SnapshotCoinsStats stats;
+    HashWriter hasher{};
+    MuHash3072 muhash;
+    SnapshotChunkPipeline pipeline{threads, EncodeChunk};
+
+    const auto write_chunk{[&] {
+        const auto chunk{pipeline.Pop()};
+        afile << chunk->header;
+        afile.write(chunk->payload);
+        hasher.write(chunk->hashed);
+        muhash *= chunk->muhash;
+        stats.coins_count += chunk->header.m_coins_count;
+    }};
+
+    auto chunk{std::make_shared<SnapshotChunk>()};
+    size_t chunk_size{0};
+    const auto push_chunk{[&] {
+        pipeline.Push(std::move(chunk));
+        chunk = std::make_shared<SnapshotChunk>();
+        chunk_size = 0;
+        if (pipeline.Full()) write_chunk();
+    }};
+
+    // The UTXO set hash commits to the outputs of a transaction by increasing
+    // index, which is not the order of the coins database for indexes that
+    // take more than two bytes to encode, so the outputs of a transaction are
+    // gathered before being added to chunks.
+    uint256 last_hash;
+    std::map<uint32_t, Coin> outputs;
+    const auto add_outputs{[&] {
+        for (auto& [n, coin] : outputs) {
+            // Upper bound of the serialized size of the coin
+            chunk_size += 64 + coin.out.scriptPubKey.size();
+            chunk->coins.emplace_back(COutPoint{last_hash, n}, std::move(coin));
+            if (chunk_size >= SNAPSHOT_CHUNK_TARGET_SIZE) push_chunk();
+        }
+        outputs.clear();
+    }};
+
+    COutPoint key;
+    Coin coin;
+    uint64_t coins_read{0};
+    for (; cursor.Valid(); cursor.Next()) {
+        if (!cursor.GetKey(key) || !cursor.GetValue(coin)) {
+            throw std::runtime_error("Unable to read UTXO set");
+        }
+        if (key.hash != last_hash) {
+            add_outputs();
+            last_hash = key.hash;
+        }
+        outputs.emplace(key.n, std::move(coin));
+        if (++coins_read % 10000 == 0) interruption_point();
+    }
+    add_outputs();
+    if (!chunk->coins.empty()) push_chunk();
+    while (!pipeline.Empty()) write_chunk();
+
+    stats.hash_serialized = hasher.GetHash();
+    muhash.Finalize(stats.muhash);
+    return stats;
+}
+
+util::Result<SnapshotCoinsStats> ReadSnapshotCoins(AutoFile& afile, uint64_t coins_count, int max_height, int threads,
+                                                   const std::function<bool(std::vector<std::pair<COutPoint, Coin>>&)>& emplace)
+{
+    SnapshotCoinsStats stats;
+    HashWriter hasher{};
+    MuHash3072 muhash;
+    SnapshotChunkPipeline pipeline{threads, [max_height](SnapshotChunk& chunk) { DecodeChunk(chunk, max_height); }};
+
+    const auto emplace_chunk{[&]() -> util::Result<void> {
+        const auto chunk{pipeline.Pop()};
+        if (!chunk->error.empty()) {
+            return util::Error{Untranslated(strprintf("%s after deserializing %d coins", chunk->error, stats.coins_count))};
+        }
+        hasher.write(chunk->hashed);
+        muhash *= chunk->muhash;
+        stats.coins_count += chunk->coins.size();
+        if (!emplace(chunk->coins)) {
+            return util::Error{Untranslated(strprintf("interrupted after deserializing %d coins", stats.coins_count))};
+        }
+        return {};
+    }};
+
+    uint64_t coins_left{coins_count};
+    while (coins_left > 0) {
+        auto chunk{std::make_shared<SnapshotChunk>()};
+        try {
+            afile >> chunk->header;
+            if (chunk->header.m_coins_count == 0 || chunk->header.m_coins_count > coins_left ||
+                chunk->header.m_size > MAX_SNAPSHOT_CHUNK_SIZE) {
+                return util::Error{Untranslated(strprintf("bad snapshot chunk header after reading %d coins", coins_count - coins_left))};
+            }
+            chunk->payload.resize(chunk->header.m_size);
+            afile.read(chunk->payload);
+        } catch (const std::ios_base::failure&) {
+            return util::Error{Untranslated(strprintf("bad snapshot format or truncated snapshot after reading %d coins", coins_count - coins_left))};
+        }
+        coins_left -= chunk->header.m_coins_count;
+        pipeline.Push(std::move(chunk));
+        if (pipeline.Full()) {
+            if (auto res{emplace_chunk()}; !res) return util::Error{util::ErrorString(res)};
+        }
+    }
+    while (!pipeline.Empty()) {
+        if (auto res{emplace_chunk()}; !res) return util::Error{util::ErrorString(res)};
+    }
+
+    if (std::fgetc(afile.Get()) != EOF) {
+        return util::Error{Untranslated(strprintf("bad snapshot - coins left over after deserializing %d coins", coins_count))};
+    }
+
+    stats.hash_serialized = hasher.GetHash();
+    muhash.Finalize(stats.muhash);
+    return stats;
+}
 
 bool WriteSnapshotBaseBlockhash(Chainstate& snapshot_chainstate)
 {
@@ -11,19 +11,36 @@
 #include <sync.h>
 #include <uint256.h>
 #include <util/fs.h>
+#include <util/result.h>
 
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <ios>
 #include <optional>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+class AutoFile;
+class CCoinsViewCursor;
 class Chainstate;
+class Coin;
+class COutPoint;
 
 namespace node {
+//! Magic bytes at the start of a UTXO snapshot file.
+static constexpr std::array<uint8_t, 5> SNAPSHOT_MAGIC_BYTES{'u', 't', 'x', 'o', 0xff};
+
 //! Metadata describing a serialized version of a UTXO set from which an
 //! assumeutxo Chainstate can be constructed.
 class SnapshotMetadata
 {
 public:
+    //! Version of the snapshot format, in which the coins follow the metadata
+    //! in chunks (see SnapshotChunkHeader).
+    static constexpr uint16_t VERSION{2};
+
     //! The hash of the block that reflects the tip of the chain for the
     //! UTXO set contained in this snapshot.
     uint256 m_base_blockhash;
@@ -39,9 +56,68 @@ public:
             m_base_blockhash(base_blockhash),
             m_coins_count(coins_count) { }
 
-    SERIALIZE_METHODS(SnapshotMetadata, obj) { READWRITE(obj.m_base_blockhash, obj.m_coins_count); }
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << SNAPSHOT_MAGIC_BYTES << VERSION << m_base_blockhash << m_coins_count;
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        std::array<uint8_t, SNAPSHOT_MAGIC_BYTES.size()> magic;
+        uint16_t version;
+        s >> magic;
+        if (magic != SNAPSHOT_MAGIC_BYTES) {
+            throw std::ios_base::failure("Invalid UTXO snapshot magic bytes");
+        }
+        s >> version;
+        if (version != VERSION) {
+            throw std::ios_base::failure("Unsupported UTXO snapshot version");
+        }
+        s >> m_base_blockhash >> m_coins_count;
+    }
 };
 
+//! Size a chunk of a snapshot being written is closed at.
+static constexpr uint32_t SNAPSHOT_CHUNK_TARGET_SIZE{1 << 20};
+//! Largest chunk accepted when loading a snapshot.
+static constexpr uint32_t MAX_SNAPSHOT_CHUNK_SIZE{16 << 20};
+
+//! Header of a chunk of a snapshot. It is followed by `m_size` bytes of
+//! (outpoint, coin) pairs, in key order, so that chunks can be checked and
+//! decoded independently of each other.
+struct SnapshotChunkHeader {
+    uint32_t m_coins_count{0};
+    uint32_t m_size{0};
+    //! Double SHA256 of the chunk's payload
+    uint256 m_hash;
+
+    SERIALIZE_METHODS(SnapshotChunkHeader, obj) { READWRITE(obj.m_coins_count, obj.m_size, obj.m_hash); }
+};
+
+//! Hashes of the coins written to or read from a snapshot.
+struct SnapshotCoinsStats {
+    uint64_t coins_count{0};
+    //! Hash of the coins as committed to by assumeutxo data (CoinStatsHashType::HASH_SERIALIZED)
+    uint256 hash_serialized;
+    //! MuHash of the coins, as reported by gettxoutsetinfo and the coinstatsindex
+    uint256 muhash;
+};
+
+//! Write the coins of `cursor` to a snapshot, after its metadata. Chunks are
+//! serialized and hashed by `threads` threads, and written in key order.
+SnapshotCoinsStats WriteSnapshotCoins(AutoFile& afile, CCoinsViewCursor& cursor, int threads,
+                                      const std::function<void()>& interruption_point);
+
+//! Read the `coins_count` coins of a snapshot, after its metadata. Chunks are
+//! checked and decoded by `threads` threads, and handed to `emplace` in key
+//! order. Reading stops if `emplace` returns false.
+//!
+//! @param[in] max_height  Greatest height a coin of the snapshot may have.
+util::Result<SnapshotCoinsStats> ReadSnapshotCoins(AutoFile& afile, uint64_t coins_count, int max_height, int threads,
+                                                   const std::function<bool(std::vector<std::pair<COutPoint, Coin>>&)>& emplace);
+
 //! The file in the snapshot chainstate dir which stores the base blockhash. This is
 //! needed to reconstruct snapshot chainstates on init.
 //!
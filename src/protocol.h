@@ -265,6 +265,28 @@ extern const char* WTXIDRELAY;
  * txreconciliation, as described by BIP 330.
  */
 extern const char* SENDTXRCNCL;
+/**
+ * Requests a sketch of the peer's reconciliation set. Contains the size of our
+ * own set and the q coefficient used to estimate the set difference, as
+ * described by BIP 330.
+ */
+extern const char* REQRECON;
+/**
+ * Contains a sketch of the sender's reconciliation set, in response to
+ * reqrecon, or the extension of a previously sent sketch, in response to
+ * reqsketchext (BIP 330).
+ */
+extern const char* SKETCH;
+/**
+ * Requests an extension of the sketch sent in the current reconciliation
+ * round, after the initial one failed to decode (BIP 330).
+ */
+extern const char* REQSKETCHEXT;
+/**
+ * Finishes a reconciliation round: whether the set difference was found and,
+ * if so, the short IDs of the transactions the sender is missing (BIP 330).
+ */
+extern const char* RECONCILDIFF;
 }; // namespace NetMsgType
 
 /* Get a vector of all valid message types (see above) */
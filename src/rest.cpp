@@ -10,8 +10,10 @@
 #include <chainparams.h>
 #include <core_io.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
+#include <key_io.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
@@ -1000,6 +1002,55 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+static bool rest_address_history(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string address;
+    const RESTResponseFormat rf = ParseDataFormat(address, str_uri_part);
+    if (rf != RESTResponseFormat::JSON) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+
+    if (!g_address_index) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index is not enabled");
+    }
+
+    const CTxDestination dest{DecodeDestination(address)};
+    if (!IsValidDestination(dest)) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address: " + address);
+    }
+
+    std::string raw_skip, raw_count;
+    try {
+        raw_skip = req->GetQueryParameter("skip").value_or("0");
+        raw_count = req->GetQueryParameter("count").value_or(ToString(DEFAULT_ADDRESS_HISTORY_COUNT));
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    const auto skip{ToIntegral<size_t>(raw_skip)};
+    if (!skip.has_value()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid skip: " + raw_skip);
+    }
+    const auto count{ToIntegral<size_t>(raw_count)};
+    if (!count.has_value() || *count > MAX_ADDRESS_HISTORY_COUNT) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Count is invalid or out of acceptable range (0-%u): %s", MAX_ADDRESS_HISTORY_COUNT, raw_count));
+    }
+
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Address index is still syncing");
+    }
+
+    std::vector<AddressHistoryEntry> entries;
+    if (!g_address_index->FindHistory(AddressIndex::ScriptHash(GetScriptForDestination(dest)), *skip, *count, entries)) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read the address index");
+    }
+
+    std::string str_json = AddressHistoryToJSON(entries).write() + "\n";
+    req->WriteHeader("Content-Type", "application/json");
+    req->WriteReply(HTTP_OK, str_json);
+    return true;
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1016,6 +1067,7 @@ static const struct {
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
+      {"/rest/addresshistory/", rest_address_history},
 };
 
 void StartREST(const std::any& context)
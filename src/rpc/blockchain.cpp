@@ -11,6 +11,7 @@
 #include <clientversion.h>
 #include <coins.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <consensus/amount.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
@@ -18,6 +19,8 @@
 #include <deploymentinfo.h>
 #include <deploymentstatus.h>
 #include <hash.h>
+#include <key_io.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
 #include <kernel/coinstats.h>
@@ -41,6 +44,7 @@
 #include <univalue.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/hasher.h>
 #include <util/strencodings.h>
 #include <util/translation.h>
 #include <validation.h>
@@ -51,15 +55,20 @@
 #include <stdint.h>
 
 #include <condition_variable>
+#include <cstdio>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <unordered_set>
 
 using kernel::CCoinsStats;
 using kernel::CoinStatsHashType;
 
 using node::BlockManager;
 using node::NodeContext;
+using node::SnapshotCoinsStats;
 using node::SnapshotMetadata;
+using node::WriteSnapshotCoins;
 
 struct CUpdatedBlock
 {
@@ -858,7 +867,10 @@ static std::optional<kernel::CCoinsStats> GetUTXOStats(CCoinsView* view, node::B
     // best block.
     CHECK_NONFATAL(!pindex || pindex->GetBlockHash() == view->GetBestBlock());
 
-    return kernel::ComputeUTXOStats(hash_type, view, blockman, interruption_point);
+    // Set hashes do not depend on the order of the coins, so slices of the
+    // UTXO set can be hashed on threads of their own.
+    const int threads{std::clamp(DEFAULT_SCAN_THREADS + GetNumCores(), 1, MAX_SCAN_THREADS)};
+    return kernel::ComputeUTXOStats(hash_type, view, blockman, interruption_point, threads);
 }
 
 static RPCHelpMan gettxoutsetinfo()
@@ -1996,41 +2008,63 @@ static RPCHelpMan getblockstats()
 }
 
 namespace {
-//! Search for a given set of pubkey scripts
-bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor* cursor, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results, std::function<void()>& interruption_point)
+/** Scripts looked for by scantxoutset. */
+using ScanNeedles = std::unordered_set<CScript, SaltedSipHasher>;
+
+/**
+ * A slice of the UTXO set, scanned by a thread of its own: the coins whose
+ * txid starts with a byte in [begin, end).
+ */
+struct CoinsScanSlice {
+    unsigned int begin;
+    unsigned int end;
+    std::unique_ptr<CCoinsViewCursor> cursor;
+    //! Position of the cursor past the start of the slice, in 1/65536ths of the keyspace
+    std::atomic<uint32_t> progress{0};
+    bool success{false};
+};
+
+//! Search a slice of the UTXO set for a given set of pubkey scripts
+bool FindScriptPubKey(CoinsScanSlice& slice, const std::atomic<bool>& should_abort, std::atomic<int64_t>& count, const ScanNeedles& needles, const std::function<void(const COutPoint&, const Coin&)>& found)
 {
-    scan_progress = 0;
-    count = 0;
+    CCoinsViewCursor* cursor{slice.cursor.get()};
+    int64_t slice_count = 0;
     while (cursor->Valid()) {
         COutPoint key;
         Coin coin;
-        if (!cursor->GetKey(key) || !cursor->GetValue(coin)) return false;
-        if (++count % 8192 == 0) {
-            interruption_point();
-            if (should_abort) {
-                // allow to abort the scan via the abort reference
-                return false;
-            }
+        if (!cursor->GetKey(key)) return false;
+        if (*key.hash.begin() >= slice.end) break;
+        if (!cursor->GetValue(coin)) return false;
+        if (++slice_count % 8192 == 0 && should_abort) {
+            // allow to abort the scan via the abort reference
+            return false;
         }
-        if (count % 256 == 0) {
-            // update progress reference every 256 item
+        if (slice_count % 256 == 0) {
+            // update progress and count every 256 items
             uint32_t high = 0x100 * *key.hash.begin() + *(key.hash.begin() + 1);
-            scan_progress = (int)(high * 100.0 / 65536.0 + 0.5);
+            slice.progress = high - 0x100 * slice.begin;
+            count += 256;
         }
         if (needles.count(coin.out.scriptPubKey)) {
-            out_results.emplace(key, coin);
+            found(key, coin);
         }
         cursor->Next();
     }
-    scan_progress = 100;
+    slice.progress = 0x100 * (slice.end - slice.begin);
+    count += slice_count % 256;
     return true;
 }
 } // namespace
 
 /** RAII object to prevent concurrency issue when scanning the txout set */
 static std::atomic<int> g_scan_progress;
+static std::atomic<int64_t> g_scan_txouts;
 static std::atomic<bool> g_scan_in_progress;
 static std::atomic<bool> g_should_abort_scan;
+/** Outputs found so far by the running scan, and the descriptors of the scripts looked for */
+static Mutex g_scan_results_mutex;
+static std::map<COutPoint, Coin> g_scan_results GUARDED_BY(g_scan_results_mutex);
+static std::map<CScript, std::string> g_scan_descriptors GUARDED_BY(g_scan_results_mutex);
 class CoinsViewScanReserver
 {
 private:
@@ -2050,6 +2084,12 @@ public:
 
     ~CoinsViewScanReserver() {
         if (m_could_reserve) {
+            {
+                LOCK(g_scan_results_mutex);
+                g_scan_results.clear();
+                g_scan_descriptors.clear();
+            }
+            g_scan_txouts = 0;
             g_scan_in_progress = false;
             g_scan_progress = 0;
         }
@@ -2084,11 +2124,54 @@ static const auto scan_result_abort = RPCResult{
 static const auto scan_result_status_none = RPCResult{
     "when action=='status' and no scan is in progress - possibly already completed", RPCResult::Type::NONE, "", ""
 };
+static const auto scan_result_unspents = RPCResult{
+    RPCResult::Type::ARR, "unspents", "",
+    {
+        {RPCResult::Type::OBJ, "", "",
+        {
+            {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
+            {RPCResult::Type::NUM, "vout", "The vout value"},
+            {RPCResult::Type::STR_HEX, "scriptPubKey", "The script key"},
+            {RPCResult::Type::STR, "desc", "A specialized descriptor for the matched scriptPubKey"},
+            {RPCResult::Type::STR_AMOUNT, "amount", "The total amount in " + CURRENCY_UNIT + " of the unspent output"},
+            {RPCResult::Type::BOOL, "coinbase", "Whether this is a coinbase output"},
+            {RPCResult::Type::NUM, "height", "Height of the unspent transaction output"},
+        }},
+    }
+};
 static const auto scan_result_status_some = RPCResult{
     "when action=='status' and a scan is currently in progress", RPCResult::Type::OBJ, "", "",
-    {{RPCResult::Type::NUM, "progress", "Approximate percent complete"},}
+    {
+        {RPCResult::Type::NUM, "progress", "Approximate percent complete"},
+        {RPCResult::Type::NUM, "txouts", "The number of unspent transaction outputs scanned so far"},
+        scan_result_unspents,
+    }
 };
 
+/** The found outputs, in the format of the scantxoutset result. */
+static UniValue ScanUnspentsToJSON(const std::map<COutPoint, Coin>& coins, const std::map<CScript, std::string>& descriptors, CAmount& total_in)
+{
+    UniValue unspents(UniValue::VARR);
+    for (const auto& it : coins) {
+        const COutPoint& outpoint = it.first;
+        const Coin& coin = it.second;
+        const CTxOut& txo = coin.out;
+        total_in += txo.nValue;
+
+        UniValue unspent(UniValue::VOBJ);
+        unspent.pushKV("txid", outpoint.hash.GetHex());
+        unspent.pushKV("vout", (int32_t)outpoint.n);
+        unspent.pushKV("scriptPubKey", HexStr(txo.scriptPubKey));
+        unspent.pushKV("desc", descriptors.at(txo.scriptPubKey));
+        unspent.pushKV("amount", ValueFromAmount(txo.nValue));
+        unspent.pushKV("coinbase", coin.IsCoinBase());
+        unspent.pushKV("height", (int32_t)coin.nHeight);
+
+        unspents.push_back(unspent);
+    }
+    return unspents;
+}
+
 
 static RPCHelpMan scantxoutset()
 {
@@ -2115,6 +2198,11 @@ static RPCHelpMan scantxoutset()
         {
             scan_action_arg_desc,
             scan_objects_arg_desc,
+            RPCArg{"options", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "",
+                {
+                    {"threads", RPCArg::Type::NUM, RPCArg::Default{DEFAULT_SCAN_THREADS}, "Number of threads to scan the UTXO set with, <= 0 means the number of cores plus that value"},
+                },
+                RPCArgOptions{.oneline_description="options"}},
         },
         {
             RPCResult{"when action=='start'; only returns after scan completes", RPCResult::Type::OBJ, "", "", {
@@ -2122,19 +2210,7 @@ static RPCHelpMan scantxoutset()
                 {RPCResult::Type::NUM, "txouts", "The number of unspent transaction outputs scanned"},
                 {RPCResult::Type::NUM, "height", "The current block height (index)"},
                 {RPCResult::Type::STR_HEX, "bestblock", "The hash of the block at the tip of the chain"},
-                {RPCResult::Type::ARR, "unspents", "",
-                {
-                    {RPCResult::Type::OBJ, "", "",
-                    {
-                        {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
-                        {RPCResult::Type::NUM, "vout", "The vout value"},
-                        {RPCResult::Type::STR_HEX, "scriptPubKey", "The script key"},
-                        {RPCResult::Type::STR, "desc", "A specialized descriptor for the matched scriptPubKey"},
-                        {RPCResult::Type::STR_AMOUNT, "amount", "The total amount in " + CURRENCY_UNIT + " of the unspent output"},
-                        {RPCResult::Type::BOOL, "coinbase", "Whether this is a coinbase output"},
-                        {RPCResult::Type::NUM, "height", "Height of the unspent transaction output"},
-                    }},
-                }},
+                scan_result_unspents,
                 {RPCResult::Type::STR_AMOUNT, "total_amount", "The total amount of all found unspent outputs in " + CURRENCY_UNIT},
             }},
             scan_result_abort,
@@ -2159,6 +2235,10 @@ static RPCHelpMan scantxoutset()
             return UniValue::VNULL;
         }
         result.pushKV("progress", g_scan_progress.load());
+        result.pushKV("txouts", g_scan_txouts.load());
+        CAmount total_in = 0;
+        LOCK(g_scan_results_mutex);
+        result.pushKV("unspents", ScanUnspentsToJSON(g_scan_results, g_scan_descriptors, total_in));
         return result;
     } else if (request.params[0].get_str() == "abort") {
         CoinsViewScanReserver reserver;
@@ -2179,7 +2259,7 @@ static RPCHelpMan scantxoutset()
             throw JSONRPCError(RPC_MISC_ERROR, "scanobjects argument is required for the start action");
         }
 
-        std::set<CScript> needles;
+        ScanNeedles needles;
         std::map<CScript, std::string> descriptors;
         CAmount total_in = 0;
 
@@ -2193,14 +2273,18 @@ static RPCHelpMan scantxoutset()
                 descriptors.emplace(std::move(script), std::move(inferred));
             }
         }
+        WITH_LOCK(g_scan_results_mutex, g_scan_descriptors = descriptors);
+
+        UniValue options{request.params[2].isNull() ? UniValue::VOBJ : request.params[2]};
+        int threads{options.exists("threads") ? options["threads"].getInt<int>() : DEFAULT_SCAN_THREADS};
+        if (threads <= 0) threads += GetNumCores();
+        threads = std::clamp(threads, 1, MAX_SCAN_THREADS);
 
-        // Scan the unspent transaction output set for inputs
-        UniValue unspents(UniValue::VARR);
-        std::vector<CTxOut> input_txos;
-        std::map<COutPoint, Coin> coins;
+        // Scan the unspent transaction output set for inputs, split in slices
+        // of the txid keyspace. All cursors are opened while holding cs_main
+        // right after the flush, so they all see the UTXO set at the same tip.
         g_should_abort_scan = false;
-        int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
+        std::vector<CoinsScanSlice> slices(threads);
         const CBlockIndex* tip;
         NodeContext& node = EnsureAnyNodeContext(request.context);
         {
@@ -2208,34 +2292,59 @@ static RPCHelpMan scantxoutset()
             LOCK(cs_main);
             Chainstate& active_chainstate = chainman.ActiveChainstate();
             active_chainstate.ForceFlushStateToDisk();
-            pcursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor());
+            for (int i = 0; i < threads; ++i) {
+                slices[i].begin = 0x100 * i / threads;
+                slices[i].end = 0x100 * (i + 1) / threads;
+                uint256 start;
+                *start.begin() = slices[i].begin;
+                slices[i].cursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor(start));
+            }
             tip = CHECK_NONFATAL(active_chainstate.m_chain.Tip());
         }
-        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins, node.rpc_interruption_point);
+
+        // Found outputs are published right away, for status reports.
+        const std::function<void(const COutPoint&, const Coin&)> found = [](const COutPoint& outpoint, const Coin& coin) {
+            LOCK(g_scan_results_mutex);
+            g_scan_results.emplace(outpoint, coin);
+        };
+        Mutex done_mutex;
+        std::condition_variable done_cv;
+        int running{threads};
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([&, i] {
+                CoinsScanSlice& slice{slices[i]};
+                slice.success = FindScriptPubKey(slice, g_should_abort_scan, g_scan_txouts, needles, found);
+                WITH_LOCK(done_mutex, --running);
+                done_cv.notify_all();
+            });
+        }
+        while (WITH_LOCK(done_mutex, return running) > 0) {
+            {
+                WAIT_LOCK(done_mutex, lock);
+                done_cv.wait_for(lock, std::chrono::milliseconds{100}, [&]() EXCLUSIVE_LOCKS_REQUIRED(done_mutex) { return running == 0; });
+            }
+            uint32_t progress{0};
+            for (const CoinsScanSlice& slice : slices) progress += slice.progress;
+            g_scan_progress = (int)(progress * 100.0 / 65536.0 + 0.5);
+            try {
+                node.rpc_interruption_point(); // allow a clean shutdown
+            } catch (...) {
+                g_should_abort_scan = true;
+                for (std::thread& worker : workers) worker.join();
+                throw;
+            }
+        }
+        for (std::thread& worker : workers) worker.join();
+        g_scan_progress = 100;
+
+        const bool res{std::all_of(slices.begin(), slices.end(), [](const CoinsScanSlice& slice) { return slice.success; })};
         result.pushKV("success", res);
-        result.pushKV("txouts", count);
+        result.pushKV("txouts", g_scan_txouts.load());
         result.pushKV("height", tip->nHeight);
         result.pushKV("bestblock", tip->GetBlockHash().GetHex());
-
-        for (const auto& it : coins) {
-            const COutPoint& outpoint = it.first;
-            const Coin& coin = it.second;
-            const CTxOut& txo = coin.out;
-            input_txos.push_back(txo);
-            total_in += txo.nValue;
-
-            UniValue unspent(UniValue::VOBJ);
-            unspent.pushKV("txid", outpoint.hash.GetHex());
-            unspent.pushKV("vout", (int32_t)outpoint.n);
-            unspent.pushKV("scriptPubKey", HexStr(txo.scriptPubKey));
-            unspent.pushKV("desc", descriptors[txo.scriptPubKey]);
-            unspent.pushKV("amount", ValueFromAmount(txo.nValue));
-            unspent.pushKV("coinbase", coin.IsCoinBase());
-            unspent.pushKV("height", (int32_t)coin.nHeight);
-
-            unspents.push_back(unspent);
-        }
-        result.pushKV("unspents", unspents);
+        LOCK(g_scan_results_mutex);
+        result.pushKV("unspents", ScanUnspentsToJSON(g_scan_results, descriptors, total_in));
         result.pushKV("total_amount", ValueFromAmount(total_in));
     } else {
         throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid action '%s'", request.params[0].get_str()));
@@ -2250,6 +2359,9 @@ static std::atomic<int> g_scanfilter_progress;
 static std::atomic<int> g_scanfilter_progress_height;
 static std::atomic<bool> g_scanfilter_in_progress;
 static std::atomic<bool> g_scanfilter_should_abort_scan;
+/** Blocks found relevant so far by the running scan */
+static Mutex g_scanfilter_results_mutex;
+static std::vector<uint256> g_scanfilter_relevant_blocks GUARDED_BY(g_scanfilter_results_mutex);
 class BlockFiltersScanReserver
 {
 private:
@@ -2268,6 +2380,7 @@ public:
 
     ~BlockFiltersScanReserver() {
         if (m_could_reserve) {
+            WITH_LOCK(g_scanfilter_results_mutex, g_scanfilter_relevant_blocks.clear());
             g_scanfilter_in_progress = false;
         }
     }
@@ -2298,6 +2411,31 @@ static bool CheckBlockFilterMatches(BlockManager& blockman, const CBlockIndex& b
     return false;
 }
 
+/**
+ * Match every filter against the needles, the filters split in contiguous
+ * slices between `threads` threads. Returns a flag per filter; not a
+ * std::vector<bool>, whose elements cannot be written concurrently.
+ */
+static std::vector<char> MatchFilters(const std::vector<BlockFilter>& filters, const GCSFilter::ElementSet& needles, int threads)
+{
+    std::vector<char> matches(filters.size());
+    auto match_slice = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            matches[i] = filters[i].GetFilter().MatchAny(needles);
+        }
+    };
+
+    const size_t slices{std::min<size_t>(threads, filters.size())};
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < slices; ++i) {
+        workers.emplace_back(match_slice, filters.size() * i / slices, filters.size() * (i + 1) / slices);
+    }
+    match_slice(0, slices > 1 ? filters.size() / slices : filters.size());
+    for (std::thread& worker : workers) worker.join();
+
+    return matches;
+}
+
 static RPCHelpMan scanblocks()
 {
     return RPCHelpMan{"scanblocks",
@@ -2312,6 +2450,7 @@ static RPCHelpMan scanblocks()
             RPCArg{"options", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "",
                 {
                     {"filter_false_positives", RPCArg::Type::BOOL, RPCArg::Default{false}, "Filter false positives (slower and may fail on pruned nodes). Otherwise they may occur at a rate of 1/M"},
+                    {"threads", RPCArg::Type::NUM, RPCArg::Default{DEFAULT_SCAN_THREADS}, "Number of threads to match the filters with, <= 0 means the number of cores plus that value"},
                 },
                 RPCArgOptions{.oneline_description="options"}},
         },
@@ -2328,6 +2467,9 @@ static RPCHelpMan scanblocks()
             RPCResult{"when action=='status' and a scan is currently in progress", RPCResult::Type::OBJ, "", "", {
                     {RPCResult::Type::NUM, "progress", "Approximate percent complete"},
                     {RPCResult::Type::NUM, "current_height", "Height of the block currently being scanned"},
+                    {RPCResult::Type::ARR, "relevant_blocks", "Blocks that may have matched a scanobject, found so far.", {
+                        {RPCResult::Type::STR_HEX, "blockhash", "A relevant blockhash"},
+                    }},
                 },
             },
             scan_result_abort,
@@ -2351,6 +2493,10 @@ static RPCHelpMan scanblocks()
         }
         ret.pushKV("progress", g_scanfilter_progress.load());
         ret.pushKV("current_height", g_scanfilter_progress_height.load());
+        UniValue blocks(UniValue::VARR);
+        LOCK(g_scanfilter_results_mutex);
+        for (const uint256& block_hash : g_scanfilter_relevant_blocks) blocks.push_back(block_hash.GetHex());
+        ret.pushKV("relevant_blocks", blocks);
         return ret;
     } else if (request.params[0].get_str() == "abort") {
         BlockFiltersScanReserver reserver;
@@ -2375,6 +2521,9 @@ static RPCHelpMan scanblocks()
 
         UniValue options{request.params[5].isNull() ? UniValue::VOBJ : request.params[5]};
         bool filter_false_positives{options.exists("filter_false_positives") ? options["filter_false_positives"].get_bool() : false};
+        int threads{options.exists("threads") ? options["threads"].getInt<int>() : DEFAULT_SCAN_THREADS};
+        if (threads <= 0) threads += GetNumCores();
+        threads = std::clamp(threads, 1, MAX_SCAN_THREADS);
 
         BlockFilterIndex* index = GetBlockFilterIndex(filtertype);
         if (!index) {
@@ -2417,7 +2566,6 @@ static RPCHelpMan scanblocks()
                 needle_set.emplace(script.begin(), script.end());
             }
         }
-        UniValue blocks(UniValue::VARR);
         const int amount_per_chunk = 10000;
         std::vector<BlockFilter> filters;
         int start_block_height = start_index->nHeight; // for progress reporting
@@ -2443,9 +2591,11 @@ static RPCHelpMan scanblocks()
                     stop_block;
 
             if (index->LookupFilterRange(start_block, end_range, filters)) {
-                for (const BlockFilter& filter : filters) {
-                    // compare the elements-set with each filter
-                    if (filter.GetFilter().MatchAny(needle_set)) {
+                // compare the elements-set with each filter
+                const std::vector<char> matches{MatchFilters(filters, needle_set, threads)};
+                for (size_t i = 0; i < filters.size(); ++i) {
+                    const BlockFilter& filter{filters[i]};
+                    if (matches[i]) {
                         if (filter_false_positives) {
                             // Double check the filter matches by scanning the block
                             const CBlockIndex& blockindex = *CHECK_NONFATAL(WITH_LOCK(cs_main, return chainman.m_blockman.LookupBlockIndex(filter.GetBlockHash())));
@@ -2455,7 +2605,8 @@ static RPCHelpMan scanblocks()
                             }
                         }
 
-                        blocks.push_back(filter.GetBlockHash().GetHex());
+                        // Found blocks are published right away, for status reports.
+                        WITH_LOCK(g_scanfilter_results_mutex, g_scanfilter_relevant_blocks.push_back(filter.GetBlockHash()));
                     }
                 }
             }
@@ -2475,6 +2626,9 @@ static RPCHelpMan scanblocks()
 
         ret.pushKV("from_height", start_block_height);
         ret.pushKV("to_height", start_index->nHeight); // start_index is always the last scanned block here
+        UniValue blocks(UniValue::VARR);
+        LOCK(g_scanfilter_results_mutex);
+        for (const uint256& block_hash : g_scanfilter_relevant_blocks) blocks.push_back(block_hash.GetHex());
         ret.pushKV("relevant_blocks", blocks);
         ret.pushKV("completed", completed);
     }
@@ -2565,6 +2719,92 @@ static RPCHelpMan getblockfilter()
     };
 }
 
+UniValue AddressHistoryToJSON(const std::vector<AddressHistoryEntry>& entries)
+{
+    UniValue ret(UniValue::VARR);
+    for (const AddressHistoryEntry& entry : entries) {
+        UniValue out(UniValue::VOBJ);
+        out.pushKV("height", entry.height);
+        out.pushKV("txid", entry.txid.GetHex());
+        out.pushKV("vout", (uint64_t)entry.vout);
+        out.pushKV("amount", ValueFromAmount(entry.amount));
+        if (entry.spent) {
+            UniValue spent(UniValue::VOBJ);
+            spent.pushKV("txid", entry.spent->txid.GetHex());
+            spent.pushKV("vin", (uint64_t)entry.spent->vin);
+            spent.pushKV("height", entry.spent->height);
+            out.pushKV("spent", spent);
+        }
+        ret.push_back(out);
+    }
+    return ret;
+}
+
+static RPCHelpMan getaddresshistory()
+{
+    return RPCHelpMan{"getaddresshistory",
+                "\nList the confirmed outputs paying to an address, oldest first, and the inputs spending them.\n"
+                "Requires -addressindex.\n",
+                {
+                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address"},
+                    {"skip", RPCArg::Type::NUM, RPCArg::Default{0}, "The number of outputs to skip"},
+                    {"count", RPCArg::Type::NUM, RPCArg::Default{DEFAULT_ADDRESS_HISTORY_COUNT}, strprintf("The maximum number of outputs to return, up to %d", MAX_ADDRESS_HISTORY_COUNT)},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::NUM, "height", "The height of the block containing the output"},
+                            {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
+                            {RPCResult::Type::NUM, "vout", "The output number"},
+                            {RPCResult::Type::STR_AMOUNT, "amount", "The value of the output in " + CURRENCY_UNIT},
+                            {RPCResult::Type::OBJ, "spent", /*optional=*/true, "The input spending the output, if it was spent",
+                            {
+                                {RPCResult::Type::STR_HEX, "txid", "The spending transaction id"},
+                                {RPCResult::Type::NUM, "vin", "The input number"},
+                                {RPCResult::Type::NUM, "height", "The height of the block containing the spending transaction"},
+                            }},
+                        }},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\"") +
+                    HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\" 100 100") +
+                    HelpExampleRpc("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\", 100, 100")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    if (!g_address_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled. Start with -addressindex.");
+    }
+
+    const CTxDestination dest{DecodeDestination(request.params[0].get_str())};
+    if (!IsValidDestination(dest)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+    }
+    const int skip{request.params[1].isNull() ? 0 : request.params[1].getInt<int>()};
+    const int count{request.params[2].isNull() ? DEFAULT_ADDRESS_HISTORY_COUNT : request.params[2].getInt<int>()};
+    if (skip < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative skip");
+    }
+    if (count < 0 || count > MAX_ADDRESS_HISTORY_COUNT) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("count must be between 0 and %d", MAX_ADDRESS_HISTORY_COUNT));
+    }
+
+    if (!g_address_index->BlockUntilSyncedToCurrentChain()) {
+        const IndexSummary summary{g_address_index->GetSummary()};
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to get data because addressindex is still syncing. Current height: %d", summary.best_block_height));
+    }
+
+    std::vector<AddressHistoryEntry> entries;
+    if (!g_address_index->FindHistory(AddressIndex::ScriptHash(GetScriptForDestination(dest)), skip, count, entries)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read the address index. This error is unexpected and indicates index corruption.");
+    }
+    return AddressHistoryToJSON(entries);
+},
+    };
+}
+
 /**
  * Serialize the UTXO set to a file for loading elsewhere.
  *
@@ -2586,6 +2826,7 @@ static RPCHelpMan dumptxoutset()
                     {RPCResult::Type::NUM, "base_height", "the height of the base of the snapshot"},
                     {RPCResult::Type::STR, "path", "the absolute path that the snapshot was written to"},
                     {RPCResult::Type::STR_HEX, "txoutset_hash", "the hash of the UTXO set contents"},
+                    {RPCResult::Type::STR_HEX, "txoutset_muhash", "the MuHash of the UTXO set contents, as reported by gettxoutsetinfo"},
                     {RPCResult::Type::NUM, "nchaintx", "the number of transactions in the chain up to and including the base block"},
                 }
         },
@@ -2634,14 +2875,13 @@ UniValue CreateUTXOSnapshot(
     const fs::path& temppath)
 {
     std::unique_ptr<CCoinsViewCursor> pcursor;
-    std::optional<CCoinsStats> maybe_stats;
     const CBlockIndex* tip;
+    int threads;
 
     {
         // We need to lock cs_main to ensure that the coinsdb isn't written to
-        // between (i) flushing coins cache to disk (coinsdb), (ii) getting stats
-        // based upon the coinsdb, and (iii) constructing a cursor to the
-        // coinsdb for use below this block.
+        // between (i) flushing coins cache to disk (coinsdb) and (ii)
+        // constructing a cursor to the coinsdb for use below this block.
         //
         // Cursors returned by leveldb iterate over snapshots, so the contents
         // of the pcursor will not be affected by simultaneous writes during
@@ -2654,46 +2894,40 @@ UniValue CreateUTXOSnapshot(
 
         chainstate.ForceFlushStateToDisk();
 
-        maybe_stats = GetUTXOStats(&chainstate.CoinsDB(), chainstate.m_blockman, CoinStatsHashType::HASH_SERIALIZED, node.rpc_interruption_point);
-        if (!maybe_stats) {
-            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
-        }
-
         pcursor = chainstate.CoinsDB().Cursor();
-        tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(maybe_stats->hashBlock));
+        tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(pcursor->GetBestBlock()));
+        threads = CHECK_NONFATAL(node.chainman)->m_options.snapshot_threads;
     }
 
     LOG_TIME_SECONDS(strprintf("writing UTXO snapshot at height %s (%s) to file %s (via %s)",
         tip->nHeight, tip->GetBlockHash().ToString(),
         fs::PathToString(path), fs::PathToString(temppath)));
 
-    SnapshotMetadata metadata{tip->GetBlockHash(), maybe_stats->coins_count};
+    // The coins are counted and hashed as they are written, the metadata is
+    // written again with their count once they all are.
+    SnapshotMetadata metadata{tip->GetBlockHash(), 0};
 
     afile << metadata;
 
-    COutPoint key;
-    Coin coin;
-    unsigned int iter{0};
-
-    while (pcursor->Valid()) {
-        if (iter % 5000 == 0) node.rpc_interruption_point();
-        ++iter;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            afile << key;
-            afile << coin;
-        }
+    const SnapshotCoinsStats stats{WriteSnapshotCoins(afile, *pcursor, threads, node.rpc_interruption_point)};
 
-        pcursor->Next();
+    metadata.m_coins_count = stats.coins_count;
+    if (std::fseek(afile.Get(), 0, SEEK_SET) != 0) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to write snapshot metadata");
     }
+    afile << metadata;
 
-    afile.fclose();
+    if (afile.fclose() != 0) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to write snapshot file " + temppath.u8string());
+    }
 
     UniValue result(UniValue::VOBJ);
-    result.pushKV("coins_written", maybe_stats->coins_count);
+    result.pushKV("coins_written", stats.coins_count);
     result.pushKV("base_hash", tip->GetBlockHash().ToString());
     result.pushKV("base_height", tip->nHeight);
     result.pushKV("path", path.u8string());
-    result.pushKV("txoutset_hash", maybe_stats->hashSerialized.ToString());
+    result.pushKV("txoutset_hash", stats.hash_serialized.ToString());
+    result.pushKV("txoutset_muhash", stats.muhash.ToString());
     result.pushKV("nchaintx", tip->nChainTx);
     return result;
 }
@@ -2749,7 +2983,11 @@ static RPCHelpMan loadtxoutset()
     }
 
     SnapshotMetadata metadata;
-    afile >> metadata;
+    try {
+        afile >> metadata;
+    } catch (const std::ios_base::failure& e) {
+        throw JSONRPCError(RPC_DESERIALIZATION_ERROR, strprintf("Unable to parse metadata: %s", e.what()));
+    }
 
     uint256 base_blockhash = metadata.m_base_blockhash;
     if (!chainman.GetParams().AssumeutxoForBlockhash(base_blockhash).has_value()) {
@@ -2893,6 +3131,7 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &scantxoutset},
         {"blockchain", &scanblocks},
         {"blockchain", &getblockfilter},
+        {"blockchain", &getaddresshistory},
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
         {"blockchain", &getchainstates},
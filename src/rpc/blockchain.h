@@ -16,6 +16,7 @@
 #include <stdint.h>
 #include <vector>
 
+struct AddressHistoryEntry;
 class CBlock;
 class CBlockIndex;
 class Chainstate;
@@ -25,6 +26,14 @@ struct NodeContext;
 } // namespace node
 
 static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
+/** Number of outputs returned by an address history lookup when no count is given */
+static constexpr int DEFAULT_ADDRESS_HISTORY_COUNT{100};
+/** Maximum number of outputs returned by a single address history lookup */
+static constexpr int MAX_ADDRESS_HISTORY_COUNT{1000};
+/** Number of threads scantxoutset and scanblocks scan with by default, 0 meaning the number of cores */
+static constexpr int DEFAULT_SCAN_THREADS{0};
+/** Maximum number of threads scantxoutset and scanblocks scan with */
+static constexpr int MAX_SCAN_THREADS{16};
 
 /**
  * Get the difficulty of the net wrt to the given block index.
@@ -43,6 +52,9 @@ UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CB
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex) LOCKS_EXCLUDED(cs_main);
 
+/** Address index history to JSON, as returned by getaddresshistory */
+UniValue AddressHistoryToJSON(const std::vector<AddressHistoryEntry>& entries);
+
 /** Used by getblockstats to get feerates at different percentiles by weight  */
 void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
 
@@ -168,6 +168,19 @@ static RPCHelpMan getpeerinfo()
                                                       "Only known message types can appear as keys in the object and all bytes received\n"
                                                       "of unknown message types are listed under '"+NET_MESSAGE_TYPE_OTHER+"'."}
                     }},
+                    {RPCResult::Type::NUM, "processtime", "The total time in seconds spent processing messages from this peer"},
+                    {RPCResult::Type::OBJ_DYN, "processtime_per_msg", "",
+                    {
+                        {RPCResult::Type::NUM, "msg", "The time in seconds spent processing messages from this peer aggregated by message type\n"
+                                                      "When a message type is not listed in this json object, no time was spent on it.\n"
+                                                      "Time spent on messages of unknown type is listed under '"+NET_MESSAGE_TYPE_OTHER+"'."}
+                    }},
+                    {RPCResult::Type::NUM, "sigchecks", "The number of signatures verified while processing messages from this peer\n"
+                                                        "(excluding those verified by script verification threads during block validation)"},
+                    {RPCResult::Type::NUM, "recv_queue_bytes", "The bytes of received messages waiting to be processed"},
+                    {RPCResult::Type::NUM, "send_queue_bytes", "The bytes of messages waiting to be sent"},
+                    {RPCResult::Type::NUM, "orphan_bytes", "The memory used by orphan transactions received from this peer, in bytes"},
+                    {RPCResult::Type::NUM, "txrequest_bytes", "The memory used to track transactions announced by this peer, in bytes"},
                     {RPCResult::Type::STR, "connection_type", "Type of connection: \n" + Join(CONNECTION_TYPE_DOC, ",\n") + ".\n"
                                                               "Please note this output is unlikely to be stable in upcoming releases as we iterate to\n"
                                                               "best capture connection behaviors."},
@@ -276,6 +289,19 @@ static RPCHelpMan getpeerinfo()
                 recvPerMsgType.pushKV(i.first, i.second);
         }
         obj.pushKV("bytesrecv_per_msg", recvPerMsgType);
+
+        obj.pushKV("processtime", Ticks<SecondsDouble>(stats.m_process_time));
+        UniValue processTimePerMsgType(UniValue::VOBJ);
+        for (const auto& i : stats.mapProcessTimePerMsgType) {
+            if (i.second > 0us)
+                processTimePerMsgType.pushKV(i.first, Ticks<SecondsDouble>(i.second));
+        }
+        obj.pushKV("processtime_per_msg", processTimePerMsgType);
+        obj.pushKV("sigchecks", stats.m_sig_checks);
+        obj.pushKV("recv_queue_bytes", stats.m_recv_queue_bytes);
+        obj.pushKV("send_queue_bytes", stats.m_send_queue_bytes);
+        obj.pushKV("orphan_bytes", uint64_t(statestats.m_orphan_usage));
+        obj.pushKV("txrequest_bytes", uint64_t(statestats.m_txrequest_usage));
         obj.pushKV("connection_type", ConnectionTypeAsString(stats.m_conn_type));
         obj.pushKV("transport_protocol_type", TransportTypeAsString(stats.m_transport_type));
         obj.pushKV("session_id", stats.m_session_id);
@@ -6,6 +6,7 @@
 #include <chainparams.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/addressindex.h>
 #include <index/coinstatsindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
@@ -384,6 +385,10 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
     }
 
+    if (g_address_index) {
+        result.pushKVs(SummaryToJSON(g_address_index->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
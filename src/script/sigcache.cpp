@@ -90,6 +90,9 @@ public:
  * signatureCache could be made local to VerifySignature.
 */
 static CSignatureCache signatureCache;
+
+//! Signatures verified on this thread that were not found in signatureCache.
+thread_local uint64_t g_thread_sig_checks{0};
 } // namespace
 
 // To be called once in AppInitMain/BasicTestingSetup to initialize the
@@ -111,6 +114,7 @@ bool CachingTransactionSignatureChecker::VerifyECDSASignature(const std::vector<
     signatureCache.ComputeEntryECDSA(entry, sighash, vchSig, pubkey);
     if (signatureCache.Get(entry, !store))
         return true;
+    ++g_thread_sig_checks;
     if (!TransactionSignatureChecker::VerifyECDSASignature(vchSig, pubkey, sighash))
         return false;
     if (store)
@@ -123,7 +127,13 @@ bool CachingTransactionSignatureChecker::VerifySchnorrSignature(Span<const unsig
     uint256 entry;
     signatureCache.ComputeEntrySchnorr(entry, sighash, sig, pubkey);
     if (signatureCache.Get(entry, !store)) return true;
+    ++g_thread_sig_checks;
     if (!TransactionSignatureChecker::VerifySchnorrSignature(sig, pubkey, sighash)) return false;
     if (store) signatureCache.Set(entry);
     return true;
 }
+
+uint64_t GetThreadSignatureChecks()
+{
+    return g_thread_sig_checks;
+}
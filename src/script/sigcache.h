@@ -10,6 +10,7 @@
 #include <span.h>
 #include <util/hasher.h>
 
+#include <cstdint>
 #include <optional>
 #include <vector>
 
@@ -34,4 +35,11 @@ public:
 
 [[nodiscard]] bool InitSignatureCache(size_t max_size_bytes);
 
+/**
+ * Number of signatures the calling thread has verified through a CachingTransactionSignatureChecker
+ * without finding them in the signature cache. Callers take the difference of two readings to
+ * attribute the verifications done in between.
+ */
+uint64_t GetThreadSignatureChecks();
+
 #endif // SUPERAXECOIN_SCRIPT_SIGCACHE_H
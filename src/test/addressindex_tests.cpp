@@ -0,0 +1,80 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <index/addressindex.h>
+#include <interfaces/chain.h>
+#include <test/util/index.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(addressindex_initial_sync, TestChain100Setup)
+{
+    AddressIndex address_index(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(address_index.Init());
+
+    const CScript coinbase_script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const uint256 coinbase_hash{AddressIndex::ScriptHash(coinbase_script)};
+    std::vector<AddressHistoryEntry> entries;
+
+    // BlockUntilSyncedToCurrentChain should return false before the index is started.
+    BOOST_CHECK(!address_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(address_index.StartBackgroundSync());
+    IndexWaitSynced(address_index);
+
+    // Every coinbase of the chain pays to the coinbase key, oldest first.
+    BOOST_REQUIRE(address_index.FindHistory(coinbase_hash, 0, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), m_coinbase_txns.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        BOOST_CHECK_EQUAL(entries[i].height, int(i + 1));
+        BOOST_CHECK_EQUAL(entries[i].txid, m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(entries[i].vout, 0U);
+        BOOST_CHECK_EQUAL(entries[i].amount, m_coinbase_txns[i]->vout[0].nValue);
+        BOOST_CHECK(!entries[i].spent);
+    }
+
+    // Pagination
+    BOOST_REQUIRE(address_index.FindHistory(coinbase_hash, 95, 3, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 3U);
+    BOOST_CHECK_EQUAL(entries[0].height, 96);
+    BOOST_REQUIRE(address_index.FindHistory(coinbase_hash, 98, 10, entries));
+    BOOST_CHECK_EQUAL(entries.size(), 2U);
+    BOOST_REQUIRE(address_index.FindHistory(coinbase_hash, 100, 10, entries));
+    BOOST_CHECK(entries.empty());
+
+    // Spending the first coinbase records the spending input next to it,
+    // and the new output under its own script.
+    const CScript dest_script{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, dest_script, 1 * COIN, /*submit=*/false)};
+    CreateAndProcessBlock({spend}, coinbase_script);
+    BOOST_CHECK(address_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(address_index.FindHistory(coinbase_hash, 0, 2, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 2U);
+    BOOST_REQUIRE(entries[0].spent);
+    BOOST_CHECK_EQUAL(entries[0].spent->txid, spend.GetHash());
+    BOOST_CHECK_EQUAL(entries[0].spent->vin, 0U);
+    BOOST_CHECK_EQUAL(entries[0].spent->height, 101);
+    BOOST_CHECK(!entries[1].spent);
+
+    BOOST_REQUIRE(address_index.FindHistory(AddressIndex::ScriptHash(dest_script), 0, 10, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 1U);
+    BOOST_CHECK_EQUAL(entries[0].height, 101);
+    BOOST_CHECK_EQUAL(entries[0].txid, spend.GetHash());
+    BOOST_CHECK_EQUAL(entries[0].amount, 1 * COIN);
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification, see txindex_tests.
+    SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    address_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
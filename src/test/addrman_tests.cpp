@@ -18,7 +18,9 @@
 #include <boost/test/unit_test.hpp>
 
 #include <optional>
+#include <set>
 #include <string>
+#include <thread>
 
 using namespace std::literals;
 using node::NodeContext;
@@ -278,6 +280,49 @@ BOOST_AUTO_TEST_CASE(addrman_select_special)
     BOOST_CHECK(addrman->Select(/*new_only=*/false, NET_IPV4).first == addr1);
 }
 
+BOOST_AUTO_TEST_CASE(addrman_concurrent_select)
+{
+    auto addrman = std::make_unique<AddrMan>(EMPTY_NETGROUPMAN, DETERMINISTIC, GetCheckRatio(m_node));
+
+    std::vector<CAddress> addrs;
+    std::vector<CNetAddr> sources;
+    std::set<CService> known;
+    for (int i = 0; i < 2000; ++i) {
+        addrs.emplace_back(ResolveService(strprintf("250.%d.%d.1", i / 256, i % 256), 8333), NODE_NONE);
+        addrs.back().nTime = Now<NodeSeconds>();
+        known.insert(addrs.back());
+    }
+    for (int i = 0; i < 64; ++i) {
+        sources.push_back(ResolveIP(strprintf("252.%d.2.2", i)));
+    }
+
+    // Select from the published snapshots while another thread adds entries, moves some of them
+    // to tried, and evicts entries from colliding new bucket positions.
+    std::thread writer{[&] {
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            addrman->Add({addrs[i]}, sources[i % sources.size()]);
+            if (i % 3 == 0) addrman->Good(addrs[i]);
+        }
+    }};
+    size_t selected{0};
+    while (selected < 20000) {
+        const auto [addr, last_try]{addrman->Select()};
+        if (!addr.IsValid()) continue;
+        BOOST_REQUIRE(known.count(addr));
+        ++selected;
+    }
+    writer.join();
+
+    // Nothing is lost when the entries are written from a snapshot.
+    DataStream ssPeers{};
+    ssPeers << *addrman;
+    AddrMan addrman2{EMPTY_NETGROUPMAN, DETERMINISTIC, GetCheckRatio(m_node)};
+    ssPeers >> addrman2;
+    BOOST_CHECK_EQUAL(addrman2.Size(), addrman->Size());
+    BOOST_CHECK_EQUAL(addrman2.Size(std::nullopt, /*in_new=*/false), addrman->Size(std::nullopt, /*in_new=*/false));
+    BOOST_CHECK(known.count(addrman2.Select().first));
+}
+
 BOOST_AUTO_TEST_CASE(addrman_new_collisions)
 {
     auto addrman = std::make_unique<AddrMan>(EMPTY_NETGROUPMAN, DETERMINISTIC, GetCheckRatio(m_node));
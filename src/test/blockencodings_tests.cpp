@@ -302,6 +302,56 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(LargeMempoolRoundTripTest)
+{
+    // The mempool is scanned in batches of short IDs; make sure matches are
+    // found across batch boundaries and in a trailing partial batch.
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    TestMemPoolEntryHelper entry;
+
+    CBlock block;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig.resize(10);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 42;
+    block.vtx.push_back(MakeTransactionRef(tx));
+    block.nVersion = 42;
+    block.hashPrevBlock = InsecureRand256();
+    block.nBits = 0x207fffff;
+
+    LOCK2(cs_main, pool.cs);
+    std::vector<bool> in_mempool{false};
+    for (int i = 0; i < 301; ++i) {
+        tx.vin[0].prevout.hash = InsecureRand256();
+        tx.vin[0].prevout.n = 0;
+        const CTransactionRef ref{MakeTransactionRef(tx)};
+        const bool add_to_mempool{i != 150};
+        if (add_to_mempool) pool.addUnchecked(entry.FromTx(ref));
+        if (i % 3 == 0) {
+            block.vtx.push_back(ref);
+            in_mempool.push_back(add_to_mempool);
+        }
+    }
+    bool mutated;
+    block.hashMerkleRoot = BlockMerkleRoot(block, &mutated);
+    assert(!mutated);
+    while (!CheckProofOfWork(block.GetHash(), block.nBits, Params().GetConsensus())) ++block.nNonce;
+
+    CBlockHeaderAndShortTxIDs shortIDs{block};
+    PartiallyDownloadedBlock partialBlock(&pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_OK);
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        BOOST_CHECK_EQUAL(partialBlock.IsTxAvailable(i), i == 0 || in_mempool[i]);
+    }
+
+    CBlock block2;
+    std::vector<CTransactionRef> vtx_missing{block.vtx[51]};
+    BOOST_CHECK(partialBlock.FillBlock(block2, vtx_missing) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+    BOOST_CHECK_EQUAL(block.hashMerkleRoot.ToString(), BlockMerkleRoot(block2, &mutated).ToString());
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = InsecureRand256();
@@ -7,13 +7,16 @@
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/kernel_notifications.h>
+#include <pow.h>
 #include <script/solver.h>
 #include <primitives/block.h>
+#include <streams.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 #include <test/util/logging.h>
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 
 using node::BLOCK_SERIALIZATION_HEADER_SIZE;
@@ -201,4 +204,61 @@ BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
     BOOST_CHECK_EQUAL(read_block.nVersion, 2);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_compressed_blocks)
+{
+    const auto params {CreateChainParams(ArgsManager{}, ChainType::REGTEST)};
+    KernelNotifications notifications{m_node.exit_status};
+    const BlockManager::Options blockman_opts{
+        .chainparams = *params,
+        .compress_blocks = true,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+    };
+    BlockManager blockman{m_node.kernel->interrupt, blockman_opts};
+
+    // A block of repeated transactions, which compresses well
+    CBlock block{params->GenesisBlock()};
+    for (int i = 0; i < 100; ++i) block.vtx.push_back(block.vtx[0]);
+    while (!CheckProofOfWork(block.GetHash(), block.nBits, params->GetConsensus())) ++block.nNonce;
+    const unsigned int block_size{static_cast<unsigned int>(::GetSerializeSize(block, CLIENT_VERSION))};
+
+    const FlatFilePos pos{blockman.SaveBlockToDisk(block, /*nHeight=*/0, /*dbp=*/nullptr)};
+    BOOST_CHECK_EQUAL(pos.nPos, BLOCK_SERIALIZATION_HEADER_SIZE);
+    uint32_t stored_size;
+    bool compressed;
+    BOOST_REQUIRE(blockman.ReadBlockDataSize(pos, stored_size, compressed));
+    BOOST_CHECK(compressed);
+    BOOST_CHECK_LT(stored_size, block_size / 10);
+    BOOST_CHECK_EQUAL(blockman.CalculateCurrentUsage(), stored_size + BLOCK_SERIALIZATION_HEADER_SIZE);
+
+    // Blocks are decompressed when read
+    CBlock read_block;
+    BOOST_CHECK(blockman.ReadBlockFromDisk(read_block, pos));
+    BOOST_CHECK_EQUAL(read_block.GetHash(), block.GetHash());
+    BOOST_CHECK_EQUAL(read_block.vtx.size(), block.vtx.size());
+    std::vector<uint8_t> raw_block;
+    BOOST_CHECK(blockman.ReadRawBlockFromDisk(raw_block, pos));
+    std::vector<uint8_t> expected;
+    CVectorWriter{CLIENT_VERSION, expected, 0} << block;
+    BOOST_CHECK(raw_block == expected);
+
+    // A block that compression does not make smaller is stored as is
+    CBlock random_block;
+    random_block.hashPrevBlock = InsecureRand256();
+    random_block.hashMerkleRoot = InsecureRand256();
+    random_block.nTime = InsecureRand32();
+    random_block.nBits = InsecureRand32();
+    random_block.nNonce = InsecureRand32();
+    const FlatFilePos random_pos{blockman.SaveBlockToDisk(random_block, /*nHeight=*/1, /*dbp=*/nullptr)};
+    BOOST_REQUIRE(blockman.ReadBlockDataSize(random_pos, stored_size, compressed));
+    BOOST_CHECK(!compressed);
+    BOOST_CHECK_EQUAL(stored_size, ::GetSerializeSize(random_block, CLIENT_VERSION));
+
+    // A compressed block found during a reindex takes the space it is stored in
+    CBlockFileInfo* block_data = blockman.GetBlockFileInfo(0);
+    const unsigned int file_size{block_data->nSize};
+    BOOST_CHECK(blockman.SaveBlockToDisk(block, /*nHeight=*/0, /*dbp=*/&pos) == pos);
+    BOOST_CHECK_EQUAL(block_data->nSize, file_size);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,8 +7,10 @@
 #include <interfaces/chain.h>
 #include <kernel/coinstats.h>
 #include <test/util/index.h>
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
+#include <txdb.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -118,4 +120,38 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_unclean_shutdown, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(coinstats_parallel, TestingSetup)
+{
+    Chainstate& chainstate{m_node.chainman->ActiveChainstate()};
+    {
+        LOCK(cs_main);
+        CCoinsViewCache& cache{chainstate.CoinsTip()};
+        for (int i = 0; i < 1000; ++i) {
+            const COutPoint outpoint{InsecureRand256(), static_cast<uint32_t>(InsecureRandRange(4))};
+            cache.AddCoin(outpoint, Coin{CTxOut{InsecureRandMoneyAmount(), CScript{} << OP_TRUE}, 1, InsecureRandBool()}, false);
+        }
+        BOOST_REQUIRE(cache.Flush());
+    }
+
+    // Set hashes of slices of the coins database combine to the hash of all
+    // of it, and the totals add up.
+    CCoinsViewDB& db{WITH_LOCK(cs_main, return chainstate.CoinsDB())};
+    for (const auto hash_type : {kernel::CoinStatsHashType::MUHASH, kernel::CoinStatsHashType::NONE}) {
+        const auto expected{kernel::ComputeUTXOStats(hash_type, &db, m_node.chainman->m_blockman)};
+        BOOST_REQUIRE(expected);
+        for (const int threads : {2, 3, 16}) {
+            const auto stats{kernel::ComputeUTXOStats(hash_type, &db, m_node.chainman->m_blockman, {}, threads)};
+            BOOST_REQUIRE(stats);
+            BOOST_CHECK_EQUAL(stats->nHeight, expected->nHeight);
+            BOOST_CHECK_EQUAL(stats->hashBlock, expected->hashBlock);
+            BOOST_CHECK_EQUAL(stats->hashSerialized, expected->hashSerialized);
+            BOOST_CHECK_EQUAL(stats->coins_count, expected->coins_count);
+            BOOST_CHECK_EQUAL(stats->nTransactions, expected->nTransactions);
+            BOOST_CHECK_EQUAL(stats->nTransactionOutputs, expected->nTransactionOutputs);
+            BOOST_CHECK_EQUAL(stats->nBogoSize, expected->nBogoSize);
+            BOOST_CHECK(stats->total_amount == expected->total_amount);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
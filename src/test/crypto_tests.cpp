@@ -21,6 +21,9 @@
 #include <test/util/setup_common.h>
 #include <util/strencodings.h>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -838,6 +841,31 @@ BOOST_AUTO_TEST_CASE(chacha20_midblock)
     BOOST_CHECK(Span{block}.last(52) == Span{b3});
 }
 
+BOOST_AUTO_TEST_CASE(chacha20_multiblock)
+{
+    // Multi-block implementations must match block-at-a-time output, including
+    // across a wraparound of the 32-bit block counter.
+    const auto key = ParseHex<std::byte>("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+    const ChaCha20::Nonce96 nonce{0x01020304, 0x05060708090a0b0c};
+    for (uint32_t start : {0U, 3U, 0xffffffffU - 20, 0xfffffff8U}) {
+        std::vector<std::byte> bulk(64 * 37), single(64 * 37), in(64 * 37);
+        for (size_t i = 0; i < in.size(); ++i) in[i] = std::byte(i * 7);
+
+        ChaCha20 c20{key};
+        c20.Seek(nonce, start);
+        c20.Keystream(bulk);
+        c20.Seek(nonce, start);
+        for (size_t i = 0; i < single.size(); i += 64) c20.Keystream(Span{single}.subspan(i, 64));
+        BOOST_CHECK(bulk == single);
+
+        c20.Seek(nonce, start);
+        c20.Crypt(in, bulk);
+        c20.Seek(nonce, start);
+        for (size_t i = 0; i < single.size(); i += 64) c20.Crypt(Span{in}.subspan(i, 64), Span{single}.subspan(i, 64));
+        BOOST_CHECK(bulk == single);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(poly1305_testvector)
 {
     // RFC 7539, section 2.5.2.
@@ -1292,4 +1320,38 @@ BOOST_AUTO_TEST_CASE(muhash_tests)
     BOOST_CHECK_EQUAL(HexStr(out4), "3a31e6903aff0de9f62f9a9f7f8b861de76ce2cda09822b90014319ae5dc2271");
 }
 
+BOOST_AUTO_TEST_CASE(num3072_divide)
+{
+    const auto check_divide{[](const Num3072& a, const Num3072& b) {
+        Num3072 c{a};
+        c.Divide(b);
+        c.Multiply(b);
+        BOOST_CHECK(std::equal(std::begin(c.limbs), std::end(c.limbs), std::begin(a.limbs)));
+    }};
+    const auto random_num{[] {
+        unsigned char data[Num3072::BYTE_SIZE];
+        const auto bytes{g_insecure_rand_ctx.randbytes(Num3072::BYTE_SIZE)};
+        std::copy(bytes.begin(), bytes.end(), data);
+        return Num3072{data};
+    }};
+
+    // Small divisors, and the modulus minus one, its own inverse
+    Num3072 modulus_minus_one;
+    for (auto& limb : modulus_minus_one.limbs) limb = std::numeric_limits<Num3072::limb_t>::max();
+    modulus_minus_one.limbs[0] -= 1103717;
+    Num3072 two;
+    two.limbs[0] = 2;
+    for (const auto& b : {Num3072{}, two, modulus_minus_one}) {
+        check_divide(random_num(), b);
+    }
+    Num3072 one{modulus_minus_one};
+    one.Divide(modulus_minus_one);
+    const Num3072 expected_one;
+    BOOST_CHECK(std::equal(std::begin(one.limbs), std::end(one.limbs), std::begin(expected_one.limbs)));
+
+    for (int i = 0; i < 100; ++i) {
+        check_divide(random_num(), random_num());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
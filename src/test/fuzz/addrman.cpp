@@ -143,21 +143,20 @@ public:
     /**
      * Compare with another AddrMan.
      * This compares:
-     * - the values in `mapInfo` (the keys aka ids are ignored)
-     * - vvNew entries refer to the same addresses
-     * - vvTried entries refer to the same addresses
+     * - the entries in `m_tables` (the ids are ignored)
+     * - new bucket positions refer to the same addresses
+     * - tried bucket positions refer to the same addresses
      */
     bool operator==(const AddrManDeterministic& other) const
     {
         LOCK2(m_impl->cs, other.m_impl->cs);
 
-        if (m_impl->mapInfo.size() != other.m_impl->mapInfo.size() || m_impl->nNew != other.m_impl->nNew ||
+        if (m_impl->vRandom.size() != other.m_impl->vRandom.size() || m_impl->nNew != other.m_impl->nNew ||
             m_impl->nTried != other.m_impl->nTried) {
             return false;
         }
 
-        // Check that all values in `mapInfo` are equal to all values in `other.mapInfo`.
-        // Keys may be different.
+        // Check that all entries are equal to all entries of `other`. Ids may be different.
 
         auto addrinfo_hasher = [](const AddrInfo& a) {
             CSipHasher hasher(0, 0);
@@ -183,47 +182,49 @@ public:
 
         using Addresses = std::unordered_set<AddrInfo, decltype(addrinfo_hasher), decltype(addrinfo_eq)>;
 
-        const size_t num_addresses{m_impl->mapInfo.size()};
+        const size_t num_addresses{m_impl->vRandom.size()};
 
         Addresses addresses{num_addresses, addrinfo_hasher, addrinfo_eq};
-        for (const auto& [id, addr] : m_impl->mapInfo) {
-            addresses.insert(addr);
+        for (const nid_type id : m_impl->vRandom) {
+            addresses.insert(m_impl->m_tables.GetInfo(id));
         }
 
         Addresses other_addresses{num_addresses, addrinfo_hasher, addrinfo_eq};
-        for (const auto& [id, addr] : other.m_impl->mapInfo) {
-            other_addresses.insert(addr);
+        for (const nid_type id : other.m_impl->vRandom) {
+            other_addresses.insert(other.m_impl->m_tables.GetInfo(id));
         }
 
         if (addresses != other_addresses) {
             return false;
         }
 
-        auto IdsReferToSameAddress = [&](int id, int other_id) EXCLUSIVE_LOCKS_REQUIRED(m_impl->cs, other.m_impl->cs) {
+        auto IdsReferToSameAddress = [&](nid_type id, nid_type other_id) EXCLUSIVE_LOCKS_REQUIRED(m_impl->cs, other.m_impl->cs) {
             if (id == -1 && other_id == -1) {
                 return true;
             }
             if ((id == -1 && other_id != -1) || (id != -1 && other_id == -1)) {
                 return false;
             }
-            return m_impl->mapInfo.at(id) == other.m_impl->mapInfo.at(other_id);
+            return m_impl->m_tables.GetInfo(id) == other.m_impl->m_tables.GetInfo(other_id);
         };
 
-        // Check that `vvNew` contains the same addresses as `other.vvNew`. Notice - `vvNew[i][j]`
-        // contains just an id and the address is to be found in `mapInfo.at(id)`. The ids
-        // themselves may differ between `vvNew` and `other.vvNew`.
-        for (size_t i = 0; i < ADDRMAN_NEW_BUCKET_COUNT; ++i) {
-            for (size_t j = 0; j < ADDRMAN_BUCKET_SIZE; ++j) {
-                if (!IdsReferToSameAddress(m_impl->vvNew[i][j], other.m_impl->vvNew[i][j])) {
+        // Check that the new buckets contain the same addresses as `other`'s. Notice - a bucket
+        // position contains just an id and the address is to be found in `m_tables.GetInfo(id)`.
+        // The ids themselves may differ between the two.
+        for (int i = 0; i < ADDRMAN_NEW_BUCKET_COUNT; ++i) {
+            for (int j = 0; j < ADDRMAN_BUCKET_SIZE; ++j) {
+                if (!IdsReferToSameAddress(m_impl->m_tables.GetEntry(/*use_tried=*/false, i, j),
+                                           other.m_impl->m_tables.GetEntry(/*use_tried=*/false, i, j))) {
                     return false;
                 }
             }
         }
 
-        // Same for `vvTried`.
-        for (size_t i = 0; i < ADDRMAN_TRIED_BUCKET_COUNT; ++i) {
-            for (size_t j = 0; j < ADDRMAN_BUCKET_SIZE; ++j) {
-                if (!IdsReferToSameAddress(m_impl->vvTried[i][j], other.m_impl->vvTried[i][j])) {
+        // Same for the tried buckets.
+        for (int i = 0; i < ADDRMAN_TRIED_BUCKET_COUNT; ++i) {
+            for (int j = 0; j < ADDRMAN_BUCKET_SIZE; ++j) {
+                if (!IdsReferToSameAddress(m_impl->m_tables.GetEntry(/*use_tried=*/true, i, j),
+                                           other.m_impl->m_tables.GetEntry(/*use_tried=*/true, i, j))) {
                     return false;
                 }
             }
@@ -15,6 +15,7 @@
 #include <cassert>
 #include <cstdint>
 #include <iosfwd>
+#include <optional>
 #include <unordered_set>
 #include <vector>
 
@@ -78,6 +79,16 @@ FUZZ_TARGET(golomb_rice)
 
     assert(encoded_deltas == decoded_deltas);
 
+    {
+        SpanReader stream{0, golomb_rice_data};
+        const uint32_t n = static_cast<uint32_t>(ReadCompactSize(stream));
+        GolombRiceDecoder decoder{Span{golomb_rice_data}.last(stream.size())};
+        for (uint32_t i = 0; i < n; ++i) {
+            assert(decoder.Decode(BASIC_FILTER_P) == decoded_deltas[i]);
+        }
+        assert(decoder.RemainingBytes() == 0);
+    }
+
     {
         const std::vector<uint8_t> random_bytes = ConsumeRandomLengthByteVector(fuzzed_data_provider, 1024);
         SpanReader stream{0, random_bytes};
@@ -87,12 +98,25 @@ FUZZ_TARGET(golomb_rice)
         } catch (const std::ios_base::failure&) {
             return;
         }
+        // The word-at-a-time decoder must agree with the bit reader, also on
+        // where the data ends and how much of it is left over.
+        GolombRiceDecoder decoder{Span{random_bytes}.last(stream.size())};
         BitStreamReader<SpanReader> bitreader{stream};
+        const uint8_t P{fuzzed_data_provider.ConsumeIntegralInRange<uint8_t>(0, 63)};
         for (uint32_t i = 0; i < std::min<uint32_t>(n, 1024); ++i) {
+            std::optional<uint64_t> expected;
+            try {
+                expected = GolombRiceDecode(bitreader, P);
+            } catch (const std::ios_base::failure&) {
+            }
+            std::optional<uint64_t> decoded;
             try {
-                (void)GolombRiceDecode(bitreader, BASIC_FILTER_P);
+                decoded = decoder.Decode(P);
             } catch (const std::ios_base::failure&) {
             }
+            assert(decoded == expected);
+            if (!expected) break;
+            assert(decoder.RemainingBytes() == stream.size());
         }
     }
 }
@@ -0,0 +1,43 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <span.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <util/lz4.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+FUZZ_TARGET(lz4)
+{
+    FuzzedDataProvider fuzzed_data_provider{buffer.data(), buffer.size()};
+
+    // Arbitrary data must not be decoded out of bounds
+    const size_t out_size{fuzzed_data_provider.ConsumeIntegralInRange<size_t>(0, 1 << 16)};
+    const std::vector<std::byte> compressed{fuzzed_data_provider.ConsumeBytes<std::byte>(fuzzed_data_provider.ConsumeIntegralInRange<size_t>(0, 1 << 12))};
+    std::vector<std::byte> out(out_size);
+    (void)util::LZ4Decompress(compressed, out);
+
+    // Data compresses within the bound, and decompresses to itself
+    const size_t prefix_size{fuzzed_data_provider.ConsumeIntegral<uint16_t>()};
+    const std::vector<std::byte> data{fuzzed_data_provider.ConsumeRemainingBytes<std::byte>()};
+    std::vector<std::byte> roundtrip_compressed;
+    util::LZ4Compress(data, roundtrip_compressed);
+    assert(roundtrip_compressed.size() <= util::LZ4CompressBound(data.size()));
+    std::vector<std::byte> decompressed(data.size());
+    assert(util::LZ4Decompress(roundtrip_compressed, decompressed));
+    assert(decompressed == data);
+    if (!data.empty()) {
+        decompressed.pop_back();
+        assert(!util::LZ4Decompress(roundtrip_compressed, decompressed));
+        // Any prefix of the data can be decompressed on its own
+        decompressed.resize(std::min(prefix_size, data.size()));
+        assert(util::LZ4DecompressPrefix(roundtrip_compressed, decompressed));
+        assert(std::equal(decompressed.begin(), decompressed.end(), data.begin()));
+    }
+}
@@ -11,7 +11,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <limits>
 #include <optional>
 #include <vector>
 
@@ -35,6 +37,8 @@ FUZZ_TARGET(node_eviction)
             /*m_network=*/fuzzed_data_provider.PickValueInArray(ALL_NETWORKS),
             /*m_noban=*/fuzzed_data_provider.ConsumeBool(),
             /*m_conn_type=*/fuzzed_data_provider.PickValueInArray(ALL_CONNECTION_TYPES),
+            /*m_process_time=*/std::chrono::microseconds{fuzzed_data_provider.ConsumeIntegralInRange<int64_t>(0, std::numeric_limits<int32_t>::max())},
+            /*m_memory_usage=*/fuzzed_data_provider.ConsumeIntegralInRange<size_t>(0, std::numeric_limits<uint32_t>::max()),
         });
     }
     // Make a copy since eviction_candidates may be in some valid but otherwise
@@ -191,6 +191,11 @@ void SimulationTest(Transport& initiator, Transport& responder, R& rng, FuzzedDa
         assert(bytes == bytes_next);
         assert(msg_type == msg_type_next);
         if (more_nonext) assert(more_next);
+        // The scatter-gather variant must start with the same bytes.
+        const auto& [spans, more_v, msg_type_v] = transports[side]->GetBytesToSendV(false);
+        assert(spans[0] == bytes);
+        assert(msg_type_v == msg_type);
+        if (!spans[1].empty()) assert(more_nonext);
         // Compare with previously reported output.
         assert(to_send[side].size() <= bytes.size());
         assert(to_send[side] == Span{bytes}.first(to_send[side].size()));
@@ -132,9 +132,14 @@ FUZZ_TARGET(txorphan, .init = initialize_orphanage)
                     // test mocktime and expiry
                     SetMockTime(ConsumeTime(fuzzed_data_provider));
                     auto limit = fuzzed_data_provider.ConsumeIntegral<unsigned int>();
-                    orphanage.LimitOrphans(limit);
+                    auto usage_limit = fuzzed_data_provider.ConsumeIntegral<size_t>();
+                    orphanage.LimitOrphans(limit, usage_limit);
                     Assert(orphanage.Size() <= limit);
+                    Assert(orphanage.TotalOrphanUsage() <= usage_limit);
                 });
+            // per-peer usage is part of the total
+            Assert(orphanage.UsageByPeer(peer_id) <= orphanage.TotalOrphanUsage());
+            Assert((orphanage.Size() == 0) == (orphanage.TotalOrphanUsage() == 0));
         }
     }
 }
@@ -318,7 +318,7 @@ FUZZ_TARGET(txrequest)
     // Decode the input as a sequence of instructions with parameters
     auto it = buffer.begin();
     while (it != buffer.end()) {
-        int cmd = *(it++) % 11;
+        int cmd = *(it++) % 14;
         int peer, txidnum, delaynum;
         switch (cmd) {
         case 0: // Make time jump to the next event (m_time of CANDIDATE or REQUESTED)
@@ -366,6 +366,23 @@ FUZZ_TARGET(txrequest)
             txidnum = it == buffer.end() ? 0 : *(it++);
             tester.ReceivedResponse(peer, txidnum % MAX_TXHASHES);
             break;
+        case 11: // Received an inv for every txhash at once, all with the same reqtime
+            peer = it == buffer.end() ? 0 : *(it++) % MAX_PEERS;
+            delaynum = it == buffer.end() ? 0 : *(it++);
+            for (int txhash = 0; txhash < MAX_TXHASHES; ++txhash) {
+                tester.ReceivedInv(peer, txhash, delaynum & 1, delaynum & 2, tester.Now() + DELAYS[delaynum]);
+            }
+            break;
+        case 12: // Peer reconnected and announced again
+            peer = it == buffer.end() ? 0 : *(it++) % MAX_PEERS;
+            txidnum = it == buffer.end() ? 0 : *(it++);
+            tester.DisconnectedPeer(peer);
+            tester.ReceivedInv(peer, txidnum % MAX_TXHASHES, (txidnum / MAX_TXHASHES) & 1, (txidnum / MAX_TXHASHES) & 2,
+                std::chrono::microseconds::min());
+            break;
+        case 13: // Check consistency in the middle of the sequence too
+            tester.Check();
+            break;
         default:
             assert(false);
         }
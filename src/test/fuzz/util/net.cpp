@@ -134,6 +134,14 @@ ssize_t FuzzedSock::Send(const void* data, size_t len, int flags) const
     return r;
 }
 
+ssize_t FuzzedSock::SendMany(Span<const Span<const unsigned char>> bufs, int flags) const
+{
+    size_t len{0};
+    for (const auto& buf : bufs) len += buf.size();
+    // The outcome only depends on the total size, not on the contents.
+    return Send(nullptr, len, flags);
+}
+
 ssize_t FuzzedSock::Recv(void* buf, size_t len, int flags) const
 {
     // Have a permanent error at recv_errnos[0] because when the fuzzed data is exhausted
@@ -106,6 +106,38 @@ BOOST_AUTO_TEST_CASE(siphash)
 
     BOOST_CHECK_EQUAL(SipHashUint256(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL, uint256S("1f1e1d1c1b1a191817161514131211100f0e0d0c0b0a09080706050403020100")), 0x7127512f72f27cceull);
 
+    // Check that the batched version matches SipHashUint256 for every batch size, including partial lanes
+    std::vector<uint256> batch_vals;
+    for (int i = 0; i < 11; ++i) batch_vals.push_back(InsecureRand256());
+    for (size_t n = 0; n <= batch_vals.size(); ++n) {
+        const uint64_t k0{InsecureRandBits(64)}, k1{InsecureRandBits(64)};
+        std::vector<const uint256*> ptrs;
+        for (size_t i = 0; i < n; ++i) ptrs.push_back(&batch_vals[i]);
+        std::vector<uint64_t> out(n);
+        SipHashUint256Batch(k0, k1, ptrs, out);
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(out[i], SipHashUint256(k0, k1, batch_vals[i]));
+        }
+    }
+
+    // Check that the word-at-a-time and batched byte string versions match CSipHasher, for
+    // lengths around the word size and pairs of lengths with and without a common prefix
+    std::vector<std::vector<unsigned char>> byte_vals;
+    for (size_t len = 0; len < 40; ++len) byte_vals.push_back(g_insecure_rand_ctx.randbytes(len));
+    for (size_t len : {63, 64, 65, 200}) byte_vals.push_back(g_insecure_rand_ctx.randbytes(len));
+    for (int round = 0; round < 4; ++round) {
+        const uint64_t k0{InsecureRandBits(64)}, k1{InsecureRandBits(64)};
+        Shuffle(byte_vals.begin(), byte_vals.end(), g_insecure_rand_ctx);
+        std::vector<Span<const unsigned char>> spans(byte_vals.begin(), byte_vals.end());
+        std::vector<uint64_t> out(spans.size() + round);
+        SipHashBatch(k0, k1, Span{spans}.first(spans.size() - round), out);
+        for (size_t i = 0; i < spans.size(); ++i) {
+            const uint64_t expected{CSipHasher(k0, k1).Write(spans[i]).Finalize()};
+            BOOST_CHECK_EQUAL(SipHash(k0, k1, spans[i]), expected);
+            if (i < spans.size() - round) BOOST_CHECK_EQUAL(out[i], expected);
+        }
+    }
+
     // Check test vectors from spec, one byte at a time
     CSipHasher hasher2(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL);
     for (uint8_t x=0; x<std::size(siphash_4_2_testvec); ++x)
@@ -6,6 +6,7 @@
 #include <policy/policy.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
+#include <util/rbf.h>
 #include <util/time.h>
 
 #include <test/util/setup_common.h>
@@ -800,4 +801,72 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTestsDiamond)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolSnapshotTest)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // ta signals BIP125, tb spends it and inherits replaceability, tc is unrelated
+    CMutableTransaction mta;
+    mta.vin.resize(1);
+    mta.vin[0].nSequence = MAX_BIP125_RBF_SEQUENCE;
+    mta.vout.resize(2);
+    for (auto& out : mta.vout) {
+        out.scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        out.nValue = 5 * COIN;
+    }
+    const CTransactionRef ta{MakeTransactionRef(mta)};
+    const CTransactionRef tb{make_tx(/*output_values=*/{4 * COIN}, /*inputs=*/{ta})};
+    const CTransactionRef tc{make_tx(/*output_values=*/{3 * COIN})};
+    pool.addUnchecked(entry.Fee(10000LL).FromTx(ta));
+    pool.addUnchecked(entry.Fee(20000LL).FromTx(tb));
+
+    const auto snapshot{pool.GetSnapshot()};
+    BOOST_CHECK_EQUAL(snapshot->entries.size(), 2U);
+    BOOST_CHECK_EQUAL(snapshot->mempool_sequence, pool.GetSequence());
+    const MempoolEntrySnapshot* sa{snapshot->Find(ta->GetHash())};
+    const MempoolEntrySnapshot* sb{snapshot->Find(tb->GetHash())};
+    BOOST_REQUIRE(sa && sb);
+    BOOST_CHECK(!snapshot->Find(tc->GetHash()));
+    BOOST_CHECK(sa->bip125_replaceable);
+    BOOST_CHECK(sb->bip125_replaceable);
+    BOOST_CHECK(sa->children == std::vector<uint256>{tb->GetHash()});
+    BOOST_CHECK(sb->parents == std::vector<uint256>{ta->GetHash()});
+    BOOST_CHECK_EQUAL(sa->count_with_descendants, 2U);
+    BOOST_CHECK_EQUAL(sa->mod_fees_with_descendants, 30000);
+    BOOST_CHECK_EQUAL(sb->count_with_ancestors, 2U);
+
+    // An unchanged mempool hands out the same snapshot
+    BOOST_CHECK_EQUAL(pool.GetSnapshot(), snapshot);
+
+    // Entry snapshots taken directly agree with the full snapshot
+    const MempoolEntrySnapshot direct{pool.GetEntrySnapshot(*pool.GetIter(tb->GetHash()))};
+    BOOST_CHECK(direct.bip125_replaceable);
+    BOOST_CHECK_EQUAL(direct.size_with_ancestors, sb->size_with_ancestors);
+
+    // Prioritisation, unbroadcast status and additions all publish a new
+    // snapshot, leaving the old one untouched for readers still holding it
+    pool.PrioritiseTransaction(tb->GetHash(), 5000);
+    const auto prioritised{pool.GetSnapshot()};
+    BOOST_CHECK(prioritised != snapshot);
+    BOOST_CHECK_EQUAL(prioritised->Find(tb->GetHash())->modified_fee, 25000);
+    BOOST_CHECK_EQUAL(snapshot->Find(tb->GetHash())->modified_fee, 20000);
+
+    pool.AddUnbroadcastTx(ta->GetHash());
+    const auto unbroadcast{pool.GetSnapshot()};
+    BOOST_CHECK(unbroadcast != prioritised);
+    BOOST_CHECK(unbroadcast->Find(ta->GetHash())->unbroadcast);
+
+    pool.addUnchecked(entry.Fee(10000LL).FromTx(tc));
+    const auto added{pool.GetSnapshot()};
+    BOOST_CHECK_EQUAL(added->entries.size(), 3U);
+    BOOST_CHECK(!added->Find(tc->GetHash())->bip125_replaceable);
+
+    pool.removeRecursive(*ta, REMOVAL_REASON_DUMMY);
+    const auto removed{pool.GetSnapshot()};
+    BOOST_CHECK_EQUAL(removed->entries.size(), 1U);
+    BOOST_CHECK_EQUAL(added->entries.size(), 3U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -676,6 +676,44 @@ BOOST_AUTO_TEST_CASE(peer_eviction_test)
             BOOST_CHECK(!SelectNodeToEvict(GetRandomNodeEvictionCandidates(number_of_nodes, random_context)));
         }
 
+        // A peer that takes disproportionate processing time or memory is evicted first once
+        // the protected peers are taken out. It ranks low on every protection criterion, but
+        // would not be evicted otherwise: the youngest connection would be.
+        if (number_of_nodes >= 29) {
+            const NodeId heavy_id{number_of_nodes - 2};
+            const auto setup_unprotected = [number_of_nodes](NodeEvictionCandidate& candidate) {
+                candidate.nKeyedNetGroup = number_of_nodes - candidate.id;
+                candidate.m_min_ping_time = std::chrono::microseconds{candidate.id};
+                candidate.m_last_tx_time = std::chrono::seconds{number_of_nodes - candidate.id};
+                candidate.m_last_block_time = std::chrono::seconds{number_of_nodes - candidate.id};
+                candidate.m_connected = std::chrono::seconds{candidate.id};
+                candidate.m_relay_txs = true;
+                candidate.prefer_evict = false;
+                candidate.m_is_local = false;
+                candidate.m_network = NET_IPV4;
+            };
+            BOOST_CHECK(IsEvicted(
+                number_of_nodes, [&](NodeEvictionCandidate& candidate) {
+                    setup_unprotected(candidate);
+                    if (candidate.id == heavy_id) candidate.m_memory_usage = EVICTION_MIN_MEMORY_USAGE + 1;
+                },
+                {heavy_id}, random_context));
+            BOOST_CHECK(IsEvicted(
+                number_of_nodes, [&](NodeEvictionCandidate& candidate) {
+                    setup_unprotected(candidate);
+                    candidate.m_process_time = std::chrono::seconds{1};
+                    if (candidate.id == heavy_id) candidate.m_process_time = std::chrono::seconds{EVICTION_RESOURCE_MEDIAN_MULTIPLE + 1};
+                },
+                {heavy_id}, random_context));
+            // Up to the absolute minimum, a peer is not considered heavy however it compares to the others.
+            BOOST_CHECK(!IsEvicted(
+                number_of_nodes, [&](NodeEvictionCandidate& candidate) {
+                    setup_unprotected(candidate);
+                    if (candidate.id == heavy_id) candidate.m_memory_usage = EVICTION_MIN_MEMORY_USAGE;
+                },
+                {heavy_id}, random_context));
+        }
+
         // Cases left to test:
         // * "If any remaining peers are preferred for eviction consider only them. [...]"
         // * "Identify the network group with the most connections and youngest member. [...]"
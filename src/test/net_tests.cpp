@@ -15,6 +15,8 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <test/util/mining.h>
+#include <test/util/net.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
@@ -22,6 +24,7 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 #include <validation.h>
+#include <validationinterface.h>
 #include <version.h>
 
 #include <boost/test/unit_test.hpp>
@@ -910,6 +913,121 @@ BOOST_AUTO_TEST_CASE(initial_advertise_from_version_message)
 }
 
 
+BOOST_AUTO_TEST_CASE(concurrent_messages_keep_order)
+{
+    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+    auto& connman{static_cast<ConnmanTestMsg&>(*m_node.connman)};
+    PeerManager& peerman{*m_node.peerman};
+    const CNetMsgMaker msg_maker{PROTOCOL_VERSION};
+
+    in_addr peer_in_addr;
+    peer_in_addr.s_addr = htonl(0x01020304);
+    CNode peer{/*id=*/0,
+               /*sock=*/nullptr,
+               /*addrIn=*/CAddress{CService{peer_in_addr, 8333}, NODE_NETWORK},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               /*addrBindIn=*/CAddress{},
+               /*addrNameIn=*/std::string{},
+               /*conn_type_in=*/ConnectionType::INBOUND,
+               /*inbound_onion=*/false};
+    connman.Handshake(peer, /*successfully_connected=*/true, ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+                      ServiceFlags(NODE_NETWORK | NODE_WITNESS), PROTOCOL_VERSION, /*relay_txs=*/true);
+    connman.FlushSendBuffer(peer);
+    // Without a send buffer limit in the test connman, every sent message pauses sending.
+    peer.fPauseSend = false;
+
+    size_t pongs{0};
+    m_node.args->ForceSetArg("-capturemessages", "1");
+    const auto CaptureMessageOrig = CaptureMessage;
+    CaptureMessage = [&pongs](const CAddress& addr, const std::string& msg_type, Span<const unsigned char> data, bool is_incoming) {
+        if (!is_incoming && msg_type == NetMsgType::PONG) ++pongs;
+    };
+
+    // A ping at the front of the queue is answered without g_msgproc_mutex.
+    (void)connman.ReceiveMsgFrom(peer, msg_maker.Make(NetMsgType::PING, uint64_t{1}));
+    (void)connman.ReceiveMsgFrom(peer, msg_maker.Make(NetMsgType::SENDHEADERS));
+    (void)connman.ReceiveMsgFrom(peer, msg_maker.Make(NetMsgType::PING, uint64_t{2}));
+    BOOST_CHECK(peerman.ProcessConcurrentMessages(&peer));
+    BOOST_CHECK_EQUAL(pongs, 1U);
+    peer.fPauseSend = false;
+
+    // A ping behind a message that needs g_msgproc_mutex waits for it.
+    BOOST_CHECK(!peerman.ProcessConcurrentMessages(&peer));
+    BOOST_CHECK_EQUAL(pongs, 1U);
+    connman.ProcessMessagesOnce(peer);
+    BOOST_CHECK_EQUAL(pongs, 1U);
+    BOOST_CHECK(!peerman.ProcessConcurrentMessages(&peer));
+    BOOST_CHECK_EQUAL(pongs, 2U);
+
+    CaptureMessage = CaptureMessageOrig;
+    m_node.args->ForceSetArg("-capturemessages", "0");
+    peerman.FinalizeNode(peer);
+    TestOnlyResetTimeData();
+}
+
+BOOST_AUTO_TEST_CASE(recent_block_messages_shared)
+{
+    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+    auto& connman{static_cast<ConnmanTestMsg&>(*m_node.connman)};
+    PeerManager& peerman{*m_node.peerman};
+    const CNetMsgMaker msg_maker{PROTOCOL_VERSION};
+
+    // Connecting a new block after IBD makes it the PeerManager's most recent block.
+    static_cast<TestChainstateManager&>(*m_node.chainman).JumpOutOfIbd();
+    RegisterValidationInterface(&peerman);
+    auto block{PrepareBlock(m_node, CScript{} << OP_TRUE)};
+    BOOST_REQUIRE(!MineBlock(m_node, block).IsNull());
+    UnregisterValidationInterface(&peerman);
+
+    std::vector<const unsigned char*> block_payloads;
+    m_node.args->ForceSetArg("-capturemessages", "1");
+    const auto CaptureMessageOrig = CaptureMessage;
+    CaptureMessage = [&block_payloads](const CAddress& addr, const std::string& msg_type, Span<const unsigned char> data, bool is_incoming) {
+        if (!is_incoming && msg_type == NetMsgType::BLOCK) block_payloads.push_back(data.data());
+    };
+
+    in_addr peer_in_addr;
+    peer_in_addr.s_addr = htonl(0x01020304);
+    std::vector<std::unique_ptr<CNode>> peers;
+    for (NodeId id{0}; id < 2; ++id) {
+        peers.push_back(std::make_unique<CNode>(id,
+                                                /*sock=*/nullptr,
+                                                /*addrIn=*/CAddress{CService{peer_in_addr, 8333}, NODE_NETWORK},
+                                                /*nKeyedNetGroupIn=*/0,
+                                                /*nLocalHostNonceIn=*/0,
+                                                /*addrBindIn=*/CAddress{},
+                                                /*addrNameIn=*/std::string{},
+                                                /*conn_type_in=*/ConnectionType::INBOUND,
+                                                /*inbound_onion=*/false));
+        connman.Handshake(*peers.back(), /*successfully_connected=*/true, ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+                          ServiceFlags(NODE_NETWORK | NODE_WITNESS), PROTOCOL_VERSION, /*relay_txs=*/true);
+    }
+
+    // Each peer keeps the block sent to it until it requests the next one, so that payloads
+    // which are not shared are allocated at the same time, and thus differ.
+    for (const GetDataMsg inv_type : {MSG_BLOCK, MSG_WITNESS_BLOCK}) {
+        for (const auto& peer : peers) {
+            connman.FlushSendBuffer(*peer);
+            peer->fPauseSend = false;
+            (void)connman.ReceiveMsgFrom(*peer, msg_maker.Make(NetMsgType::GETDATA, std::vector<CInv>{CInv{inv_type, block->GetHash()}}));
+            connman.ProcessMessagesOnce(*peer);
+        }
+    }
+
+    // Both peers were sent the same serialized blocks, without and with witness data.
+    BOOST_REQUIRE_EQUAL(block_payloads.size(), 4U);
+    BOOST_CHECK(block_payloads[0] == block_payloads[1]);
+    BOOST_CHECK(block_payloads[2] == block_payloads[3]);
+    BOOST_CHECK(block_payloads[0] != block_payloads[2]);
+
+    CaptureMessage = CaptureMessageOrig;
+    m_node.args->ForceSetArg("-capturemessages", "0");
+    for (const auto& peer : peers) peerman.FinalizeNode(*peer);
+}
+
 BOOST_AUTO_TEST_CASE(advertise_local_address)
 {
     auto CreatePeer = [](const CAddress& addr) {
@@ -1565,4 +1683,59 @@ BOOST_AUTO_TEST_CASE(v2transport_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(v1transport_shared_payload)
+{
+    CSerializedNetMsg msg;
+    msg.m_type = NetMsgType::BLOCK;
+    msg.data = g_insecure_rand_ctx.randbytes<uint8_t>(1000);
+    const std::vector<uint8_t> payload{msg.data};
+    msg.MakeShared();
+    BOOST_CHECK(msg.data.empty());
+    BOOST_CHECK(msg.Payload() == Span{payload});
+
+    // Copies of a shared message reference the same payload.
+    std::vector<CSerializedNetMsg> copies;
+    for (int i = 0; i < 3; ++i) copies.push_back(msg.Copy());
+    for (const auto& copy : copies) BOOST_CHECK(copy.Payload().data() == msg.Payload().data());
+
+    for (auto& copy : copies) {
+        V1Transport sender{0, SER_NETWORK, INIT_PROTO_VERSION};
+        V1Transport receiver{1, SER_NETWORK, INIT_PROTO_VERSION};
+        BOOST_REQUIRE(sender.SetMessageToSend(copy));
+
+        // The header and the shared payload are handed out together, without copying the latter.
+        std::vector<uint8_t> wire;
+        {
+            const auto& [spans, more, msg_type] = sender.GetBytesToSendV(/*have_next_message=*/false);
+            BOOST_CHECK_EQUAL(spans[0].size(), CMessageHeader::HEADER_SIZE);
+            BOOST_CHECK(spans[1].data() == msg.Payload().data());
+            BOOST_CHECK(!more);
+            BOOST_CHECK_EQUAL(msg_type, NetMsgType::BLOCK);
+            for (const auto& span : spans) wire.insert(wire.end(), span.begin(), span.end());
+        }
+
+        // A partial write may end beyond the header.
+        sender.MarkBytesSent(CMessageHeader::HEADER_SIZE + 10);
+        {
+            const auto& [spans, more, msg_type] = sender.GetBytesToSendV(/*have_next_message=*/false);
+            BOOST_CHECK(spans[0] == Span{payload}.subspan(10));
+            BOOST_CHECK(spans[1].empty());
+            sender.MarkBytesSent(spans[0].size());
+        }
+        BOOST_CHECK(std::get<0>(sender.GetBytesToSend(/*have_next_message=*/false)).empty());
+
+        Span<const uint8_t> to_recv{wire};
+        while (!to_recv.empty()) BOOST_REQUIRE(receiver.ReceivedBytes(to_recv));
+        BOOST_REQUIRE(receiver.ReceivedMessageComplete());
+        bool reject{false};
+        CNetMessage received{receiver.GetReceivedMessage(std::chrono::microseconds{0}, reject)};
+        BOOST_CHECK(!reject);
+        BOOST_CHECK_EQUAL(received.m_type, NetMsgType::BLOCK);
+        BOOST_CHECK(Span{received.m_recv} == MakeByteSpan(payload));
+    }
+
+    // Sent messages release their reference to the payload.
+    BOOST_CHECK_EQUAL(msg.m_shared_data.use_count(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
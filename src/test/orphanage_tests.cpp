@@ -136,4 +136,99 @@ BOOST_AUTO_TEST_CASE(DoS_mapOrphans)
     BOOST_CHECK(orphanage.CountOrphans() == 0);
 }
 
+static CTransactionRef MakeOrphan(const std::vector<COutPoint>& prevouts, size_t script_size)
+{
+    CMutableTransaction tx;
+    for (const COutPoint& prevout : prevouts) {
+        tx.vin.emplace_back(prevout);
+    }
+    tx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(script_size, 0x01);
+    tx.vout.resize(2);
+    tx.vout[0].nValue = 1 * CENT;
+    tx.vout[1].nValue = 1 * CENT;
+    return MakeTransactionRef(tx);
+}
+
+BOOST_AUTO_TEST_CASE(orphanage_memory_limits)
+{
+    TxOrphanageTest orphanage;
+
+    // Peer 0 announces many large orphans, peer 1 a couple of small ones.
+    for (int i = 0; i < 20; i++) {
+        BOOST_CHECK(orphanage.AddTx(MakeOrphan({COutPoint{InsecureRand256(), 0}}, 10000), /*peer=*/0));
+    }
+    const CTransactionRef small_a{MakeOrphan({COutPoint{InsecureRand256(), 0}}, 10)};
+    const CTransactionRef small_b{MakeOrphan({COutPoint{InsecureRand256(), 0}}, 10)};
+    BOOST_CHECK(orphanage.AddTx(small_a, /*peer=*/1));
+    BOOST_CHECK(orphanage.AddTx(small_b, /*peer=*/1));
+
+    BOOST_CHECK(orphanage.UsageByPeer(0) > 20 * 10000);
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(0) + orphanage.UsageByPeer(1), orphanage.TotalOrphanUsage());
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(2), 0U);
+
+    // Enforcing a memory limit evicts from the heaviest peer only.
+    const size_t limit{orphanage.TotalOrphanUsage() / 2};
+    orphanage.LimitOrphans(/*max_orphans=*/1000, limit);
+    BOOST_CHECK(orphanage.TotalOrphanUsage() <= limit);
+    BOOST_CHECK(orphanage.CountOrphans() < 22);
+    BOOST_CHECK(orphanage.HaveTx(GenTxid::Txid(small_a->GetHash())));
+    BOOST_CHECK(orphanage.HaveTx(GenTxid::Txid(small_b->GetHash())));
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(0) + orphanage.UsageByPeer(1), orphanage.TotalOrphanUsage());
+
+    // Erasing a peer releases all of its accounted memory.
+    const size_t peer1_usage{orphanage.UsageByPeer(1)};
+    orphanage.EraseForPeer(0);
+    BOOST_CHECK_EQUAL(orphanage.UsageByPeer(0), 0U);
+    BOOST_CHECK_EQUAL(orphanage.TotalOrphanUsage(), peer1_usage);
+    orphanage.EraseForPeer(1);
+    BOOST_CHECK_EQUAL(orphanage.TotalOrphanUsage(), 0U);
+    BOOST_CHECK_EQUAL(orphanage.CountOrphans(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(orphanage_parent_index)
+{
+    TxOrphanageTest orphanage;
+
+    CMutableTransaction parent_mut;
+    parent_mut.vin.emplace_back(COutPoint{InsecureRand256(), 0});
+    parent_mut.vout.resize(3);
+    const CTransactionRef parent{MakeTransactionRef(parent_mut)};
+
+    // Two children from different peers, one of which spends two outputs of the parent.
+    const CTransactionRef child_a{MakeOrphan({COutPoint{parent->GetHash(), 0}, COutPoint{parent->GetHash(), 1}}, 10)};
+    const CTransactionRef child_b{MakeOrphan({COutPoint{parent->GetHash(), 2}}, 10)};
+    const CTransactionRef unrelated{MakeOrphan({COutPoint{InsecureRand256(), 0}}, 10)};
+    BOOST_CHECK(orphanage.AddTx(child_a, /*peer=*/0));
+    BOOST_CHECK(orphanage.AddTx(child_b, /*peer=*/1));
+    BOOST_CHECK(orphanage.AddTx(unrelated, /*peer=*/1));
+
+    // Package candidates are only taken from the peer asking about the parent.
+    BOOST_CHECK(orphanage.GetChildrenFromSamePeer(parent, /*peer=*/0) == std::vector<CTransactionRef>{child_a});
+    BOOST_CHECK(orphanage.GetChildrenFromSamePeer(parent, /*peer=*/1) == std::vector<CTransactionRef>{child_b});
+    BOOST_CHECK(orphanage.GetChildrenFromSamePeer(parent, /*peer=*/2).empty());
+    BOOST_CHECK(orphanage.GetChildrenFromSamePeer(child_a, /*peer=*/0).empty());
+
+    // The parent's arrival schedules both children with their announcing peers.
+    orphanage.AddChildrenToWorkSet(*parent);
+    BOOST_CHECK(orphanage.HaveTxToReconsider(0));
+    BOOST_CHECK(orphanage.GetTxToReconsider(0) == child_a);
+    BOOST_CHECK(!orphanage.HaveTxToReconsider(0));
+    BOOST_CHECK(orphanage.GetTxToReconsider(1) == child_b);
+    BOOST_CHECK(orphanage.GetTxToReconsider(1) == nullptr);
+
+    // A block spending only output 2 of the parent conflicts with child_b alone.
+    CBlock block;
+    block.vtx.push_back(MakeOrphan({COutPoint{parent->GetHash(), 2}}, 20));
+    orphanage.EraseForBlock(block);
+    BOOST_CHECK(orphanage.HaveTx(GenTxid::Txid(child_a->GetHash())));
+    BOOST_CHECK(!orphanage.HaveTx(GenTxid::Txid(child_b->GetHash())));
+    BOOST_CHECK(orphanage.HaveTx(GenTxid::Txid(unrelated->GetHash())));
+
+    // Once erased, the parent no longer resolves any children.
+    BOOST_CHECK_EQUAL(orphanage.EraseTx(child_a->GetHash()), 1);
+    orphanage.AddChildrenToWorkSet(*parent);
+    BOOST_CHECK(!orphanage.HaveTxToReconsider(0));
+    BOOST_CHECK(!orphanage.HaveTxToReconsider(1));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
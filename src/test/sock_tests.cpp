@@ -169,6 +169,65 @@ BOOST_AUTO_TEST_CASE(recv_until_terminator_limit)
     receiver.join();
 }
 
+#ifdef USE_EPOLL
+BOOST_AUTO_TEST_CASE(epoll_wait_many)
+{
+    SockEpoll epoll;
+    BOOST_REQUIRE(epoll.IsValid());
+
+    int s[2];
+    CreateSocketPair(s);
+    auto sock0{std::make_shared<const Sock>(s[0])};
+    auto sock1{std::make_shared<const Sock>(s[1])};
+
+    Sock::EventsPerSock events_per_sock;
+    events_per_sock.emplace(sock0, Sock::Events{Sock::RECV});
+    events_per_sock.emplace(sock1, Sock::Events{Sock::RECV | Sock::SEND});
+
+    // Nothing to read, but sock1 can send.
+    BOOST_REQUIRE(epoll.WaitMany(0ms, events_per_sock));
+    BOOST_CHECK_EQUAL(epoll.RegisteredCount(), 2U);
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, 0);
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock1).occurred, Sock::SEND);
+
+    // Readiness is level-triggered: unread data is reported on every call.
+    BOOST_REQUIRE_EQUAL(sock1->Send("a", 1, 0), 1);
+    for (int i = 0; i < 2; ++i) {
+        BOOST_REQUIRE(epoll.WaitMany(1min, events_per_sock));
+        BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, Sock::RECV);
+    }
+
+    // Changing the requested events updates the registration.
+    events_per_sock.at(sock0).requested = Sock::SEND;
+    BOOST_REQUIRE(epoll.WaitMany(0ms, events_per_sock));
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock0).occurred, Sock::SEND);
+
+    // Sockets missing from the set are unregistered.
+    events_per_sock.erase(sock1);
+    BOOST_REQUIRE(epoll.WaitMany(0ms, events_per_sock));
+    BOOST_CHECK_EQUAL(epoll.RegisteredCount(), 1U);
+
+    // A socket that reuses the descriptor of a closed, registered socket is registered anew.
+    events_per_sock.clear();
+    events_per_sock.emplace(sock1, Sock::Events{Sock::RECV});
+    BOOST_REQUIRE(epoll.WaitMany(0ms, events_per_sock));
+    events_per_sock.clear();
+    sock1.reset();
+    sock0.reset();
+    int s2[2];
+    CreateSocketPair(s2);
+    auto sock2{std::make_shared<const Sock>(s2[0])};
+    auto sock3{std::make_shared<const Sock>(s2[1])};
+    events_per_sock.emplace(sock2, Sock::Events{Sock::RECV});
+    events_per_sock.emplace(sock3, Sock::Events{Sock::RECV});
+    BOOST_REQUIRE_EQUAL(sock2->Send("b", 1, 0), 1);
+    BOOST_REQUIRE(epoll.WaitMany(1min, events_per_sock));
+    BOOST_CHECK_EQUAL(epoll.RegisteredCount(), 2U);
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock2).occurred, 0);
+    BOOST_CHECK_EQUAL(events_per_sock.at(sock3).occurred, Sock::RECV);
+}
+#endif // USE_EPOLL
+
 #endif /* WIN32 */
 
 BOOST_AUTO_TEST_SUITE_END()
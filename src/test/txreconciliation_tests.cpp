@@ -4,10 +4,87 @@
 
 #include <node/txreconciliation.h>
 
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 
+#include <algorithm>
+
 #include <boost/test/unit_test.hpp>
 
+namespace {
+
+/** Register one peer (id 0) on both trackers, with the first one initiating reconciliations. */
+void RegisterPair(TxReconciliationTracker& initiator, TxReconciliationTracker& responder)
+{
+    const uint64_t initiator_salt = initiator.PreRegisterPeer(0);
+    const uint64_t responder_salt = responder.PreRegisterPeer(0);
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(0, /*is_peer_inbound=*/false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(0, /*is_peer_inbound=*/true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+}
+
+std::vector<uint256> RandomWtxids(size_t count)
+{
+    std::vector<uint256> wtxids(count);
+    for (auto& wtxid : wtxids) wtxid = InsecureRand256();
+    return wtxids;
+}
+
+void Sorted(std::vector<uint256>& v) { std::sort(v.begin(), v.end()); }
+
+/**
+ * Run a round between the two trackers, with `shared` in both sets. Returns whether the initiator
+ * needed an extension and checks both sides end up announcing exactly their own transactions.
+ */
+bool RunRound(TxReconciliationTracker& initiator, TxReconciliationTracker& responder,
+              const std::vector<uint256>& shared, std::vector<uint256> initiator_only, std::vector<uint256> responder_only,
+              std::chrono::microseconds now, ReconciliationSketchResult::Status expected)
+{
+    for (const auto& wtxid : shared) {
+        BOOST_REQUIRE(initiator.AddToSet(0, wtxid));
+        BOOST_REQUIRE(responder.AddToSet(0, wtxid));
+    }
+    for (const auto& wtxid : initiator_only) BOOST_REQUIRE(initiator.AddToSet(0, wtxid));
+    for (const auto& wtxid : responder_only) BOOST_REQUIRE(responder.AddToSet(0, wtxid));
+
+    const auto request{initiator.InitiateReconciliationRequest(0, now)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->set_size, shared.size() + initiator_only.size());
+    // Only one round at a time.
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(0, now + RECON_REQUEST_INTERVAL));
+
+    const auto sketch{responder.HandleReconciliationRequest(0, request->set_size, request->q)};
+    BOOST_REQUIRE(sketch);
+    auto result{initiator.HandleSketch(0, *sketch)};
+    const bool extended{result.status == ReconciliationSketchResult::Status::NEED_EXTENSION};
+    if (extended) {
+        const auto extension{responder.HandleSketchExtensionRequest(0)};
+        BOOST_REQUIRE(extension);
+        BOOST_CHECK_EQUAL(extension->size(), sketch->size());
+        result = initiator.HandleSketch(0, *extension);
+    }
+    BOOST_REQUIRE(result.status == expected);
+
+    const bool success{result.status == ReconciliationSketchResult::Status::SUCCESS};
+    const auto responder_announces{responder.HandleReconciliationDifference(0, success, result.missing)};
+    BOOST_REQUIRE(responder_announces);
+    if (!success) {
+        // Fallback: both sides flood their whole set.
+        initiator_only.insert(initiator_only.end(), shared.begin(), shared.end());
+        responder_only.insert(responder_only.end(), shared.begin(), shared.end());
+    }
+    auto initiator_announces{result.to_announce};
+    auto responder_announced{*responder_announces};
+    Sorted(initiator_announces);
+    Sorted(initiator_only);
+    Sorted(responder_announced);
+    Sorted(responder_only);
+    BOOST_CHECK(initiator_announces == initiator_only);
+    BOOST_CHECK(responder_announced == responder_only);
+    return extended;
+}
+
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(RegisterPeerTest)
@@ -81,4 +158,65 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(ReconciliationRoundTest)
+{
+    using namespace std::chrono_literals;
+    using Status = ReconciliationSketchResult::Status;
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    RegisterPair(initiator, responder);
+
+    // Only registered peers have sets, and only the initiator sends requests.
+    BOOST_CHECK(!initiator.AddToSet(1, InsecureRand256()));
+    BOOST_CHECK(!responder.InitiateReconciliationRequest(0, 0s));
+
+    // The difference fits the estimated capacity: decoded from the initial sketch.
+    BOOST_CHECK(!RunRound(initiator, responder, RandomWtxids(20), RandomWtxids(3), RandomWtxids(4), 0s, Status::SUCCESS));
+
+    // The next round is not due yet.
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(0, RECON_REQUEST_INTERVAL - 1s));
+
+    // The difference exceeds the initial capacity (13) but fits the extension.
+    BOOST_CHECK(RunRound(initiator, responder, RandomWtxids(40), RandomWtxids(8), RandomWtxids(8), RECON_REQUEST_INTERVAL, Status::SUCCESS));
+
+    // The difference exceeds the extension too: fall back to flooding.
+    BOOST_CHECK(RunRound(initiator, responder, {}, RandomWtxids(10), RandomWtxids(10), 2 * RECON_REQUEST_INTERVAL, Status::FAILURE));
+
+    // Transactions the peer announced to us are not reconciled.
+    const auto wtxids{RandomWtxids(2)};
+    BOOST_REQUIRE(initiator.AddToSet(0, wtxids[0]));
+    BOOST_REQUIRE(initiator.AddToSet(0, wtxids[1]));
+    initiator.TryRemovingFromSet(0, wtxids[0]);
+    const auto request{initiator.InitiateReconciliationRequest(0, 3 * RECON_REQUEST_INTERVAL)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->set_size, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationProtocolViolationTest)
+{
+    using namespace std::chrono_literals;
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(TXRECONCILIATION_VERSION);
+    RegisterPair(initiator, responder);
+
+    // Messages out of turn.
+    BOOST_CHECK(initiator.HandleSketch(0, {}).status == ReconciliationSketchResult::Status::PROTOCOL_VIOLATION);
+    BOOST_CHECK(!responder.HandleSketchExtensionRequest(0));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(0, true, {}));
+    BOOST_CHECK(!initiator.HandleReconciliationRequest(0, 0, 0));
+
+    // Too large a q.
+    BOOST_CHECK(!responder.HandleReconciliationRequest(0, 0, Q_PRECISION + 1));
+
+    // Sketches must hold whole elements.
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(0, 0s));
+    const std::vector<uint8_t> odd_sketch(3);
+    BOOST_CHECK(initiator.HandleSketch(0, odd_sketch).status == ReconciliationSketchResult::Status::PROTOCOL_VIOLATION);
+
+    // A responder asks for a fallback with an empty sketch when the difference is too large.
+    const auto sketch{responder.HandleReconciliationRequest(0, MAX_SKETCH_CAPACITY, 0)};
+    BOOST_REQUIRE(sketch);
+    BOOST_CHECK(sketch->empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -118,6 +118,8 @@ std::vector<NodeEvictionCandidate> GetRandomNodeEvictionCandidates(int n_candida
             /*m_network=*/ALL_NETWORKS[random_context.randrange(ALL_NETWORKS.size())],
             /*m_noban=*/false,
             /*m_conn_type=*/ConnectionType::INBOUND,
+            /*m_process_time=*/std::chrono::microseconds{0},
+            /*m_memory_usage=*/0,
         });
     }
     return candidates;
@@ -13,6 +13,7 @@
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/getuniquepath.h>
+#include <util/lz4.h>
 #include <util/message.h> // For MessageSign(), MessageVerify(), MESSAGE_MAGIC
 #include <util/moneystr.h>
 #include <util/overflow.h>
@@ -1816,4 +1817,55 @@ BOOST_AUTO_TEST_CASE(clearshrink_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(util_LZ4)
+{
+    const auto roundtrip{[](const std::vector<std::byte>& data) {
+        std::vector<std::byte> compressed;
+        util::LZ4Compress(data, compressed);
+        BOOST_CHECK_LE(compressed.size(), util::LZ4CompressBound(data.size()));
+        std::vector<std::byte> decompressed(data.size());
+        BOOST_CHECK(util::LZ4Decompress(compressed, decompressed));
+        BOOST_CHECK(decompressed == data);
+        return compressed;
+    }};
+
+    roundtrip({});
+    const auto random{g_insecure_rand_ctx.randbytes<std::byte>(100000)};
+    roundtrip(random);
+
+    // Repeated data, including copies overlapping their source and lengths
+    // taking several bytes to encode
+    std::vector<std::byte> repeated(100000, std::byte{'a'});
+    std::copy(random.begin(), random.begin() + 1000, repeated.begin() + 5000);
+    const auto compressed{roundtrip(repeated)};
+    BOOST_CHECK_LT(compressed.size(), 2000U);
+
+    // Decompressing a prefix stops within a literal run or a copy
+    for (const size_t prefix_size : {0, 10, 5001, 5500, 50000}) {
+        std::vector<std::byte> prefix(prefix_size);
+        BOOST_CHECK(util::LZ4DecompressPrefix(compressed, prefix));
+        BOOST_CHECK(std::equal(prefix.begin(), prefix.end(), repeated.begin()));
+    }
+    std::vector<std::byte> too_long(repeated.size() + 1);
+    BOOST_CHECK(!util::LZ4DecompressPrefix(compressed, too_long));
+
+    // 45 times 'a', as one literal, a copy of 39 bytes from 1 byte back and
+    // the 5 last literals
+    const auto expected{MakeByteSpan(std::string_view{"\x1f\x61\x01\x00\x14\x50\x61\x61\x61\x61\x61", 11})};
+    std::vector<std::byte> decompressed(45);
+    BOOST_CHECK(util::LZ4Decompress(expected, decompressed));
+    BOOST_CHECK(decompressed == std::vector<std::byte>(45, std::byte{'a'}));
+
+    // Truncated data, data decompressing to another size, and copies from
+    // before the start are rejected
+    std::vector<std::byte> out(repeated.size());
+    BOOST_CHECK(!util::LZ4Decompress(Span{compressed}.first(compressed.size() - 1), out));
+    out.resize(repeated.size() + 1);
+    BOOST_CHECK(!util::LZ4Decompress(compressed, out));
+    out.resize(repeated.size() - 1);
+    BOOST_CHECK(!util::LZ4Decompress(compressed, out));
+    const auto bad_offset{MakeByteSpan(std::string_view{"\x10\x61\x02\x00\x50\x61\x61\x61\x61\x61", 10})};
+    BOOST_CHECK(!util::LZ4Decompress(bad_offset, decompressed));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coins.h>
+#include <crypto/muhash.h>
+#include <hash.h>
+#include <kernel/coinstats.h>
+#include <node/utxo_snapshot.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <streams.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <uint256.h>
+#include <util/fs.h>
+
+#include <map>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using kernel::SerializeCoinForHash;
+using node::ReadSnapshotCoins;
+using node::SnapshotCoinsStats;
+using node::WriteSnapshotCoins;
+
+BOOST_FIXTURE_TEST_SUITE(utxo_snapshot_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(snapshot_coins_roundtrip)
+{
+    CCoinsViewDB db{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    std::map<COutPoint, Coin> coins;
+    {
+        // The outputs of a transaction with that many outputs are not in
+        // the order of their index in the database.
+        const uint256 txid{InsecureRand256()};
+        for (uint32_t n = 0; n < 20000; ++n) {
+            coins.emplace(COutPoint{txid, n}, Coin{CTxOut{1, CScript{} << OP_TRUE}, 1, false});
+        }
+        for (int i = 0; i < 2000; ++i) {
+            CScript script{CScript{} << OP_TRUE};
+            const auto data{g_insecure_rand_ctx.randbytes(InsecureRandRange(100))};
+            script.insert(script.end(), data.begin(), data.end());
+            coins.emplace(COutPoint{InsecureRand256(), static_cast<uint32_t>(InsecureRandRange(4))},
+                          Coin{CTxOut{InsecureRandMoneyAmount(), script}, static_cast<int>(InsecureRandRange(100)), InsecureRandBool()});
+        }
+        CCoinsViewCache cache{&db};
+        for (const auto& [outpoint, coin] : coins) cache.AddCoin(outpoint, Coin{coin}, false);
+        cache.SetBestBlock(InsecureRand256());
+        BOOST_REQUIRE(cache.Flush());
+    }
+
+    // The UTXO set hash commits to the coins by increasing outpoint.
+    HashWriter hasher{};
+    MuHash3072 muhash;
+    for (const auto& [outpoint, coin] : coins) {
+        DataStream ss{};
+        SerializeCoinForHash(ss, outpoint, coin);
+        hasher.write(ss);
+        muhash.Insert(MakeUCharSpan(ss));
+    }
+    SnapshotCoinsStats expected;
+    expected.coins_count = coins.size();
+    expected.hash_serialized = hasher.GetHash();
+    muhash.Finalize(expected.muhash);
+
+    const auto check_stats{[&](const SnapshotCoinsStats& stats) {
+        BOOST_CHECK_EQUAL(stats.coins_count, expected.coins_count);
+        BOOST_CHECK_EQUAL(stats.hash_serialized, expected.hash_serialized);
+        BOOST_CHECK_EQUAL(stats.muhash, expected.muhash);
+    }};
+
+    const fs::path path{m_args.GetDataDirBase() / "snapshot.dat"};
+    for (const int threads : {1, 4}) {
+        {
+            AutoFile afile{fsbridge::fopen(path, "wb")};
+            const auto cursor{db.Cursor()};
+            check_stats(WriteSnapshotCoins(afile, *cursor, threads, [] {}));
+        }
+
+        std::map<COutPoint, Coin> read;
+        const auto emplace{[&](std::vector<std::pair<COutPoint, Coin>>& chunk) {
+            for (auto& [outpoint, coin] : chunk) {
+                BOOST_CHECK(read.emplace(outpoint, std::move(coin)).second);
+            }
+            return true;
+        }};
+        {
+            AutoFile afile{fsbridge::fopen(path, "rb")};
+            const auto stats{ReadSnapshotCoins(afile, coins.size(), 100, threads, emplace)};
+            BOOST_REQUIRE(stats);
+            check_stats(*stats);
+        }
+        BOOST_REQUIRE_EQUAL(read.size(), coins.size());
+        for (const auto& [outpoint, coin] : coins) {
+            const Coin& read_coin{read.at(outpoint)};
+            BOOST_CHECK(read_coin.out == coin.out);
+            BOOST_CHECK(read_coin.nHeight == coin.nHeight);
+            BOOST_CHECK(read_coin.fCoinBase == coin.fCoinBase);
+        }
+
+        // Coins left over, missing coins, or coins above the base height
+        for (const auto& [coins_count, max_height] : {std::pair{coins.size() - 1, 100}, {coins.size() + 1, 100}, {coins.size(), 50}}) {
+            read.clear();
+            AutoFile afile{fsbridge::fopen(path, "rb")};
+            BOOST_CHECK(!ReadSnapshotCoins(afile, coins_count, max_height, threads, emplace));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
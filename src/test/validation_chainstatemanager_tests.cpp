@@ -224,14 +224,11 @@ struct SnapshotTestSetup : TestChain100Setup {
         // Should not load malleated snapshots
         BOOST_REQUIRE(!CreateAndActivateUTXOSnapshot(
             this, [](AutoFile& auto_infile, SnapshotMetadata& metadata) {
-                // A UTXO is missing but count is correct
-                metadata.m_coins_count -= 1;
-
-                COutPoint outpoint;
-                Coin coin;
-
-                auto_infile >> outpoint;
-                auto_infile >> coin;
+                // A chunk of UTXOs is missing but count is correct
+                node::SnapshotChunkHeader header;
+                auto_infile >> header;
+                auto_infile.ignore(header.m_size);
+                metadata.m_coins_count -= header.m_coins_count;
         }));
 
         BOOST_CHECK(!node::FindSnapshotChainstateDir(chainman.m_options.datadir));
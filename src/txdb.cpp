@@ -178,13 +178,19 @@ private:
 };
 
 std::unique_ptr<CCoinsViewCursor> CCoinsViewDB::Cursor() const
+{
+    return Cursor(uint256::ZERO);
+}
+
+std::unique_ptr<CCoinsViewCursor> CCoinsViewDB::Cursor(const uint256& txid) const
 {
     auto i = std::make_unique<CCoinsViewDBCursor>(
         const_cast<CDBWrapper&>(*m_db).NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
        that restriction.  */
-    i->pcursor->Seek(DB_COIN);
+    const COutPoint start{txid, 0};
+    i->pcursor->Seek(CoinEntry{&start});
     // Cache key of first record
     if (i->pcursor->Valid()) {
         CoinEntry entry(&i->keyTmp.second);
@@ -37,6 +37,8 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxTxIndexCache = 1024;
 //! Max memory allocated to all block filter index caches combined in MiB.
 static const int64_t max_filter_index_cache = 1024;
+//! Max memory allocated to the address index cache in MiB.
+static const int64_t max_address_index_cache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
 
@@ -65,6 +67,8 @@ public:
     std::vector<uint256> GetHeadBlocks() const override;
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase = true) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
+    //! Cursor over the coins from the first output of `txid` on, in key order.
+    std::unique_ptr<CCoinsViewCursor> Cursor(const uint256& txid) const;
 
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
@@ -14,17 +14,20 @@
 #include <logging.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
+#include <policy/rbf.h>
 #include <policy/settings.h>
 #include <reverse_iterator.h>
 #include <util/check.h>
 #include <util/moneystr.h>
 #include <util/overflow.h>
+#include <util/rbf.h>
 #include <util/result.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
 #include <validationinterface.h>
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <optional>
@@ -113,6 +116,8 @@ void CTxMemPool::UpdateTransactionsFromBlock(const std::vector<uint256>& vHashes
 
     std::set<uint256> descendants_to_remove;
 
+    ++m_snapshot_generation;
+
     // Iterate in reverse, so that whenever we are looking at a transaction
     // we are sure that all in-mempool descendants have already been processed.
     // This maximizes the benefit of the descendant cache and guarantees that
@@ -154,21 +159,17 @@ void CTxMemPool::UpdateTransactionsFromBlock(const std::vector<uint256>& vHashes
     }
 }
 
-util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateAncestorsAndCheckLimits(
+util::Result<void> CTxMemPool::CalculateAncestorsAndCheckLimits(
     int64_t entry_size,
     size_t entry_count,
-    CTxMemPoolEntry::Parents& staged_ancestors,
     const Limits& limits) const
 {
     int64_t totalSizeWithAncestors = entry_size;
-    setEntries ancestors;
-
-    while (!staged_ancestors.empty()) {
-        const CTxMemPoolEntry& stage = staged_ancestors.begin()->get();
-        txiter stageit = mapTx.iterator_to(stage);
 
-        ancestors.insert(stageit);
-        staged_ancestors.erase(stage);
+    // m_traversal_buffer starts out with the staged parents. Newly found ancestors are appended,
+    // so it is both the work queue and, once the walk completes, the result.
+    for (size_t i = 0; i < m_traversal_buffer.size(); ++i) {
+        const txiter stageit = m_traversal_buffer[i];
         totalSizeWithAncestors += stageit->GetTxSize();
 
         if (stageit->GetSizeWithDescendants() + entry_size > limits.descendant_size_vbytes) {
@@ -181,19 +182,15 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateAncestorsAndCheckLimit
 
         const CTxMemPoolEntry::Parents& parents = stageit->GetMemPoolParentsConst();
         for (const CTxMemPoolEntry& parent : parents) {
-            txiter parent_it = mapTx.iterator_to(parent);
-
             // If this is a new ancestor, add it.
-            if (ancestors.count(parent_it) == 0) {
-                staged_ancestors.insert(parent);
-            }
-            if (staged_ancestors.size() + ancestors.size() + entry_count > static_cast<uint64_t>(limits.ancestor_count)) {
+            StageAncestor(mapTx.iterator_to(parent));
+            if (m_traversal_buffer.size() + entry_count > static_cast<uint64_t>(limits.ancestor_count)) {
                 return util::Error{Untranslated(strprintf("too many unconfirmed ancestors [limit: %u]", limits.ancestor_count))};
             }
         }
     }
 
-    return ancestors;
+    return {};
 }
 
 bool CTxMemPool::CheckPackageLimits(const Package& package,
@@ -217,13 +214,14 @@ bool CTxMemPool::CheckPackageLimits(const Package& package,
         return false;
     }
 
-    CTxMemPoolEntry::Parents staged_ancestors;
+    WITH_FRESH_EPOCH(m_epoch);
+    m_traversal_buffer.clear();
     for (const auto& tx : package) {
         for (const auto& input : tx->vin) {
             std::optional<txiter> piter = GetIter(input.prevout.hash);
             if (piter) {
-                staged_ancestors.insert(**piter);
-                if (staged_ancestors.size() + package.size() > static_cast<uint64_t>(m_limits.ancestor_count)) {
+                StageAncestor(*piter);
+                if (m_traversal_buffer.size() + package.size() > static_cast<uint64_t>(m_limits.ancestor_count)) {
                     errString = strprintf("too many unconfirmed parents [limit: %u]", m_limits.ancestor_count);
                     return false;
                 }
@@ -233,11 +231,10 @@ bool CTxMemPool::CheckPackageLimits(const Package& package,
     // When multiple transactions are passed in, the ancestors and descendants of all transactions
     // considered together must be within limits even if they are not interdependent. This may be
     // stricter than the limits for each individual transaction.
-    const auto ancestors{CalculateAncestorsAndCheckLimits(total_vsize, package.size(),
-                                                          staged_ancestors, m_limits)};
+    const auto ancestors{CalculateAncestorsAndCheckLimits(total_vsize, package.size(), m_limits)};
     // It's possible to overestimate the ancestor/descendant totals.
-    if (!ancestors.has_value()) errString = "possibly " + util::ErrorString(ancestors).original;
-    return ancestors.has_value();
+    if (!ancestors) errString = "possibly " + util::ErrorString(ancestors).original;
+    return bool{ancestors};
 }
 
 util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateMemPoolAncestors(
@@ -245,9 +242,10 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateMemPoolAncestors(
     const Limits& limits,
     bool fSearchForParents /* = true */) const
 {
-    CTxMemPoolEntry::Parents staged_ancestors;
     const CTransaction &tx = entry.GetTx();
 
+    WITH_FRESH_EPOCH(m_epoch);
+    m_traversal_buffer.clear();
     if (fSearchForParents) {
         // Get parents of this transaction that are in the mempool
         // GetMemPoolParents() is only valid for entries in the mempool, so we
@@ -255,8 +253,8 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateMemPoolAncestors(
         for (unsigned int i = 0; i < tx.vin.size(); i++) {
             std::optional<txiter> piter = GetIter(tx.vin[i].prevout.hash);
             if (piter) {
-                staged_ancestors.insert(**piter);
-                if (staged_ancestors.size() + 1 > static_cast<uint64_t>(limits.ancestor_count)) {
+                StageAncestor(*piter);
+                if (m_traversal_buffer.size() + 1 > static_cast<uint64_t>(limits.ancestor_count)) {
                     return util::Error{Untranslated(strprintf("too many unconfirmed parents [limit: %u]", limits.ancestor_count))};
                 }
             }
@@ -264,12 +262,15 @@ util::Result<CTxMemPool::setEntries> CTxMemPool::CalculateMemPoolAncestors(
     } else {
         // If we're not searching for parents, we require this to already be an
         // entry in the mempool and use the entry's cached parents.
-        txiter it = mapTx.iterator_to(entry);
-        staged_ancestors = it->GetMemPoolParentsConst();
+        for (const CTxMemPoolEntry& parent : entry.GetMemPoolParentsConst()) {
+            StageAncestor(mapTx.iterator_to(parent));
+        }
     }
 
-    return CalculateAncestorsAndCheckLimits(entry.GetTxSize(), /*entry_count=*/1, staged_ancestors,
-                                            limits);
+    if (auto result{CalculateAncestorsAndCheckLimits(entry.GetTxSize(), /*entry_count=*/1, limits)}; !result) {
+        return util::Error{util::ErrorString(result)};
+    }
+    return setEntries(m_traversal_buffer.begin(), m_traversal_buffer.end());
 }
 
 CTxMemPool::setEntries CTxMemPool::AssumeCalculateMemPoolAncestors(
@@ -335,14 +336,23 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         // and CTxMemPoolEntry::Children (which we need to preserve until we're
         // finished with all operations that need to traverse the mempool).
         for (txiter removeIt : entriesToRemove) {
-            setEntries setDescendants;
-            CalculateDescendants(removeIt, setDescendants);
-            setDescendants.erase(removeIt); // don't update state for self
             int32_t modifySize = -removeIt->GetTxSize();
             CAmount modifyFee = -removeIt->GetModifiedFee();
             int modifySigOps = -removeIt->GetSigOpCost();
-            for (txiter dit : setDescendants) {
-                mapTx.modify(dit, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(modifySize, modifyFee, -1, modifySigOps); });
+            // Walk all descendants, visiting each once, but don't update state for self.
+            WITH_FRESH_EPOCH(m_epoch);
+            m_traversal_buffer.clear();
+            visited(removeIt);
+            m_traversal_buffer.push_back(removeIt);
+            while (!m_traversal_buffer.empty()) {
+                const txiter it = m_traversal_buffer.back();
+                m_traversal_buffer.pop_back();
+                for (const CTxMemPoolEntry& child : it->GetMemPoolChildrenConst()) {
+                    const txiter childit = mapTx.iterator_to(child);
+                    if (visited(childit)) continue;
+                    mapTx.modify(childit, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(modifySize, modifyFee, -1, modifySigOps); });
+                    m_traversal_buffer.push_back(childit);
+                }
             }
         }
     }
@@ -367,10 +377,28 @@ void CTxMemPool::UpdateForRemoveFromMempool(const setEntries &entriesToRemove, b
         // mempool parents we'd calculate by searching, and it's important that
         // we use the cached notion of ancestor transactions as the set of
         // things to update for removal.
-        auto ancestors{AssumeCalculateMemPoolAncestors(__func__, entry, Limits::NoLimits(), /*fSearchForParents=*/false)};
-        // Note that UpdateAncestorsOf severs the child links that point to
-        // removeIt in the entries for the parents of removeIt.
-        UpdateAncestorsOf(false, removeIt, ancestors);
+        // Sever the child links that point to removeIt in the entries for the
+        // parents of removeIt, then walk all ancestors to remove this entry from
+        // their descendant state. This is UpdateAncestorsOf() without building
+        // the ancestor set.
+        for (const CTxMemPoolEntry& parent : entry.GetMemPoolParentsConst()) {
+            UpdateChild(mapTx.iterator_to(parent), removeIt, false);
+        }
+        const int32_t updateSize{-removeIt->GetTxSize()};
+        const CAmount updateFee{-removeIt->GetModifiedFee()};
+        WITH_FRESH_EPOCH(m_epoch);
+        m_traversal_buffer.clear();
+        m_traversal_buffer.push_back(removeIt);
+        while (!m_traversal_buffer.empty()) {
+            const txiter it = m_traversal_buffer.back();
+            m_traversal_buffer.pop_back();
+            for (const CTxMemPoolEntry& parent : it->GetMemPoolParentsConst()) {
+                const txiter parentit = mapTx.iterator_to(parent);
+                if (visited(parentit)) continue;
+                mapTx.modify(parentit, [=](CTxMemPoolEntry& e) { e.UpdateDescendantState(updateSize, updateFee, -1); });
+                m_traversal_buffer.push_back(parentit);
+            }
+        }
     }
     // After updating all the ancestor sizes, we can now sever the link between each
     // transaction being removed and any mempool children (ie, update CTxMemPoolEntry::m_parents
@@ -474,6 +502,7 @@ void CTxMemPool::addUnchecked(const CTxMemPoolEntry &entry, setEntries &setAnces
     UpdateEntryForAncestors(newit, setAncestors);
 
     nTransactionsUpdated++;
+    ++m_snapshot_generation;
     totalTxSize += entry.GetTxSize();
     m_total_fee += entry.GetFee();
     if (minerPolicyEstimator) {
@@ -532,6 +561,7 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
     cachedInnerUsage -= memusage::DynamicUsage(it->GetMemPoolParentsConst()) + memusage::DynamicUsage(it->GetMemPoolChildrenConst());
     mapTx.erase(it);
     nTransactionsUpdated++;
+    ++m_snapshot_generation;
     if (minerPolicyEstimator) {minerPolicyEstimator->removeTx(hash, false);}
 }
 
@@ -543,23 +573,21 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 // can save time by not iterating over those entries.
 void CTxMemPool::CalculateDescendants(txiter entryit, setEntries& setDescendants) const
 {
-    setEntries stage;
-    if (setDescendants.count(entryit) == 0) {
-        stage.insert(entryit);
-    }
+    if (!setDescendants.insert(entryit).second) return;
     // Traverse down the children of entry, only adding children that are not
     // accounted for in setDescendants already (because those children have either
-    // already been walked, or will be walked in this iteration).
+    // already been walked, or will be walked in this iteration). setDescendants
+    // doubles as the visited set, so the stage only needs to be a stack.
+    std::vector<txiter> stage{entryit};
     while (!stage.empty()) {
-        txiter it = *stage.begin();
-        setDescendants.insert(it);
-        stage.erase(it);
+        const txiter it = stage.back();
+        stage.pop_back();
 
         const CTxMemPoolEntry::Children& children = it->GetMemPoolChildrenConst();
         for (const CTxMemPoolEntry& child : children) {
             txiter childiter = mapTx.iterator_to(child);
-            if (!setDescendants.count(childiter)) {
-                stage.insert(childiter);
+            if (setDescendants.insert(childiter).second) {
+                stage.push_back(childiter);
             }
         }
     }
@@ -850,6 +878,88 @@ std::vector<TxMempoolInfo> CTxMemPool::infoAll() const
     return ret;
 }
 
+static MempoolEntrySnapshot MakeEntrySnapshot(const CTxMemPoolEntry& e, bool bip125_replaceable, bool unbroadcast)
+{
+    MempoolEntrySnapshot snap{
+        .tx = e.GetSharedTx(),
+        .fee = e.GetFee(),
+        .modified_fee = e.GetModifiedFee(),
+        .vsize = e.GetTxSize(),
+        .weight = e.GetTxWeight(),
+        .time = e.GetTime(),
+        .height = e.GetHeight(),
+        .count_with_descendants = e.GetCountWithDescendants(),
+        .size_with_descendants = e.GetSizeWithDescendants(),
+        .mod_fees_with_descendants = e.GetModFeesWithDescendants(),
+        .count_with_ancestors = e.GetCountWithAncestors(),
+        .size_with_ancestors = e.GetSizeWithAncestors(),
+        .mod_fees_with_ancestors = e.GetModFeesWithAncestors(),
+        .parents = {},
+        .children = {},
+        .bip125_replaceable = bip125_replaceable,
+        .unbroadcast = unbroadcast,
+    };
+    snap.parents.reserve(e.GetMemPoolParentsConst().size());
+    for (const CTxMemPoolEntry& parent : e.GetMemPoolParentsConst()) {
+        snap.parents.push_back(parent.GetTx().GetHash());
+    }
+    snap.children.reserve(e.GetMemPoolChildrenConst().size());
+    for (const CTxMemPoolEntry& child : e.GetMemPoolChildrenConst()) {
+        snap.children.push_back(child.GetTx().GetHash());
+    }
+    return snap;
+}
+
+MempoolEntrySnapshot CTxMemPool::GetEntrySnapshot(txiter it) const
+{
+    AssertLockHeld(cs);
+    const CTransaction& tx{it->GetTx()};
+    return MakeEntrySnapshot(*it, IsRBFOptIn(tx, *this) == RBFTransactionState::REPLACEABLE_BIP125, IsUnbroadcastTx(tx.GetHash()));
+}
+
+std::shared_ptr<const MempoolSnapshot> CTxMemPool::GetSnapshot() const
+{
+    LOCK(cs);
+    if (m_snapshot && m_snapshot_built_generation == m_snapshot_generation) return m_snapshot;
+
+    // Resolve BIP125 signaling for all entries at once: visiting entries in
+    // increasing ancestor count guarantees parents are resolved before their
+    // children, which avoids an ancestor walk per entry.
+    std::vector<txiter> by_ancestor_count;
+    by_ancestor_count.reserve(mapTx.size());
+    for (txiter it = mapTx.begin(); it != mapTx.end(); ++it) {
+        by_ancestor_count.push_back(it);
+    }
+    std::sort(by_ancestor_count.begin(), by_ancestor_count.end(), [](txiter a, txiter b) {
+        return a->GetCountWithAncestors() < b->GetCountWithAncestors();
+    });
+    std::unordered_map<uint256, bool, SaltedTxidHasher> replaceable;
+    replaceable.reserve(mapTx.size());
+    for (txiter it : by_ancestor_count) {
+        bool signals{SignalsOptInRBF(it->GetTx())};
+        for (const CTxMemPoolEntry& parent : it->GetMemPoolParentsConst()) {
+            if (signals) break;
+            const auto parent_it{replaceable.find(parent.GetTx().GetHash())};
+            signals = parent_it != replaceable.end() && parent_it->second;
+        }
+        replaceable.emplace(it->GetTx().GetHash(), signals);
+    }
+
+    auto snapshot{std::make_shared<MempoolSnapshot>()};
+    snapshot->mempool_sequence = m_sequence_number;
+    snapshot->entries.reserve(mapTx.size());
+    snapshot->index.reserve(mapTx.size());
+    for (const CTxMemPoolEntry& e : mapTx) {
+        const uint256& txid{e.GetTx().GetHash()};
+        snapshot->index.emplace(txid, snapshot->entries.size());
+        snapshot->entries.push_back(MakeEntrySnapshot(e, replaceable.at(txid), IsUnbroadcastTx(txid)));
+    }
+
+    m_snapshot = std::move(snapshot);
+    m_snapshot_built_generation = m_snapshot_generation;
+    return m_snapshot;
+}
+
 CTransactionRef CTxMemPool::get(const uint256& hash) const
 {
     LOCK(cs);
@@ -901,6 +1011,7 @@ void CTxMemPool::PrioritiseTransaction(const uint256& hash, const CAmount& nFeeD
                 mapTx.modify(descendantIt, [=](CTxMemPoolEntry& e){ e.UpdateAncestorState(0, nFeeDelta, 0, 0); });
             }
             ++nTransactionsUpdated;
+            ++m_snapshot_generation;
         }
         if (delta == 0) {
             mapDeltas.erase(hash);
@@ -1041,6 +1152,7 @@ void CTxMemPool::RemoveUnbroadcastTx(const uint256& txid, const bool unchecked)
 
     if (m_unbroadcast_txids.erase(txid))
     {
+        ++m_snapshot_generation;
         LogPrint(BCLog::MEMPOOL, "Removed %i from set of unbroadcast txns%s\n", txid.GetHex(), (unchecked ? " before confirmation that txn was sent out" : ""));
     }
 }
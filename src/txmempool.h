@@ -31,11 +31,14 @@
 #include <boost/multi_index_container.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -225,6 +228,56 @@ struct TxMempoolInfo
     int64_t nFeeDelta;
 };
 
+/**
+ * Immutable copy of a mempool entry and its in-mempool relationships, taken
+ * while holding CTxMemPool::cs so it can be serialized after the lock is
+ * released.
+ */
+struct MempoolEntrySnapshot
+{
+    CTransactionRef tx;
+    CAmount fee;
+    CAmount modified_fee;
+    int32_t vsize;
+    int32_t weight;
+    std::chrono::seconds time;
+    unsigned int height;
+    uint64_t count_with_descendants;
+    int64_t size_with_descendants;
+    CAmount mod_fees_with_descendants;
+    uint64_t count_with_ancestors;
+    int64_t size_with_ancestors;
+    CAmount mod_fees_with_ancestors;
+    /** Txids of in-mempool parents */
+    std::vector<uint256> parents;
+    /** Txids of in-mempool children */
+    std::vector<uint256> children;
+    /** Whether the tx or any in-mempool ancestor signals BIP125 replaceability */
+    bool bip125_replaceable;
+    bool unbroadcast;
+};
+
+/**
+ * Point-in-time view of all mempool entries. A snapshot is never modified
+ * once published, so any number of readers can iterate it without holding
+ * CTxMemPool::cs while transactions keep being accepted.
+ */
+struct MempoolSnapshot
+{
+    /** Mempool sequence number when the snapshot was taken */
+    uint64_t mempool_sequence;
+    /** Entries in mapTx order */
+    std::vector<MempoolEntrySnapshot> entries;
+    /** Position of each txid in entries */
+    std::unordered_map<uint256, size_t, SaltedTxidHasher> index;
+
+    const MempoolEntrySnapshot* Find(const uint256& txid) const
+    {
+        const auto it{index.find(txid)};
+        return it == index.end() ? nullptr : &entries[it->second];
+    }
+};
+
 /**
  * CTxMemPool stores valid-according-to-the-current-best-chain transactions
  * that may be included in the next block.
@@ -319,6 +372,15 @@ protected:
     // is added or removed from the mempool for any reason.
     mutable uint64_t m_sequence_number GUARDED_BY(cs){1};
 
+    // Bumped on every change that is visible through MempoolEntrySnapshot
+    // (entries added or removed, fee deltas, unbroadcast status, and
+    // relationships fixed up after a reorg).
+    uint64_t m_snapshot_generation GUARDED_BY(cs){0};
+    // Most recently built snapshot and the generation it reflects. Readers share
+    // it until the next change.
+    mutable std::shared_ptr<const MempoolSnapshot> m_snapshot GUARDED_BY(cs);
+    mutable uint64_t m_snapshot_built_generation GUARDED_BY(cs){0};
+
     void trackPackageRemoved(const CFeeRate& rate) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     bool m_load_tried GUARDED_BY(cs){false};
@@ -415,21 +477,34 @@ private:
 
 
     /**
-     * Helper function to calculate all in-mempool ancestors of staged_ancestors and apply ancestor
-     * and descendant limits (including staged_ancestors themselves, entry_size and entry_count).
+     * Scratch space for the epoch-based graph walks below. Reused across calls so that
+     * steady-state traversals do not allocate. Only meaningful while m_epoch is guarded.
+     */
+    mutable std::vector<txiter> m_traversal_buffer GUARDED_BY(cs);
+
+    /** Stage an in-mempool parent for CalculateAncestorsAndCheckLimits(), unless it was
+     *  already staged during the current epoch. */
+    void StageAncestor(txiter it) const EXCLUSIVE_LOCKS_REQUIRED(cs, m_epoch)
+    {
+        if (!visited(it)) m_traversal_buffer.push_back(it);
+    }
+
+    /**
+     * Helper function to calculate all in-mempool ancestors of the entries staged with
+     * StageAncestor() and apply ancestor and descendant limits (including the staged entries
+     * themselves, entry_size and entry_count). Each ancestor is visited once using m_epoch; on
+     * success, m_traversal_buffer holds every ancestor.
      *
      * @param[in]   entry_size          Virtual size to include in the limits.
      * @param[in]   entry_count         How many entries to include in the limits.
-     * @param[in]   staged_ancestors    Should contain entries in the mempool.
      * @param[in]   limits              Maximum number and size of ancestors and descendants
      *
-     * @return all in-mempool ancestors, or an error if any ancestor or descendant limits were hit
+     * @return an error if any ancestor or descendant limits were hit
      */
-    util::Result<setEntries> CalculateAncestorsAndCheckLimits(int64_t entry_size,
-                                                              size_t entry_count,
-                                                              CTxMemPoolEntry::Parents &staged_ancestors,
-                                                              const Limits& limits
-                                                              ) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+    util::Result<void> CalculateAncestorsAndCheckLimits(int64_t entry_size,
+                                                        size_t entry_count,
+                                                        const Limits& limits
+                                                        ) const EXCLUSIVE_LOCKS_REQUIRED(cs, m_epoch);
 
 public:
     indirectmap<COutPoint, const CTransaction*> mapNextTx GUARDED_BY(cs);
@@ -697,6 +772,17 @@ public:
 
     std::vector<TxMempoolInfo> infoAll() const;
 
+    /** Copy an entry and its in-mempool relationships into a MempoolEntrySnapshot. */
+    MempoolEntrySnapshot GetEntrySnapshot(txiter it) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /**
+     * Return an immutable snapshot of every mempool entry. The cached snapshot is
+     * reused as long as the mempool has not changed since it was built, so cs is
+     * only held for an O(1) check or, after a change, for copying the entries;
+     * never while callers iterate or serialize the result.
+     */
+    std::shared_ptr<const MempoolSnapshot> GetSnapshot() const;
+
     size_t DynamicMemoryUsage() const;
 
     /** Adds a transaction to the unbroadcast set */
@@ -705,7 +791,7 @@ public:
         LOCK(cs);
         // Sanity check the transaction is in the mempool & insert into
         // unbroadcast set.
-        if (exists(GenTxid::Txid(txid))) m_unbroadcast_txids.insert(txid);
+        if (exists(GenTxid::Txid(txid)) && m_unbroadcast_txids.insert(txid).second) ++m_snapshot_generation;
     };
 
     /** Removes a transaction from the unbroadcast set */
@@ -5,9 +5,11 @@
 #include <txorphanage.h>
 
 #include <consensus/validation.h>
+#include <core_memusage.h>
 #include <logging.h>
 #include <policy/policy.h>
 
+#include <algorithm>
 #include <cassert>
 
 /** Expiration time for orphan transactions in seconds */
@@ -15,6 +17,18 @@ static constexpr int64_t ORPHAN_TX_EXPIRE_TIME = 20 * 60;
 /** Minimum time between orphan transactions expire time checks in seconds */
 static constexpr int64_t ORPHAN_TX_EXPIRE_INTERVAL = 5 * 60;
 
+/** Distinct txids of the outputs spent by tx, i.e. the parents an orphan may be missing */
+static std::vector<uint256> GetParentTxids(const CTransaction& tx)
+{
+    std::vector<uint256> parents;
+    parents.reserve(tx.vin.size());
+    for (const CTxIn& txin : tx.vin) {
+        parents.push_back(txin.prevout.hash);
+    }
+    std::sort(parents.begin(), parents.end());
+    parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+    return parents;
+}
 
 bool TxOrphanage::AddTx(const CTransactionRef& tx, NodeId peer)
 {
@@ -30,8 +44,7 @@ bool TxOrphanage::AddTx(const CTransactionRef& tx, NodeId peer)
     // large transaction with a missing parent then we assume
     // it will rebroadcast it later, after the parent transaction(s)
     // have been mined or received.
-    // 100 orphans, each of which is at most 100,000 bytes big is
-    // at most 10 megabytes of orphans and somewhat more byprev index (in the worst case):
+    // The orphanage as a whole is bounded by -maxorphanmem, see LimitOrphans().
     unsigned int sz = GetTransactionWeight(*tx);
     if (sz > MAX_STANDARD_TX_WEIGHT)
     {
@@ -39,17 +52,23 @@ bool TxOrphanage::AddTx(const CTransactionRef& tx, NodeId peer)
         return false;
     }
 
-    auto ret = m_orphans.emplace(hash, OrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, m_orphan_list.size()});
+    const std::vector<uint256> parents{GetParentTxids(*tx)};
+    // Charge the peer for the transaction itself and its parent index entries.
+    const size_t usage{RecursiveDynamicUsage(tx) + parents.size() * sizeof(OrphanMap::iterator)};
+    PeerOrphans& peer_orphans = m_peer_orphans[peer];
+    auto ret = m_orphans.emplace(hash, OrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, usage, peer_orphans.orphans.size()});
     assert(ret.second);
-    m_orphan_list.push_back(ret.first);
+    peer_orphans.orphans.push_back(ret.first);
+    peer_orphans.usage += usage;
+    m_total_orphan_usage += usage;
     // Allow for lookups in the orphan pool by wtxid, as well as txid
     m_wtxid_to_orphan_it.emplace(tx->GetWitnessHash(), ret.first);
-    for (const CTxIn& txin : tx->vin) {
-        m_outpoint_to_orphan_it[txin.prevout].insert(ret.first);
+    for (const uint256& parent : parents) {
+        m_parent_to_orphan_it[parent].push_back(ret.first);
     }
 
-    LogPrint(BCLog::TXPACKAGES, "stored orphan tx %s (wtxid=%s) (mapsz %u outsz %u)\n", hash.ToString(), wtxid.ToString(),
-             m_orphans.size(), m_outpoint_to_orphan_it.size());
+    LogPrint(BCLog::TXPACKAGES, "stored orphan tx %s (wtxid=%s) (mapsz %u parentsz %u usage %u)\n", hash.ToString(), wtxid.ToString(),
+             m_orphans.size(), m_parent_to_orphan_it.size(), m_total_orphan_usage);
     return true;
 }
 
@@ -65,28 +84,38 @@ int TxOrphanage::EraseTxNoLock(const uint256& txid)
     std::map<uint256, OrphanTx>::iterator it = m_orphans.find(txid);
     if (it == m_orphans.end())
         return 0;
-    for (const CTxIn& txin : it->second.tx->vin)
-    {
-        auto itPrev = m_outpoint_to_orphan_it.find(txin.prevout);
-        if (itPrev == m_outpoint_to_orphan_it.end())
+    for (const uint256& parent : GetParentTxids(*it->second.tx)) {
+        auto itPrev = m_parent_to_orphan_it.find(parent);
+        if (itPrev == m_parent_to_orphan_it.end())
             continue;
-        itPrev->second.erase(it);
-        if (itPrev->second.empty())
-            m_outpoint_to_orphan_it.erase(itPrev);
+        auto& children = itPrev->second;
+        children.erase(std::remove(children.begin(), children.end(), it), children.end());
+        if (children.empty())
+            m_parent_to_orphan_it.erase(itPrev);
     }
 
+    auto peer_it = m_peer_orphans.find(it->second.fromPeer);
+    assert(peer_it != m_peer_orphans.end());
+    PeerOrphans& peer_orphans = peer_it->second;
     size_t old_pos = it->second.list_pos;
-    assert(m_orphan_list[old_pos] == it);
-    if (old_pos + 1 != m_orphan_list.size()) {
-        // Unless we're deleting the last entry in m_orphan_list, move the last
+    assert(peer_orphans.orphans[old_pos] == it);
+    if (old_pos + 1 != peer_orphans.orphans.size()) {
+        // Unless we're deleting the last entry in the peer's list, move the last
         // entry to the position we're deleting.
-        auto it_last = m_orphan_list.back();
-        m_orphan_list[old_pos] = it_last;
+        auto it_last = peer_orphans.orphans.back();
+        peer_orphans.orphans[old_pos] = it_last;
         it_last->second.list_pos = old_pos;
     }
+    peer_orphans.orphans.pop_back();
+    peer_orphans.usage -= it->second.usage;
+    m_total_orphan_usage -= it->second.usage;
+    if (peer_orphans.orphans.empty()) {
+        assert(peer_orphans.usage == 0);
+        m_peer_orphans.erase(peer_it);
+    }
+
     const auto& wtxid = it->second.tx->GetWitnessHash();
     LogPrint(BCLog::TXPACKAGES, "   removed orphan tx %s (wtxid=%s)\n", txid.ToString(), wtxid.ToString());
-    m_orphan_list.pop_back();
     m_wtxid_to_orphan_it.erase(it->second.tx->GetWitnessHash());
 
     m_orphans.erase(it);
@@ -100,19 +129,22 @@ void TxOrphanage::EraseForPeer(NodeId peer)
     m_peer_work_set.erase(peer);
 
     int nErased = 0;
-    std::map<uint256, OrphanTx>::iterator iter = m_orphans.begin();
-    while (iter != m_orphans.end())
-    {
-        std::map<uint256, OrphanTx>::iterator maybeErase = iter++; // increment to avoid iterator becoming invalid
-        if (maybeErase->second.fromPeer == peer)
-        {
-            nErased += EraseTxNoLock(maybeErase->second.tx->GetHash());
+    auto peer_it = m_peer_orphans.find(peer);
+    if (peer_it != m_peer_orphans.end()) {
+        // Copy the txids first: erasing the last orphan also erases the peer's entry.
+        std::vector<uint256> txids;
+        txids.reserve(peer_it->second.orphans.size());
+        for (const auto& orphan_it : peer_it->second.orphans) {
+            txids.push_back(orphan_it->first);
+        }
+        for (const uint256& txid : txids) {
+            nErased += EraseTxNoLock(txid);
         }
     }
     if (nErased > 0) LogPrint(BCLog::TXPACKAGES, "Erased %d orphan tx from peer=%d\n", nErased, peer);
 }
 
-void TxOrphanage::LimitOrphans(unsigned int max_orphans)
+void TxOrphanage::LimitOrphans(unsigned int max_orphans, size_t max_orphan_usage)
 {
     LOCK(m_mutex);
 
@@ -138,11 +170,15 @@ void TxOrphanage::LimitOrphans(unsigned int max_orphans)
         if (nErased > 0) LogPrint(BCLog::TXPACKAGES, "Erased %d orphan tx due to expiration\n", nErased);
     }
     FastRandomContext rng;
-    while (m_orphans.size() > max_orphans)
+    while (m_orphans.size() > max_orphans || m_total_orphan_usage > max_orphan_usage)
     {
-        // Evict a random orphan:
-        size_t randompos = rng.randrange(m_orphan_list.size());
-        EraseTxNoLock(m_orphan_list[randompos]->first);
+        // Evict a random orphan from the peer using the most memory:
+        auto peer_it = std::max_element(m_peer_orphans.begin(), m_peer_orphans.end(),
+            [](const auto& a, const auto& b) { return a.second.usage < b.second.usage; });
+        assert(peer_it != m_peer_orphans.end());
+        const auto& orphans = peer_it->second.orphans;
+        size_t randompos = rng.randrange(orphans.size());
+        EraseTxNoLock(orphans[randompos]->first);
         ++nEvicted;
     }
     if (nEvicted > 0) LogPrint(BCLog::TXPACKAGES, "orphanage overflow, removed %u tx\n", nEvicted);
@@ -153,19 +189,16 @@ void TxOrphanage::AddChildrenToWorkSet(const CTransaction& tx)
     LOCK(m_mutex);
 
 
-    for (unsigned int i = 0; i < tx.vout.size(); i++) {
-        const auto it_by_prev = m_outpoint_to_orphan_it.find(COutPoint(tx.GetHash(), i));
-        if (it_by_prev != m_outpoint_to_orphan_it.end()) {
-            for (const auto& elem : it_by_prev->second) {
-                // Get this source peer's work set, emplacing an empty set if it didn't exist
-                // (note: if this peer wasn't still connected, we would have removed the orphan tx already)
-                std::set<uint256>& orphan_work_set = m_peer_work_set.try_emplace(elem->second.fromPeer).first->second;
-                // Add this tx to the work set
-                orphan_work_set.insert(elem->first);
-                LogPrint(BCLog::TXPACKAGES, "added %s (wtxid=%s) to peer %d workset\n",
-                         tx.GetHash().ToString(), tx.GetWitnessHash().ToString(), elem->second.fromPeer);
-            }
-        }
+    const auto it_by_parent = m_parent_to_orphan_it.find(tx.GetHash());
+    if (it_by_parent == m_parent_to_orphan_it.end()) return;
+    for (const auto& elem : it_by_parent->second) {
+        // Get this source peer's work set, emplacing an empty set if it didn't exist
+        // (note: if this peer wasn't still connected, we would have removed the orphan tx already)
+        std::set<uint256>& orphan_work_set = m_peer_work_set.try_emplace(elem->second.fromPeer).first->second;
+        // Add this tx to the work set
+        orphan_work_set.insert(elem->first);
+        LogPrint(BCLog::TXPACKAGES, "added %s (wtxid=%s) to peer %d workset\n",
+                 tx.GetHash().ToString(), tx.GetWitnessHash().ToString(), elem->second.fromPeer);
     }
 }
 
@@ -199,6 +232,26 @@ CTransactionRef TxOrphanage::GetTxToReconsider(NodeId peer)
     return nullptr;
 }
 
+std::vector<CTransactionRef> TxOrphanage::GetChildrenFromSamePeer(const CTransactionRef& parent, NodeId peer) const
+{
+    LOCK(m_mutex);
+
+    std::vector<CTransactionRef> children;
+    const auto it_by_parent = m_parent_to_orphan_it.find(parent->GetHash());
+    if (it_by_parent == m_parent_to_orphan_it.end()) return children;
+    for (const auto& orphan_it : it_by_parent->second) {
+        if (orphan_it->second.fromPeer == peer) children.push_back(orphan_it->second.tx);
+    }
+    return children;
+}
+
+size_t TxOrphanage::UsageByPeer(NodeId peer) const
+{
+    LOCK(m_mutex);
+    auto peer_it = m_peer_orphans.find(peer);
+    return peer_it == m_peer_orphans.end() ? 0 : peer_it->second.usage;
+}
+
 bool TxOrphanage::HaveTxToReconsider(NodeId peer)
 {
     LOCK(m_mutex);
@@ -222,12 +275,14 @@ void TxOrphanage::EraseForBlock(const CBlock& block)
 
         // Which orphan pool entries must we evict?
         for (const auto& txin : tx.vin) {
-            auto itByPrev = m_outpoint_to_orphan_it.find(txin.prevout);
-            if (itByPrev == m_outpoint_to_orphan_it.end()) continue;
-            for (auto mi = itByPrev->second.begin(); mi != itByPrev->second.end(); ++mi) {
-                const CTransaction& orphanTx = *(*mi)->second.tx;
-                const uint256& orphanHash = orphanTx.GetHash();
-                vOrphanErase.push_back(orphanHash);
+            auto itByPrev = m_parent_to_orphan_it.find(txin.prevout.hash);
+            if (itByPrev == m_parent_to_orphan_it.end()) continue;
+            for (const auto& orphan_it : itByPrev->second) {
+                // Only orphans spending this exact outpoint conflict with the block
+                const CTransaction& orphanTx = *orphan_it->second.tx;
+                const bool spends_prevout = std::any_of(orphanTx.vin.begin(), orphanTx.vin.end(),
+                    [&](const CTxIn& orphan_in) { return orphan_in.prevout == txin.prevout; });
+                if (spends_prevout) vOrphanErase.push_back(orphanTx.GetHash());
             }
         }
     }
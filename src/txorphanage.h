@@ -9,14 +9,20 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <sync.h>
+#include <util/hasher.h>
 
+#include <limits>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 /** A class to track orphan transactions (failed on TX_MISSING_INPUTS)
  * Since we cannot distinguish orphans from bad transactions with
- * non-existent inputs, we heavily limit the number of orphans
- * we keep and the duration we keep them for.
+ * non-existent inputs, we heavily limit the memory orphans may use
+ * and the duration we keep them for. Memory is accounted per announcing
+ * peer, and eviction always targets the peer using the most, so a single
+ * peer flooding the orphanage only displaces its own orphans.
  */
 class TxOrphanage {
 public:
@@ -42,12 +48,18 @@ public:
     /** Erase all orphans included in or invalidated by a new block */
     void EraseForBlock(const CBlock& block) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
 
-    /** Limit the orphanage to the given maximum */
-    void LimitOrphans(unsigned int max_orphans) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Limit the orphanage to the given maximum number of transactions and
+     *  total memory usage (in bytes), evicting from the peer whose orphans
+     *  use the most memory first */
+    void LimitOrphans(unsigned int max_orphans, size_t max_orphan_usage = std::numeric_limits<size_t>::max()) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
 
     /** Add any orphans that list a particular tx as a parent into the from peer's work set */
     void AddChildrenToWorkSet(const CTransaction& tx) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);;
 
+    /** Return the orphans announced by peer that spend an output of parent, i.e. the
+     *  candidate children for a 1-parent-1-child package */
+    std::vector<CTransactionRef> GetChildrenFromSamePeer(const CTransactionRef& parent, NodeId peer) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
     /** Does this peer have any work to do? */
     bool HaveTxToReconsider(NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);;
 
@@ -58,6 +70,16 @@ public:
         return m_orphans.size();
     }
 
+    /** Return the total memory usage accounted to orphans, in bytes */
+    size_t TotalOrphanUsage() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        return m_total_orphan_usage;
+    }
+
+    /** Return the memory usage accounted to orphans announced by a peer, in bytes */
+    size_t UsageByPeer(NodeId peer) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
 protected:
     /** Guards orphan transactions */
     mutable Mutex m_mutex;
@@ -66,11 +88,15 @@ protected:
         CTransactionRef tx;
         NodeId fromPeer;
         int64_t nTimeExpire;
+        /** Memory usage accounted to this orphan */
+        size_t usage;
+        /** Position in the announcing peer's PeerOrphans::orphans */
         size_t list_pos;
     };
 
     /** Map from txid to orphan transaction record. Limited by
-     *  -maxorphantx/DEFAULT_MAX_ORPHAN_TRANSACTIONS */
+     *  -maxorphantx/DEFAULT_MAX_ORPHAN_TRANSACTIONS and
+     *  -maxorphanmem/DEFAULT_MAX_ORPHAN_USAGE */
     std::map<uint256, OrphanTx> m_orphans GUARDED_BY(m_mutex);
 
     /** Which peer provided the orphans that need to be reconsidered */
@@ -78,21 +104,23 @@ protected:
 
     using OrphanMap = decltype(m_orphans);
 
-    struct IteratorComparator
-    {
-        template<typename I>
-        bool operator()(const I& a, const I& b) const
-        {
-            return &(*a) < &(*b);
-        }
+    /** Orphans announced by one peer, and the memory they use */
+    struct PeerOrphans {
+        /** Orphan transactions in vector for quick random eviction */
+        std::vector<OrphanMap::iterator> orphans;
+        size_t usage{0};
     };
 
-    /** Index from the parents' COutPoint into the m_orphans. Used
-     *  to remove orphan transactions from the m_orphans */
-    std::map<COutPoint, std::set<OrphanMap::iterator, IteratorComparator>> m_outpoint_to_orphan_it GUARDED_BY(m_mutex);
+    /** Per-peer orphan lists and memory accounting */
+    std::map<NodeId, PeerOrphans> m_peer_orphans GUARDED_BY(m_mutex);
+
+    /** Sum of OrphanTx::usage over all orphans */
+    size_t m_total_orphan_usage GUARDED_BY(m_mutex){0};
 
-    /** Orphan transactions in vector for quick random eviction */
-    std::vector<OrphanMap::iterator> m_orphan_list GUARDED_BY(m_mutex);
+    /** Index from a (missing) parent txid to the orphans spending any of its
+     *  outputs. Each orphan appears at most once per parent. Used to find the
+     *  children of a newly accepted or confirmed transaction in O(children). */
+    std::unordered_map<uint256, std::vector<OrphanMap::iterator>, SaltedTxidHasher> m_parent_to_orphan_it GUARDED_BY(m_mutex);
 
     /** Index from wtxid into the m_orphans to lookup orphan
      *  transactions using their witness ids. */
@@ -5,21 +5,23 @@
 #include <txrequest.h>
 
 #include <crypto/siphash.h>
+#include <memusage.h>
 #include <net.h>
+#include <prevector.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <uint256.h>
+#include <util/hasher.h>
 
-#include <boost/multi_index/indexed_by.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/tag.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/tuple/tuple.hpp>
-
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <assert.h>
 
@@ -28,7 +30,6 @@ namespace {
 /** The various states a (txhash,peer) pair can be in.
  *
  * Note that CANDIDATE is split up into 3 substates (DELAYED, BEST, READY), allowing more efficient implementation.
- * Also note that the sorting order of ByTxHashView relies on the specific order of values in this enum.
  *
  * Expected behaviour is:
  *   - When first announced by a peer, the state is CANDIDATE_DELAYED until reqtime is reached.
@@ -54,29 +55,50 @@ enum class State : uint8_t {
     COMPLETED,
 };
 
+bool IsSelected(State state) { return state == State::CANDIDATE_BEST || state == State::REQUESTED; }
+bool IsWaiting(State state) { return state == State::REQUESTED || state == State::CANDIDATE_DELAYED; }
+bool IsSelectable(State state) { return state == State::CANDIDATE_READY || state == State::CANDIDATE_BEST; }
+
 //! Type alias for sequence numbers.
 using SequenceNumber = uint64_t;
 
+//! Type alias for priorities.
+using Priority = uint64_t;
+
+//! Position of an announcement in the tracker's announcement storage.
+using AnnIndex = uint32_t;
+
 /** An announcement. This is the data we track for each txid or wtxid that is announced to us by each peer. */
 struct Announcement {
     /** Txid or wtxid that was announced. */
-    const uint256 m_txhash;
+    uint256 m_txhash;
     /** For CANDIDATE_{DELAYED,BEST,READY} the reqtime; for REQUESTED the expiry. */
     std::chrono::microseconds m_time;
     /** What peer the request was from. */
-    const NodeId m_peer;
+    NodeId m_peer;
+    /** The priority of this announcement, computed when it is created. */
+    Priority m_priority;
     /** What sequence number this announcement has. */
-    const SequenceNumber m_sequence : 59;
+    SequenceNumber m_sequence : 58;
     /** Whether the request is preferred. */
-    const bool m_preferred : 1;
+    bool m_preferred : 1;
     /** Whether this is a wtxid request. */
-    const bool m_is_wtxid : 1;
+    bool m_is_wtxid : 1;
+    /** Whether this slot of the announcement storage holds an announcement. */
+    bool m_in_use : 1;
 
     /** What state this announcement is in.
      *  This is a uint8_t instead of a State to silence a GCC warning in versions prior to 9.3.
      *  See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=61414 */
     uint8_t m_state : 3;
 
+    /** Position in the peer's list of announcements. */
+    AnnIndex m_peer_pos;
+    /** Position in the peer's list of CANDIDATE_BEST announcements (only meaningful in that state). */
+    AnnIndex m_best_pos;
+    /** Identifies the latest time event scheduled for this slot; older events for it are stale. */
+    uint32_t m_event_id{0};
+
     /** Convert m_state to a State enum. */
     State GetState() const { return static_cast<State>(m_state); }
 
@@ -84,33 +106,15 @@ struct Announcement {
     void SetState(State state) { m_state = static_cast<uint8_t>(state); }
 
     /** Whether this announcement is selected. There can be at most 1 selected peer per txhash. */
-    bool IsSelected() const
-    {
-        return GetState() == State::CANDIDATE_BEST || GetState() == State::REQUESTED;
-    }
+    bool IsSelected() const { return ::IsSelected(GetState()); }
 
     /** Whether this announcement is waiting for a certain time to pass. */
-    bool IsWaiting() const
-    {
-        return GetState() == State::REQUESTED || GetState() == State::CANDIDATE_DELAYED;
-    }
+    bool IsWaiting() const { return ::IsWaiting(GetState()); }
 
     /** Whether this announcement can feasibly be selected if the current IsSelected() one disappears. */
-    bool IsSelectable() const
-    {
-        return GetState() == State::CANDIDATE_READY || GetState() == State::CANDIDATE_BEST;
-    }
-
-    /** Construct a new announcement from scratch, initially in CANDIDATE_DELAYED state. */
-    Announcement(const GenTxid& gtxid, NodeId peer, bool preferred, std::chrono::microseconds reqtime,
-        SequenceNumber sequence) :
-        m_txhash(gtxid.GetHash()), m_time(reqtime), m_peer(peer), m_sequence(sequence), m_preferred(preferred),
-        m_is_wtxid(gtxid.IsWtxid()), m_state(static_cast<uint8_t>(State::CANDIDATE_DELAYED)) {}
+    bool IsSelectable() const { return ::IsSelectable(GetState()); }
 };
 
-//! Type alias for priorities.
-using Priority = uint64_t;
-
 /** A functor with embedded salt that computes priority of an announcement.
  *
  * Higher priorities are selected first.
@@ -134,104 +138,22 @@ public:
     }
 };
 
-// Definitions for the 3 indexes used in the main data structure.
-//
-// Each index has a By* type to identify it, a By*View data type to represent the view of announcement it is sorted
-// by, and an By*ViewExtractor type to convert an announcement into the By*View type.
-// See https://www.boost.org/doc/libs/1_58_0/libs/multi_index/doc/reference/key_extraction.html#key_extractors
-// for more information about the key extraction concept.
-
-// The ByPeer index is sorted by (peer, state == CANDIDATE_BEST, txhash)
-//
-// Uses:
-// * Looking up existing announcements by peer/txhash, by checking both (peer, false, txhash) and
-//   (peer, true, txhash).
-// * Finding all CANDIDATE_BEST announcements for a given peer in GetRequestable.
-struct ByPeer {};
-using ByPeerView = std::tuple<NodeId, bool, const uint256&>;
-struct ByPeerViewExtractor
-{
-    using result_type = ByPeerView;
-    result_type operator()(const Announcement& ann) const
-    {
-        return ByPeerView{ann.m_peer, ann.GetState() == State::CANDIDATE_BEST, ann.m_txhash};
-    }
-};
-
-// The ByTxHash index is sorted by (txhash, state, priority).
-//
-// Note: priority == 0 whenever state != CANDIDATE_READY.
-//
-// Uses:
-// * Deleting all announcements with a given txhash in ForgetTxHash.
-// * Finding the best CANDIDATE_READY to convert to CANDIDATE_BEST, when no other CANDIDATE_READY or REQUESTED
-//   announcement exists for that txhash.
-// * Determining when no more non-COMPLETED announcements for a given txhash exist, so the COMPLETED ones can be
-//   deleted.
-struct ByTxHash {};
-using ByTxHashView = std::tuple<const uint256&, State, Priority>;
-class ByTxHashViewExtractor {
-    const PriorityComputer& m_computer;
-public:
-    explicit ByTxHashViewExtractor(const PriorityComputer& computer) : m_computer(computer) {}
-    using result_type = ByTxHashView;
-    result_type operator()(const Announcement& ann) const
-    {
-        const Priority prio = (ann.GetState() == State::CANDIDATE_READY) ? m_computer(ann) : 0;
-        return ByTxHashView{ann.m_txhash, ann.GetState(), prio};
-    }
-};
+/** All announcements for one txhash. Few peers announce the same transaction, so this rarely allocates. */
+using TxHashAnnouncements = prevector<4, AnnIndex>;
 
-enum class WaitState {
-    //! Used for announcements that need efficient testing of "is their timestamp in the future?".
-    FUTURE_EVENT,
-    //! Used for announcements whose timestamp is not relevant.
-    NO_EVENT,
-    //! Used for announcements that need efficient testing of "is their timestamp in the past?".
-    PAST_EVENT,
-};
-
-WaitState GetWaitState(const Announcement& ann)
-{
-    if (ann.IsWaiting()) return WaitState::FUTURE_EVENT;
-    if (ann.IsSelectable()) return WaitState::PAST_EVENT;
-    return WaitState::NO_EVENT;
-}
+/** A point in time at which a CANDIDATE_DELAYED announcement becomes ready, or a REQUESTED one expires.
+ *
+ * Events are not removed when the announcement changes state or is deleted; they are recognized as stale through
+ * m_event_id instead, and skipped when they come up. */
+struct TimeEvent {
+    std::chrono::microseconds m_time;
+    AnnIndex m_ann;
+    uint32_t m_event_id;
 
-// The ByTime index is sorted by (wait_state, time).
-//
-// All announcements with a timestamp in the future can be found by iterating the index forward from the beginning.
-// All announcements with a timestamp in the past can be found by iterating the index backwards from the end.
-//
-// Uses:
-// * Finding CANDIDATE_DELAYED announcements whose reqtime has passed, and REQUESTED announcements whose expiry has
-//   passed.
-// * Finding CANDIDATE_READY/BEST announcements whose reqtime is in the future (when the clock time went backwards).
-struct ByTime {};
-using ByTimeView = std::pair<WaitState, std::chrono::microseconds>;
-struct ByTimeViewExtractor
-{
-    using result_type = ByTimeView;
-    result_type operator()(const Announcement& ann) const
-    {
-        return ByTimeView{GetWaitState(ann), ann.m_time};
-    }
+    /** Order for a min-heap on time. */
+    bool operator>(const TimeEvent& other) const { return m_time > other.m_time; }
 };
 
-/** Data type for the main data structure (Announcement objects with ByPeer/ByTxHash/ByTime indexes). */
-using Index = boost::multi_index_container<
-    Announcement,
-    boost::multi_index::indexed_by<
-        boost::multi_index::ordered_unique<boost::multi_index::tag<ByPeer>, ByPeerViewExtractor>,
-        boost::multi_index::ordered_non_unique<boost::multi_index::tag<ByTxHash>, ByTxHashViewExtractor>,
-        boost::multi_index::ordered_non_unique<boost::multi_index::tag<ByTime>, ByTimeViewExtractor>
-    >
->;
-
-/** Helper type to simplify syntax of iterator types. */
-template<typename Tag>
-using Iter = typename Index::index<Tag>::type::iterator;
-
 /** Per-peer statistics object. */
 struct PeerInfo {
     size_t m_total = 0; //!< Total number of announcements for this peer.
@@ -239,6 +161,16 @@ struct PeerInfo {
     size_t m_requested = 0; //!< Number of REQUESTED announcements for this peer.
 };
 
+/** Per-peer data: statistics plus the peer's announcements, so that its CANDIDATE_BEST ones can be listed
+ *  without searching. */
+struct PeerData {
+    PeerInfo m_info;
+    //! All announcements from this peer.
+    std::vector<AnnIndex> m_announcements;
+    //! The CANDIDATE_BEST announcements from this peer, in no particular order.
+    std::vector<AnnIndex> m_best;
+};
+
 /** Per-txhash statistics object. Only used for sanity checking. */
 struct TxHashInfo
 {
@@ -265,11 +197,12 @@ bool operator==(const PeerInfo& a, const PeerInfo& b)
            std::tie(b.m_total, b.m_completed, b.m_requested);
 };
 
-/** (Re)compute the PeerInfo map from the index. Only used for sanity checking. */
-std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index& index)
+/** (Re)compute the PeerInfo map from the announcements. Only used for sanity checking. */
+std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const std::vector<Announcement>& anns)
 {
     std::unordered_map<NodeId, PeerInfo> ret;
-    for (const Announcement& ann : index) {
+    for (const Announcement& ann : anns) {
+        if (!ann.m_in_use) continue;
         PeerInfo& info = ret[ann.m_peer];
         ++info.m_total;
         info.m_requested += (ann.GetState() == State::REQUESTED);
@@ -279,10 +212,11 @@ std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index& index)
 }
 
 /** Compute the TxHashInfo map. Only used for sanity checking. */
-std::map<uint256, TxHashInfo> ComputeTxHashInfo(const Index& index, const PriorityComputer& computer)
+std::map<uint256, TxHashInfo> ComputeTxHashInfo(const std::vector<Announcement>& anns, const PriorityComputer& computer)
 {
     std::map<uint256, TxHashInfo> ret;
-    for (const Announcement& ann : index) {
+    for (const Announcement& ann : anns) {
+        if (!ann.m_in_use) continue;
         TxHashInfo& info = ret[ann.m_txhash];
         // Classify how many announcements of each state we have for this txhash.
         info.m_candidate_delayed += (ann.GetState() == State::CANDIDATE_DELAYED);
@@ -309,7 +243,14 @@ GenTxid ToGenTxid(const Announcement& ann)
 
 }  // namespace
 
-/** Actual implementation for TxRequestTracker's data structure. */
+/** Actual implementation for TxRequestTracker's data structure.
+ *
+ * Announcements live in a flat vector whose slots are reused, and are referred to by position. Each txhash maps to
+ * the (few) positions of its announcements, so finding the best candidate or the selected announcement for a txhash
+ * is a short scan. Each peer lists its announcements, and separately its CANDIDATE_BEST ones, which is all
+ * GetRequestable needs. A min-heap of time events drives the CANDIDATE_DELAYED -> CANDIDATE_READY and
+ * REQUESTED -> COMPLETED transitions.
+ */
 class TxRequestTracker::Impl {
     //! The current sequence number. Increases for every announcement. This is used to sort txhashes returned by
     //! GetRequestable in announcement order.
@@ -318,21 +259,71 @@ class TxRequestTracker::Impl {
     //! This tracker's priority computer.
     const PriorityComputer m_computer;
 
-    //! This tracker's main data structure. See SanityCheck() for the invariants that apply to it.
-    Index m_index;
+    //! Storage for all announcements. Slots not m_in_use are listed in m_free.
+    std::vector<Announcement> m_anns;
+
+    //! Unused slots of m_anns.
+    std::vector<AnnIndex> m_free;
+
+    //! Number of announcements in m_anns.
+    size_t m_size{0};
+
+    //! The announcements for each txhash.
+    std::unordered_map<uint256, TxHashAnnouncements, SaltedTxidHasher> m_txhashes;
+
+    //! Map with this tracker's per-peer data. Only peers with announcements have an entry.
+    std::unordered_map<NodeId, PeerData> m_peers;
 
-    //! Map with this tracker's per-peer statistics.
-    std::unordered_map<NodeId, PeerInfo> m_peerinfo;
+    //! Min-heap of time events, possibly stale. Every IsWaiting() announcement has exactly one current event.
+    std::vector<TimeEvent> m_events;
+
+    //! Number of IsWaiting() announcements, i.e. of current events in m_events.
+    size_t m_waiting{0};
+
+    //! No IsSelectable() announcement has a time after this; time going back before it requires demoting some.
+    std::chrono::microseconds m_horizon{std::chrono::microseconds::min()};
 
 public:
     void SanityCheck() const
     {
-        // Recompute m_peerdata from m_index. This verifies the data in it as it should just be caching statistics
-        // on m_index. It also verifies the invariant that no PeerInfo announcements with m_total==0 exist.
-        assert(m_peerinfo == RecomputePeerInfo(m_index));
-
-        // Calculate per-txhash statistics from m_index, and validate invariants.
-        for (auto& item : ComputeTxHashInfo(m_index, m_computer)) {
+        // Recompute m_peerdata from m_anns. This verifies the data in it as it should just be caching statistics
+        // on m_anns. It also verifies the invariant that no PeerInfo announcements with m_total==0 exist.
+        std::unordered_map<NodeId, PeerInfo> peerinfo;
+        for (const auto& [peer, data] : m_peers) peerinfo.emplace(peer, data.m_info);
+        assert(peerinfo == RecomputePeerInfo(m_anns));
+
+        // Check the per-peer lists, the per-txhash lists and the cached priorities.
+        size_t best{0}, waiting{0};
+        for (const auto& [peer, data] : m_peers) {
+            assert(data.m_announcements.size() == data.m_info.m_total);
+            for (AnnIndex pos = 0; pos < data.m_announcements.size(); ++pos) {
+                const Announcement& ann = m_anns[data.m_announcements[pos]];
+                assert(ann.m_in_use && ann.m_peer == peer && ann.m_peer_pos == pos);
+                assert(ann.m_priority == m_computer(ann));
+                waiting += ann.IsWaiting();
+            }
+            for (AnnIndex pos = 0; pos < data.m_best.size(); ++pos) {
+                const Announcement& ann = m_anns[data.m_best[pos]];
+                assert(ann.m_in_use && ann.m_peer == peer && ann.m_best_pos == pos);
+                assert(ann.GetState() == State::CANDIDATE_BEST);
+            }
+            best += data.m_best.size();
+        }
+        size_t listed{0};
+        for (const auto& [txhash, anns] : m_txhashes) {
+            assert(!anns.empty());
+            for (AnnIndex i : anns) assert(m_anns[i].m_in_use && m_anns[i].m_txhash == txhash);
+            listed += anns.size();
+        }
+        assert(listed == m_size);
+        assert(m_anns.size() == m_size + m_free.size());
+        assert(m_waiting == waiting);
+        assert(std::count_if(m_events.begin(), m_events.end(), [&](const TimeEvent& ev) { return IsCurrent(ev); }) ==
+               static_cast<std::ptrdiff_t>(m_waiting));
+
+        // Calculate per-txhash statistics from m_anns, and validate invariants.
+        size_t candidate_best{0};
+        for (auto& item : ComputeTxHashInfo(m_anns, m_computer)) {
             TxHashInfo& info = item.second;
 
             // Cannot have only COMPLETED peer (txhash should have been forgotten already)
@@ -356,12 +347,17 @@ public:
             // No txhash can have been announced by the same peer twice.
             std::sort(info.m_peers.begin(), info.m_peers.end());
             assert(std::adjacent_find(info.m_peers.begin(), info.m_peers.end()) == info.m_peers.end());
+
+            // Every CANDIDATE_BEST announcement is listed by its peer.
+            candidate_best += info.m_candidate_best;
         }
+        assert(candidate_best == best);
     }
 
     void PostGetRequestableSanityCheck(std::chrono::microseconds now) const
     {
-        for (const Announcement& ann : m_index) {
+        for (const Announcement& ann : m_anns) {
+            if (!ann.m_in_use) continue;
             if (ann.IsWaiting()) {
                 // REQUESTED and CANDIDATE_DELAYED must have a time in the future (they should have been converted
                 // to COMPLETED/CANDIDATE_READY respectively).
@@ -375,116 +371,178 @@ public:
     }
 
 private:
-    //! Wrapper around Index::...::erase that keeps m_peerinfo up to date.
-    template<typename Tag>
-    Iter<Tag> Erase(Iter<Tag> it)
+    //! Whether a time event still applies to the announcement it refers to.
+    bool IsCurrent(const TimeEvent& ev) const
+    {
+        const Announcement& ann = m_anns[ev.m_ann];
+        return ann.m_in_use && ann.m_event_id == ev.m_event_id && ann.IsWaiting();
+    }
+
+    //! Schedule a time event for an IsWaiting() announcement at its m_time, superseding any earlier one.
+    void ScheduleEvent(AnnIndex i)
+    {
+        Announcement& ann = m_anns[i];
+        m_events.push_back(TimeEvent{ann.m_time, i, ++ann.m_event_id});
+        std::push_heap(m_events.begin(), m_events.end(), std::greater<TimeEvent>{});
+        // Drop stale events once they make up most of the heap.
+        if (m_events.size() > 2 * m_waiting + 64) {
+            m_events.erase(std::remove_if(m_events.begin(), m_events.end(), [&](const TimeEvent& ev) { return !IsCurrent(ev); }),
+                           m_events.end());
+            std::make_heap(m_events.begin(), m_events.end(), std::greater<TimeEvent>{});
+        }
+    }
+
+    //! Change the state of an announcement, keeping the per-peer data and the time events up to date.
+    void SetState(AnnIndex i, State state)
+    {
+        Announcement& ann = m_anns[i];
+        const State old_state = ann.GetState();
+        PeerData& peer = m_peers.find(ann.m_peer)->second;
+        peer.m_info.m_completed -= old_state == State::COMPLETED;
+        peer.m_info.m_requested -= old_state == State::REQUESTED;
+        peer.m_info.m_completed += state == State::COMPLETED;
+        peer.m_info.m_requested += state == State::REQUESTED;
+        if (old_state == State::CANDIDATE_BEST) RemoveBest(peer, i);
+        if (state == State::CANDIDATE_BEST) {
+            ann.m_best_pos = peer.m_best.size();
+            peer.m_best.push_back(i);
+        }
+        m_waiting -= ::IsWaiting(old_state);
+        m_waiting += ::IsWaiting(state);
+        ann.SetState(state);
+        if (ann.IsWaiting()) ScheduleEvent(i);
+    }
+
+    //! Remove an announcement from its peer's CANDIDATE_BEST list.
+    void RemoveBest(PeerData& peer, AnnIndex i)
     {
-        auto peerit = m_peerinfo.find(it->m_peer);
-        peerit->second.m_completed -= it->GetState() == State::COMPLETED;
-        peerit->second.m_requested -= it->GetState() == State::REQUESTED;
-        if (--peerit->second.m_total == 0) m_peerinfo.erase(peerit);
-        return m_index.get<Tag>().erase(it);
+        const AnnIndex last = peer.m_best.back();
+        peer.m_best[m_anns[i].m_best_pos] = last;
+        m_anns[last].m_best_pos = m_anns[i].m_best_pos;
+        peer.m_best.pop_back();
     }
 
-    //! Wrapper around Index::...::modify that keeps m_peerinfo up to date.
-    template<typename Tag, typename Modifier>
-    void Modify(Iter<Tag> it, Modifier modifier)
+    //! Delete an announcement that has already been removed from its txhash's list, keeping m_peers up to date.
+    void Erase(AnnIndex i)
     {
-        auto peerit = m_peerinfo.find(it->m_peer);
-        peerit->second.m_completed -= it->GetState() == State::COMPLETED;
-        peerit->second.m_requested -= it->GetState() == State::REQUESTED;
-        m_index.get<Tag>().modify(it, std::move(modifier));
-        peerit->second.m_completed += it->GetState() == State::COMPLETED;
-        peerit->second.m_requested += it->GetState() == State::REQUESTED;
+        Announcement& ann = m_anns[i];
+        auto peerit = m_peers.find(ann.m_peer);
+        PeerData& peer = peerit->second;
+        peer.m_info.m_completed -= ann.GetState() == State::COMPLETED;
+        peer.m_info.m_requested -= ann.GetState() == State::REQUESTED;
+        if (ann.GetState() == State::CANDIDATE_BEST) RemoveBest(peer, i);
+        m_waiting -= ann.IsWaiting();
+        const AnnIndex last = peer.m_announcements.back();
+        peer.m_announcements[ann.m_peer_pos] = last;
+        m_anns[last].m_peer_pos = ann.m_peer_pos;
+        peer.m_announcements.pop_back();
+        if (--peer.m_info.m_total == 0) m_peers.erase(peerit);
+        ann.m_in_use = false;
+        m_free.push_back(i);
+        --m_size;
+    }
+
+    //! Delete all announcements for a txhash.
+    void EraseTxHash(std::unordered_map<uint256, TxHashAnnouncements, SaltedTxidHasher>::iterator it)
+    {
+        for (AnnIndex i : it->second) Erase(i);
+        m_txhashes.erase(it);
+    }
+
+    //! Find the announcement for a (peer, txhash) combination, if any.
+    std::optional<AnnIndex> Find(NodeId peer, const uint256& txhash) const
+    {
+        auto it = m_txhashes.find(txhash);
+        if (it == m_txhashes.end()) return std::nullopt;
+        for (AnnIndex i : it->second) {
+            if (m_anns[i].m_peer == peer) return i;
+        }
+        return std::nullopt;
+    }
+
+    //! The announcements for the txhash of a given announcement.
+    TxHashAnnouncements& AnnouncementsFor(AnnIndex i) { return m_txhashes.find(m_anns[i].m_txhash)->second; }
+
+    //! Find the CANDIDATE_BEST or REQUESTED announcement among a txhash's announcements, if any.
+    std::optional<AnnIndex> FindSelected(const TxHashAnnouncements& anns) const
+    {
+        for (AnnIndex i : anns) {
+            if (m_anns[i].IsSelected()) return i;
+        }
+        return std::nullopt;
+    }
+
+    //! Find the highest-priority CANDIDATE_READY announcement among a txhash's announcements, if any.
+    std::optional<AnnIndex> FindBestReady(const TxHashAnnouncements& anns) const
+    {
+        std::optional<AnnIndex> best;
+        for (AnnIndex i : anns) {
+            if (m_anns[i].GetState() == State::CANDIDATE_READY && (!best || m_anns[i].m_priority > m_anns[*best].m_priority)) {
+                best = i;
+            }
+        }
+        return best;
     }
 
     //! Convert a CANDIDATE_DELAYED announcement into a CANDIDATE_READY. If this makes it the new best
     //! CANDIDATE_READY (and no REQUESTED exists) and better than the CANDIDATE_BEST (if any), it becomes the new
     //! CANDIDATE_BEST.
-    void PromoteCandidateReady(Iter<ByTxHash> it)
+    void PromoteCandidateReady(AnnIndex i)
     {
-        assert(it != m_index.get<ByTxHash>().end());
-        assert(it->GetState() == State::CANDIDATE_DELAYED);
-        // Convert CANDIDATE_DELAYED to CANDIDATE_READY first.
-        Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_READY); });
-        // The following code relies on the fact that the ByTxHash is sorted by txhash, and then by state (first
-        // _DELAYED, then _READY, then _BEST/REQUESTED). Within the _READY announcements, the best one (highest
-        // priority) comes last. Thus, if an existing _BEST exists for the same txhash that this announcement may
-        // be preferred over, it must immediately follow the newly created _READY.
-        auto it_next = std::next(it);
-        if (it_next == m_index.get<ByTxHash>().end() || it_next->m_txhash != it->m_txhash ||
-            it_next->GetState() == State::COMPLETED) {
+        assert(m_anns[i].GetState() == State::CANDIDATE_DELAYED);
+        const auto selected = FindSelected(AnnouncementsFor(i));
+        if (!selected) {
             // This is the new best CANDIDATE_READY, and there is no IsSelected() announcement for this txhash
             // already.
-            Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
-        } else if (it_next->GetState() == State::CANDIDATE_BEST) {
-            Priority priority_old = m_computer(*it_next);
-            Priority priority_new = m_computer(*it);
-            if (priority_new > priority_old) {
-                // There is a CANDIDATE_BEST announcement already, but this one is better.
-                Modify<ByTxHash>(it_next, [](Announcement& ann){ ann.SetState(State::CANDIDATE_READY); });
-                Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
-            }
+            SetState(i, State::CANDIDATE_BEST);
+        } else if (m_anns[*selected].GetState() == State::CANDIDATE_BEST && m_anns[i].m_priority > m_anns[*selected].m_priority) {
+            // There is a CANDIDATE_BEST announcement already, but this one is better.
+            SetState(*selected, State::CANDIDATE_READY);
+            SetState(i, State::CANDIDATE_BEST);
+        } else {
+            SetState(i, State::CANDIDATE_READY);
         }
     }
 
     //! Change the state of an announcement to something non-IsSelected(). If it was IsSelected(), the next best
     //! announcement will be marked CANDIDATE_BEST.
-    void ChangeAndReselect(Iter<ByTxHash> it, State new_state)
+    void ChangeAndReselect(AnnIndex i, State new_state)
     {
         assert(new_state == State::COMPLETED || new_state == State::CANDIDATE_DELAYED);
-        assert(it != m_index.get<ByTxHash>().end());
-        if (it->IsSelected() && it != m_index.get<ByTxHash>().begin()) {
-            auto it_prev = std::prev(it);
-            // The next best CANDIDATE_READY, if any, immediately precedes the REQUESTED or CANDIDATE_BEST
-            // announcement in the ByTxHash index.
-            if (it_prev->m_txhash == it->m_txhash && it_prev->GetState() == State::CANDIDATE_READY) {
-                // If one such CANDIDATE_READY exists (for this txhash), convert it to CANDIDATE_BEST.
-                Modify<ByTxHash>(it_prev, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
-            }
+        if (m_anns[i].IsSelected()) {
+            // If a CANDIDATE_READY exists for this txhash, convert the best one to CANDIDATE_BEST.
+            if (const auto next = FindBestReady(AnnouncementsFor(i))) SetState(*next, State::CANDIDATE_BEST);
         }
-        Modify<ByTxHash>(it, [new_state](Announcement& ann){ ann.SetState(new_state); });
+        SetState(i, new_state);
     }
 
-    //! Check if 'it' is the only announcement for a given txhash that isn't COMPLETED.
-    bool IsOnlyNonCompleted(Iter<ByTxHash> it)
+    //! Check if 'i' is the only announcement for a given txhash that isn't COMPLETED.
+    bool IsOnlyNonCompleted(AnnIndex i, const TxHashAnnouncements& anns) const
     {
-        assert(it != m_index.get<ByTxHash>().end());
-        assert(it->GetState() != State::COMPLETED); // Not allowed to call this on COMPLETED announcements.
-
-        // This announcement has a predecessor that belongs to the same txhash. Due to ordering, and the
-        // fact that 'it' is not COMPLETED, its predecessor cannot be COMPLETED here.
-        if (it != m_index.get<ByTxHash>().begin() && std::prev(it)->m_txhash == it->m_txhash) return false;
-
-        // This announcement has a successor that belongs to the same txhash, and is not COMPLETED.
-        if (std::next(it) != m_index.get<ByTxHash>().end() && std::next(it)->m_txhash == it->m_txhash &&
-            std::next(it)->GetState() != State::COMPLETED) return false;
-
-        return true;
+        assert(m_anns[i].GetState() != State::COMPLETED); // Not allowed to call this on COMPLETED announcements.
+        return std::all_of(anns.begin(), anns.end(), [&](AnnIndex j) {
+            return j == i || m_anns[j].GetState() == State::COMPLETED;
+        });
     }
 
     /** Convert any announcement to a COMPLETED one. If there are no non-COMPLETED announcements left for this
      *  txhash, they are deleted. If this was a REQUESTED announcement, and there are other CANDIDATEs left, the
      *  best one is made CANDIDATE_BEST. Returns whether the announcement still exists. */
-    bool MakeCompleted(Iter<ByTxHash> it)
+    bool MakeCompleted(AnnIndex i)
     {
-        assert(it != m_index.get<ByTxHash>().end());
-
         // Nothing to be done if it's already COMPLETED.
-        if (it->GetState() == State::COMPLETED) return true;
+        if (m_anns[i].GetState() == State::COMPLETED) return true;
 
-        if (IsOnlyNonCompleted(it)) {
+        auto it = m_txhashes.find(m_anns[i].m_txhash);
+        if (IsOnlyNonCompleted(i, it->second)) {
             // This is the last non-COMPLETED announcement for this txhash. Delete all.
-            uint256 txhash = it->m_txhash;
-            do {
-                it = Erase<ByTxHash>(it);
-            } while (it != m_index.get<ByTxHash>().end() && it->m_txhash == txhash);
+            EraseTxHash(it);
             return false;
         }
 
         // Mark the announcement COMPLETED, and select the next best announcement (the first CANDIDATE_READY) if
         // needed.
-        ChangeAndReselect(it, State::COMPLETED);
+        ChangeAndReselect(i, State::COMPLETED);
 
         return true;
     }
@@ -497,102 +555,114 @@ private:
     {
         if (expired) expired->clear();
 
-        // Iterate over all CANDIDATE_DELAYED and REQUESTED from old to new, as long as they're in the past,
-        // and convert them to CANDIDATE_READY and COMPLETED respectively.
-        while (!m_index.empty()) {
-            auto it = m_index.get<ByTime>().begin();
-            if (it->GetState() == State::CANDIDATE_DELAYED && it->m_time <= now) {
-                PromoteCandidateReady(m_index.project<ByTxHash>(it));
-            } else if (it->GetState() == State::REQUESTED && it->m_time <= now) {
-                if (expired) expired->emplace_back(it->m_peer, ToGenTxid(*it));
-                MakeCompleted(m_index.project<ByTxHash>(it));
+        // Process the time events that are in the past, from old to new, converting CANDIDATE_DELAYED and REQUESTED
+        // announcements to CANDIDATE_READY and COMPLETED respectively.
+        while (!m_events.empty()) {
+            const TimeEvent ev = m_events.front();
+            const bool current = IsCurrent(ev);
+            if (current && ev.m_time > now) break;
+            std::pop_heap(m_events.begin(), m_events.end(), std::greater<TimeEvent>{});
+            m_events.pop_back();
+            if (!current) continue;
+            const Announcement& ann = m_anns[ev.m_ann];
+            if (ann.GetState() == State::CANDIDATE_DELAYED) {
+                PromoteCandidateReady(ev.m_ann);
             } else {
-                break;
+                if (expired) expired->emplace_back(ann.m_peer, ToGenTxid(ann));
+                MakeCompleted(ev.m_ann);
             }
         }
 
-        while (!m_index.empty()) {
+        if (now < m_horizon) {
             // If time went backwards, we may need to demote CANDIDATE_BEST and CANDIDATE_READY announcements back
             // to CANDIDATE_DELAYED. This is an unusual edge case, and unlikely to matter in production. However,
-            // it makes it much easier to specify and test TxRequestTracker::Impl's behaviour.
-            auto it = std::prev(m_index.get<ByTime>().end());
-            if (it->IsSelectable() && it->m_time > now) {
-                ChangeAndReselect(m_index.project<ByTxHash>(it), State::CANDIDATE_DELAYED);
-            } else {
-                break;
+            // it makes it much easier to specify and test TxRequestTracker::Impl's behaviour. Collect them first,
+            // as demoting a CANDIDATE_BEST may select another one that needs demoting too.
+            std::vector<AnnIndex> demote;
+            for (AnnIndex i = 0; i < m_anns.size(); ++i) {
+                if (m_anns[i].m_in_use && m_anns[i].IsSelectable() && m_anns[i].m_time > now) demote.push_back(i);
+            }
+            for (AnnIndex i : demote) {
+                if (m_anns[i].IsSelectable()) ChangeAndReselect(i, State::CANDIDATE_DELAYED);
             }
         }
+        m_horizon = now;
     }
 
 public:
     explicit Impl(bool deterministic) :
-        m_computer(deterministic),
-        // Explicitly initialize m_index as we need to pass a reference to m_computer to ByTxHashViewExtractor.
-        m_index(boost::make_tuple(
-            boost::make_tuple(ByPeerViewExtractor(), std::less<ByPeerView>()),
-            boost::make_tuple(ByTxHashViewExtractor(m_computer), std::less<ByTxHashView>()),
-            boost::make_tuple(ByTimeViewExtractor(), std::less<ByTimeView>())
-        )) {}
-
-    // Disable copying and assigning (a default copy won't work due the stateful ByTxHashViewExtractor).
+        m_computer(deterministic) {}
+
+    // Disable copying and assigning (announcement positions are shared between the internal structures).
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
 
     void DisconnectedPeer(NodeId peer)
     {
-        auto& index = m_index.get<ByPeer>();
-        auto it = index.lower_bound(ByPeerView{peer, false, uint256::ZERO});
-        while (it != index.end() && it->m_peer == peer) {
-            // Check what to continue with after this iteration. 'it' will be deleted in what follows, so we need to
-            // decide what to continue with afterwards. There are a number of cases to consider:
-            // - std::next(it) is end() or belongs to a different peer. In that case, this is the last iteration
-            //   of the loop (denote this by setting it_next to end()).
-            // - 'it' is not the only non-COMPLETED announcement for its txhash. This means it will be deleted, but
-            //   no other Announcement objects will be modified. Continue with std::next(it) if it belongs to the
-            //   same peer, but decide this ahead of time (as 'it' may change position in what follows).
-            // - 'it' is the only non-COMPLETED announcement for its txhash. This means it will be deleted along
-            //   with all other announcements for the same txhash - which may include std::next(it). However, other
-            //   than 'it', no announcements for the same peer can be affected (due to (peer, txhash) uniqueness).
-            //   In other words, the situation where std::next(it) is deleted can only occur if std::next(it)
-            //   belongs to a different peer but the same txhash as 'it'. This is covered by the first bulletpoint
-            //   already, and we'll have set it_next to end().
-            auto it_next = (std::next(it) == index.end() || std::next(it)->m_peer != peer) ? index.end() :
-                std::next(it);
+        auto peerit = m_peers.find(peer);
+        if (peerit == m_peers.end()) return;
+        // Copy the list, as it shrinks (and is deleted along with the peer's entry) in what follows. Deleting an
+        // announcement can delete other announcements for the same txhash, but never other ones from this peer,
+        // due to (peer, txhash) uniqueness.
+        const std::vector<AnnIndex> anns = peerit->second.m_announcements;
+        for (AnnIndex i : anns) {
             // If the announcement isn't already COMPLETED, first make it COMPLETED (which will mark other
             // CANDIDATEs as CANDIDATE_BEST, or delete all of a txhash's announcements if no non-COMPLETED ones are
             // left).
-            if (MakeCompleted(m_index.project<ByTxHash>(it))) {
-                // Then actually delete the announcement (unless it was already deleted by MakeCompleted).
-                Erase<ByPeer>(it);
+            if (MakeCompleted(i)) {
+                // Then actually delete the announcement (unless it was already deleted by MakeCompleted). Other
+                // non-COMPLETED announcements for the txhash remain, so its list does not become empty.
+                auto& txhash_anns = AnnouncementsFor(i);
+                txhash_anns.erase(std::find(txhash_anns.begin(), txhash_anns.end(), i));
+                Erase(i);
             }
-            it = it_next;
         }
     }
 
     void ForgetTxHash(const uint256& txhash)
     {
-        auto it = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_DELAYED, 0});
-        while (it != m_index.get<ByTxHash>().end() && it->m_txhash == txhash) {
-            it = Erase<ByTxHash>(it);
-        }
+        auto it = m_txhashes.find(txhash);
+        if (it != m_txhashes.end()) EraseTxHash(it);
     }
 
     void ReceivedInv(NodeId peer, const GenTxid& gtxid, bool preferred,
         std::chrono::microseconds reqtime)
     {
-        // Bail out if we already have a CANDIDATE_BEST announcement for this (txhash, peer) combination. The case
-        // where there is a non-CANDIDATE_BEST announcement already will be caught by the uniqueness property of the
-        // ByPeer index when we try to emplace the new object below.
-        if (m_index.get<ByPeer>().count(ByPeerView{peer, true, gtxid.GetHash()})) return;
+        // Bail out if we already have an announcement for this (txhash, peer) combination, whatever its state.
+        auto& txhash_anns = m_txhashes.try_emplace(gtxid.GetHash()).first->second;
+        for (AnnIndex i : txhash_anns) {
+            if (m_anns[i].m_peer == peer) return;
+        }
 
-        // Try creating the announcement with CANDIDATE_DELAYED state (which will fail due to the uniqueness
-        // of the ByPeer index if a non-CANDIDATE_BEST announcement already exists with the same txhash and peer).
-        // Bail out in that case.
-        auto ret = m_index.get<ByPeer>().emplace(gtxid, peer, preferred, reqtime, m_current_sequence);
-        if (!ret.second) return;
+        // Create the announcement with CANDIDATE_DELAYED state, reusing a free slot if there is one.
+        AnnIndex i;
+        if (m_free.empty()) {
+            i = m_anns.size();
+            m_anns.emplace_back();
+        } else {
+            i = m_free.back();
+            m_free.pop_back();
+        }
+        Announcement& ann = m_anns[i];
+        ann.m_txhash = gtxid.GetHash();
+        ann.m_time = reqtime;
+        ann.m_peer = peer;
+        ann.m_priority = m_computer(gtxid.GetHash(), peer, preferred);
+        ann.m_sequence = m_current_sequence;
+        ann.m_preferred = preferred;
+        ann.m_is_wtxid = gtxid.IsWtxid();
+        ann.m_in_use = true;
+        ann.SetState(State::CANDIDATE_DELAYED);
+        txhash_anns.push_back(i);
 
         // Update accounting metadata.
-        ++m_peerinfo[peer].m_total;
+        PeerData& data = m_peers[peer];
+        ann.m_peer_pos = data.m_announcements.size();
+        data.m_announcements.push_back(i);
+        ++data.m_info.m_total;
+        ++m_size;
+        ++m_waiting;
+        ScheduleEvent(i);
         ++m_current_sequence;
     }
 
@@ -604,13 +674,11 @@ public:
         SetTimePoint(now, expired);
 
         // Find all CANDIDATE_BEST announcements for this peer.
+        auto peerit = m_peers.find(peer);
+        if (peerit == m_peers.end()) return {};
         std::vector<const Announcement*> selected;
-        auto it_peer = m_index.get<ByPeer>().lower_bound(ByPeerView{peer, true, uint256::ZERO});
-        while (it_peer != m_index.get<ByPeer>().end() && it_peer->m_peer == peer &&
-            it_peer->GetState() == State::CANDIDATE_BEST) {
-            selected.emplace_back(&*it_peer);
-            ++it_peer;
-        }
+        selected.reserve(peerit->second.m_best.size());
+        for (AnnIndex i : peerit->second.m_best) selected.push_back(&m_anns[i]);
 
         // Sort by sequence number.
         std::sort(selected.begin(), selected.end(), [](const Announcement* a, const Announcement* b) {
@@ -628,16 +696,15 @@ public:
 
     void RequestedTx(NodeId peer, const uint256& txhash, std::chrono::microseconds expiry)
     {
-        auto it = m_index.get<ByPeer>().find(ByPeerView{peer, true, txhash});
-        if (it == m_index.get<ByPeer>().end()) {
+        const auto i = Find(peer, txhash);
+        if (!i) return;
+        const State state = m_anns[*i].GetState();
+        if (state != State::CANDIDATE_BEST) {
             // There is no CANDIDATE_BEST announcement, look for a _READY or _DELAYED instead. If the caller only
             // ever invokes RequestedTx with the values returned by GetRequestable, and no other non-const functions
             // other than ForgetTxHash and GetRequestable in between, this branch will never execute (as txhashes
             // returned by GetRequestable always correspond to CANDIDATE_BEST announcements).
-
-            it = m_index.get<ByPeer>().find(ByPeerView{peer, false, txhash});
-            if (it == m_index.get<ByPeer>().end() || (it->GetState() != State::CANDIDATE_DELAYED &&
-                                                      it->GetState() != State::CANDIDATE_READY)) {
+            if (state != State::CANDIDATE_DELAYED && state != State::CANDIDATE_READY) {
                 // There is no CANDIDATE announcement tracked for this peer, so we have nothing to do. Either this
                 // txhash wasn't tracked at all (and the caller should have called ReceivedInv), or it was already
                 // requested and/or completed for other reasons and this is just a superfluous RequestedTx call.
@@ -647,63 +714,64 @@ public:
             // Look for an existing CANDIDATE_BEST or REQUESTED with the same txhash. We only need to do this if the
             // found announcement had a different state than CANDIDATE_BEST. If it did, invariants guarantee that no
             // other CANDIDATE_BEST or REQUESTED can exist.
-            auto it_old = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_BEST, 0});
-            if (it_old != m_index.get<ByTxHash>().end() && it_old->m_txhash == txhash) {
-                if (it_old->GetState() == State::CANDIDATE_BEST) {
+            if (const auto old = FindSelected(AnnouncementsFor(*i))) {
+                if (m_anns[*old].GetState() == State::CANDIDATE_BEST) {
                     // The data structure's invariants require that there can be at most one CANDIDATE_BEST or one
                     // REQUESTED announcement per txhash (but not both simultaneously), so we have to convert any
                     // existing CANDIDATE_BEST to another CANDIDATE_* when constructing another REQUESTED.
                     // It doesn't matter whether we pick CANDIDATE_READY or _DELAYED here, as SetTimePoint()
                     // will correct it at GetRequestable() time. If time only goes forward, it will always be
                     // _READY, so pick that to avoid extra work in SetTimePoint().
-                    Modify<ByTxHash>(it_old, [](Announcement& ann) { ann.SetState(State::CANDIDATE_READY); });
-                } else if (it_old->GetState() == State::REQUESTED) {
+                    SetState(*old, State::CANDIDATE_READY);
+                } else {
                     // As we're no longer waiting for a response to the previous REQUESTED announcement, convert it
                     // to COMPLETED. This also helps guaranteeing progress.
-                    Modify<ByTxHash>(it_old, [](Announcement& ann) { ann.SetState(State::COMPLETED); });
+                    SetState(*old, State::COMPLETED);
                 }
             }
         }
 
-        Modify<ByPeer>(it, [expiry](Announcement& ann) {
-            ann.SetState(State::REQUESTED);
-            ann.m_time = expiry;
-        });
+        m_anns[*i].m_time = expiry;
+        SetState(*i, State::REQUESTED);
     }
 
     void ReceivedResponse(NodeId peer, const uint256& txhash)
     {
-        // We need to search the ByPeer index for both (peer, false, txhash) and (peer, true, txhash).
-        auto it = m_index.get<ByPeer>().find(ByPeerView{peer, false, txhash});
-        if (it == m_index.get<ByPeer>().end()) {
-            it = m_index.get<ByPeer>().find(ByPeerView{peer, true, txhash});
-        }
-        if (it != m_index.get<ByPeer>().end()) MakeCompleted(m_index.project<ByTxHash>(it));
+        if (const auto i = Find(peer, txhash)) MakeCompleted(*i);
     }
 
     size_t CountInFlight(NodeId peer) const
     {
-        auto it = m_peerinfo.find(peer);
-        if (it != m_peerinfo.end()) return it->second.m_requested;
+        auto it = m_peers.find(peer);
+        if (it != m_peers.end()) return it->second.m_info.m_requested;
         return 0;
     }
 
     size_t CountCandidates(NodeId peer) const
     {
-        auto it = m_peerinfo.find(peer);
-        if (it != m_peerinfo.end()) return it->second.m_total - it->second.m_requested - it->second.m_completed;
+        auto it = m_peers.find(peer);
+        if (it != m_peers.end()) return it->second.m_info.m_total - it->second.m_info.m_requested - it->second.m_info.m_completed;
         return 0;
     }
 
     size_t Count(NodeId peer) const
     {
-        auto it = m_peerinfo.find(peer);
-        if (it != m_peerinfo.end()) return it->second.m_total;
+        auto it = m_peers.find(peer);
+        if (it != m_peers.end()) return it->second.m_info.m_total;
         return 0;
     }
 
     //! Count how many announcements are being tracked in total across all peers and transactions.
-    size_t Size() const { return m_index.size(); }
+    size_t Size() const { return m_size; }
+
+    size_t UsageByPeer(NodeId peer) const
+    {
+        auto it = m_peers.find(peer);
+        if (it == m_peers.end()) return 0;
+        // Each announcement occupies a storage slot and an entry in its txhash's list.
+        return it->second.m_info.m_total * (sizeof(Announcement) + sizeof(AnnIndex)) +
+               memusage::DynamicUsage(it->second.m_announcements) + memusage::DynamicUsage(it->second.m_best);
+    }
 
     uint64_t ComputePriority(const uint256& txhash, NodeId peer, bool preferred) const
     {
@@ -724,6 +792,7 @@ size_t TxRequestTracker::CountInFlight(NodeId peer) const { return m_impl->Count
 size_t TxRequestTracker::CountCandidates(NodeId peer) const { return m_impl->CountCandidates(peer); }
 size_t TxRequestTracker::Count(NodeId peer) const { return m_impl->Count(peer); }
 size_t TxRequestTracker::Size() const { return m_impl->Size(); }
+size_t TxRequestTracker::UsageByPeer(NodeId peer) const { return m_impl->UsageByPeer(peer); }
 void TxRequestTracker::SanityCheck() const { m_impl->SanityCheck(); }
 
 void TxRequestTracker::PostGetRequestableSanityCheck(std::chrono::microseconds now) const
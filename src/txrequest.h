@@ -90,8 +90,10 @@
  * Complexity:
  * - Memory usage is proportional to the total number of tracked announcements (Size()) plus the number of
  *   peers with a nonzero number of tracked announcements.
- * - CPU usage is generally logarithmic in the total number of tracked announcements, plus the number of
- *   announcements affected by an operation (amortized O(1) per announcement).
+ * - CPU usage is generally proportional to the number of announcements for the affected txhash (expected O(1)
+ *   hash table operations), plus the number of announcements affected by an operation. GetRequestable
+ *   additionally costs logarithmic time in the total number of tracked announcements per announcement whose
+ *   reqtime or expiry passed, and does not depend on how many announcements other peers have.
  */
 class TxRequestTracker {
     // Avoid littering this header file with implementation details.
@@ -195,6 +197,9 @@ public:
     /** Count how many announcements are being tracked in total across all peers and transaction hashes. */
     size_t Size() const;
 
+    /** Estimate the memory used to track a peer's announcements, in bytes. */
+    size_t UsageByPeer(NodeId peer) const;
+
     /** Access to the internal priority computation (testing only) */
     uint64_t ComputePriority(const uint256& txhash, NodeId peer, bool preferred) const;
 
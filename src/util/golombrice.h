@@ -5,11 +5,15 @@
 #ifndef SUPERAXECOIN_UTIL_GOLOMBRICE_H
 #define SUPERAXECOIN_UTIL_GOLOMBRICE_H
 
+#include <crypto/common.h>
+#include <span.h>
 #include <util/fastrange.h>
 
 #include <streams.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <ios>
 
 template <typename OStream>
 void GolombRiceEncode(BitStreamWriter<OStream>& bitwriter, uint8_t P, uint64_t x)
@@ -42,4 +46,76 @@ uint64_t GolombRiceDecode(BitStreamReader<IStream>& bitreader, uint8_t P)
     return (q << P) + r;
 }
 
+/**
+ * Decodes a sequence of Golomb-Rice coded values, as GolombRiceDecode on a
+ * BitStreamReader does, a machine word at a time: up to 64 bits are buffered,
+ * the unary quotient is read by counting the leading ones of the buffer and
+ * the remainder by a single shift.
+ */
+class GolombRiceDecoder
+{
+private:
+    Span<const unsigned char> m_data;
+    /// Index of the next byte of m_data to buffer
+    size_t m_pos{0};
+    /// Buffered bits, most significant first. Bits past m_count are zero.
+    uint64_t m_buffer{0};
+    /// Number of buffered bits
+    int m_count{0};
+
+    void Refill()
+    {
+        while (m_count <= 56 && m_pos < m_data.size()) {
+            m_buffer |= uint64_t{m_data[m_pos++]} << (56 - m_count);
+            m_count += 8;
+        }
+        if (m_count == 0) {
+            throw std::ios_base::failure("GolombRiceDecoder: end of data");
+        }
+    }
+
+    void Consume(int nbits)
+    {
+        m_buffer = nbits < 64 ? m_buffer << nbits : 0;
+        m_count -= nbits;
+    }
+
+public:
+    explicit GolombRiceDecoder(Span<const unsigned char> data) : m_data(data) {}
+
+    uint64_t Decode(uint8_t P)
+    {
+        // Read unary-encoded quotient: q 1's followed by one 0.
+        uint64_t q = 0;
+        while (true) {
+            Refill();
+            // The bits past m_count are zero, so this never exceeds m_count
+            // unless m_count is 64.
+            const int ones{64 - static_cast<int>(CountBits(~m_buffer))};
+            if (ones < m_count) {
+                q += ones;
+                Consume(ones + 1);
+                break;
+            }
+            q += m_count;
+            Consume(m_count);
+        }
+
+        uint64_t r = 0;
+        for (int needed = P; needed > 0;) {
+            Refill();
+            const int nbits{std::min(needed, m_count)};
+            const uint64_t bits{m_buffer >> (64 - nbits)};
+            r = nbits < 64 ? (r << nbits) | bits : bits;
+            Consume(nbits);
+            needed -= nbits;
+        }
+
+        return (q << P) + r;
+    }
+
+    /** Number of bytes a BitStreamReader would not have read yet. */
+    size_t RemainingBytes() const { return m_data.size() - m_pos + m_count / 8; }
+};
+
 #endif // SUPERAXECOIN_UTIL_GOLOMBRICE_H
@@ -0,0 +1,166 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/lz4.h>
+
+#include <crypto/common.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace util {
+namespace {
+
+//! Shortest copy that can be encoded
+constexpr size_t MIN_MATCH{4};
+//! The last bytes of the data are always literals
+constexpr size_t LAST_LITERALS{5};
+//! A copy may not start within this many bytes of the end of the data
+constexpr size_t MF_LIMIT{12};
+//! Largest distance a copy can be made from
+constexpr size_t MAX_OFFSET{65535};
+//! Length nibbles of this value are followed by more length bytes
+constexpr size_t RUN_MASK{15};
+//! Number of bits of the hash of 4 bytes that index the match table
+constexpr int HASH_LOG{14};
+//! After this many positions without a match the step grows, so that data
+//! that does not compress is skipped quickly
+constexpr int SKIP_TRIGGER{6};
+
+uint32_t HashSequence(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+void WriteLength(std::vector<std::byte>& out, size_t length)
+{
+    for (; length >= 255; length -= 255) out.push_back(std::byte{255});
+    out.push_back(std::byte(length));
+}
+
+/** Write literals, followed by a copy unless they are the last ones. */
+void WriteSequence(std::vector<std::byte>& out, Span<const std::byte> literals, size_t offset = 0, size_t match_length = 0)
+{
+    const size_t match_code{match_length ? match_length - MIN_MATCH : 0};
+    out.push_back(std::byte(std::min(literals.size(), RUN_MASK) << 4 | std::min(match_code, RUN_MASK)));
+    if (literals.size() >= RUN_MASK) WriteLength(out, literals.size() - RUN_MASK);
+    out.insert(out.end(), literals.begin(), literals.end());
+    if (match_length == 0) return;
+    out.push_back(std::byte(offset & 0xff));
+    out.push_back(std::byte(offset >> 8));
+    if (match_code >= RUN_MASK) WriteLength(out, match_code - RUN_MASK);
+}
+
+/** Read the remainder of a length whose nibble was RUN_MASK. */
+bool ReadLength(Span<const std::byte> in, size_t& pos, size_t& length)
+{
+    uint8_t byte;
+    do {
+        if (pos == in.size()) return false;
+        byte = uint8_t(in[pos++]);
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool Decompress(Span<const std::byte> in, Span<std::byte> out, bool prefix)
+{
+    size_t in_pos{0};
+    size_t out_pos{0};
+    while (in_pos < in.size()) {
+        const uint8_t token{uint8_t(in[in_pos++])};
+
+        size_t literals{size_t{token} >> 4};
+        if (literals == RUN_MASK && !ReadLength(in, in_pos, literals)) return false;
+        if (literals > in.size() - in_pos) return false;
+        if (literals > out.size() - out_pos) {
+            if (!prefix) return false;
+            literals = out.size() - out_pos;
+        }
+        if (literals) std::memcpy(out.data() + out_pos, in.data() + in_pos, literals);
+        in_pos += literals;
+        out_pos += literals;
+        if (prefix && out_pos == out.size()) return true;
+
+        // The last sequence has no copy
+        if (in_pos == in.size()) return out_pos == out.size();
+
+        if (in.size() - in_pos < 2) return false;
+        const size_t offset{size_t(in[in_pos]) | size_t(in[in_pos + 1]) << 8};
+        in_pos += 2;
+        if (offset == 0 || offset > out_pos) return false;
+        size_t length{size_t{token} & RUN_MASK};
+        if (length == RUN_MASK && !ReadLength(in, in_pos, length)) return false;
+        length += MIN_MATCH;
+        if (length > out.size() - out_pos) {
+            if (!prefix) return false;
+            length = out.size() - out_pos;
+        }
+        std::byte* dst{out.data() + out_pos};
+        const std::byte* src{dst - offset};
+        if (offset >= length) {
+            std::memcpy(dst, src, length);
+        } else {
+            // Overlapping copies repeat the last `offset` bytes
+            for (size_t i = 0; i < length; ++i) dst[i] = src[i];
+        }
+        out_pos += length;
+        if (prefix && out_pos == out.size()) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void LZ4Compress(Span<const std::byte> in, std::vector<std::byte>& out)
+{
+    out.reserve(out.size() + LZ4CompressBound(in.size()));
+    const unsigned char* data{UCharCast(in.data())};
+    size_t anchor{0};
+    if (in.size() > MF_LIMIT) {
+        const size_t match_limit{in.size() - LAST_LITERALS};
+        const size_t search_limit{in.size() - MF_LIMIT};
+        // Last position of each hash of 4 bytes. Positions are stored in 32
+        // bits, which is plenty for the sizes this is used on.
+        std::vector<uint32_t> table(size_t{1} << HASH_LOG);
+        size_t pos{0};
+        size_t misses{0};
+        while (pos < search_limit) {
+            const uint32_t sequence{ReadLE32(data + pos)};
+            uint32_t& entry{table[HashSequence(sequence)]};
+            size_t candidate{entry};
+            entry = pos;
+            if (candidate >= pos || pos - candidate > MAX_OFFSET || ReadLE32(data + candidate) != sequence) {
+                pos += 1 + (misses++ >> SKIP_TRIGGER);
+                continue;
+            }
+            size_t length{MIN_MATCH};
+            while (pos + length < match_limit && data[candidate + length] == data[pos + length]) ++length;
+            // The match may extend back over the literals before it
+            while (pos > anchor && candidate > 0 && data[pos - 1] == data[candidate - 1]) {
+                --pos;
+                --candidate;
+                ++length;
+            }
+            WriteSequence(out, in.subspan(anchor, pos - anchor), pos - candidate, length);
+            pos += length;
+            anchor = pos;
+            misses = 0;
+        }
+    }
+    WriteSequence(out, in.subspan(anchor));
+}
+
+bool LZ4Decompress(Span<const std::byte> in, Span<std::byte> out)
+{
+    return Decompress(in, out, /*prefix=*/false);
+}
+
+bool LZ4DecompressPrefix(Span<const std::byte> in, Span<std::byte> out)
+{
+    return Decompress(in, out, /*prefix=*/true);
+}
+
+} // namespace util
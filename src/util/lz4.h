@@ -0,0 +1,44 @@
+// Copyright (c) 2024 The SuperAxeCoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SUPERAXECOIN_UTIL_LZ4_H
+#define SUPERAXECOIN_UTIL_LZ4_H
+
+#include <span.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Compression in the LZ4 block format
+ * (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+ *
+ * The data is split in sequences of literal bytes, each followed by a copy of
+ * at least 4 bytes from up to 64 KiB back in the output. Decoding is a loop of
+ * memory copies, which makes it fast enough to be done on every read.
+ */
+namespace util {
+
+/** Upper bound of the compressed size of `size` bytes. */
+constexpr size_t LZ4CompressBound(size_t size) { return size + size / 255 + 16; }
+
+/** Compress data, appending the result to `out`. */
+void LZ4Compress(Span<const std::byte> in, std::vector<std::byte>& out);
+
+/**
+ * Decompress data into `out`, which must have the exact decompressed size.
+ * Returns false if the data is malformed or does not decompress to that size.
+ */
+[[nodiscard]] bool LZ4Decompress(Span<const std::byte> in, Span<std::byte> out);
+
+/**
+ * Decompress the first `out.size()` bytes of data, skipping the work of
+ * decompressing the rest. Returns false if the data is malformed up to there,
+ * or decompresses to fewer bytes.
+ */
+[[nodiscard]] bool LZ4DecompressPrefix(Span<const std::byte> in, Span<std::byte> out);
+
+} // namespace util
+
+#endif // SUPERAXECOIN_UTIL_LZ4_H
@@ -11,14 +11,26 @@
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <memory>
 #include <stdexcept>
 #include <string>
 
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+
 #ifdef USE_POLL
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
 static inline bool IOErrorIsPermanent(int err)
 {
     return err != WSAEAGAIN && err != WSAEINTR && err != WSAEWOULDBLOCK && err != WSAEINPROGRESS;
@@ -47,6 +59,30 @@ ssize_t Sock::Send(const void* data, size_t len, int flags) const
     return send(m_socket, static_cast<const char*>(data), len, flags);
 }
 
+ssize_t Sock::SendMany(Span<const Span<const unsigned char>> bufs, int flags) const
+{
+#ifdef WIN32
+    for (const auto& buf : bufs) {
+        if (!buf.empty()) return Send(buf.data(), buf.size(), flags);
+    }
+    return 0;
+#else
+    std::array<iovec, MAX_SEND_MANY_BUFFERS> iov;
+    size_t count{0};
+    for (const auto& buf : bufs) {
+        if (buf.empty()) continue;
+        if (count == iov.size()) break;
+        iov[count].iov_base = const_cast<unsigned char*>(buf.data());
+        iov[count].iov_len = buf.size();
+        ++count;
+    }
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+    return sendmsg(m_socket, &msg, flags);
+#endif
+}
+
 ssize_t Sock::Recv(void* buf, size_t len, int flags) const
 {
     return recv(m_socket, static_cast<char*>(buf), len, flags);
@@ -242,6 +278,141 @@ bool Sock::WaitMany(std::chrono::milliseconds timeout, EventsPerSock& events_per
 #endif /* USE_POLL */
 }
 
+std::optional<SockEventsMode> SockEventsModeFromString(const std::string& str)
+{
+    if (str == "poll") return SockEventsMode::POLL;
+#ifdef USE_EPOLL
+    if (str == "epoll") return SockEventsMode::EPOLL;
+#endif
+    return std::nullopt;
+}
+
+std::string SockEventsModeToString(SockEventsMode mode)
+{
+    switch (mode) {
+    case SockEventsMode::POLL: return "poll";
+    case SockEventsMode::EPOLL: return "epoll";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
+#ifdef USE_EPOLL
+static uint32_t EpollEventsFromRequested(Sock::Event requested)
+{
+    uint32_t ev{0};
+    if (requested & Sock::RECV) {
+        ev |= EPOLLIN;
+    }
+    if (requested & Sock::SEND) {
+        ev |= EPOLLOUT;
+    }
+    return ev;
+}
+
+SockEpoll::SockEpoll() : m_epoll_fd{epoll_create1(EPOLL_CLOEXEC)}
+{
+    if (m_epoll_fd == -1) {
+        LogPrintf("Error creating epoll instance: %s\n", NetworkErrorString(WSAGetLastError()));
+    }
+}
+
+SockEpoll::~SockEpoll()
+{
+    if (m_epoll_fd != -1) {
+        close(m_epoll_fd);
+    }
+}
+
+bool SockEpoll::Update(const std::shared_ptr<const Sock>& sock, Sock::Events& events)
+{
+    const SOCKET fd{sock->m_socket};
+    epoll_event ev{};
+    ev.events = EpollEventsFromRequested(events.requested);
+    ev.data.fd = fd;
+
+    auto [it, inserted] = m_registrations.try_emplace(fd);
+    Registration& reg{it->second};
+    // The descriptor of a closed socket is removed from the epoll set by the
+    // kernel and may be reused by a new socket, which must be added again.
+    const bool same_sock{!inserted && !reg.sock.owner_before(sock) && !sock.owner_before(reg.sock)};
+    if (!same_sock) {
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0 &&
+            (errno != EEXIST || epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev) != 0)) {
+            m_registrations.erase(it);
+            return false;
+        }
+        reg.sock = sock;
+    } else if (reg.requested != events.requested) {
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev) != 0 &&
+            (errno != ENOENT || epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)) {
+            m_registrations.erase(it);
+            return false;
+        }
+    }
+    reg.requested = events.requested;
+    reg.current = &events;
+    reg.round = m_round;
+    return true;
+}
+
+bool SockEpoll::WaitMany(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock)
+{
+    if (m_epoll_fd == -1) {
+        return false;
+    }
+
+    ++m_round;
+    size_t num_waited{0};
+    for (auto& [sock, events] : events_per_sock) {
+        events.occurred = 0;
+        if (Update(sock, events)) {
+            ++num_waited;
+        } else {
+            // Like POLLNVAL from poll(2): let the caller find out what is wrong
+            // with the socket by using it.
+            events.occurred = Sock::ERR;
+        }
+    }
+    // Unregister the sockets that are no longer waited on, if there are any.
+    for (auto it = m_registrations.begin(); num_waited < m_registrations.size() && it != m_registrations.end();) {
+        if (it->second.round == m_round) {
+            ++it;
+            continue;
+        }
+        // An expired socket was closed, which already removed it from the epoll set.
+        if (!it->second.sock.expired()) {
+            (void)epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->first, nullptr);
+        }
+        it = m_registrations.erase(it);
+    }
+
+    m_ready.resize(std::max<size_t>(m_registrations.size(), 1));
+    const int num_ready{epoll_wait(m_epoll_fd, m_ready.data(), m_ready.size(), count_milliseconds(timeout))};
+    if (num_ready == SOCKET_ERROR) {
+        return false;
+    }
+
+    for (int i = 0; i < num_ready; ++i) {
+        const auto it{m_registrations.find(m_ready[i].data.fd)};
+        if (it == m_registrations.end() || it->second.round != m_round) {
+            continue;
+        }
+        Sock::Events& events{*it->second.current};
+        if (m_ready[i].events & EPOLLIN) {
+            events.occurred |= Sock::RECV;
+        }
+        if (m_ready[i].events & EPOLLOUT) {
+            events.occurred |= Sock::SEND;
+        }
+        if (m_ready[i].events & (EPOLLERR | EPOLLHUP)) {
+            events.occurred |= Sock::ERR;
+        }
+    }
+
+    return true;
+}
+#endif // USE_EPOLL
+
 void Sock::SendComplete(const std::string& data,
                         std::chrono::milliseconds timeout,
                         CThreadInterrupt& interrupt) const
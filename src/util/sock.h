@@ -6,13 +6,20 @@
 #define SUPERAXECOIN_UTIL_SOCK_H
 
 #include <compat/compat.h>
+#include <span.h>
 #include <util/threadinterrupt.h>
 #include <util/time.h>
 
 #include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 /**
  * Maximum time to wait for I/O readiness.
@@ -64,6 +71,20 @@ public:
      */
     [[nodiscard]] virtual ssize_t Send(const void* data, size_t len, int flags) const;
 
+    /**
+     * Maximum number of buffers passed to a single SendMany() call; any further ones are left
+     * unsent, as if by a short write.
+     */
+    static constexpr size_t MAX_SEND_MANY_BUFFERS{16};
+
+    /**
+     * sendmsg(2) wrapper. Sends the concatenation of bufs with a single scatter-gather write,
+     * with the same return value and flags semantics as Send(). Where sendmsg(2) is not
+     * available, only the first non-empty buffer is sent. Code that uses this wrapper can be
+     * unit tested if this method is overridden by a mock Sock implementation.
+     */
+    [[nodiscard]] virtual ssize_t SendMany(Span<const Span<const unsigned char>> bufs, int flags) const;
+
     /**
      * recv(2) wrapper. Equivalent to `recv(m_socket, buf, len, flags);`. Code that uses this
      * wrapper can be unit tested if this method is overridden by a mock Sock implementation.
@@ -262,6 +283,8 @@ public:
     bool operator==(SOCKET s) const;
 
 protected:
+    friend class SockEpoll;
+
     /**
      * Contained socket. `INVALID_SOCKET` designates the object is empty.
      */
@@ -274,6 +297,87 @@ private:
     void Close();
 };
 
+/**
+ * How to wait for readiness of many sockets (CConnman's socket handler loop).
+ */
+enum class SockEventsMode {
+    /** Sock::WaitMany(): poll(2), or select(2) where poll(2) is not used. */
+    POLL,
+    /** SockEpoll: epoll(7) with registrations kept across calls. */
+    EPOLL,
+};
+
+#ifdef USE_EPOLL
+static constexpr SockEventsMode DEFAULT_SOCK_EVENTS_MODE{SockEventsMode::EPOLL};
+#else
+static constexpr SockEventsMode DEFAULT_SOCK_EVENTS_MODE{SockEventsMode::POLL};
+#endif
+
+/** Parse "poll" or "epoll". Returns std::nullopt for unknown or unavailable modes. */
+std::optional<SockEventsMode> SockEventsModeFromString(const std::string& str);
+std::string SockEventsModeToString(SockEventsMode mode);
+
+#ifdef USE_EPOLL
+/**
+ * Wait for readiness of many sockets using epoll(7).
+ *
+ * Sock::WaitMany() hands every socket to the kernel on each call, which costs
+ * O(sockets) per wakeup even if almost all of them are idle. This class keeps
+ * the sockets registered between calls and only updates the kernel for sockets
+ * that were added or removed, or whose requested events changed. The kernel
+ * then only reports the sockets that are ready.
+ *
+ * Readiness is level-triggered, so the results are the same as
+ * Sock::WaitMany(): a socket with unread data is reported again on the next
+ * call even if the caller did not drain it.
+ *
+ * Not thread-safe.
+ */
+class SockEpoll
+{
+public:
+    SockEpoll();
+    ~SockEpoll();
+
+    SockEpoll(const SockEpoll&) = delete;
+    SockEpoll& operator=(const SockEpoll&) = delete;
+
+    /** Whether the epoll instance was created. If not, WaitMany() always fails. */
+    bool IsValid() const { return m_epoll_fd != -1; }
+
+    /**
+     * Same as Sock::WaitMany(). Sockets that were passed to a previous call
+     * but are missing from `events_per_sock` are unregistered.
+     * @return true on success (even if no sockets are ready) and false on error
+     */
+    [[nodiscard]] bool WaitMany(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock);
+
+    /** Number of sockets currently registered with the kernel. */
+    size_t RegisteredCount() const { return m_registrations.size(); }
+
+private:
+    struct Registration {
+        /** The registered socket. Used to detect a closed socket whose descriptor was reused. */
+        std::weak_ptr<const Sock> sock;
+        /** Events the kernel is asked to report. */
+        Sock::Event requested{0};
+        /** Where to report events, valid if `round` is the current call's. */
+        Sock::Events* current{nullptr};
+        /** The last WaitMany() call that waited on this socket. */
+        uint64_t round{0};
+    };
+
+    /** Register or update `sock`, returning false if the kernel refused it. */
+    bool Update(const std::shared_ptr<const Sock>& sock, Sock::Events& events);
+
+    int m_epoll_fd{-1};
+    /** Number of WaitMany() calls so far. */
+    uint64_t m_round{0};
+    std::unordered_map<SOCKET, Registration> m_registrations;
+    std::vector<epoll_event> m_ready;
+};
+#endif // USE_EPOLL
+
 /** Return readable error string for a network error code */
 std::string NetworkErrorString(int err);
 
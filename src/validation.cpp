@@ -55,6 +55,7 @@
 #include <util/rbf.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/thread.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
@@ -64,7 +65,10 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <limits>
+#include <map>
 #include <numeric>
 #include <optional>
 #include <string>
@@ -82,6 +86,7 @@ using node::BlockMap;
 using node::CBlockIndexHeightOnlyComparator;
 using node::CBlockIndexWorkComparator;
 using node::fReindex;
+using node::ReadSnapshotCoins;
 using node::SnapshotMetadata;
 
 /** Time to wait between writing blocks/block index to disk. */
@@ -4625,6 +4630,72 @@ bool Chainstate::LoadGenesisBlock()
     return true;
 }
 
+/**
+ * Locate the next {magic, size} marker of a block in a block file, resuming the scan at `rewind`,
+ * which is moved past the start of the marker. Returns false at the end of the file.
+ */
+static bool FindExternalBlock(BufferedFile& blkdat, const MessageStartChars& message_start, uint64_t& rewind,
+                              unsigned int& size, bool& compressed)
+{
+    while (!blkdat.eof()) {
+        blkdat.SetPos(rewind);
+        rewind++; // start one byte further next time, in case of failure
+        blkdat.SetLimit(); // remove former limit
+        try {
+            // locate a header
+            MessageStartChars buf;
+            blkdat.FindByte(std::byte(message_start[0]));
+            rewind = blkdat.GetPos() + 1;
+            blkdat >> buf;
+            if (buf != message_start) {
+                continue;
+            }
+            // read size
+            blkdat >> size;
+            compressed = (size & node::BLOCK_COMPRESSED_FLAG) != 0;
+            size &= ~node::BLOCK_COMPRESSED_FLAG;
+            if (size < (compressed ? sizeof(uint32_t) : 80) || size > MAX_BLOCK_SERIALIZED_SIZE)
+                continue;
+        } catch (const std::exception&) {
+            // no valid block header found; don't complain
+            // (this happens at the end of every blk.dat file)
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Read the header of the block at the position of `blkdat`. Only the header of a compressed block
+ * is decompressed, its data is kept in `compressed_data` in case the block is needed.
+ */
+static CBlockHeader ReadExternalBlockHeader(BufferedFile& blkdat, unsigned int size, bool compressed,
+                                            std::vector<std::byte>& compressed_data)
+{
+    CBlockHeader header;
+    if (compressed) {
+        compressed_data.resize(size);
+        blkdat.read(compressed_data);
+        if (!node::DecompressBlockHeader(compressed_data, header)) {
+            throw std::ios_base::failure("invalid compressed block data");
+        }
+    } else {
+        blkdat >> header;
+    }
+    return header;
+}
+
+/** Decompress and deserialize a block read by ReadExternalBlockHeader. */
+static void ReadCompressedBlock(Span<const std::byte> compressed_data, CBlock& block)
+{
+    std::vector<uint8_t> block_data;
+    if (!node::DecompressBlockData(compressed_data, block_data)) {
+        throw std::ios_base::failure("invalid compressed block data");
+    }
+    SpanReader{CLIENT_VERSION, block_data} >> block;
+}
+
 void ChainstateManager::LoadExternalBlockFile(
     CAutoFile& file_in,
     FlatFilePos* dbp,
@@ -4642,145 +4713,38 @@ void ChainstateManager::LoadExternalBlockFile(
         // nRewind indicates where to resume scanning in case something goes wrong,
         // such as a block fails to deserialize.
         uint64_t nRewind = blkdat.GetPos();
-        while (!blkdat.eof()) {
+        unsigned int nSize = 0;
+        bool compressed{false};
+        while (FindExternalBlock(blkdat, params.MessageStart(), nRewind, nSize, compressed)) {
             if (m_interrupt) return;
 
-            blkdat.SetPos(nRewind);
-            nRewind++; // start one byte further next time, in case of failure
-            blkdat.SetLimit(); // remove former limit
-            unsigned int nSize = 0;
-            try {
-                // locate a header
-                MessageStartChars buf;
-                blkdat.FindByte(std::byte(params.MessageStart()[0]));
-                nRewind = blkdat.GetPos() + 1;
-                blkdat >> buf;
-                if (buf != params.MessageStart()) {
-                    continue;
-                }
-                // read size
-                blkdat >> nSize;
-                if (nSize < 80 || nSize > MAX_BLOCK_SERIALIZED_SIZE)
-                    continue;
-            } catch (const std::exception&) {
-                // no valid block header found; don't complain
-                // (this happens at the end of every blk.dat file)
-                break;
-            }
             try {
                 // read block header
                 const uint64_t nBlockPos{blkdat.GetPos()};
                 if (dbp)
                     dbp->nPos = nBlockPos;
                 blkdat.SetLimit(nBlockPos + nSize);
-                CBlockHeader header;
-                blkdat >> header;
-                const uint256 hash{header.GetHash()};
+                std::vector<std::byte> compressed_data;
+                const CBlockHeader header{ReadExternalBlockHeader(blkdat, nSize, compressed, compressed_data)};
                 // Skip the rest of this block (this may read from disk into memory); position to the marker before the
                 // next block, but it's still possible to rewind to the start of the current block (without a disk read).
                 nRewind = nBlockPos + nSize;
                 blkdat.SkipTo(nRewind);
 
-                std::shared_ptr<CBlock> pblock{}; // needs to remain available after the cs_main lock is released to avoid duplicate reads from disk
-
-                {
-                    LOCK(cs_main);
-                    // detect out of order blocks, and store them for later
-                    if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(header.hashPrevBlock)) {
-                        LogPrint(BCLog::REINDEX, "%s: Out of order block %s, parent %s not known\n", __func__, hash.ToString(),
-                                 header.hashPrevBlock.ToString());
-                        if (dbp && blocks_with_unknown_parent) {
-                            blocks_with_unknown_parent->emplace(header.hashPrevBlock, *dbp);
-                        }
-                        continue;
-                    }
-
-                    // process in case the block isn't known yet
-                    const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
-                    if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
-                        // This block can be processed immediately; rewind to its start, read and deserialize it.
+                const auto read_block{[&] {
+                    // This block can be processed immediately; rewind to its start, read and deserialize it.
+                    auto pblock{std::make_shared<CBlock>()};
+                    if (compressed) {
+                        ReadCompressedBlock(compressed_data, *pblock);
+                    } else {
                         blkdat.SetPos(nBlockPos);
-                        pblock = std::make_shared<CBlock>();
                         blkdat >> *pblock;
                         nRewind = blkdat.GetPos();
-
-                        BlockValidationState state;
-                        if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
-                            nLoaded++;
-                        }
-                        if (state.IsError()) {
-                            break;
-                        }
-                    } else if (hash != params.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
-                        LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
-                    }
-                }
-
-                // Activate the genesis block so normal node progress can continue
-                if (hash == params.GetConsensus().hashGenesisBlock) {
-                    bool genesis_activation_failure = false;
-                    for (auto c : GetAll()) {
-                        BlockValidationState state;
-                        if (!c->ActivateBestChain(state, nullptr)) {
-                            genesis_activation_failure = true;
-                            break;
-                        }
-                    }
-                    if (genesis_activation_failure) {
-                        break;
-                    }
-                }
-
-                if (m_blockman.IsPruneMode() && !fReindex && pblock) {
-                    // must update the tip for pruning to work while importing with -loadblock.
-                    // this is a tradeoff to conserve disk space at the expense of time
-                    // spent updating the tip to be able to prune.
-                    // otherwise, ActivateBestChain won't be called by the import process
-                    // until after all of the block files are loaded. ActivateBestChain can be
-                    // called by concurrent network message processing. but, that is not
-                    // reliable for the purpose of pruning while importing.
-                    bool activation_failure = false;
-                    for (auto c : GetAll()) {
-                        BlockValidationState state;
-                        if (!c->ActivateBestChain(state, pblock)) {
-                            LogPrint(BCLog::REINDEX, "failed to activate chain (%s)\n", state.ToString());
-                            activation_failure = true;
-                            break;
-                        }
-                    }
-                    if (activation_failure) {
-                        break;
-                    }
-                }
-
-                NotifyHeaderTip(*this);
-
-                if (!blocks_with_unknown_parent) continue;
-
-                // Recursively process earlier encountered successors of this block
-                std::deque<uint256> queue;
-                queue.push_back(hash);
-                while (!queue.empty()) {
-                    uint256 head = queue.front();
-                    queue.pop_front();
-                    auto range = blocks_with_unknown_parent->equal_range(head);
-                    while (range.first != range.second) {
-                        std::multimap<uint256, FlatFilePos>::iterator it = range.first;
-                        std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
-                        if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second)) {
-                            LogPrint(BCLog::REINDEX, "%s: Processing out of order child %s of %s\n", __func__, pblockrecursive->GetHash().ToString(),
-                                    head.ToString());
-                            LOCK(cs_main);
-                            BlockValidationState dummy;
-                            if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
-                                nLoaded++;
-                                queue.push_back(pblockrecursive->GetHash());
-                            }
-                        }
-                        range.first++;
-                        blocks_with_unknown_parent->erase(it);
-                        NotifyHeaderTip(*this);
                     }
+                    return pblock;
+                }};
+                if (!LoadExternalBlock(header, read_block, dbp, blocks_with_unknown_parent, nLoaded)) {
+                    break;
                 }
             } catch (const std::exception& e) {
                 // historical bugs added extra data to the block files that does not deserialize cleanly.
@@ -4803,6 +4767,364 @@ void ChainstateManager::LoadExternalBlockFile(
     LogPrintf("Loaded %i blocks from external file in %dms\n", nLoaded, Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
 }
 
+bool ChainstateManager::LoadExternalBlock(
+    const CBlockHeader& header,
+    const std::function<std::shared_ptr<CBlock>()>& read_block,
+    FlatFilePos* dbp,
+    std::multimap<uint256, FlatFilePos>* blocks_with_unknown_parent,
+    int& loaded)
+{
+    const CChainParams& params{GetParams()};
+    const uint256 hash{header.GetHash()};
+
+    std::shared_ptr<CBlock> pblock{}; // needs to remain available after the cs_main lock is released to avoid duplicate reads from disk
+
+    {
+        LOCK(cs_main);
+        // detect out of order blocks, and store them for later
+        if (hash != params.GetConsensus().hashGenesisBlock && !m_blockman.LookupBlockIndex(header.hashPrevBlock)) {
+            LogPrint(BCLog::REINDEX, "LoadExternalBlockFile: Out of order block %s, parent %s not known\n", hash.ToString(),
+                     header.hashPrevBlock.ToString());
+            if (dbp && blocks_with_unknown_parent) {
+                blocks_with_unknown_parent->emplace(header.hashPrevBlock, *dbp);
+            }
+            return true;
+        }
+
+        // process in case the block isn't known yet
+        const CBlockIndex* pindex = m_blockman.LookupBlockIndex(hash);
+        if (!pindex || (pindex->nStatus & BLOCK_HAVE_DATA) == 0) {
+            pblock = read_block();
+
+            BlockValidationState state;
+            if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
+                loaded++;
+            }
+            if (state.IsError()) {
+                return false;
+            }
+        } else if (hash != params.GetConsensus().hashGenesisBlock && pindex->nHeight % 1000 == 0) {
+            LogPrint(BCLog::REINDEX, "Block Import: already had block %s at height %d\n", hash.ToString(), pindex->nHeight);
+        }
+    }
+
+    // Activate the genesis block so normal node progress can continue
+    if (hash == params.GetConsensus().hashGenesisBlock) {
+        for (auto c : GetAll()) {
+            BlockValidationState state;
+            if (!c->ActivateBestChain(state, nullptr)) {
+                return false;
+            }
+        }
+    }
+
+    if (m_blockman.IsPruneMode() && !fReindex && pblock) {
+        // must update the tip for pruning to work while importing with -loadblock.
+        // this is a tradeoff to conserve disk space at the expense of time
+        // spent updating the tip to be able to prune.
+        // otherwise, ActivateBestChain won't be called by the import process
+        // until after all of the block files are loaded. ActivateBestChain can be
+        // called by concurrent network message processing. but, that is not
+        // reliable for the purpose of pruning while importing.
+        for (auto c : GetAll()) {
+            BlockValidationState state;
+            if (!c->ActivateBestChain(state, pblock)) {
+                LogPrint(BCLog::REINDEX, "failed to activate chain (%s)\n", state.ToString());
+                return false;
+            }
+        }
+    }
+
+    NotifyHeaderTip(*this);
+
+    if (!blocks_with_unknown_parent) return true;
+
+    // Recursively process earlier encountered successors of this block
+    std::deque<uint256> queue;
+    queue.push_back(hash);
+    while (!queue.empty()) {
+        uint256 head = queue.front();
+        queue.pop_front();
+        auto range = blocks_with_unknown_parent->equal_range(head);
+        while (range.first != range.second) {
+            std::multimap<uint256, FlatFilePos>::iterator it = range.first;
+            std::shared_ptr<CBlock> pblockrecursive = std::make_shared<CBlock>();
+            if (m_blockman.ReadBlockFromDisk(*pblockrecursive, it->second)) {
+                LogPrint(BCLog::REINDEX, "LoadExternalBlockFile: Processing out of order child %s of %s\n", pblockrecursive->GetHash().ToString(),
+                        head.ToString());
+                LOCK(cs_main);
+                BlockValidationState dummy;
+                if (AcceptBlock(pblockrecursive, dummy, nullptr, true, &it->second, nullptr, true)) {
+                    loaded++;
+                    queue.push_back(pblockrecursive->GetHash());
+                }
+            }
+            range.first++;
+            blocks_with_unknown_parent->erase(it);
+            NotifyHeaderTip(*this);
+        }
+    }
+    return true;
+}
+
+namespace {
+/** A block found in a block file by a BlockFileScanner. */
+struct ScannedBlock {
+    FlatFilePos pos;
+    unsigned int size;
+    bool compressed;
+    CBlockHeader header;
+    //! The block as stored, until it is deserialized
+    std::vector<std::byte> data;
+    //! The block, on which CheckBlock has been run, or null if it did not deserialize
+    std::shared_ptr<CBlock> block;
+    //! Why the block did not deserialize
+    std::string error;
+    bool checked{false};
+};
+
+/**
+ * Scans the block files for ChainstateManager::LoadBlockFiles. Workers find the blocks of up to
+ * as many files ahead of the one being loaded as there are of them, a file at a time each, and
+ * deserialize and run CheckBlock on the blocks found, so that AcceptBlock does not have to. The
+ * file being loaded goes first, so that all workers help with it once the files ahead of it have
+ * as many blocks waiting as they may hold.
+ */
+class BlockFileScanner
+{
+    //! Blocks of a file held at most, in stored bytes, before no more of it is scanned
+    static constexpr size_t MAX_PENDING_BYTES{16 << 20};
+    //! Blocks found at a time by a worker, in stored bytes
+    static constexpr size_t SCAN_BATCH_BYTES{1 << 20};
+
+    struct File {
+        CAutoFile file;
+        BufferedFile blkdat;
+        //! Where to resume scanning, as in LoadExternalBlockFile
+        uint64_t rewind;
+        std::deque<ScannedBlock> blocks;
+        //! Index of the first block no worker has started to check
+        size_t next_check{0};
+        size_t pending_bytes{0};
+        bool scanning{false};
+        bool done{false};
+
+        explicit File(std::FILE* f)
+            : file{f, CLIENT_VERSION},
+              blkdat{file, 2 * MAX_BLOCK_SERIALIZED_SIZE, MAX_BLOCK_SERIALIZED_SIZE + 8},
+              rewind{blkdat.GetPos()} {}
+    };
+
+    node::BlockManager& m_blockman;
+    const CChainParams& m_params;
+    const int m_num_threads;
+    Mutex m_mutex;
+    //! Workers wait on this for work
+    std::condition_variable m_work_cv;
+    //! LoadBlockFiles waits on this for the blocks of the file it loads
+    std::condition_variable m_done_cv;
+    //! The files being scanned or waiting to be loaded, by number
+    std::map<int, File> m_files GUARDED_BY(m_mutex);
+    int m_loading_file GUARDED_BY(m_mutex){0};
+    int m_next_file GUARDED_BY(m_mutex){0};
+    //! Number of the first file that does not exist
+    int m_end_file GUARDED_BY(m_mutex){std::numeric_limits<int>::max()};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_workers;
+
+    /** Find the blocks of a file from where its scan was left, returns true at its end. */
+    bool Scan(int file_num, File& f, std::vector<ScannedBlock>& found) const
+    {
+        size_t found_bytes{0};
+        unsigned int size{0};
+        bool compressed{false};
+        while (found_bytes < SCAN_BATCH_BYTES) {
+            if (!FindExternalBlock(f.blkdat, m_params.MessageStart(), f.rewind, size, compressed)) return true;
+            ScannedBlock scanned{.pos{file_num, static_cast<unsigned int>(f.blkdat.GetPos())}, .size = size, .compressed = compressed};
+            f.blkdat.SetLimit(scanned.pos.nPos + size);
+            try {
+                scanned.data.resize(size);
+                f.blkdat.read(scanned.data);
+                if (compressed) {
+                    if (!node::DecompressBlockHeader(scanned.data, scanned.header)) {
+                        throw std::ios_base::failure("invalid compressed block data");
+                    }
+                } else {
+                    SpanReader{CLIENT_VERSION, MakeUCharSpan(scanned.data)} >> scanned.header;
+                }
+            } catch (const std::exception& e) {
+                LogPrint(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, (f.rewind - 1), e.what());
+                continue;
+            }
+            f.rewind = scanned.pos.nPos + size;
+            found_bytes += size;
+            found.push_back(std::move(scanned));
+        }
+        return false;
+    }
+
+    void Check(ScannedBlock& scanned) const
+    {
+        try {
+            auto block{std::make_shared<CBlock>()};
+            if (scanned.compressed) {
+                ReadCompressedBlock(scanned.data, *block);
+            } else {
+                SpanReader{CLIENT_VERSION, MakeUCharSpan(scanned.data)} >> *block;
+            }
+            BlockValidationState state;
+            CheckBlock(*block, state, m_params.GetConsensus());
+            scanned.block = std::move(block);
+        } catch (const std::exception& e) {
+            // Only reported if the block turns out to be needed
+            scanned.error = e.what();
+        }
+        scanned.data = {};
+    }
+
+    void ThreadScan() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            int file_num{-1};
+            File* file{nullptr};
+            ScannedBlock* to_check{nullptr};
+            {
+                WAIT_LOCK(m_mutex, lock);
+                // Check the blocks of the earliest file that has some left, or find more of them
+                const auto find_work{[&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                    for (auto& [num, f] : m_files) {
+                        if (f.next_check < f.blocks.size()) {
+                            to_check = &f.blocks[f.next_check++];
+                            return true;
+                        }
+                        if (!f.done && !f.scanning && f.pending_bytes < MAX_PENDING_BYTES) {
+                            f.scanning = true;
+                            file_num = num;
+                            file = &f;
+                            return true;
+                        }
+                    }
+                    if (m_next_file < m_end_file && m_next_file < m_loading_file + m_num_threads) {
+                        file_num = m_next_file++;
+                        return true;
+                    }
+                    return false;
+                }};
+                m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || find_work(); });
+                if (m_stop) return;
+            }
+
+            if (to_check) {
+                Check(*to_check);
+                LOCK(m_mutex);
+                to_check->checked = true;
+                m_done_cv.notify_all();
+            } else if (file) {
+                std::vector<ScannedBlock> found;
+                bool done{true};
+                try {
+                    done = Scan(file_num, *file, found);
+                } catch (const std::runtime_error& e) {
+                    LogPrintf("%s: Failed to scan block file blk%05u.dat: %s\n", __func__, (unsigned int)file_num, e.what());
+                }
+                LOCK(m_mutex);
+                for (auto& scanned : found) {
+                    file->pending_bytes += scanned.size;
+                    file->blocks.push_back(std::move(scanned));
+                }
+                file->scanning = false;
+                file->done = done;
+                m_work_cv.notify_all();
+                m_done_cv.notify_all();
+            } else {
+                const FlatFilePos pos{file_num, 0};
+                std::FILE* f{fs::exists(m_blockman.GetBlockPosFilename(pos)) ? m_blockman.OpenBlockFile(pos, true).release() : nullptr};
+                LOCK(m_mutex);
+                if (f) {
+                    m_files.try_emplace(file_num, f);
+                } else {
+                    // No block files left to scan, or the error is logged in OpenBlockFile
+                    m_end_file = std::min(m_end_file, file_num);
+                }
+                m_work_cv.notify_all();
+                m_done_cv.notify_all();
+            }
+        }
+    }
+
+public:
+    BlockFileScanner(node::BlockManager& blockman, const CChainParams& params, int num_threads)
+        : m_blockman{blockman}, m_params{params}, m_num_threads{num_threads}
+    {
+        for (int i = 0; i < num_threads; ++i) {
+            m_workers.emplace_back(&util::TraceThread, strprintf("reindex.%d", i), [this] { ThreadScan(); });
+        }
+    }
+
+    ~BlockFileScanner()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_work_cv.notify_all();
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    /** Move on to loading file `file_num`. Returns false if it does not exist. */
+    bool StartFile(int file_num) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_files.erase(m_files.begin(), m_files.lower_bound(file_num));
+        m_loading_file = file_num;
+        m_work_cv.notify_all();
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return file_num >= m_end_file || m_files.count(file_num); });
+        return file_num < m_end_file;
+    }
+
+    /** Take the next block of the file being loaded, if it has any left. */
+    std::optional<ScannedBlock> Next() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        File& f{m_files.at(m_loading_file)};
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return f.blocks.empty() ? f.done : f.blocks.front().checked; });
+        if (f.blocks.empty()) return std::nullopt;
+        ScannedBlock scanned{std::move(f.blocks.front())};
+        f.blocks.pop_front();
+        --f.next_check;
+        f.pending_bytes -= scanned.size;
+        m_work_cv.notify_all();
+        return scanned;
+    }
+};
+} // namespace
+
+void ChainstateManager::LoadBlockFiles(std::multimap<uint256, FlatFilePos>& blocks_with_unknown_parent)
+{
+    BlockFileScanner scanner{m_blockman, GetParams(), m_options.reindex_threads};
+    for (int file_num = 0; scanner.StartFile(file_num); ++file_num) {
+        LogPrintf("Reindexing block file blk%05u.dat...\n", (unsigned int)file_num);
+        const auto start{SteadyClock::now()};
+        int loaded{0};
+        while (auto scanned{scanner.Next()}) {
+            if (m_interrupt) return;
+
+            const auto read_block{[&] {
+                if (!scanned->block) throw std::ios_base::failure(scanned->error);
+                return scanned->block;
+            }};
+            try {
+                if (!LoadExternalBlock(scanned->header, read_block, &scanned->pos, &blocks_with_unknown_parent, loaded)) {
+                    // Skip the rest of the file, as LoadExternalBlockFile does
+                    while (scanner.Next()) {}
+                    break;
+                }
+            } catch (const std::exception& e) {
+                // See LoadExternalBlockFile
+                LogPrint(BCLog::REINDEX, "%s: unexpected data at file offset 0x%x - %s. continuing\n", __func__, scanned->pos.nPos, e.what());
+            }
+        }
+        LogPrintf("Loaded %i blocks from external file in %dms\n", loaded, Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
+    }
+}
+
 void ChainstateManager::CheckBlockIndex()
 {
     if (!ShouldCheckBlockIndex()) {
@@ -5378,70 +5700,56 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
         return false;
     }
 
-    COutPoint outpoint;
-    Coin coin;
     const uint64_t coins_count = metadata.m_coins_count;
-    uint64_t coins_left = metadata.m_coins_count;
 
     LogPrintf("[snapshot] loading coins from snapshot %s\n", base_blockhash.ToString());
     int64_t coins_processed{0};
 
-    while (coins_left > 0) {
-        try {
-            coins_file >> outpoint;
-            coins_file >> coin;
-        } catch (const std::ios_base::failure&) {
-            LogPrintf("[snapshot] bad snapshot format or truncated snapshot after deserializing %d coins\n",
-                      coins_count - coins_left);
-            return false;
-        }
-        if (coin.nHeight > base_height ||
-            outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
-        ) {
-            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins\n",
-                      coins_count - coins_left);
-            return false;
-        }
-        if (!MoneyRange(coin.out.nValue)) {
-            LogPrintf("[snapshot] bad snapshot data after deserializing %d coins - bad tx out value\n",
-                      coins_count - coins_left);
-            return false;
-        }
-
-        coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
-
-        --coins_left;
-        ++coins_processed;
-
-        if (coins_processed % 1000000 == 0) {
-            LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
-                coins_processed,
-                static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
-                coins_cache.DynamicMemoryUsage() / (1000 * 1000));
-        }
-
-        // Batch write and flush (if we need to) every so often.
-        //
-        // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
-        // means <5MB of memory imprecision.
-        if (coins_processed % 120000 == 0) {
-            if (m_interrupt) {
-                return false;
+    // The coins are hashed as they are read, in the order of the snapshot, so
+    // a snapshot matching the assumeutxo hash holds exactly the coins of the
+    // UTXO set it was dumped from.
+    auto stats{ReadSnapshotCoins(coins_file, coins_count, base_height, m_options.snapshot_threads,
+                                 [&](std::vector<std::pair<COutPoint, Coin>>& coins) {
+        for (auto& [outpoint, coin] : coins) {
+            coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
+
+            ++coins_processed;
+
+            if (coins_processed % 1000000 == 0) {
+                LogPrintf("[snapshot] %d coins loaded (%.2f%%, %.2f MB)\n",
+                    coins_processed,
+                    static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
+                    coins_cache.DynamicMemoryUsage() / (1000 * 1000));
             }
 
-            const auto snapshot_cache_state = WITH_LOCK(::cs_main,
-                return snapshot_chainstate.GetCoinsCacheSizeState());
+            // Batch write and flush (if we need to) every so often.
+            //
+            // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
+            // means <5MB of memory imprecision.
+            if (coins_processed % 120000 == 0) {
+                if (m_interrupt) {
+                    return false;
+                }
 
-            if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                // This is a hack - we don't know what the actual best block is, but that
-                // doesn't matter for the purposes of flushing the cache here. We'll set this
-                // to its correct value (`base_blockhash`) below after the coins are loaded.
-                coins_cache.SetBestBlock(GetRandHash());
+                const auto snapshot_cache_state = WITH_LOCK(::cs_main,
+                    return snapshot_chainstate.GetCoinsCacheSizeState());
 
-                // No need to acquire cs_main since this chainstate isn't being used yet.
-                FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
+                if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
+                    // This is a hack - we don't know what the actual best block is, but that
+                    // doesn't matter for the purposes of flushing the cache here. We'll set this
+                    // to its correct value (`base_blockhash`) below after the coins are loaded.
+                    coins_cache.SetBestBlock(GetRandHash());
+
+                    // No need to acquire cs_main since this chainstate isn't being used yet.
+                    FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
+                }
             }
         }
+        return true;
+    })};
+    if (!stats) {
+        LogPrintf("[snapshot] %s\n", util::ErrorString(stats).original);
+        return false;
     }
 
     // Important that we set this. This and the coins_cache accesses above are
@@ -5451,53 +5759,24 @@ bool ChainstateManager::PopulateAndValidateSnapshot(
     // method.
     coins_cache.SetBestBlock(base_blockhash);
 
-    bool out_of_coins{false};
-    try {
-        coins_file >> outpoint;
-    } catch (const std::ios_base::failure&) {
-        // We expect an exception since we should be out of coins.
-        out_of_coins = true;
-    }
-    if (!out_of_coins) {
-        LogPrintf("[snapshot] bad snapshot - coins left over after deserializing %d coins\n",
-            coins_count);
+    // Assert that the deserialized chainstate contents match the expected assumeutxo value.
+    if (AssumeutxoHash{stats->hash_serialized} != au_data.hash_serialized) {
+        LogPrintf("[snapshot] bad snapshot content hash: expected %s, got %s\n",
+            au_data.hash_serialized.ToString(), stats->hash_serialized.ToString());
         return false;
     }
 
-    LogPrintf("[snapshot] loaded %d (%.2f MB) coins from snapshot %s\n",
+    LogPrintf("[snapshot] loaded %d (%.2f MB) coins from snapshot %s (muhash %s)\n",
         coins_count,
         coins_cache.DynamicMemoryUsage() / (1000 * 1000),
-        base_blockhash.ToString());
+        base_blockhash.ToString(),
+        stats->muhash.ToString());
 
     // No need to acquire cs_main since this chainstate isn't being used yet.
     FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/true);
 
     assert(coins_cache.GetBestBlock() == base_blockhash);
 
-    // As above, okay to immediately release cs_main here since no other context knows
-    // about the snapshot_chainstate.
-    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
-
-    std::optional<CCoinsStats> maybe_stats;
-
-    try {
-        maybe_stats = ComputeUTXOStats(
-            CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
-    } catch (StopHashingException const&) {
-        return false;
-    }
-    if (!maybe_stats.has_value()) {
-        LogPrintf("[snapshot] failed to generate coins stats\n");
-        return false;
-    }
-
-    // Assert that the deserialized chainstate contents match the expected assumeutxo value.
-    if (AssumeutxoHash{maybe_stats->hashSerialized} != au_data.hash_serialized) {
-        LogPrintf("[snapshot] bad snapshot content hash: expected %s, got %s\n",
-            au_data.hash_serialized.ToString(), maybe_stats->hashSerialized.ToString());
-        return false;
-    }
-
     snapshot_chainstate.m_chain.SetTip(*snapshot_start_block);
 
     // The remainder of this function requires modifying data protected by cs_main.
@@ -36,6 +36,7 @@
 #include <versionbits.h>
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -824,6 +825,19 @@ enum class SnapshotCompletionResult {
 class ChainstateManager
 {
 private:
+    /**
+     * Add a block found in a block file to the block index, unless its parent is not known yet
+     * or it already is, then process the children of it that were found before it. The block is
+     * only read by `read_block` if it is needed. Returns false if the rest of the file should be
+     * skipped.
+     */
+    bool LoadExternalBlock(
+        const CBlockHeader& header,
+        const std::function<std::shared_ptr<CBlock>()>& read_block,
+        FlatFilePos* dbp,
+        std::multimap<uint256, FlatFilePos>* blocks_with_unknown_parent,
+        int& loaded);
+
     //! The chainstate used under normal operation (i.e. "regular" IBD) or, if
     //! a snapshot is in use, for background validation.
     //!
@@ -1109,6 +1123,19 @@ public:
         FlatFilePos* dbp = nullptr,
         std::multimap<uint256, FlatFilePos>* blocks_with_unknown_parent = nullptr);
 
+    /**
+     * Import the blocks of all block files (datadir/blocks/blk?????.dat) during reindexing.
+     *
+     * Blocks are processed in the same order and the same way as calling LoadExternalBlockFile
+     * for each file, but the files are scanned ahead by up to m_options.reindex_threads threads,
+     * which find, deserialize and run the context-free checks on their blocks. Only the parts
+     * that need the block index are left to the calling thread.
+     *
+     * @param[in,out] blocks_with_unknown_parent    Map of disk positions for blocks with unknown
+     *                                              parent, key is parent block hash
+     */
+    void LoadBlockFiles(std::multimap<uint256, FlatFilePos>& blocks_with_unknown_parent);
+
     /**
      * Process an incoming block. This only returns after the best known valid
      * block is made active. Note that it does not, however, guarantee that the
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The SuperAxeCoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test addressindex.
+
+Test that the getaddresshistory RPC and the /rest/addresshistory endpoint
+list the outputs paying to an address and the inputs spending them, follow
+reorgs, and that the index catches up with blocks connected while it was
+disabled.
+"""
+
+from decimal import Decimal
+import http.client
+import json
+import urllib.parse
+
+from test_framework.test_framework import SuperAxeCoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+from test_framework.wallet import (
+    MiniWallet,
+    getnewdestination,
+)
+
+
+class AddressIndexTest(SuperAxeCoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [["-addressindex", "-rest"], []]
+
+    def sync_index(self, node):
+        self.wait_until(lambda: node.getindexinfo("addressindex")["addressindex"]["synced"])
+
+    def rest_history(self, address, status=200, **query_params):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        uri = f"/rest/addresshistory/{address}.json"
+        if query_params:
+            uri += f"?{urllib.parse.urlencode(query_params)}"
+        conn.request("GET", uri)
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        body = resp.read().decode("utf-8")
+        return json.loads(body, parse_float=Decimal) if status == 200 else body
+
+    def run_test(self):
+        node = self.nodes[0]
+        self.wallet = MiniWallet(node)
+        # Addresses are encoded by the node, the test framework's encoders use
+        # upstream's human-readable parts.
+        address = node.decodescript(self.wallet.get_scriptPubKey().hex())["address"]
+        self.generate(self.wallet, 101)
+        self.sync_index(node)
+
+        self.log.info("Test that the coinbase outputs are listed, oldest first")
+        history = node.getaddresshistory(address, 0, 1000)
+        assert_equal(len(history), 101)
+        assert_equal([entry["height"] for entry in history], list(range(1, 102)))
+        assert all("spent" not in entry for entry in history)
+        assert_equal(len(node.getaddresshistory(address)), 100)
+
+        self.log.info("Test pagination")
+        assert_equal(node.getaddresshistory(address, 90, 5), history[90:95])
+        assert_equal(node.getaddresshistory(address, 100, 10), history[100:])
+        assert_equal(node.getaddresshistory(address, 101), [])
+        assert_raises_rpc_error(-8, "Negative skip", node.getaddresshistory, address, -1)
+        assert_raises_rpc_error(-8, "count must be between 0 and 1000", node.getaddresshistory, address, 0, 1001)
+        assert_raises_rpc_error(-5, "Invalid address", node.getaddresshistory, "notanaddress")
+
+        self.log.info("Test that spending an output records the spending input")
+        _, dest_script, _ = getnewdestination()
+        dest_address = node.decodescript(dest_script.hex())["address"]
+        send = self.wallet.send_to(from_node=node, scriptPubKey=dest_script, amount=100_000_000)
+        spent_txid = send["tx"].vin[0].prevout.hash.to_bytes(32, "big").hex()
+        self.generate(self.wallet, 1)
+        tip_height = node.getblockcount()
+
+        assert_equal(node.getaddresshistory(dest_address), [{
+            "height": tip_height,
+            "txid": send["txid"],
+            "vout": send["sent_vout"],
+            "amount": Decimal("1.00000000"),
+        }])
+        spent = [entry for entry in node.getaddresshistory(address, 0, 1000) if "spent" in entry]
+        assert_equal(len(spent), 1)
+        assert_equal(spent[0]["txid"], spent_txid)
+        assert_equal(spent[0]["spent"], {"txid": send["txid"], "vin": 0, "height": tip_height})
+
+        self.log.info("Test the REST interface")
+        assert_equal(self.rest_history(dest_address), node.getaddresshistory(dest_address))
+        assert_equal(self.rest_history(address, skip=90, count=5), history[90:95])
+        assert "Invalid address" in self.rest_history("notanaddress", status=400)
+        assert "out of acceptable range" in self.rest_history(address, status=400, count=1001)
+
+        self.log.info("Test that blocks disconnected in a reorg are removed from the index")
+        tip = node.getbestblockhash()
+        node.invalidateblock(tip)
+        fork = self.generateblock(node, output=address, transactions=[], sync_fun=self.no_op)["hash"]
+        self.sync_index(node)
+        assert_equal(node.getaddresshistory(dest_address), [])
+        assert all("spent" not in entry for entry in node.getaddresshistory(address, 0, 1000))
+        node.invalidateblock(fork)
+        node.reconsiderblock(tip)
+        self.sync_index(node)
+        assert_equal(len(node.getaddresshistory(dest_address)), 1)
+        assert_equal(len([entry for entry in node.getaddresshistory(address, 0, 1000) if "spent" in entry]), 1)
+
+        self.log.info("Test that the index is not available without -addressindex")
+        assert_raises_rpc_error(-1, "Address index is not enabled", self.nodes[1].getaddresshistory, address)
+
+        self.log.info("Test that the index catches up with blocks connected while disabled")
+        self.restart_node(0, extra_args=["-addressindex=0"])
+        self.generate(self.wallet, 5, sync_fun=self.no_op)
+        with node.assert_debug_log(["addressindex: synced 5 blocks"]):
+            self.restart_node(0, extra_args=["-addressindex", "-rest"])
+            self.sync_index(node)
+        assert_equal(len(node.getaddresshistory(address, 0, 1000)), 101 + 1 + 5 + 1)
+
+
+if __name__ == '__main__':
+    AddressIndexTest().main()
@@ -35,6 +35,7 @@ Interesting starting states could be loading a snapshot when the current chain t
 """
 from shutil import rmtree
 
+from test_framework.messages import hash256
 from test_framework.test_framework import SuperAxeCoinTestFramework
 from test_framework.util import (
     assert_equal,
@@ -75,39 +76,65 @@ class AssumeutxoTest(SuperAxeCoinTestFramework):
             with self.nodes[1].assert_debug_log([log_msg]):
                 assert_raises_rpc_error(-32603, f"Unable to load UTXO snapshot{rpc_details}", self.nodes[1].loadtxoutset, bad_snapshot_path)
 
+        # The metadata is made of magic bytes, a version, the base block hash
+        # and the number of coins. The coins follow in chunks, each starting
+        # with its number of coins, its size and the hash of its payload.
+        BLOCK_HASH_OFFSET = 5 + 2
+        NUM_COINS_OFFSET = BLOCK_HASH_OFFSET + 32
+        CHUNK_OFFSET = NUM_COINS_OFFSET + 8
+        PAYLOAD_OFFSET = CHUNK_OFFSET + 4 + 4 + 32
+
+        self.log.info("  - snapshot file with bad magic bytes or version")
+        for offset in [0, 5]:
+            with open(bad_snapshot_path, 'wb') as f:
+                f.write(valid_snapshot_contents[:offset] + b"\x00" + valid_snapshot_contents[offset + 1:])
+            assert_raises_rpc_error(-22, "Unable to parse metadata", self.nodes[1].loadtxoutset, bad_snapshot_path)
+
         self.log.info("  - snapshot file refering to a block that is not in the assumeutxo parameters")
         prev_block_hash = self.nodes[0].getblockhash(SNAPSHOT_BASE_HEIGHT - 1)
         bogus_block_hash = "0" * 64  # Represents any unknown block hash
         for bad_block_hash in [bogus_block_hash, prev_block_hash]:
             with open(bad_snapshot_path, 'wb') as f:
-                # block hash of the snapshot base is stored right at the start (first 32 bytes)
-                f.write(bytes.fromhex(bad_block_hash)[::-1] + valid_snapshot_contents[32:])
+                f.write(valid_snapshot_contents[:BLOCK_HASH_OFFSET])
+                f.write(bytes.fromhex(bad_block_hash)[::-1])
+                f.write(valid_snapshot_contents[NUM_COINS_OFFSET:])
             error_details = f", assumeutxo block hash in snapshot metadata not recognized ({bad_block_hash})"
             expected_error(rpc_details=error_details)
 
         self.log.info("  - snapshot file with wrong number of coins")
-        valid_num_coins = int.from_bytes(valid_snapshot_contents[32:32 + 8], "little")
+        valid_num_coins = int.from_bytes(valid_snapshot_contents[NUM_COINS_OFFSET:NUM_COINS_OFFSET + 8], "little")
         for off in [-1, +1]:
             with open(bad_snapshot_path, 'wb') as f:
-                f.write(valid_snapshot_contents[:32])
+                f.write(valid_snapshot_contents[:NUM_COINS_OFFSET])
                 f.write((valid_num_coins + off).to_bytes(8, "little"))
-                f.write(valid_snapshot_contents[32 + 8:])
-            expected_error(log_msg=f"bad snapshot - coins left over after deserializing 298 coins" if off == -1 else f"bad snapshot format or truncated snapshot after deserializing 299 coins")
+                f.write(valid_snapshot_contents[CHUNK_OFFSET:])
+            expected_error(log_msg=f"bad snapshot chunk header after reading 0 coins" if off == -1 else f"bad snapshot format or truncated snapshot after reading 299 coins")
+
+        self.log.info("  - snapshot file with a chunk not matching its hash")
+        with open(bad_snapshot_path, "wb") as f:
+            f.write(valid_snapshot_contents[:PAYLOAD_OFFSET])
+            f.write(b"\xff" * 32)
+            f.write(valid_snapshot_contents[PAYLOAD_OFFSET + 32:])
+        expected_error(log_msg="bad chunk hash after deserializing 0 coins")
 
         self.log.info("  - snapshot file with alternated UTXO data")
+        payload_size = int.from_bytes(valid_snapshot_contents[CHUNK_OFFSET + 4:CHUNK_OFFSET + 8], "little")
         cases = [
-            [b"\xff" * 32, 0, "05030e506678f2eca8d624ffed97090ab3beadad1b51ee6e5985ba91c5720e37"], # wrong outpoint hash
-            [(1).to_bytes(4, "little"), 32, "7d29cfe2c1e242bc6f103878bb70cfffa8b4dac20dbd001ff6ce24b7de2d2399"], # wrong outpoint index
-            [b"\x81", 36, "f03939a195531f96d5dff983e294a1af62af86049fa7a19a7627246f237c03f1"], # wrong coin code VARINT((coinbase ? 1 : 0) | (height << 1))
-            [b"\x83", 36, "e4577da84590fb288c0f7967e89575e1b0aa46624669640f6f5dfef028d39930"], # another wrong coin code
+            [b"\xff" * 32, 0], # wrong outpoint hash
+            [(1).to_bytes(4, "little"), 32], # wrong outpoint index
+            [b"\x81", 36], # wrong coin code VARINT((coinbase ? 1 : 0) | (height << 1))
+            [b"\x83", 36], # another wrong coin code
         ]
 
-        for content, offset, wrong_hash in cases:
+        for content, offset in cases:
+            payload = bytearray(valid_snapshot_contents[PAYLOAD_OFFSET:PAYLOAD_OFFSET + payload_size])
+            payload[offset:offset + len(content)] = content
             with open(bad_snapshot_path, "wb") as f:
-                f.write(valid_snapshot_contents[:(32 + 8 + offset)])
-                f.write(content)
-                f.write(valid_snapshot_contents[(32 + 8 + offset + len(content)):])
-            expected_error(log_msg=f"[snapshot] bad snapshot content hash: expected 61d9c2b29a2571a5fe285fe2d8554f91f93309666fc9b8223ee96338de25ff53, got {wrong_hash}")
+                f.write(valid_snapshot_contents[:CHUNK_OFFSET + 8])
+                f.write(hash256(payload))
+                f.write(payload)
+                f.write(valid_snapshot_contents[PAYLOAD_OFFSET + payload_size:])
+            expected_error(log_msg=f"[snapshot] bad snapshot content hash: expected 61d9c2b29a2571a5fe285fe2d8554f91f93309666fc9b8223ee96338de25ff53, got ")
 
     def test_invalid_chainstate_scenarios(self):
         self.log.info("Test different scenarios of invalid snapshot chainstate in datadir")
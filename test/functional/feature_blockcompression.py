@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The SuperAxeCoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test storing blocks compressed with -blockcompression.
+
+- Generate blocks on a node storing them compressed, and check they take less
+  space than on a node storing them as is.
+- Check compressed blocks are served to peers, by RPC and through the
+  txindex, the same as blocks stored as is.
+- Reindex from block files holding both compressed and uncompressed blocks.
+"""
+
+from test_framework.test_framework import SuperAxeCoinTestFramework
+from test_framework.util import assert_equal
+from test_framework.wallet import MiniWallet
+
+
+class BlockCompressionTest(SuperAxeCoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [["-blockcompression", "-txindex"], ["-txindex"]]
+
+    def run_test(self):
+        compressed, plain = self.nodes
+        wallet = MiniWallet(compressed)
+
+        self.log.info("Generate blocks with transactions")
+        self.generate(wallet, 101)
+        txids = []
+        for _ in range(5):
+            txids += [wallet.send_self_transfer(from_node=compressed)["txid"] for _ in range(20)]
+            self.generate(compressed, 1)
+        tip = compressed.getbestblockhash()
+
+        self.log.info("Check blocks are the same on both nodes")
+        for height in range(compressed.getblockcount() + 1):
+            blockhash = compressed.getblockhash(height)
+            assert_equal(compressed.getblock(blockhash, 0), plain.getblock(blockhash, 0))
+        for txid in txids:
+            assert_equal(compressed.getrawtransaction(txid), plain.getrawtransaction(txid))
+
+        self.log.info("Check compressed blocks take less space")
+        compressed_size = compressed.getblockchaininfo()["size_on_disk"]
+        plain_size = plain.getblockchaininfo()["size_on_disk"]
+        self.log.info(f"Blocks take {compressed_size} bytes compressed, {plain_size} bytes as is")
+        assert compressed_size < plain_size
+        self.stop_nodes()
+
+        self.log.info("Reindex blocks stored compressed and as is")
+        self.start_node(0, extra_args=["-txindex"])
+        self.generate(compressed, 2, sync_fun=self.no_op)
+        self.restart_node(0, extra_args=["-reindex", "-txindex"])
+        assert_equal(compressed.getblockcount(), 108)
+        assert_equal(compressed.getblock(tip)["confirmations"], 3)
+        self.wait_until(lambda: compressed.getindexinfo()["txindex"]["synced"])
+        for txid in txids:
+            assert_equal(compressed.getrawtransaction(txid, True)["txid"], txid)
+
+        self.log.info("Serve compressed blocks to peers")
+        self.restart_node(0, extra_args=["-blockcompression", "-txindex"])
+        self.generate(compressed, 2, sync_fun=self.no_op)
+        self.start_node(1, extra_args=["-txindex"])
+        self.connect_nodes(1, 0)
+        self.sync_blocks()
+        assert_equal(plain.getblockcount(), 110)
+
+
+if __name__ == '__main__':
+    BlockCompressionTest().main()
@@ -7,7 +7,8 @@
 - Start a single node and generate 3 blocks.
 - Stop the node and restart it with -reindex. Verify that the node has reindexed up to block 3.
 - Stop the node and restart it with -reindex-chainstate. Verify that the node has reindexed up to block 3.
-- Verify that out-of-order blocks are correctly processed, see LoadExternalBlockFile()
+- Verify that out-of-order blocks are correctly processed, see LoadExternalBlockFile(), both with
+  the block files scanned in parallel and one after the other (-reindexthreads=1).
 """
 
 from test_framework.test_framework import SuperAxeCoinTestFramework
@@ -62,16 +63,19 @@ class ReindexTest(SuperAxeCoinTestFramework):
             bf.write(b[b3_start:b4_start])
             bf.write(b[b2_start:b3_start])
 
-        # The reindexing code should detect and accommodate out of order blocks.
-        with self.nodes[0].assert_debug_log([
-            'LoadExternalBlockFile: Out of order block',
-            'LoadExternalBlockFile: Processing out of order child',
-        ]):
-            extra_args = [["-reindex"]]
-            self.start_nodes(extra_args)
-
-        # All blocks should be accepted and processed.
-        assert_equal(self.nodes[0].getblockcount(), 12)
+        for reindex_threads in [4, 1]:
+            # The reindexing code should detect and accommodate out of order blocks.
+            with self.nodes[0].assert_debug_log([
+                'LoadExternalBlockFile: Out of order block',
+                'LoadExternalBlockFile: Processing out of order child',
+            ]):
+                extra_args = [["-reindex", f"-reindexthreads={reindex_threads}"]]
+                self.start_nodes(extra_args)
+
+            # All blocks should be accepted and processed.
+            assert_equal(self.nodes[0].getblockcount(), 12)
+            self.stop_nodes()
+        self.start_nodes()
 
     def run_test(self):
         self.reindex(False)
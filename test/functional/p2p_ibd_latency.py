@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The SuperAxeCoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test adaptive block download over a high-latency link.
+
+Both nodes download the same chain of small blocks from a peer that answers
+getdata and ping messages only after an emulated round-trip delay. The node
+with adaptive block download keeps more than MAX_BLOCKS_IN_TRANSIT_PER_PEER
+blocks in flight once it has measured the link; the node with the fixed
+limit does not.
+"""
+
+import time
+
+from test_framework.blocktools import (
+    create_block,
+    create_coinbase,
+)
+from test_framework.messages import (
+    CBlockHeader,
+    MSG_BLOCK,
+    MSG_TYPE_MASK,
+    msg_block,
+    msg_headers,
+    msg_pong,
+)
+from test_framework.p2p import (
+    NetworkThread,
+    P2PInterface,
+)
+from test_framework.test_framework import SuperAxeCoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than,
+)
+
+# Emulated round-trip time of the link to the block serving peer
+LATENCY = 0.1
+NUM_BLOCKS = 1500
+MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16
+
+
+class P2PHighLatencyBlockServer(P2PInterface):
+    """Serves blocks from block_store, delaying every getdata and ping response by LATENCY."""
+    def __init__(self, block_store):
+        super().__init__()
+        self.block_store = block_store
+        self.in_flight = 0
+        self.max_in_flight = 0
+
+    def on_getdata(self, message):
+        blocks = [self.block_store[inv.hash] for inv in message.inv if (inv.type & MSG_TYPE_MASK) == MSG_BLOCK]
+        self.in_flight += len(blocks)
+        self.max_in_flight = max(self.max_in_flight, self.in_flight)
+        NetworkThread.network_event_loop.call_later(LATENCY, self.deliver_blocks, blocks)
+
+    def deliver_blocks(self, blocks):
+        for block in blocks:
+            self.send_message(msg_block(block))
+            self.in_flight -= 1
+
+    def on_ping(self, message):
+        NetworkThread.network_event_loop.call_later(LATENCY, self.send_message, msg_pong(message.nonce))
+
+    def on_getheaders(self, message):
+        pass
+
+
+class P2PIBDLatencyTest(SuperAxeCoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [[], ["-adaptiveblockdownload=0"]]
+
+    def setup_network(self):
+        self.setup_nodes()
+
+    def sync_from_server(self, node, blocks):
+        server = node.add_outbound_p2p_connection(P2PHighLatencyBlockServer({b.sha256: b for b in blocks}), p2p_idx=0, connection_type="outbound-full-relay")
+        start = time.time()
+        server.send_message(msg_headers([CBlockHeader(b) for b in blocks]))
+        self.wait_until(lambda: node.getblockcount() == NUM_BLOCKS, timeout=600)
+        elapsed = time.time() - start
+        node.disconnect_p2ps()
+        return elapsed, server.max_in_flight
+
+    def run_test(self):
+        self.log.info("Prepare blocks without sending them to the nodes")
+        tip = int(self.nodes[0].getbestblockhash(), 16)
+        block_time = self.nodes[0].getblock(self.nodes[0].getbestblockhash())['time'] + 1
+        blocks = []
+        for height in range(1, NUM_BLOCKS + 1):
+            blocks.append(create_block(tip, create_coinbase(height), block_time))
+            blocks[-1].solve()
+            tip = blocks[-1].sha256
+            block_time += 1
+
+        self.log.info(f"Sync {NUM_BLOCKS} blocks over a link with {LATENCY * 1000:.0f}ms round trips")
+        adaptive_time, adaptive_in_flight = self.sync_from_server(self.nodes[0], blocks)
+        fixed_time, fixed_in_flight = self.sync_from_server(self.nodes[1], blocks)
+        self.log.info(f"Adaptive: {adaptive_time:.1f}s, up to {adaptive_in_flight} blocks in flight")
+        self.log.info(f"Fixed: {fixed_time:.1f}s, up to {fixed_in_flight} blocks in flight")
+
+        assert_greater_than(adaptive_in_flight, MAX_BLOCKS_IN_TRANSIT_PER_PEER)
+        assert fixed_in_flight <= MAX_BLOCKS_IN_TRANSIT_PER_PEER
+        assert_equal(self.nodes[0].getbestblockhash(), self.nodes[1].getbestblockhash())
+
+
+if __name__ == '__main__':
+    P2PIBDLatencyTest().main()
@@ -48,6 +48,8 @@ class P2PIBDStallingTest(SuperAxeCoinTestFramework):
     def set_test_params(self):
         self.setup_clean_chain = True
         self.num_nodes = 1
+        # This test relies on the fixed 1024 block download window.
+        self.extra_args = [["-adaptiveblockdownload=0"]]
 
     def run_test(self):
         NUM_BLOCKS = 1025
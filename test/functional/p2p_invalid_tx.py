@@ -26,6 +26,7 @@ class InvalidTxRequestTest(SuperAxeCoinTestFramework):
         self.num_nodes = 1
         self.extra_args = [[
             "-acceptnonstdtxn=1",
+            "-maxorphantx=100",
         ]]
         self.setup_clean_chain = True
 
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The SuperAxeCoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test relay of 1-parent-1-child packages over the P2P network.
+
+A parent whose feerate is below the mempool minimum feerate is rejected on its
+own. Once an orphan child from the same peer pays for it, the node fetches the
+parent again and validates both as a package.
+"""
+
+from decimal import Decimal
+import time
+
+from test_framework.blocktools import COINBASE_MATURITY
+from test_framework.messages import msg_tx
+from test_framework.p2p import (
+    NONPREF_PEER_TX_DELAY,
+    P2PTxInvStore,
+    TXID_RELAY_DELAY,
+)
+from test_framework.test_framework import SuperAxeCoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than,
+    create_lots_of_big_transactions,
+    gen_return_txouts,
+)
+from test_framework.wallet import MiniWallet
+
+# Delay before the node requests a missing parent (by txid) from a non-preferred peer
+PARENT_REQUEST_DELAY = NONPREF_PEER_TX_DELAY + TXID_RELAY_DELAY + 1
+
+
+class PackageRelayTest(SuperAxeCoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+        self.extra_args = [[
+            "-datacarriersize=100000",
+            "-maxmempool=5",
+        ]]
+
+    def fill_mempool(self):
+        """Fill the mempool until eviction raises the mempool minimum feerate above minrelaytxfee."""
+        self.log.info("Fill the mempool until the mempoolminfee rises")
+        node = self.nodes[0]
+        txouts = gen_return_txouts()
+        relayfee = node.getnetworkinfo()['relayfee']
+        num_of_batches = 75
+        self.generate(self.wallet, num_of_batches)
+        self.generate(node, COINBASE_MATURITY - 1)
+        base_fee = relayfee * 130
+        with node.assert_debug_log(["rolling minimum fee bumped"]):
+            for batch in range(num_of_batches):
+                create_lots_of_big_transactions(self.wallet, node, (batch + 1) * base_fee, 1, txouts)
+        assert_greater_than(node.getmempoolinfo()['mempoolminfee'], Decimal('0.00001000'))
+
+    def create_package(self, child_pays):
+        """Create a parent below the mempool minimum feerate and a child spending it. The child
+        pays enough to bump the package above the minimum if child_pays is set."""
+        node = self.nodes[0]
+        mempoolminfee = node.getmempoolinfo()['mempoolminfee']
+        parent = self.wallet.create_self_transfer(fee_rate=node.getnetworkinfo()['relayfee'], confirmed_only=True)
+        child = self.wallet.create_self_transfer(
+            utxo_to_spend=parent["new_utxo"],
+            fee_rate=mempoolminfee * (10 if child_pays else 1),
+        )
+        return parent["tx"], child["tx"]
+
+    def provide_parent(self, peer, parent):
+        """Wait for the node to request the missing parent by txid and send it."""
+        self.nodes[0].bumpmocktime(PARENT_REQUEST_DELAY)
+        peer.wait_for_getdata([parent.sha256])
+        peer.send_and_ping(msg_tx(parent))
+
+    def test_parent_then_child(self):
+        self.log.info("Test that a rejected low-feerate parent is fetched again for its orphan child")
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(P2PTxInvStore())
+        parent, child = self.create_package(child_pays=True)
+
+        with node.assert_debug_log(["mempool min fee not met"]):
+            peer.send_and_ping(msg_tx(parent))
+        assert parent.rehash() not in node.getrawmempool()
+
+        peer.send_and_ping(msg_tx(child))
+        assert child.rehash() not in node.getrawmempool()
+        with node.assert_debug_log(["evaluating package"]):
+            self.provide_parent(peer, parent)
+        assert parent.rehash() in node.getrawmempool()
+        assert child.rehash() in node.getrawmempool()
+        node.disconnect_p2ps()
+
+    def test_child_then_parent(self):
+        self.log.info("Test that an orphan child pays for its parent when the parent arrives")
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(P2PTxInvStore())
+        parent, child = self.create_package(child_pays=True)
+
+        peer.send_and_ping(msg_tx(child))
+        self.provide_parent(peer, parent)
+        assert parent.rehash() in node.getrawmempool()
+        assert child.rehash() in node.getrawmempool()
+        node.disconnect_p2ps()
+
+    def test_package_too_low(self):
+        self.log.info("Test that a package below the mempool minimum feerate is rejected and not retried")
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(P2PTxInvStore())
+        parent, child = self.create_package(child_pays=False)
+
+        peer.send_and_ping(msg_tx(child))
+        with node.assert_debug_log(["package rejected"]):
+            self.provide_parent(peer, parent)
+        assert parent.rehash() not in node.getrawmempool()
+        assert child.rehash() not in node.getrawmempool()
+
+        # The same package is not evaluated again
+        with node.assert_debug_log(expected_msgs=[], unexpected_msgs=["evaluating package"]):
+            peer.send_and_ping(msg_tx(parent))
+        node.disconnect_p2ps()
+
+    def test_other_peer_child(self):
+        self.log.info("Test that a parent is not paired with an orphan from a different peer")
+        node = self.nodes[0]
+        peer_child = node.add_p2p_connection(P2PTxInvStore())
+        peer_parent = node.add_p2p_connection(P2PTxInvStore())
+        parent, child = self.create_package(child_pays=True)
+
+        peer_child.send_and_ping(msg_tx(child))
+        with node.assert_debug_log(expected_msgs=["mempool min fee not met"], unexpected_msgs=["evaluating package"]):
+            peer_parent.send_and_ping(msg_tx(parent))
+        assert parent.rehash() not in node.getrawmempool()
+
+        # The child's peer is still asked for the parent, and the package succeeds then.
+        self.provide_parent(peer_child, parent)
+        assert parent.rehash() in node.getrawmempool()
+        assert child.rehash() in node.getrawmempool()
+        node.disconnect_p2ps()
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.setmocktime(int(time.time()))
+        self.wallet = MiniWallet(node)
+        self.generate(self.wallet, 20)
+        self.fill_mempool()
+        assert_equal(node.getmempoolinfo()['minrelaytxfee'], Decimal('0.00001000'))
+
+        self.test_parent_then_child()
+        self.test_child_then_parent()
+        self.test_package_too_low()
+        self.test_other_peer_child()
+
+
+if __name__ == '__main__':
+    PackageRelayTest().main()
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The SuperAxeCoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test transaction announcement via reconciliation (BIP-330).
+
+Two separate fully connected meshes of nodes relay the same number of
+transactions: one with -txreconciliation, one without. Every node of both
+meshes must end up with every transaction, and the reconciling mesh must
+spend fewer bytes on announcements (inv plus the reconciliation messages).
+"""
+
+import time
+
+from test_framework.test_framework import SuperAxeCoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than,
+)
+from test_framework.wallet import MiniWallet
+
+MESH_SIZE = 4
+NUM_TXS = 200
+ANNOUNCEMENT_MSGS = ["inv", "reqrecon", "sketch", "reqsketchext", "reconcildiff"]
+
+
+class P2PTxRelayReconciliationTest(SuperAxeCoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2 * MESH_SIZE
+        self.extra_args = [["-txreconciliation"]] * MESH_SIZE + [[]] * MESH_SIZE
+
+    def setup_network(self):
+        self.setup_nodes()
+        for mesh in self.meshes():
+            for i, a in enumerate(mesh):
+                for b in mesh[i + 1:]:
+                    self.connect_nodes(a.index, b.index)
+
+    def meshes(self):
+        return [self.nodes[:MESH_SIZE], self.nodes[MESH_SIZE:]]
+
+    def announcement_bytes(self, mesh):
+        total = 0
+        for node in mesh:
+            for peer in node.getpeerinfo():
+                total += sum(peer["bytessent_per_msg"].get(msg, 0) for msg in ANNOUNCEMENT_MSGS)
+        return total
+
+    def relay(self, mesh, mocktime):
+        """Send NUM_TXS transactions from the first node and wait until every node has them all."""
+        wallet = MiniWallet(mesh[0])
+        self.generate(wallet, 101, sync_fun=lambda: self.sync_blocks(mesh))
+        # Fan out to enough outputs to send NUM_TXS independent transactions.
+        wallet.send_self_transfer_multi(from_node=mesh[0], num_outputs=NUM_TXS)
+        self.generate(mesh[0], 1, sync_fun=lambda: self.sync_blocks(mesh))
+        wallet.rescan_utxos()
+
+        before = self.announcement_bytes(mesh)
+        for _ in range(NUM_TXS):
+            wallet.send_self_transfer(from_node=mesh[0], utxo_to_spend=wallet.get_utxo(confirmed_only=True))
+
+        # Drive trickle and reconciliation timers with mocktime instead of waiting for them.
+        def all_received():
+            nonlocal mocktime
+            mocktime += 1
+            for node in mesh:
+                node.setmocktime(mocktime)
+            return all(node.getmempoolinfo()["size"] == NUM_TXS for node in mesh)
+        self.wait_until(all_received, timeout=120)
+        return self.announcement_bytes(mesh) - before, mocktime
+
+    def run_test(self):
+        mocktime = int(time.time())
+        for node in self.nodes:
+            node.setmocktime(mocktime)
+
+        reconciling, flooding = self.meshes()
+        self.log.info("Check that reconciling peers registered each other")
+        for node in reconciling:
+            assert_equal(len(node.getpeerinfo()), MESH_SIZE - 1)
+
+        self.log.info(f"Relay {NUM_TXS} transactions through a mesh of {MESH_SIZE} reconciling nodes")
+        recon_bytes, mocktime = self.relay(reconciling, mocktime)
+        self.log.info(f"Relay {NUM_TXS} transactions through a mesh of {MESH_SIZE} flooding nodes")
+        flood_bytes, mocktime = self.relay(flooding, mocktime)
+        self.log.info(f"Announcement bytes: {recon_bytes} with reconciliation, {flood_bytes} with flooding "
+                      f"({100 * (1 - recon_bytes / flood_bytes):.0f}% saved)")
+
+        for node in reconciling:
+            for peer in node.getpeerinfo():
+                assert "sketch" in peer["bytesrecv_per_msg"] or "sketch" in peer["bytessent_per_msg"]
+        assert_greater_than(flood_bytes, recon_bytes)
+
+
+if __name__ == '__main__':
+    P2PTxRelayReconciliationTest().main()
@@ -47,6 +47,7 @@ class DumptxoutsetTest(SuperAxeCoinTestFramework):
 
         assert_equal(
             out['txoutset_hash'], 'a0b7baa3bf5ccbd3279728f230d7ca0c44a76e9923fca8f32dbfd08d65ea496a')
+        assert_equal(out['txoutset_muhash'], node.gettxoutsetinfo("muhash")['muhash'])
         assert_equal(out['nchaintx'], 101)
 
         # Specifying a path to an existing or invalid file will fail.
@@ -103,6 +103,11 @@ class NetTest(SuperAxeCoinTestFramework):
         assert_equal(peer_info[1][0]['connection_type'], 'manual')
         assert_equal(peer_info[1][1]['connection_type'], 'inbound')
 
+        # check the per-peer resource accounting
+        for info in peer_info:
+            assert_greater_than(info[0]["processtime_per_msg"]["version"], 0)
+            assert_greater_than(info[0]["processtime"], 0)
+
         # Check dynamically generated networks list in getpeerinfo help output.
         assert "(ipv4, ipv6, onion, i2p, cjdns, not_publicly_routable)" in self.nodes[0].help("getpeerinfo")
 
@@ -116,6 +121,8 @@ class NetTest(SuperAxeCoinTestFramework):
         peer_info = self.nodes[0].getpeerinfo()[no_version_peer_id]
         peer_info.pop("addr")
         peer_info.pop("addrbind")
+        # Includes the transport's own send buffers, whose size depends on the transport implementation
+        peer_info.pop("send_queue_bytes")
         assert_equal(
             peer_info,
             {
@@ -139,18 +146,24 @@ class NetTest(SuperAxeCoinTestFramework):
                 "lastsend": 0,
                 "minfeefilter": Decimal("0E-8"),
                 "network": "not_publicly_routable",
+                "orphan_bytes": 0,
                 "permissions": [],
                 "presynced_headers": -1,
+                "processtime": 0,
+                "processtime_per_msg": {},
+                "recv_queue_bytes": 0,
                 "relaytxes": False,
                 "services": "0000000000000000",
                 "servicesnames": [],
                 "session_id": "",
+                "sigchecks": 0,
                 "startingheight": -1,
                 "subver": "",
                 "synced_blocks": -1,
                 "synced_headers": -1,
                 "timeoffset": 0,
                 "transport_protocol_type": "v1",
+                "txrequest_bytes": 0,
                 "version": 0,
             },
         )
@@ -70,6 +70,13 @@ class ScanblocksTest(SuperAxeCoinTestFramework):
                 start_height=height,
                 options={"filter_false_positives": v})['relevant_blocks']
 
+        # matching the filters in several threads finds the same blocks, in order
+        descs = [{"desc": f"pkh({parent_key}/*)", "range": [0, 100]}]
+        expected = node.scanblocks("start", descs)['relevant_blocks']
+        for threads in [2, 7, 0]:
+            assert_equal(node.scanblocks(
+                "start", descs, options={"threads": threads})['relevant_blocks'], expected)
+
         # also test the stop height
         assert blockhash in node.scanblocks(
             "start", [f"addr({addr_1})"], height, height)['relevant_blocks']
@@ -1889,6 +1889,88 @@ class msg_sendtxrcncl:
         return "msg_sendtxrcncl(version=%lu, salt=%lu)" %\
             (self.version, self.salt)
 
+
+class msg_reqrecon:
+    __slots__ = ("set_size", "q")
+    msgtype = b"reqrecon"
+
+    def __init__(self, set_size=0, q=0):
+        self.set_size = set_size
+        self.q = q
+
+    def deserialize(self, f):
+        self.set_size = struct.unpack("<H", f.read(2))[0]
+        self.q = struct.unpack("<H", f.read(2))[0]
+
+    def serialize(self):
+        r = b""
+        r += struct.pack("<H", self.set_size)
+        r += struct.pack("<H", self.q)
+        return r
+
+    def __repr__(self):
+        return "msg_reqrecon(set_size=%lu, q=%lu)" %\
+            (self.set_size, self.q)
+
+
+class msg_sketch:
+    __slots__ = ("skdata",)
+    msgtype = b"sketch"
+
+    def __init__(self, skdata=b""):
+        self.skdata = skdata
+
+    def deserialize(self, f):
+        self.skdata = deser_string(f)
+
+    def serialize(self):
+        return ser_string(self.skdata)
+
+    def __repr__(self):
+        return "msg_sketch(skdata=%s)" % self.skdata.hex()
+
+
+class msg_reqsketchext:
+    __slots__ = ()
+    msgtype = b"reqsketchext"
+
+    def __init__(self):
+        pass
+
+    def deserialize(self, f):
+        pass
+
+    def serialize(self):
+        return b""
+
+    def __repr__(self):
+        return "msg_reqsketchext()"
+
+
+class msg_reconcildiff:
+    __slots__ = ("success", "ask_shortids")
+    msgtype = b"reconcildiff"
+
+    def __init__(self, success=0, ask_shortids=None):
+        self.success = success
+        self.ask_shortids = ask_shortids if ask_shortids is not None else []
+
+    def deserialize(self, f):
+        self.success = struct.unpack("<B", f.read(1))[0]
+        self.ask_shortids = [struct.unpack("<I", f.read(4))[0] for _ in range(deser_compact_size(f))]
+
+    def serialize(self):
+        r = b""
+        r += struct.pack("<B", self.success)
+        r += ser_compact_size(len(self.ask_shortids))
+        for short_id in self.ask_shortids:
+            r += struct.pack("<I", short_id)
+        return r
+
+    def __repr__(self):
+        return "msg_reconcildiff(success=%i, ask_shortids=%s)" %\
+            (self.success, repr(self.ask_shortids))
+
 class TestFrameworkScript(unittest.TestCase):
     def test_addrv2_encode_decode(self):
         def check_addrv2(ip, net):
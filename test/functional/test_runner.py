@@ -126,6 +126,7 @@ BASE_SCRIPTS = [
     'wallet_address_types.py --legacy-wallet',
     'wallet_address_types.py --descriptors',
     'p2p_orphan_handling.py',
+    'p2p_opportunistic_1p1c.py',
     'wallet_basic.py --legacy-wallet',
     'wallet_basic.py --descriptors',
     'feature_maxtipage.py',
@@ -165,6 +166,7 @@ BASE_SCRIPTS = [
     'wallet_abandonconflict.py --descriptors',
     'feature_reindex.py',
     'feature_reindex_readonly.py',
+    'feature_blockcompression.py',
     'wallet_labels.py --legacy-wallet',
     'wallet_labels.py --descriptors',
     'p2p_compactblocks.py',
@@ -277,6 +279,7 @@ BASE_SCRIPTS = [
     'p2p_leak_tx.py',
     'p2p_leak_tx.py --v2transport',
     'p2p_eviction.py',
+    'p2p_ibd_latency.py',
     'p2p_ibd_stalling.py',
     'p2p_ibd_stalling.py --v2transport',
     'p2p_net_deadlock.py',
@@ -356,12 +359,14 @@ BASE_SCRIPTS = [
     'p2p_tx_privacy.py',
     'rpc_scanblocks.py',
     'p2p_sendtxrcncl.py',
+    'p2p_txrelay_reconciliation.py',
     'rpc_scantxoutset.py',
     'feature_txindex_compatibility.py',
     'feature_unsupported_utxo_db.py',
     'feature_logging.py',
     'feature_anchors.py',
     'mempool_datacarrier.py',
+    'feature_addressindex.py',
     'feature_coinstatsindex.py',
     'wallet_orphanedreward.py',
     'wallet_timelock.py',